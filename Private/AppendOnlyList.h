@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+
+namespace rl
+{
+
+// A list one thread appends to while any thread reads what has been appended, entries live in fixed blocks that never move.
+// Push publishes the entry with a release store of the count, readers acquire the count before touching the block, so an index handed to another thread is always readable.
+template<typename T, uint32_t BlockSize, uint32_t MaxBlocks>
+struct AppendOnlyList
+{
+	static constexpr uint32_t Capacity = BlockSize * MaxBlocks;
+	static constexpr uint32_t InvalidIndex = ~0u;
+
+	// Owner thread only, InvalidIndex once the list is full.
+	uint32_t Push(const T& value)
+	{
+		const uint32_t index = Count.load(std::memory_order_relaxed);
+
+		if (index >= Capacity)
+		{
+			return InvalidIndex;
+		}
+
+		std::unique_ptr<T[]>& block = Blocks[index / BlockSize];
+		if (!block)
+		{
+			block = std::make_unique<T[]>(BlockSize);
+		}
+
+		block[index % BlockSize] = value;
+
+		Count.store(index + 1u, std::memory_order_release);
+
+		return index;
+	}
+
+	// Any thread, null for an index that hasn't been pushed.
+	const T* Find(uint32_t index) const
+	{
+		if (index >= Count.load(std::memory_order_acquire))
+		{
+			return nullptr;
+		}
+
+		return &Blocks[index / BlockSize][index % BlockSize];
+	}
+
+	uint32_t GetCount() const { return Count.load(std::memory_order_acquire); }
+
+	// Only while no thread is reading, the blocks are kept for the next entries.
+	void Clear() { Count.store(0u, std::memory_order_relaxed); }
+
+private:
+	std::unique_ptr<T[]> Blocks[MaxBlocks];
+	std::atomic<uint32_t> Count = 0u;
+};
+
+}
@@ -0,0 +1,478 @@
+#include "AsyncFileReader.h"
+
+#include <cassert>
+#include <cstring>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace rl
+{
+
+AsyncFileReader::~AsyncFileReader()
+{
+	ShutDown();
+}
+
+bool AsyncFileReader::Init(uint32_t queueDepth)
+{
+	assert(QueueDepth == 0u && "AsyncFileReader::Init called twice");
+
+	if (queueDepth == 0u)
+	{
+		return false;
+	}
+
+	QueueDepth = queueDepth;
+	Slots.resize(queueDepth);
+
+	for (uint32_t slot = queueDepth; slot > 0u; slot--)
+	{
+		FreeSlots.push_back(slot - 1u);
+	}
+
+	if (!InitPlatform())
+	{
+		ShutDown();
+		return false;
+	}
+
+	return true;
+}
+
+void AsyncFileReader::ShutDown()
+{
+	if (QueueDepth == 0u)
+	{
+		return;
+	}
+
+	QueuedParts.clear();
+
+	// The kernel may still be writing into the destinations, so they can't be handed back before the parts in flight finish
+	std::vector<Completion> dropped;
+	while (GetInFlightCount() > 0u)
+	{
+		Reap(dropped, true);
+		QueuedParts.clear();
+	}
+
+	ShutDownPlatform();
+
+	QueueDepth = 0u;
+	PendingCount = 0u;
+
+	Requests.clear();
+	FreeRequests.clear();
+	Slots.clear();
+	FreeSlots.clear();
+}
+
+void AsyncFileReader::Read(AsyncFileHandle file, size_t offset, void* pDst, size_t size, uint64_t userData)
+{
+	assert(QueueDepth > 0u && size > 0u);
+
+	uint32_t request = 0u;
+	if (!FreeRequests.empty())
+	{
+		request = FreeRequests.back();
+		FreeRequests.pop_back();
+	}
+	else
+	{
+		request = (uint32_t)Requests.size();
+		Requests.emplace_back();
+	}
+
+	Requests[request] = { userData, 0u, false };
+
+	for (size_t partOffset = 0u; partOffset < size; partOffset += ReadPartSize)
+	{
+		const uint32_t partSize = size - partOffset < ReadPartSize ? (uint32_t)(size - partOffset) : ReadPartSize;
+
+		QueuedParts.push_back({ request, file, offset + partOffset, (uint8_t*)pDst + partOffset, partSize });
+		Requests[request].OutstandingParts++;
+	}
+
+	PendingCount++;
+}
+
+void AsyncFileReader::Poll(std::vector<Completion>& completions, bool wait)
+{
+	StartQueuedParts(completions);
+
+	if (GetInFlightCount() == 0u)
+	{
+		return;
+	}
+
+	Reap(completions, wait);
+
+	// Refill the slots the finished parts gave back, so the disk stays busy while the caller handles the completions
+	StartQueuedParts(completions);
+}
+
+void AsyncFileReader::StartQueuedParts(std::vector<Completion>& completions)
+{
+	while (!QueuedParts.empty() && !FreeSlots.empty())
+	{
+		const uint32_t slot = FreeSlots.back();
+		FreeSlots.pop_back();
+
+		Slots[slot] = QueuedParts.front();
+		QueuedParts.pop_front();
+
+		if (!StartPart(slot))
+		{
+			FinishPart(slot, -1, completions);
+		}
+	}
+
+#if !defined(_WIN32)
+	if (Ring >= 0 && UnsubmittedCount > 0u)
+	{
+		const long submitted = syscall(__NR_io_uring_enter, Ring, UnsubmittedCount, 0u, 0u, nullptr, 0u);
+		UnsubmittedCount -= submitted > 0 ? (uint32_t)submitted : 0u;
+	}
+#endif
+}
+
+void AsyncFileReader::FinishPart(uint32_t slot, int64_t result, std::vector<Completion>& completions)
+{
+	Part part = Slots[slot];
+
+	Slots[slot] = {};
+	FreeSlots.push_back(slot);
+
+#if !defined(_WIN32)
+	if (result == -EINTR || result == -EAGAIN)
+	{
+		QueuedParts.push_front(part);
+		return;
+	}
+#endif
+
+	// A read of 0 bytes means the file ended before the range did
+	if (result <= 0)
+	{
+		RetirePart(part.Request, false, completions);
+		return;
+	}
+
+	// Short reads carry on from where they stopped
+	if ((uint64_t)result < part.Size)
+	{
+		part.Offset += (size_t)result;
+		part.pDst += result;
+		part.Size -= (uint32_t)result;
+
+		QueuedParts.push_front(part);
+		return;
+	}
+
+	RetirePart(part.Request, true, completions);
+}
+
+void AsyncFileReader::RetirePart(uint32_t request, bool success, std::vector<Completion>& completions)
+{
+	Request& owner = Requests[request];
+
+	owner.Failed |= !success;
+
+	if (--owner.OutstandingParts > 0u)
+	{
+		return;
+	}
+
+	completions.push_back({ owner.UserData, !owner.Failed });
+
+	FreeRequests.push_back(request);
+	PendingCount--;
+}
+
+#if defined(_WIN32)
+
+static OVERLAPPED* GetOverlapped(std::vector<uint8_t>& storage, uint32_t slot)
+{
+	return (OVERLAPPED*)storage.data() + slot;
+}
+
+bool AsyncFileReader::InitPlatform()
+{
+	Overlapped.resize(QueueDepth * sizeof(OVERLAPPED));
+
+	Port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+
+	return Port != nullptr;
+}
+
+void AsyncFileReader::ShutDownPlatform()
+{
+	if (Port)
+	{
+		CloseHandle(Port);
+	}
+
+	Port = nullptr;
+	Overlapped.clear();
+}
+
+AsyncFileHandle AsyncFileReader::Open(const char* path, size_t& outSize)
+{
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return InvalidAsyncFile;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || !CreateIoCompletionPort(file, Port, 0, 0))
+	{
+		CloseHandle(file);
+		return InvalidAsyncFile;
+	}
+
+	outSize = (size_t)size.QuadPart;
+
+	return file;
+}
+
+void AsyncFileReader::Close(AsyncFileHandle file)
+{
+	if (file != InvalidAsyncFile)
+	{
+		CloseHandle(file);
+	}
+}
+
+bool AsyncFileReader::StartPart(uint32_t slot)
+{
+	const Part& part = Slots[slot];
+
+	OVERLAPPED* overlapped = GetOverlapped(Overlapped, slot);
+	memset(overlapped, 0, sizeof(OVERLAPPED));
+	overlapped->Offset = (DWORD)part.Offset;
+	overlapped->OffsetHigh = (DWORD)((uint64_t)part.Offset >> 32u);
+
+	// Reads that finish straight away still post to the port, so every started part completes through Reap
+	return ReadFile(part.File, part.pDst, part.Size, nullptr, overlapped) || GetLastError() == ERROR_IO_PENDING;
+}
+
+void AsyncFileReader::Reap(std::vector<Completion>& completions, bool wait)
+{
+	OVERLAPPED_ENTRY entries[64];
+	ULONG removed = 0u;
+
+	if (!GetQueuedCompletionStatusEx(Port, entries, (ULONG)(sizeof(entries) / sizeof(entries[0])), &removed, wait ? INFINITE : 0u, FALSE))
+	{
+		return;
+	}
+
+	for (ULONG i = 0; i < removed; i++)
+	{
+		const uint32_t slot = (uint32_t)(entries[i].lpOverlapped - GetOverlapped(Overlapped, 0u));
+
+		DWORD bytes = 0u;
+		const bool success = GetOverlappedResult(Slots[slot].File, entries[i].lpOverlapped, &bytes, FALSE);
+
+		FinishPart(slot, success ? (int64_t)bytes : -1, completions);
+	}
+}
+
+#else
+
+bool AsyncFileReader::InitPlatform()
+{
+	io_uring_params params = {};
+
+	Ring = (int)syscall(__NR_io_uring_setup, QueueDepth, &params);
+
+	// Kernels before 5.6 have no plain read op, RW_CUR_POS arrived with it, so those and kernels without io_uring read in Poll instead
+	if (Ring < 0 || !(params.features & IORING_FEAT_RW_CUR_POS))
+	{
+		ShutDownPlatform();
+		return true;
+	}
+
+	SqMemorySize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+	CqMemorySize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+	const bool singleMapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0u;
+	if (singleMapping)
+	{
+		SqMemorySize = CqMemorySize = SqMemorySize > CqMemorySize ? SqMemorySize : CqMemorySize;
+	}
+
+	SqMemory = mmap(nullptr, SqMemorySize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, Ring, IORING_OFF_SQ_RING);
+	CqMemory = singleMapping ? SqMemory : mmap(nullptr, CqMemorySize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, Ring, IORING_OFF_CQ_RING);
+
+	SqesSize = params.sq_entries * sizeof(io_uring_sqe);
+	Sqes = mmap(nullptr, SqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, Ring, IORING_OFF_SQES);
+
+	if (SqMemory == MAP_FAILED || CqMemory == MAP_FAILED || Sqes == MAP_FAILED)
+	{
+		ShutDownPlatform();
+		return true;
+	}
+
+	uint8_t* sq = (uint8_t*)SqMemory;
+	uint8_t* cq = (uint8_t*)CqMemory;
+
+	SqTail = (uint32_t*)(sq + params.sq_off.tail);
+	SqMask = (uint32_t*)(sq + params.sq_off.ring_mask);
+	SqArray = (uint32_t*)(sq + params.sq_off.array);
+
+	CqHead = (uint32_t*)(cq + params.cq_off.head);
+	CqTail = (uint32_t*)(cq + params.cq_off.tail);
+	CqMask = (uint32_t*)(cq + params.cq_off.ring_mask);
+	Cqes = cq + params.cq_off.cqes;
+
+	return true;
+}
+
+void AsyncFileReader::ShutDownPlatform()
+{
+	if (Sqes && Sqes != MAP_FAILED)
+	{
+		munmap(Sqes, SqesSize);
+	}
+
+	if (CqMemory && CqMemory != MAP_FAILED && CqMemory != SqMemory)
+	{
+		munmap(CqMemory, CqMemorySize);
+	}
+
+	if (SqMemory && SqMemory != MAP_FAILED)
+	{
+		munmap(SqMemory, SqMemorySize);
+	}
+
+	if (Ring >= 0)
+	{
+		close(Ring);
+	}
+
+	Ring = -1;
+	SqMemory = CqMemory = Sqes = Cqes = nullptr;
+	SqTail = SqMask = SqArray = CqHead = CqTail = CqMask = nullptr;
+	UnsubmittedCount = 0u;
+}
+
+AsyncFileHandle AsyncFileReader::Open(const char* path, size_t& outSize)
+{
+	const int file = open(path, O_RDONLY | O_CLOEXEC);
+	if (file < 0)
+	{
+		return InvalidAsyncFile;
+	}
+
+	struct stat st;
+	if (fstat(file, &st) != 0)
+	{
+		close(file);
+		return InvalidAsyncFile;
+	}
+
+	posix_fadvise(file, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+	outSize = (size_t)st.st_size;
+
+	return file;
+}
+
+void AsyncFileReader::Close(AsyncFileHandle file)
+{
+	if (file != InvalidAsyncFile)
+	{
+		close(file);
+	}
+}
+
+bool AsyncFileReader::StartPart(uint32_t slot)
+{
+	if (Ring < 0)
+	{
+		return true;
+	}
+
+	const Part& part = Slots[slot];
+
+	// Parts in flight never outnumber the submission entries, so there is always room
+	const uint32_t tail = *SqTail;
+	const uint32_t index = tail & *SqMask;
+
+	io_uring_sqe* sqe = (io_uring_sqe*)Sqes + index;
+	memset(sqe, 0, sizeof(io_uring_sqe));
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = part.File;
+	sqe->off = part.Offset;
+	sqe->addr = (uint64_t)(uintptr_t)part.pDst;
+	sqe->len = part.Size;
+	sqe->user_data = slot;
+
+	SqArray[index] = index;
+	__atomic_store_n(SqTail, tail + 1u, __ATOMIC_RELEASE);
+
+	UnsubmittedCount++;
+
+	return true;
+}
+
+void AsyncFileReader::Reap(std::vector<Completion>& completions, bool wait)
+{
+	if (Ring < 0)
+	{
+		// Without io_uring the parts are read here, one after another
+		for (uint32_t slot = 0; slot < QueueDepth; slot++)
+		{
+			const Part& part = Slots[slot];
+
+			if (part.Request != InvalidSlot)
+			{
+				const ssize_t result = pread(part.File, part.pDst, part.Size, (off_t)part.Offset);
+				FinishPart(slot, result < 0 ? -(int64_t)errno : (int64_t)result, completions);
+			}
+		}
+
+		return;
+	}
+
+	if (wait || UnsubmittedCount > 0u)
+	{
+		long result = 0;
+		do
+		{
+			result = syscall(__NR_io_uring_enter, Ring, UnsubmittedCount, wait ? 1u : 0u, wait ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0u);
+		}
+		while (result < 0 && errno == EINTR);
+
+		UnsubmittedCount -= result > 0 ? (uint32_t)result : 0u;
+	}
+
+	uint32_t head = *CqHead;
+	const uint32_t tail = __atomic_load_n(CqTail, __ATOMIC_ACQUIRE);
+
+	while (head != tail)
+	{
+		const io_uring_cqe& cqe = ((const io_uring_cqe*)Cqes)[head & *CqMask];
+		head++;
+
+		FinishPart((uint32_t)cqe.user_data, cqe.res, completions);
+	}
+
+	__atomic_store_n(CqHead, head, __ATOMIC_RELEASE);
+}
+
+#endif
+
+}
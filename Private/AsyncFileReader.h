@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace rl
+{
+
+#if defined(_WIN32)
+using AsyncFileHandle = void*;
+static const AsyncFileHandle InvalidAsyncFile = (AsyncFileHandle)(intptr_t)-1;
+#else
+using AsyncFileHandle = int;
+static const AsyncFileHandle InvalidAsyncFile = -1;
+#endif
+
+// Reads file ranges into caller owned memory with many reads in flight at once, so one thread keeps the disk queue full.
+// Uses io_uring on linux and overlapped reads on an io completion port on windows, where io_uring isn't available reads block in Poll.
+// Only the thread that owns the reader may use it.
+struct AsyncFileReader
+{
+	// Each read is split into parts of at most this size, so a large read doesn't hold up the queue.
+	static constexpr uint32_t ReadPartSize = 1024u * 1024u;
+
+	struct Completion
+	{
+		uint64_t UserData = 0u;
+		bool Success = false;
+	};
+
+	AsyncFileReader() = default;
+	AsyncFileReader(const AsyncFileReader&) = delete;
+	AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+
+	~AsyncFileReader();
+
+	// queueDepth is the number of parts kept in flight.
+	bool Init(uint32_t queueDepth);
+
+	// Waits for the reads in flight, queued reads that haven't started are dropped without a completion.
+	void ShutDown();
+
+	AsyncFileHandle Open(const char* path, size_t& outSize);
+	void Close(AsyncFileHandle file);
+
+	// pDst must stay valid until the read's completion is returned by Poll.
+	void Read(AsyncFileHandle file, size_t offset, void* pDst, size_t size, uint64_t userData);
+
+	// Starts queued parts and appends finished reads to completions, when wait is set it blocks until at least one part finishes.
+	void Poll(std::vector<Completion>& completions, bool wait);
+
+	// Reads that haven't been returned by Poll yet.
+	uint32_t GetPendingCount() const { return PendingCount; }
+
+private:
+	static constexpr uint32_t InvalidSlot = ~0u;
+
+	struct Request
+	{
+		uint64_t UserData = 0u;
+		uint32_t OutstandingParts = 0u;
+		bool Failed = false;
+	};
+
+	struct Part
+	{
+		uint32_t Request = InvalidSlot;
+		AsyncFileHandle File = InvalidAsyncFile;
+		size_t Offset = 0u;
+		uint8_t* pDst = nullptr;
+		uint32_t Size = 0u;
+	};
+
+	uint32_t QueueDepth = 0u;
+	uint32_t PendingCount = 0u;
+
+	std::vector<Request> Requests;
+	std::vector<uint32_t> FreeRequests;
+
+	// Parts waiting for a slot, and the parts in flight indexed by slot.
+	std::deque<Part> QueuedParts;
+	std::vector<Part> Slots;
+	std::vector<uint32_t> FreeSlots;
+
+#if defined(_WIN32)
+	void* Port = nullptr;
+	std::vector<uint8_t> Overlapped;
+#else
+	int Ring = -1;
+
+	void* SqMemory = nullptr;
+	size_t SqMemorySize = 0u;
+	void* CqMemory = nullptr;
+	size_t CqMemorySize = 0u;
+	void* Sqes = nullptr;
+	size_t SqesSize = 0u;
+
+	uint32_t* SqTail = nullptr;
+	uint32_t* SqMask = nullptr;
+	uint32_t* SqArray = nullptr;
+	uint32_t* CqHead = nullptr;
+	uint32_t* CqTail = nullptr;
+	uint32_t* CqMask = nullptr;
+	void* Cqes = nullptr;
+
+	uint32_t UnsubmittedCount = 0u;
+#endif
+
+	uint32_t GetInFlightCount() const { return QueueDepth - (uint32_t)FreeSlots.size(); }
+
+	void StartQueuedParts(std::vector<Completion>& completions);
+	bool StartPart(uint32_t slot);
+	void FinishPart(uint32_t slot, int64_t result, std::vector<Completion>& completions);
+	void RetirePart(uint32_t request, bool success, std::vector<Completion>& completions);
+	void Reap(std::vector<Completion>& completions, bool wait);
+
+	bool InitPlatform();
+	void ShutDownPlatform();
+};
+
+}
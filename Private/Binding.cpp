@@ -1,7 +1,9 @@
 #include "Binding.h"
+#include "Buffers.h"
 #include "Textures.h"
 #include "Impl/BindingImpl.h"
 #include "IDArray.h"
+#include "TextureViewRanges.h"
 
 #include <mutex>
 
@@ -135,9 +137,14 @@ void ReleaseDsv_Lock(DepthStencilView_t dsv)
 
 ShaderResourceView_t CreateTextureSRV(Texture_t tex, RenderFormat format, TextureDimension dim, uint32_t mipLevels, uint32_t depthOrArraySize)
 {
-	ShaderResourceView_t srv = CreateSrv_Lock(ViewData(tex, format, depthOrArraySize));
+	return CreateTextureSRV(tex, format, dim, GetFullTextureRange(dim, mipLevels, depthOrArraySize));
+}
+
+ShaderResourceView_t CreateTextureSRV(Texture_t tex, RenderFormat format, TextureDimension dim, const TextureViewRange& range)
+{
+	ShaderResourceView_t srv = CreateSrv_Lock(ViewData(tex, format, range.SliceCount));
 
-	if (!CreateTextureSRVImpl(srv, tex, format, dim, mipLevels, depthOrArraySize))
+	if (!CreateTextureSRVImpl(srv, tex, format, dim, range))
 	{
 		ReleaseSrv_Lock(srv);
 		return ShaderResourceView_t::INVALID;
@@ -148,9 +155,14 @@ ShaderResourceView_t CreateTextureSRV(Texture_t tex, RenderFormat format, Textur
 
 UnorderedAccessView_t CreateTextureUAV(Texture_t tex, RenderFormat format, TextureDimension dim, uint32_t depthOrArraySize)
 {
-	UnorderedAccessView_t uav = CreateUav_Lock(ViewData(tex, format, depthOrArraySize));
+	return CreateTextureUAV(tex, format, dim, GetFullTextureRange(dim, 1u, depthOrArraySize));
+}
+
+UnorderedAccessView_t CreateTextureUAV(Texture_t tex, RenderFormat format, TextureDimension dim, const TextureViewRange& range)
+{
+	UnorderedAccessView_t uav = CreateUav_Lock(ViewData(tex, format, range.SliceCount));
 
-	if (!CreateTextureUAVImpl(uav, tex, format, dim, depthOrArraySize))
+	if (!CreateTextureUAVImpl(uav, tex, format, dim, range))
 	{
 		ReleaseUav_Lock(uav);
 		return UnorderedAccessView_t::INVALID;
@@ -161,9 +173,14 @@ UnorderedAccessView_t CreateTextureUAV(Texture_t tex, RenderFormat format, Textu
 
 RenderTargetView_t CreateTextureRTV(Texture_t tex, RenderFormat format, TextureDimension dim, uint32_t depthOrArraySize)
 {
-	RenderTargetView_t rtv = CreateRtv_Lock(ViewData(tex, format, depthOrArraySize));
+	return CreateTextureRTV(tex, format, dim, GetFullTextureRange(dim, 1u, depthOrArraySize));
+}
+
+RenderTargetView_t CreateTextureRTV(Texture_t tex, RenderFormat format, TextureDimension dim, const TextureViewRange& range)
+{
+	RenderTargetView_t rtv = CreateRtv_Lock(ViewData(tex, format, range.SliceCount));
 
-	if (!CreateTextureRTVImpl(rtv, tex, format, dim, depthOrArraySize))
+	if (!CreateTextureRTVImpl(rtv, tex, format, dim, range))
 	{
 		ReleaseRtv_Lock(rtv);
 		return RenderTargetView_t::INVALID;
@@ -174,9 +191,14 @@ RenderTargetView_t CreateTextureRTV(Texture_t tex, RenderFormat format, TextureD
 
 DepthStencilView_t CreateTextureDSV(Texture_t tex, RenderFormat format, TextureDimension dim, uint32_t depthOrArraySize)
 {
-	DepthStencilView_t dsv = CreateDsv_Lock(ViewData(tex, format, depthOrArraySize));
+	return CreateTextureDSV(tex, format, dim, GetFullTextureRange(dim, 1u, depthOrArraySize));
+}
 
-	if (!CreateTextureDSVImpl(dsv, tex, format, dim, depthOrArraySize))
+DepthStencilView_t CreateTextureDSV(Texture_t tex, RenderFormat format, TextureDimension dim, const TextureViewRange& range)
+{
+	DepthStencilView_t dsv = CreateDsv_Lock(ViewData(tex, format, range.SliceCount));
+
+	if (!CreateTextureDSVImpl(dsv, tex, format, dim, range))
 	{
 		ReleaseDsv_Lock(dsv);
 		return DepthStencilView_t::INVALID;
@@ -241,6 +263,62 @@ DepthStencilView_t CreateTextureDSV(Texture_t tex, RenderFormat depthFormat)
 	return DepthStencilView_t::INVALID;
 }
 
+ShaderResourceView_t CreateTextureSRV(Texture_t tex, const TextureViewRange& range)
+{
+	if (const TextureCreateDescEx* TexDesc = GetTextureDesc(tex))
+	{
+		if (!HasEnumFlags(TexDesc->Flags, RenderResourceFlags::SRV) || !IsRangeInTexture(*TexDesc, range))
+		{
+			return ShaderResourceView_t::INVALID;
+		}
+
+		return CreateTextureSRV(tex, TexDesc->ResourceFormat, TexDesc->Dimension, range);
+	}
+	return ShaderResourceView_t::INVALID;
+}
+
+UnorderedAccessView_t CreateTextureUAV(Texture_t tex, const TextureViewRange& range)
+{
+	if (const TextureCreateDescEx* TexDesc = GetTextureDesc(tex))
+	{
+		if (!HasEnumFlags(TexDesc->Flags, RenderResourceFlags::UAV) || !IsRangeInTexture(*TexDesc, range))
+		{
+			return UnorderedAccessView_t::INVALID;
+		}
+
+		return CreateTextureUAV(tex, TexDesc->ResourceFormat, TexDesc->Dimension, range);
+	}
+	return UnorderedAccessView_t::INVALID;
+}
+
+RenderTargetView_t CreateTextureRTV(Texture_t tex, const TextureViewRange& range)
+{
+	if (const TextureCreateDescEx* TexDesc = GetTextureDesc(tex))
+	{
+		if (!HasEnumFlags(TexDesc->Flags, RenderResourceFlags::RTV) || !IsRangeInTexture(*TexDesc, range))
+		{
+			return RenderTargetView_t::INVALID;
+		}
+
+		return CreateTextureRTV(tex, TexDesc->ResourceFormat, TexDesc->Dimension, range);
+	}
+	return RenderTargetView_t::INVALID;
+}
+
+DepthStencilView_t CreateTextureDSV(Texture_t tex, RenderFormat depthFormat, const TextureViewRange& range)
+{
+	if (const TextureCreateDescEx* TexDesc = GetTextureDesc(tex))
+	{
+		if (!HasEnumFlags(TexDesc->Flags, RenderResourceFlags::DSV) || !IsRangeInTexture(*TexDesc, range))
+		{
+			return DepthStencilView_t::INVALID;
+		}
+
+		return CreateTextureDSV(tex, depthFormat, TexDesc->Dimension, range);
+	}
+	return DepthStencilView_t::INVALID;
+}
+
 ShaderResourceView_t CreateStructuredBufferSRV(StructuredBuffer_t buf, uint32_t firstElem, uint32_t numElems, uint32_t stride)
 {
 	ShaderResourceView_t srv = CreateSrv_Lock(ViewData(buf, firstElem, numElems, stride));
@@ -267,6 +345,44 @@ UnorderedAccessView_t CreateStructuredBufferUAV(StructuredBuffer_t buf, uint32_t
 	return uav;
 }
 
+ShaderResourceView_t CreateByteBufferSRV(StructuredBuffer_t buf, uint32_t firstElem, uint32_t numElems)
+{
+	ShaderResourceView_t srv = CreateSrv_Lock(ViewData(buf, firstElem, numElems, 0u));
+
+	if (!CreateByteBufferSRVImpl(srv, buf, firstElem, numElems))
+	{
+		ReleaseSrv_Lock(srv);
+		return ShaderResourceView_t::INVALID;
+	}
+
+	return srv;
+}
+
+uint32_t CreateDynamicStructuredBufferSRV(DynamicBuffer_t buf, uint32_t stride)
+{
+	assert(stride > 0u && "CreateDynamicStructuredBufferSRV needs a stride");
+
+	return buf != DynamicBuffer_t::INVALID ? CreateDynamicStructuredBufferSRVImpl(buf, stride) : 0u;
+}
+
+uint32_t CreateDynamicByteBufferSRV(DynamicBuffer_t buf)
+{
+	return buf != DynamicBuffer_t::INVALID ? CreateDynamicByteBufferSRVImpl(buf) : 0u;
+}
+
+UnorderedAccessView_t CreateByteBufferUAV(StructuredBuffer_t buf, uint32_t firstElem, uint32_t numElems)
+{
+	UnorderedAccessView_t uav = CreateUav_Lock(ViewData(buf, firstElem, numElems, 0u));
+
+	if (!CreateByteBufferUAVImpl(uav, buf, firstElem, numElems))
+	{
+		ReleaseUav_Lock(uav);
+		return UnorderedAccessView_t::INVALID;
+	}
+
+	return uav;
+}
+
 static RenderFormat GetViewDataFormat(const ViewData* const data)
 {
 	if (data && data->Type == ViewResourceType::Texture)
@@ -279,7 +395,7 @@ ShaderResourceView_t AllocSRV(RenderFormat format, TextureDimension dim, uint32_
 {
 	ShaderResourceView_t srv = CreateSrv_Lock(ViewData(Texture_t::INVALID, format, depthOrArraySize));
 
-	if (!CreateTextureSRVImpl(srv, Texture_t::INVALID, format, dim, depthOrArraySize, mipLevels))
+	if (!CreateTextureSRVImpl(srv, Texture_t::INVALID, format, dim, GetFullTextureRange(dim, mipLevels, depthOrArraySize)))
 	{
 		ReleaseSrv_Lock(srv);
 		return ShaderResourceView_t::INVALID;
@@ -292,7 +408,7 @@ UnorderedAccessView_t AllocUAV(RenderFormat format, TextureDimension dim, uint32
 {
 	UnorderedAccessView_t uav = CreateUav_Lock(ViewData(Texture_t::INVALID, format, depthOrArraySize));
 
-	if (!CreateTextureUAVImpl(uav, Texture_t::INVALID, format, dim, depthOrArraySize))
+	if (!CreateTextureUAVImpl(uav, Texture_t::INVALID, format, dim, GetFullTextureRange(dim, 1u, depthOrArraySize)))
 	{
 		ReleaseUav_Lock(uav);
 		return UnorderedAccessView_t::INVALID;
@@ -305,7 +421,7 @@ RenderTargetView_t AllocRTV(RenderFormat format, TextureDimension dim, uint32_t
 {
 	RenderTargetView_t rtv = CreateRtv_Lock(ViewData(Texture_t::INVALID, format, depthOrArraySize));
 
-	if (!CreateTextureRTVImpl(rtv, Texture_t::INVALID, format, dim, depthOrArraySize))
+	if (!CreateTextureRTVImpl(rtv, Texture_t::INVALID, format, dim, GetFullTextureRange(dim, 1u, depthOrArraySize)))
 	{
 		ReleaseRtv_Lock(rtv);
 		return RenderTargetView_t::INVALID;
@@ -318,7 +434,7 @@ DepthStencilView_t AllocDSV(RenderFormat format, TextureDimension dim, uint32_t
 {
 	DepthStencilView_t dsv = CreateDsv_Lock(ViewData(Texture_t::INVALID, format, depthOrArraySize));
 
-	if (!CreateTextureDSVImpl(dsv, Texture_t::INVALID, format, dim, depthOrArraySize))
+	if (!CreateTextureDSVImpl(dsv, Texture_t::INVALID, format, dim, GetFullTextureRange(dim, 1u, depthOrArraySize)))
 	{
 		ReleaseDsv_Lock(dsv);
 		return DepthStencilView_t::INVALID;
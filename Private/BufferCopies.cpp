@@ -0,0 +1,144 @@
+#include "BufferCopies.h"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <queue>
+
+namespace rl
+{
+
+struct CopyEvent
+{
+	uint64_t Offset = 0u;
+	uint32_t Region = 0u;
+	bool Begin = false;
+};
+
+// Sweeps one destination's copies in offset order, each span between two copy ends is taken from the newest copy covering it.
+// Spans are appended in offset order, a copy that wins several adjacent spans is split and merged again afterwards.
+static void AppendVisible(const std::vector<BufferCopyRegion>& regions, size_t groupBegin, size_t groupEnd, std::vector<CopyEvent>& events, std::vector<bool>& ended, std::vector<BufferCopyRegion>& outRegions)
+{
+	events.clear();
+
+	for (size_t i = groupBegin; i < groupEnd; i++)
+	{
+		if (regions[i].Size > 0u)
+		{
+			events.push_back({ regions[i].DstOffset, (uint32_t)i, true });
+			events.push_back({ regions[i].DstOffset + regions[i].Size, (uint32_t)i, false });
+		}
+	}
+
+	std::sort(events.begin(), events.end(), [](const CopyEvent& a, const CopyEvent& b) { return a.Offset < b.Offset; });
+
+	// Regions are in submission order within the group, so the highest active index is the newest copy
+	std::priority_queue<uint32_t> active;
+
+	for (size_t e = 0; e < events.size();)
+	{
+		const uint64_t offset = events[e].Offset;
+
+		for (; e < events.size() && events[e].Offset == offset; e++)
+		{
+			if (events[e].Begin)
+			{
+				active.push(events[e].Region);
+			}
+			else
+			{
+				ended[events[e].Region] = true;
+			}
+		}
+
+		while (!active.empty() && ended[active.top()])
+		{
+			active.pop();
+		}
+
+		if (e < events.size() && !active.empty())
+		{
+			const BufferCopyRegion& region = regions[active.top()];
+
+			BufferCopyRegion piece = region;
+			piece.DstOffset = offset;
+			piece.SrcOffset = region.SrcOffset + (offset - region.DstOffset);
+			piece.Size = events[e].Offset - offset;
+
+			outRegions.push_back(piece);
+		}
+	}
+}
+
+void CoalesceBufferCopies(std::vector<BufferCopyRegion>& regions)
+{
+	if (regions.size() < 2u)
+	{
+		return;
+	}
+
+	// Group by destination, keeping submission order within each group.
+	// Destinations are unrelated resources, std::less gives them a total order where < on the pointers would not.
+	std::stable_sort(regions.begin(), regions.end(), [](const BufferCopyRegion& a, const BufferCopyRegion& b)
+	{
+		return std::less<const void*>()(a.Dst, b.Dst);
+	});
+
+	std::vector<BufferCopyRegion> visible;
+	visible.reserve(regions.size());
+
+	std::vector<CopyEvent> events;
+	std::vector<bool> ended(regions.size(), false);
+
+	// Groups come out in destination order and each group in offset order, so visible is already sorted
+	for (size_t groupBegin = 0; groupBegin < regions.size();)
+	{
+		size_t groupEnd = groupBegin + 1u;
+
+		while (groupEnd < regions.size() && regions[groupEnd].Dst == regions[groupBegin].Dst)
+		{
+			groupEnd++;
+		}
+
+		AppendVisible(regions, groupBegin, groupEnd, events, ended, visible);
+
+		groupBegin = groupEnd;
+	}
+
+	regions.clear();
+
+	for (const BufferCopyRegion& region : visible)
+	{
+		if (!regions.empty())
+		{
+			BufferCopyRegion& last = regions.back();
+
+			if (last.Dst == region.Dst && last.Src == region.Src &&
+				last.DstOffset + last.Size == region.DstOffset &&
+				last.SrcOffset + last.Size == region.SrcOffset)
+			{
+				last.Size += region.Size;
+				continue;
+			}
+		}
+
+		regions.push_back(region);
+	}
+}
+
+std::vector<UploadChunk> SplitUpload(uint64_t size, uint64_t chunkSize)
+{
+	assert(chunkSize > 0u);
+
+	std::vector<UploadChunk> chunks;
+	chunks.reserve((size_t)((size + chunkSize - 1u) / chunkSize));
+
+	for (uint64_t offset = 0u; offset < size; offset += chunkSize)
+	{
+		chunks.push_back({ offset, size - offset < chunkSize ? size - offset : chunkSize });
+	}
+
+	return chunks;
+}
+
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace rl
+{
+
+// A pending buffer to buffer copy, Dst and Src are opaque backend resources.
+struct BufferCopyRegion
+{
+	const void* Dst = nullptr;
+	uint64_t DstOffset = 0u;
+
+	const void* Src = nullptr;
+	uint64_t SrcOffset = 0u;
+
+	uint64_t Size = 0u;
+};
+
+// Takes copies in submission order and reduces them to the minimum set with the same result.
+// Bytes overwritten by a later copy to the same destination are dropped, then contiguous copies are merged where the source is also contiguous.
+// The output regions never overlap, so they can be issued in any order, they are sorted by destination and offset.
+void CoalesceBufferCopies(std::vector<BufferCopyRegion>& regions);
+
+// A piece of an upload too large to stage at once.
+struct UploadChunk
+{
+	uint64_t Offset = 0u;
+	uint64_t Size = 0u;
+};
+
+// Splits an upload into consecutive chunks of at most chunkSize bytes, in order.
+std::vector<UploadChunk> SplitUpload(uint64_t size, uint64_t chunkSize);
+
+}
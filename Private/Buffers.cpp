@@ -1,5 +1,6 @@
 #include "Buffers.h"
 #include "IDArray.h"
+#include "MappedFile.h"
 
 #include "Impl/BuffersImpl.h"
 
@@ -20,6 +21,22 @@ IDArray<IndexBuffer_t, BufferData> g_IndexBuffers;
 IDArray<StructuredBuffer_t, BufferData> g_StructuredBuffers;
 IDArray<ConstantBuffer_t, BufferData> g_ConstantBuffers;
 
+struct GenericBufferData
+{
+	size_t Size = 0u;
+	BufferUsage Usage = BufferUsage::NONE;
+	BufferViews Views;
+};
+
+IDArray<Buffer_t, GenericBufferData> g_Buffers;
+
+static void ReleaseBufferViews(const BufferViews& views)
+{
+	RenderRelease(views.Vertex);
+	RenderRelease(views.Index);
+	RenderRelease(views.Structured);
+}
+
 VertexBuffer_t CreateVertexBuffer(const void* const data, size_t size)
 {
 	VertexBuffer_t newBuf = g_VertexBuffers.Create(size);
@@ -72,11 +89,127 @@ ConstantBuffer_t CreateConstantBuffer(const void* const data, size_t size)
 	return newBuf;
 }
 
+Buffer_t CreateBuffer(const void* const data, size_t size, size_t stride, BufferUsage usage)
+{
+	assert(usage != BufferUsage::NONE && "CreateBuffer needs at least one usage");
+	assert((!HasEnumFlags(usage, BufferUsage::STRUCTURED) || stride > 0u) && "CreateBuffer structured usage needs a stride");
+
+	BufferViews views;
+
+	if (HasEnumFlags(usage, BufferUsage::VERTEX))
+	{
+		views.Vertex = g_VertexBuffers.Create(size);
+	}
+
+	if (HasEnumFlags(usage, BufferUsage::INDEX))
+	{
+		views.Index = g_IndexBuffers.Create(size);
+	}
+
+	if (HasEnumFlags(usage, BufferUsage::STRUCTURED | BufferUsage::RAW | BufferUsage::INDIRECT_ARGS | BufferUsage::UAV))
+	{
+		views.Structured = g_StructuredBuffers.Create();
+	}
+
+	Buffer_t newBuf = g_Buffers.Create(GenericBufferData{ size, usage, views });
+
+	// The impl only fills in the views once the buffer exists, so failed views just give back their ids
+	if (!CreateBufferImpl(newBuf, views, data, size, stride, usage))
+	{
+		g_VertexBuffers.Release(views.Vertex);
+		g_IndexBuffers.Release(views.Index);
+		g_StructuredBuffers.Release(views.Structured);
+
+		g_Buffers.Release(newBuf);
+		return Buffer_t::INVALID;
+	}
+
+	return newBuf;
+}
+
+static BufferViews GetBufferViews(Buffer_t buf)
+{
+	auto lock = g_Buffers.ReadScopeLock();
+
+	const GenericBufferData* data = g_Buffers.Get(buf);
+
+	return data ? data->Views : BufferViews{};
+}
+
+VertexBuffer_t GetVertexBuffer(Buffer_t buf)
+{
+	return GetBufferViews(buf).Vertex;
+}
+
+IndexBuffer_t GetIndexBuffer(Buffer_t buf)
+{
+	return GetBufferViews(buf).Index;
+}
+
+StructuredBuffer_t GetStructuredBuffer(Buffer_t buf)
+{
+	return GetBufferViews(buf).Structured;
+}
+
+size_t GetBufferSize(Buffer_t buf)
+{
+	auto lock = g_Buffers.ReadScopeLock();
+
+	const GenericBufferData* data = g_Buffers.Get(buf);
+
+	return data ? data->Size : 0u;
+}
+
+// The mapping only has to outlive the create call, the upload is copied out of it before the create returns.
+VertexBuffer_t CreateVertexBufferFromFile(const char* path, size_t offset, size_t size)
+{
+	MappedFile file;
+	if (!MapFileRange(file, path, offset, size))
+	{
+		return VertexBuffer_t::INVALID;
+	}
+
+	return CreateVertexBuffer(file.Data() + offset, size);
+}
+
+IndexBuffer_t CreateIndexBufferFromFile(const char* path, size_t offset, size_t size)
+{
+	MappedFile file;
+	if (!MapFileRange(file, path, offset, size))
+	{
+		return IndexBuffer_t::INVALID;
+	}
+
+	return CreateIndexBuffer(file.Data() + offset, size);
+}
+
+StructuredBuffer_t CreateStructuredBufferFromFile(const char* path, size_t stride, RenderResourceFlags flags, size_t offset, size_t size)
+{
+	MappedFile file;
+	if (!MapFileRange(file, path, offset, size))
+	{
+		return StructuredBuffer_t::INVALID;
+	}
+
+	return CreateStructuredBuffer(file.Data() + offset, size, stride, flags);
+}
+
+Buffer_t CreateBufferFromFile(const char* path, size_t stride, BufferUsage usage, size_t offset, size_t size)
+{
+	MappedFile file;
+	if (!MapFileRange(file, path, offset, size))
+	{
+		return Buffer_t::INVALID;
+	}
+
+	return CreateBuffer(file.Data() + offset, size, stride, usage);
+}
+
 void UpdateVertexBuffer(VertexBuffer_t vb, const void* const data, size_t size)
 {
 	if (g_VertexBuffers.Valid(vb))
 	{
-		UpdateVertexBufferImpl(vb, data, size);
+		UpdateVertexBufferImpl(vb, data, 0u, size);
 	}
 }
 
@@ -84,7 +217,7 @@ void UpdateIndexBuffer(IndexBuffer_t ib, const void* const data, size_t size)
 {
 	if (g_IndexBuffers.Valid(ib))
 	{
-		UpdateIndexBufferImpl(ib, data, size);
+		UpdateIndexBufferImpl(ib, data, 0u, size);
 	}
 }
 
@@ -100,7 +233,47 @@ void UpdateStructuredBuffer(StructuredBuffer_t sb, const void* const data, size_
 {
 	if (g_StructuredBuffers.Valid(sb))
 	{
-		UpdateStructuredBufferImpl(sb, data, size);
+		UpdateStructuredBufferImpl(sb, data, 0u, size);
+	}
+}
+
+void UpdateBuffer(Buffer_t buf, const void* const data, size_t size)
+{
+	if (g_Buffers.Valid(buf))
+	{
+		UpdateBufferImpl(buf, data, 0u, size);
+	}
+}
+
+void UpdateVertexBufferRange(VertexBuffer_t vb, const void* const data, size_t offset, size_t size)
+{
+	if (g_VertexBuffers.Valid(vb) && size > 0u)
+	{
+		UpdateVertexBufferImpl(vb, data, offset, size);
+	}
+}
+
+void UpdateIndexBufferRange(IndexBuffer_t ib, const void* const data, size_t offset, size_t size)
+{
+	if (g_IndexBuffers.Valid(ib) && size > 0u)
+	{
+		UpdateIndexBufferImpl(ib, data, offset, size);
+	}
+}
+
+void UpdateStructuredBufferRange(StructuredBuffer_t sb, const void* const data, size_t offset, size_t size)
+{
+	if (g_StructuredBuffers.Valid(sb) && size > 0u)
+	{
+		UpdateStructuredBufferImpl(sb, data, offset, size);
+	}
+}
+
+void UpdateBufferRange(Buffer_t buf, const void* const data, size_t offset, size_t size)
+{
+	if (g_Buffers.Valid(buf) && size > 0u)
+	{
+		UpdateBufferImpl(buf, data, offset, size);
 	}
 }
 
@@ -136,6 +309,19 @@ void RenderRelease(ConstantBuffer_t cb)
 	}
 }
 
+void RenderRelease(Buffer_t buf)
+{
+	const BufferViews views = GetBufferViews(buf);
+
+	if (g_Buffers.Release(buf))
+	{
+		// Views only alias the memory, drop them before the buffer they point into
+		ReleaseBufferViews(views);
+
+		DestroyBuffer(buf);
+	}
+}
+
 void RenderRef(VertexBuffer_t vb)
 {
 	g_VertexBuffers.AddRef(vb);
@@ -156,6 +342,11 @@ void RenderRef(ConstantBuffer_t cb)
 	g_ConstantBuffers.AddRef(cb);
 }
 
+void RenderRef(Buffer_t buf)
+{
+	g_Buffers.AddRef(buf);
+}
+
 size_t GetVertexBufferCount()
 {
 	return g_VertexBuffers.UsedSize();
@@ -176,4 +367,9 @@ size_t GetConstantBufferCount()
 	return g_ConstantBuffers.UsedSize();
 }
 
+size_t GetBufferCount()
+{
+	return g_Buffers.UsedSize();
+}
+
 }
\ No newline at end of file
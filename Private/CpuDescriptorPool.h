@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace rl
+{
+
+// Slots of cpu only descriptors, for views that command lists copy when the call is recorded, so a freed slot is reused straight away without fencing.
+// Blocks of BlockSize slots are only ever added, so a slot's descriptor never moves while it is in use.
+// Api agnostic, Block is the backend heap holding one block of descriptors.
+template<typename Block, uint32_t BlockSize>
+struct CpuDescriptorPool
+{
+	// Safe from any thread, createBlock(outBlock) is called under the lock when every slot is in use and returning false fails the allocation.
+	template<typename CreateBlock>
+	bool Alloc(CreateBlock&& createBlock, uint32_t& outSlot)
+	{
+		std::scoped_lock lock(Mutex);
+
+		if (FreeSlots.empty())
+		{
+			Block block;
+			if (!createBlock(block))
+			{
+				return false;
+			}
+
+			const uint32_t first = (uint32_t)Blocks.size() * BlockSize;
+			Blocks.emplace_back(std::move(block));
+
+			// Pushed in reverse so slots are handed out in order
+			for (uint32_t i = BlockSize; i > 0u; i--)
+			{
+				FreeSlots.push_back(first + i - 1u);
+			}
+		}
+
+		outSlot = FreeSlots.back();
+		FreeSlots.pop_back();
+
+		return true;
+	}
+
+	void Free(uint32_t slot)
+	{
+		std::scoped_lock lock(Mutex);
+
+		assert(slot < Blocks.size() * BlockSize && "CpuDescriptorPool::Free slot was never allocated");
+
+		FreeSlots.push_back(slot);
+	}
+
+	// Returns func(block, indexInBlock) for the slot, called under the lock as a new block may be added at any time.
+	template<typename Func>
+	auto WithSlot(uint32_t slot, Func&& func)
+	{
+		std::scoped_lock lock(Mutex);
+
+		assert(slot < Blocks.size() * BlockSize && "CpuDescriptorPool::WithSlot slot was never allocated");
+
+		return func(Blocks[slot / BlockSize], slot % BlockSize);
+	}
+
+	uint32_t GetBlockCount()
+	{
+		std::scoped_lock lock(Mutex);
+
+		return (uint32_t)Blocks.size();
+	}
+
+private:
+	std::mutex Mutex;
+
+	std::vector<Block> Blocks;
+	std::vector<uint32_t> FreeSlots;
+};
+
+}
@@ -0,0 +1,161 @@
+#include "DefragPlanner.h"
+
+#include <algorithm>
+#include <assert.h>
+
+namespace rl
+{
+
+static uint64_t GetUsedBytes(const DefragPage& page)
+{
+	return page.Allocator->GetSize() - page.Allocator->GetFreeSize();
+}
+
+static DefragStats GetStats(const std::vector<DefragPage>& pages, const std::vector<bool>& evacuated)
+{
+	DefragStats stats;
+
+	for (size_t i = 0; i < pages.size(); i++)
+	{
+		if (evacuated[i])
+		{
+			continue;
+		}
+
+		stats.PageCount++;
+		stats.ReservedBytes += pages[i].Allocator->GetSize();
+		stats.UsedBytes += GetUsedBytes(pages[i]);
+	}
+
+	return stats;
+}
+
+DefragPlan PlanDefrag(std::vector<DefragPage>& pages, uint64_t byteBudget, float maxSourceOccupancy)
+{
+	DefragPlan plan;
+
+	std::vector<bool> evacuated(pages.size(), false);
+
+	// Pages given moves keep their page local allocation lists, so they can't be evacuated afterwards.
+	std::vector<bool> received(pages.size(), false);
+
+	plan.Before = GetStats(pages, evacuated);
+
+	std::vector<size_t> sources;
+	for (size_t i = 0; i < pages.size(); i++)
+	{
+		assert(pages[i].Allocator);
+
+		if (!pages[i].Pinned && !pages[i].Allocations.empty())
+		{
+			sources.push_back(i);
+		}
+	}
+
+	std::sort(sources.begin(), sources.end(), [&pages](size_t a, size_t b)
+	{
+		return GetUsedBytes(pages[a]) < GetUsedBytes(pages[b]);
+	});
+
+	std::vector<size_t> destinations;
+	std::vector<DefragMove> pageMoves;
+	std::vector<size_t> pageMoveDestinations;
+
+	for (size_t source : sources)
+	{
+		DefragPage& page = pages[source];
+
+		if (received[source])
+		{
+			continue;
+		}
+
+		// Earlier evacuations may have filled this page past the threshold.
+		const uint64_t used = GetUsedBytes(page);
+		if ((float)used > maxSourceOccupancy * (float)page.Allocator->GetSize())
+		{
+			continue;
+		}
+
+		if (plan.MovedBytes + used > byteBudget)
+		{
+			break;
+		}
+
+		destinations.clear();
+		for (size_t i = 0; i < pages.size(); i++)
+		{
+			if (i != source && !evacuated[i])
+			{
+				destinations.push_back(i);
+			}
+		}
+
+		std::sort(destinations.begin(), destinations.end(), [&pages](size_t a, size_t b)
+		{
+			return GetUsedBytes(pages[a]) > GetUsedBytes(pages[b]);
+		});
+
+		// Largest first so the big allocations get the pick of the free blocks.
+		std::sort(page.Allocations.begin(), page.Allocations.end(), [](const DefragAllocation& a, const DefragAllocation& b)
+		{
+			return a.Size > b.Size;
+		});
+
+		pageMoves.clear();
+		pageMoveDestinations.clear();
+
+		bool placedAll = true;
+
+		for (const DefragAllocation& allocation : page.Allocations)
+		{
+			bool placed = false;
+
+			for (size_t destination : destinations)
+			{
+				TlsfAllocation dst;
+				if (pages[destination].Allocator->Alloc(allocation.Size, allocation.Alignment, dst))
+				{
+					pageMoves.push_back({ allocation.Id, page.Page, allocation.Offset, pages[destination].Page, dst, allocation.Size });
+					pageMoveDestinations.push_back(destination);
+					placed = true;
+					break;
+				}
+			}
+
+			if (!placed)
+			{
+				placedAll = false;
+				break;
+			}
+		}
+
+		if (!placedAll)
+		{
+			// Moving part of a page releases nothing, undo the blocks taken for it.
+			for (size_t i = 0; i < pageMoves.size(); i++)
+			{
+				pages[pageMoveDestinations[i]].Allocator->Free(pageMoves[i].Dst);
+			}
+
+			continue;
+		}
+
+		evacuated[source] = true;
+
+		for (size_t destination : pageMoveDestinations)
+		{
+			received[destination] = true;
+		}
+
+		plan.EvacuatedPages.push_back(page.Page);
+		plan.Moves.insert(plan.Moves.end(), pageMoves.begin(), pageMoves.end());
+		plan.MovedBytes += used;
+	}
+
+	plan.After = GetStats(pages, evacuated);
+
+	return plan;
+}
+
+}
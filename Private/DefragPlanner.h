@@ -0,0 +1,69 @@
+#pragma once
+
+#include "TlsfAllocator.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace rl
+{
+
+// Backend agnostic planning for compacting suballocated pages, the planner only touches the page allocators.
+// Destination blocks are allocated as part of planning, the caller copies the data and frees the evacuated pages once the gpu is done with them.
+struct DefragAllocation
+{
+	uint32_t Id = 0u;		// Caller defined, returned in the moves
+
+	uint64_t Offset = 0u;
+	uint64_t Size = 0u;
+	uint64_t Alignment = 1u;
+};
+
+struct DefragPage
+{
+	uint32_t Page = 0u;
+	TlsfAllocator* Allocator = nullptr;
+
+	std::vector<DefragAllocation> Allocations;
+
+	// Holds allocations that can't be moved, the page can still receive moves.
+	bool Pinned = false;
+};
+
+struct DefragMove
+{
+	uint32_t Id = 0u;
+
+	uint32_t SrcPage = 0u;
+	uint64_t SrcOffset = 0u;
+
+	uint32_t DstPage = 0u;
+	TlsfAllocation Dst;
+
+	uint64_t Size = 0u;
+};
+
+struct DefragStats
+{
+	uint32_t PageCount = 0u;
+	uint64_t ReservedBytes = 0u;
+	uint64_t UsedBytes = 0u;
+};
+
+struct DefragPlan
+{
+	std::vector<DefragMove> Moves;
+	std::vector<uint32_t> EvacuatedPages;
+
+	uint64_t MovedBytes = 0u;
+
+	// After assumes the evacuated pages have been released.
+	DefragStats Before;
+	DefragStats After;
+};
+
+// Empties the least used pages first, only whole pages are evacuated so every byte moved lets memory be released.
+// Pages above maxSourceOccupancy are never evacuated, moves are packed into the fullest pages to keep free space together.
+DefragPlan PlanDefrag(std::vector<DefragPage>& pages, uint64_t byteBudget, float maxSourceOccupancy = 0.5f);
+
+}
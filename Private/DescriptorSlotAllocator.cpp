@@ -0,0 +1,66 @@
+#include "DescriptorSlotAllocator.h"
+
+#include <assert.h>
+
+namespace rl
+{
+
+DescriptorSlotAllocator::DescriptorSlotAllocator(uint32_t capacity)
+	: Capacity(capacity)
+{
+}
+
+bool DescriptorSlotAllocator::Alloc(uint32_t& outSlot)
+{
+	std::scoped_lock lock(Mutex);
+
+	if (!FreeSlots.empty())
+	{
+		outSlot = FreeSlots.back();
+		FreeSlots.pop_back();
+		return true;
+	}
+
+	if (NextUnused < Capacity)
+	{
+		outSlot = NextUnused++;
+		return true;
+	}
+
+	return false;
+}
+
+void DescriptorSlotAllocator::Free(uint32_t slot)
+{
+	std::scoped_lock lock(Mutex);
+
+	assert(slot < NextUnused && "DescriptorSlotAllocator::Free slot was never allocated");
+
+	FreedThisFrame.push_back(slot);
+}
+
+void DescriptorSlotAllocator::EndFrame(uint64_t graphicsFence, uint64_t computeFence)
+{
+	std::scoped_lock lock(Mutex);
+
+	if (FreedThisFrame.empty())
+	{
+		return;
+	}
+
+	Retiring.push_back({ std::move(FreedThisFrame), graphicsFence, computeFence });
+	FreedThisFrame.clear();
+}
+
+void DescriptorSlotAllocator::Reclaim(uint64_t completedGraphicsFence, uint64_t completedComputeFence)
+{
+	std::scoped_lock lock(Mutex);
+
+	while (!Retiring.empty() && Retiring.front().GraphicsFence <= completedGraphicsFence && Retiring.front().ComputeFence <= completedComputeFence)
+	{
+		FreeSlots.insert(FreeSlots.end(), Retiring.front().Slots.begin(), Retiring.front().Slots.end());
+		Retiring.pop_front();
+	}
+}
+
+}
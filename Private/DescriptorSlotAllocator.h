@@ -0,0 +1,48 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+namespace rl
+{
+
+// Hands out slots of a persistent, fixed capacity descriptor heap, so creating or destroying a view only writes its own slot.
+// Freed slots are held until the gpu has finished every frame that could still read them, then reused.
+// Api agnostic, the fences are whatever values the backend signals at the end of a frame.
+struct DescriptorSlotAllocator
+{
+	explicit DescriptorSlotAllocator(uint32_t capacity);
+
+	// Safe from any thread, false once every slot is in use.
+	bool Alloc(uint32_t& outSlot);
+	void Free(uint32_t slot);
+
+	// Call between frames, slots freed since the last call wait for these fences.
+	void EndFrame(uint64_t graphicsFence, uint64_t computeFence);
+
+	// Returns slots whose fences have completed to the free list.
+	void Reclaim(uint64_t completedGraphicsFence, uint64_t completedComputeFence);
+
+	uint32_t GetCapacity() const { return Capacity; }
+
+private:
+	struct RetiringSlots
+	{
+		std::vector<uint32_t> Slots;
+		uint64_t GraphicsFence = 0u;
+		uint64_t ComputeFence = 0u;
+	};
+
+	std::mutex Mutex;
+
+	uint32_t Capacity = 0u;
+	uint32_t NextUnused = 0u;
+
+	std::vector<uint32_t> FreeSlots;
+	std::vector<uint32_t> FreedThisFrame;
+	std::deque<RetiringSlots> Retiring;
+};
+
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace rl
+{
+
+// Largest number of pages used by a frame over the last FrameCount frames, memory above it is released so one spike frame isn't kept forever.
+struct FrameHighWaterMark
+{
+	static constexpr uint32_t FrameCount = 120u;
+
+	void Push(size_t pages)
+	{
+		Samples[Next] = pages;
+		Next = (Next + 1u) % FrameCount;
+	}
+
+	size_t Get() const { return *std::max_element(Samples, Samples + FrameCount); }
+
+private:
+	size_t Samples[FrameCount] = {};
+	uint32_t Next = 0u;
+};
+
+// Pages used for one frame and reused once the gpu has finished it.
+// Retired pages queue in the order their frames ended and only the oldest are checked, free pages are taken from the back with one atomic increment.
+// Pages only change lists between frames, so taking one during a frame never races with the pool changing shape.
+// Api agnostic, Page provides Retire(graphicsFence, computeFence) and InFlight(completedGraphicsFence, completedComputeFence).
+template<typename Page>
+struct FramePagePool
+{
+	// Safe from any thread during a frame, null once the free pages run out.
+	Page* TakePage()
+	{
+		const size_t taken = Taken.fetch_add(1u, std::memory_order_relaxed);
+
+		return taken < Free.size() ? Free[Free.size() - 1u - taken].get() : nullptr;
+	}
+
+	// Between frames, the pages taken this frame wait for these fences.
+	void RetireTakenPages(uint64_t graphicsFence, uint64_t computeFence)
+	{
+		const size_t taken = std::min(Taken.load(std::memory_order_relaxed), Free.size());
+
+		for (size_t i = 0; i < taken; i++)
+		{
+			RetirePage(std::move(Free.back()), graphicsFence, computeFence);
+			Free.pop_back();
+		}
+
+		Taken.store(0u, std::memory_order_relaxed);
+	}
+
+	// Between frames, for pages callers created once TakePage ran dry. They join the pool behind everything retired so far.
+	void RetirePage(std::unique_ptr<Page> page, uint64_t graphicsFence, uint64_t computeFence)
+	{
+		page->Retire(graphicsFence, computeFence);
+		InFlight.emplace_back(std::move(page));
+
+		FramePages++;
+	}
+
+	// Before the frame starts, frees the pages whose fences have completed and releases free pages above the high water mark.
+	void NewFrame(uint64_t completedGraphicsFence, uint64_t completedComputeFence)
+	{
+		HighWaterMark.Push(FramePages);
+		FramePages = 0u;
+
+		while (!InFlight.empty() && !InFlight.front()->InFlight(completedGraphicsFence, completedComputeFence))
+		{
+			Free.emplace_back(std::move(InFlight.front()));
+			InFlight.pop_front();
+		}
+
+		const size_t highWaterMark = HighWaterMark.Get();
+
+		if (Free.size() > highWaterMark)
+		{
+			Free.resize(highWaterMark);
+		}
+	}
+
+	size_t GetFreeCount() const { return Free.size(); }
+	size_t GetInFlightCount() const { return InFlight.size(); }
+
+private:
+	std::deque<std::unique_ptr<Page>> InFlight;
+	std::vector<std::unique_ptr<Page>> Free;
+
+	std::atomic<size_t> Taken = 0u;
+
+	// Pages retired since the last NewFrame, the sample the high water mark is built from.
+	size_t FramePages = 0u;
+	FrameHighWaterMark HighWaterMark;
+};
+
+}
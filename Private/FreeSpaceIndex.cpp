@@ -0,0 +1,85 @@
+#include "FreeSpaceIndex.h"
+
+#include <assert.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace rl
+{
+
+uint32_t FreeSpaceIndex::GetBucket(uint64_t size)
+{
+	assert(size != 0u);
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanReverse64(&index, size);
+	return (uint32_t)index;
+#else
+	return 63u - (uint32_t)__builtin_clzll(size);
+#endif
+}
+
+uint32_t FreeSpaceIndex::CountTrailingZeros(uint64_t value)
+{
+	assert(value != 0u);
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return (uint32_t)index;
+#else
+	return (uint32_t)__builtin_ctzll(value);
+#endif
+}
+
+void FreeSpaceIndex::Update(uint32_t page, uint64_t largestFreeBlock)
+{
+	if (page >= Entries.size())
+	{
+		if (largestFreeBlock == 0u)
+		{
+			return;
+		}
+
+		Entries.resize(page + 1u);
+	}
+
+	Entry& entry = Entries[page];
+	entry.LargestFreeBlock = largestFreeBlock;
+
+	const uint32_t bucket = largestFreeBlock > 0u ? GetBucket(largestFreeBlock) : NoBucket;
+
+	if (bucket == entry.Bucket)
+	{
+		return;
+	}
+
+	// Swap remove from the old bucket, the page moved into the hole takes over its position
+	if (entry.Bucket != NoBucket)
+	{
+		std::vector<uint32_t>& oldBucket = Buckets[entry.Bucket];
+
+		const uint32_t moved = oldBucket.back();
+		oldBucket[entry.Position] = moved;
+		Entries[moved].Position = entry.Position;
+		oldBucket.pop_back();
+
+		if (oldBucket.empty())
+		{
+			NonEmptyBuckets &= ~(1ull << entry.Bucket);
+		}
+	}
+
+	entry.Bucket = bucket;
+
+	if (bucket != NoBucket)
+	{
+		entry.Position = (uint32_t)Buckets[bucket].size();
+		Buckets[bucket].push_back(page);
+
+		NonEmptyBuckets |= 1ull << bucket;
+	}
+}
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace rl
+{
+
+// Buckets pages by the log2 of their largest free block, so a page that can hold a size is found without probing every page.
+// Not thread safe, callers guard it and update a page while holding that page's own lock so the index never lags behind it.
+struct FreeSpaceIndex
+{
+	static constexpr uint32_t InvalidPage = ~0u;
+
+	// Sets a page's largest free block, zero takes the page out of the index.
+	void Update(uint32_t page, uint64_t largestFreeBlock);
+	void Remove(uint32_t page) { Update(page, 0u); }
+
+	uint64_t GetLargestFreeBlock(uint32_t page) const { return page < Entries.size() ? Entries[page].LargestFreeBlock : 0u; }
+
+	// Returns a page whose largest free block is at least size and that accept agrees to, or InvalidPage.
+	// The smallest bucket guaranteed to fit is tried first, the bucket size itself falls in is only scanned when nothing larger is left.
+	template<typename Accept>
+	uint32_t Find(uint64_t size, Accept&& accept) const
+	{
+		if (size == 0u)
+		{
+			size = 1u;
+		}
+
+		const uint32_t sizeBucket = GetBucket(size);
+
+		uint64_t candidates = sizeBucket + 1u < BucketCount ? NonEmptyBuckets & (~0ull << (sizeBucket + 1u)) : 0u;
+
+		while (candidates != 0u)
+		{
+			const uint32_t bucket = CountTrailingZeros(candidates);
+
+			for (uint32_t page : Buckets[bucket])
+			{
+				if (accept(page))
+				{
+					return page;
+				}
+			}
+
+			candidates &= candidates - 1u;
+		}
+
+		for (uint32_t page : Buckets[sizeBucket])
+		{
+			if (Entries[page].LargestFreeBlock >= size && accept(page))
+			{
+				return page;
+			}
+		}
+
+		return InvalidPage;
+	}
+
+	uint32_t Find(uint64_t size) const
+	{
+		return Find(size, [](uint32_t) { return true; });
+	}
+
+private:
+	static constexpr uint32_t BucketCount = 64u;
+	static constexpr uint32_t NoBucket = ~0u;
+
+	struct Entry
+	{
+		uint64_t LargestFreeBlock = 0u;
+		uint32_t Bucket = NoBucket;
+		uint32_t Position = 0u;
+	};
+
+	std::vector<Entry> Entries;
+	std::vector<uint32_t> Buckets[BucketCount];
+	uint64_t NonEmptyBuckets = 0u;
+
+	static uint32_t GetBucket(uint64_t size);
+	static uint32_t CountTrailingZeros(uint64_t value);
+};
+
+}
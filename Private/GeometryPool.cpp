@@ -0,0 +1,285 @@
+#include "GeometryPool.h"
+
+#include "Buffers.h"
+#include "CommandList.h"
+#include "IDArray.h"
+#include "Impl/BuffersImpl.h"
+#include "TlsfAllocator.h"
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace rl
+{
+
+struct GeometryPoolData
+{
+	GeometryPoolDesc Desc;
+
+	BufferPtr Vertices;
+	BufferPtr Indices;
+
+	// Ranges are allocated in vertices and indices, so offsets are already base vertices and first indices.
+	std::mutex Mutex;
+	TlsfAllocator VertexAllocator;
+	TlsfAllocator IndexAllocator;
+
+	// Freed ranges wait for the gpu to finish every frame that could still draw them before they are reused.
+	struct RetiringGeometry
+	{
+		std::vector<GeometryAllocation> Allocations;
+		uint64_t GraphicsFence = 0u;
+		uint64_t ComputeFence = 0u;
+	};
+
+	std::vector<GeometryAllocation> FreedThisFrame;
+	std::deque<RetiringGeometry> Retiring;
+};
+
+IDArray<GeometryPool_t, std::shared_ptr<GeometryPoolData>> g_GeometryPools;
+
+static uint32_t GetIndexSize(RenderFormat format)
+{
+	return format == RenderFormat::R16_UINT ? 2u : 4u;
+}
+
+GeometryPool_t CreateGeometryPool(const GeometryPoolDesc& desc)
+{
+	if (desc.IndexFormat != RenderFormat::R32_UINT && desc.IndexFormat != RenderFormat::R16_UINT)
+	{
+		return GeometryPool_t::INVALID;
+	}
+
+	if (desc.VertexStride == 0u || desc.VertexCapacity == 0u)
+	{
+		return GeometryPool_t::INVALID;
+	}
+
+	std::shared_ptr<GeometryPoolData> data = std::make_shared<GeometryPoolData>();
+	data->Desc = desc;
+
+	// Raw usage lets the same memory be fetched bindlessly, structured views can't share memory with vertex or index buffers on every api.
+	data->Vertices = CreateBuffer(nullptr, (size_t)desc.VertexStride * desc.VertexCapacity, desc.VertexStride, BufferUsage::VERTEX | BufferUsage::RAW);
+	data->VertexAllocator.Init(desc.VertexCapacity);
+
+	if (!data->Vertices)
+	{
+		return GeometryPool_t::INVALID;
+	}
+
+	if (desc.IndexCapacity > 0u)
+	{
+		data->Indices = CreateBuffer(nullptr, (size_t)GetIndexSize(desc.IndexFormat) * desc.IndexCapacity, GetIndexSize(desc.IndexFormat), BufferUsage::INDEX | BufferUsage::RAW);
+		data->IndexAllocator.Init(desc.IndexCapacity);
+
+		if (!data->Indices)
+		{
+			return GeometryPool_t::INVALID;
+		}
+	}
+
+	return g_GeometryPools.Create(std::move(data));
+}
+
+// Holding a reference keeps the pool's buffers alive if it is released while in use.
+static std::shared_ptr<GeometryPoolData> GetPool(GeometryPool_t pool)
+{
+	auto lock = g_GeometryPools.ReadScopeLock();
+
+	std::shared_ptr<GeometryPoolData>* data = g_GeometryPools.Get(pool);
+
+	return data ? *data : nullptr;
+}
+
+bool AllocGeometry(GeometryPool_t pool, const void* const vertices, uint32_t vertexCount, const void* const indices, uint32_t indexCount, GeometryAllocation& outAllocation)
+{
+	outAllocation = {};
+
+	const std::shared_ptr<GeometryPoolData> data = GetPool(pool);
+
+	if (!data || vertexCount == 0u || !vertices)
+	{
+		return false;
+	}
+
+	if (indexCount > 0u && (!indices || !data->Indices))
+	{
+		return false;
+	}
+
+	TlsfAllocation vertexBlock;
+	TlsfAllocation indexBlock;
+	{
+		std::scoped_lock lock(data->Mutex);
+
+		if (!data->VertexAllocator.Alloc(vertexCount, 1u, vertexBlock))
+		{
+			return false;
+		}
+
+		if (indexCount > 0u && !data->IndexAllocator.Alloc(indexCount, 1u, indexBlock))
+		{
+			data->VertexAllocator.Free(vertexBlock);
+			return false;
+		}
+	}
+
+	const size_t vertexStride = data->Desc.VertexStride;
+	UpdateBufferRange(data->Vertices.Get(), vertices, (size_t)vertexBlock.Offset * vertexStride, (size_t)vertexCount * vertexStride);
+
+	if (indexCount > 0u)
+	{
+		const size_t indexSize = GetIndexSize(data->Desc.IndexFormat);
+		UpdateBufferRange(data->Indices.Get(), indices, (size_t)indexBlock.Offset * indexSize, (size_t)indexCount * indexSize);
+	}
+
+	outAllocation.BaseVertex = (uint32_t)vertexBlock.Offset;
+	outAllocation.VertexCount = vertexCount;
+	outAllocation.FirstIndex = (uint32_t)indexBlock.Offset;
+	outAllocation.IndexCount = indexCount;
+	outAllocation.VertexBlock = vertexBlock.Block;
+	outAllocation.IndexBlock = indexBlock.Block;
+
+	return true;
+}
+
+void FreeGeometry(GeometryPool_t pool, const GeometryAllocation& allocation)
+{
+	const std::shared_ptr<GeometryPoolData> data = GetPool(pool);
+
+	if (!data || !allocation.Valid())
+	{
+		return;
+	}
+
+	std::scoped_lock lock(data->Mutex);
+
+	data->FreedThisFrame.push_back(allocation);
+}
+
+static void FreeRetired_AssumeLocked(GeometryPoolData& data, const GeometryAllocation& allocation)
+{
+	data.VertexAllocator.Free({ allocation.BaseVertex, allocation.VertexCount, allocation.VertexBlock });
+
+	if (allocation.IndexCount > 0u)
+	{
+		data.IndexAllocator.Free({ allocation.FirstIndex, allocation.IndexCount, allocation.IndexBlock });
+	}
+}
+
+void GeometryPools_EndFrame(uint64_t graphicsFence, uint64_t computeFence, uint64_t completedGraphicsFence, uint64_t completedComputeFence)
+{
+	// Released pools drop their retiring ranges with the rest of their data
+	std::vector<std::shared_ptr<GeometryPoolData>> pools;
+	g_GeometryPools.ForEachValid([&pools](GeometryPool_t, const std::shared_ptr<GeometryPoolData>& data)
+	{
+		if (data)
+		{
+			pools.push_back(data);
+		}
+
+		return true;
+	});
+
+	for (const std::shared_ptr<GeometryPoolData>& data : pools)
+	{
+		std::scoped_lock lock(data->Mutex);
+
+		if (!data->FreedThisFrame.empty())
+		{
+			data->Retiring.push_back({ std::move(data->FreedThisFrame), graphicsFence, computeFence });
+			data->FreedThisFrame.clear();
+		}
+
+		while (!data->Retiring.empty() && data->Retiring.front().GraphicsFence <= completedGraphicsFence && data->Retiring.front().ComputeFence <= completedComputeFence)
+		{
+			for (const GeometryAllocation& allocation : data->Retiring.front().Allocations)
+			{
+				FreeRetired_AssumeLocked(*data, allocation);
+			}
+
+			data->Retiring.pop_front();
+		}
+	}
+}
+
+VertexBuffer_t GetGeometryPoolVertexBuffer(GeometryPool_t pool)
+{
+	const std::shared_ptr<GeometryPoolData> data = GetPool(pool);
+
+	return data ? GetVertexBuffer(data->Vertices.Get()) : VertexBuffer_t::INVALID;
+}
+
+IndexBuffer_t GetGeometryPoolIndexBuffer(GeometryPool_t pool)
+{
+	const std::shared_ptr<GeometryPoolData> data = GetPool(pool);
+
+	return data ? GetIndexBuffer(data->Indices.Get()) : IndexBuffer_t::INVALID;
+}
+
+StructuredBuffer_t GetGeometryPoolVertexData(GeometryPool_t pool)
+{
+	const std::shared_ptr<GeometryPoolData> data = GetPool(pool);
+
+	return data ? GetStructuredBuffer(data->Vertices.Get()) : StructuredBuffer_t::INVALID;
+}
+
+StructuredBuffer_t GetGeometryPoolIndexData(GeometryPool_t pool)
+{
+	const std::shared_ptr<GeometryPoolData> data = GetPool(pool);
+
+	return data ? GetStructuredBuffer(data->Indices.Get()) : StructuredBuffer_t::INVALID;
+}
+
+void SetGeometryPool(CommandList* cl, GeometryPool_t pool)
+{
+	const std::shared_ptr<GeometryPoolData> data = GetPool(pool);
+
+	if (!data)
+	{
+		return;
+	}
+
+	cl->SetVertexBuffer(0u, GetVertexBuffer(data->Vertices.Get()), data->Desc.VertexStride, 0u);
+
+	if (data->Indices)
+	{
+		cl->SetIndexBuffer(GetIndexBuffer(data->Indices.Get()), data->Desc.IndexFormat, 0u);
+	}
+}
+
+void DrawGeometry(CommandList* cl, const GeometryAllocation& allocation, uint32_t numInstances, uint32_t startInstance)
+{
+	if (allocation.IndexCount > 0u)
+	{
+		cl->DrawIndexedInstanced(allocation.IndexCount, numInstances, allocation.FirstIndex, allocation.BaseVertex, startInstance);
+	}
+	else
+	{
+		cl->DrawInstanced(allocation.VertexCount, numInstances, allocation.BaseVertex, startInstance);
+	}
+}
+
+void RenderRelease(GeometryPool_t pool)
+{
+	if (g_GeometryPools.Release(pool))
+	{
+		// Released ids keep their data until they are reused, drop the buffers now
+		std::shared_ptr<GeometryPoolData> empty;
+		g_GeometryPools.Update(pool, empty);
+	}
+}
+
+void RenderRef(GeometryPool_t pool)
+{
+	g_GeometryPools.AddRef(pool);
+}
+
+size_t GetGeometryPoolCount()
+{
+	return g_GeometryPools.UsedSize();
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+namespace rl
+{
+
+template<typename T>
+inline void hash_combine(uint64_t& hash, const T& value)
+{
+    std::hash<T> h;
+    hash ^= h(value) + 0x9e3779b9 + (hash << 9) + (hash >> 2);
+}
+
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mutex>
 #include <shared_mutex>
 #include <vector>
 
@@ -14,21 +15,27 @@ struct IDArray
 
 	ID Create()
 	{
-		ID id = MakeID_Lock();
+		auto lock = WriteScopeLock();
+
+		ID id = MakeID();
 		Data[(uint32_t)id] = {};
 		return id;
 	}
 
 	ID Create(const DataType& data)
 	{
-		ID id = MakeID_Lock();
+		auto lock = WriteScopeLock();
+
+		ID id = MakeID();
 		Data[(uint32_t)id] = data;
 		return id;
 	}
 
 	ID Create(DataType&& data)
 	{
-		ID id = MakeID_Lock();
+		auto lock = WriteScopeLock();
+
+		ID id = MakeID();
 		Data[(uint32_t)id] = std::move(data);
 		return id;
 	}
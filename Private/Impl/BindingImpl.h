@@ -6,10 +6,10 @@ namespace rl
 {
 enum class TextureDimension : uint8_t;
 
-bool CreateTextureSRVImpl(ShaderResourceView_t srv, Texture_t tex, RenderFormat format, TextureDimension dim, uint32_t mipLevels, uint32_t depthOrArraySize);
-bool CreateTextureUAVImpl(UnorderedAccessView_t uav, Texture_t tex, RenderFormat format, TextureDimension dim, uint32_t depthOrArraySize);
-bool CreateTextureRTVImpl(RenderTargetView_t rtv, Texture_t tex, RenderFormat format, TextureDimension dim, uint32_t depthOrArraySize);
-bool CreateTextureDSVImpl(DepthStencilView_t dsv, Texture_t tex, RenderFormat format, TextureDimension dim, uint32_t depthOrArraySize);
+bool CreateTextureSRVImpl(ShaderResourceView_t srv, Texture_t tex, RenderFormat format, TextureDimension dim, const TextureViewRange& range);
+bool CreateTextureUAVImpl(UnorderedAccessView_t uav, Texture_t tex, RenderFormat format, TextureDimension dim, const TextureViewRange& range);
+bool CreateTextureRTVImpl(RenderTargetView_t rtv, Texture_t tex, RenderFormat format, TextureDimension dim, const TextureViewRange& range);
+bool CreateTextureDSVImpl(DepthStencilView_t dsv, Texture_t tex, RenderFormat format, TextureDimension dim, const TextureViewRange& range);
 
 void BindTextureSRVImpl(ShaderResourceView_t srv, Texture_t tex);
 void BindTextureUAVImpl(UnorderedAccessView_t uav, Texture_t tex);
@@ -18,6 +18,11 @@ void BindTextureDSVImpl(DepthStencilView_t dsv, Texture_t tex);
 
 bool CreateStructuredBufferSRVImpl(ShaderResourceView_t srv, StructuredBuffer_t buf, uint32_t firstElement, uint32_t numElements, uint32_t structureByteStride);
 bool CreateStructuredBufferUAVImpl(UnorderedAccessView_t uav, StructuredBuffer_t buf, uint32_t firstElement, uint32_t numElements, uint32_t structureByteStride);
+bool CreateByteBufferSRVImpl(ShaderResourceView_t srv, StructuredBuffer_t buf, uint32_t firstElement, uint32_t numElements);
+bool CreateByteBufferUAVImpl(UnorderedAccessView_t uav, StructuredBuffer_t buf, uint32_t firstElement, uint32_t numElements);
+
+uint32_t CreateDynamicStructuredBufferSRVImpl(DynamicBuffer_t buf, uint32_t structureByteStride);
+uint32_t CreateDynamicByteBufferSRVImpl(DynamicBuffer_t buf);
 
 void DestroySRV(ShaderResourceView_t srv);
 void DestroyUAV(UnorderedAccessView_t uav);
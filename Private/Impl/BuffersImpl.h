@@ -5,19 +5,33 @@
 namespace rl
 {
 
+// Typed handles aliasing a generic buffer's memory, INVALID for roles it wasn't created with.
+struct BufferViews
+{
+	VertexBuffer_t Vertex = VertexBuffer_t::INVALID;
+	IndexBuffer_t Index = IndexBuffer_t::INVALID;
+	StructuredBuffer_t Structured = StructuredBuffer_t::INVALID;
+};
+
 bool CreateVertexBufferImpl(VertexBuffer_t handle, const void* const data, size_t size);
 bool CreateIndexBufferImpl(IndexBuffer_t handle, const void* const data, size_t size);
 bool CreateStructuredBufferImpl(StructuredBuffer_t handle, const void* data, size_t size, size_t stride, RenderResourceFlags flags);
 bool CreateConstantBufferImpl(ConstantBuffer_t handle, const void* const data, size_t size);
+bool CreateBufferImpl(Buffer_t handle, const BufferViews& views, const void* const data, size_t size, size_t stride, BufferUsage usage);
 
-void UpdateVertexBufferImpl(VertexBuffer_t vb, const void* const data, size_t size);
-void UpdateIndexBufferImpl(IndexBuffer_t ib, const void* const data, size_t size);
+void UpdateVertexBufferImpl(VertexBuffer_t vb, const void* const data, size_t offset, size_t size);
+void UpdateIndexBufferImpl(IndexBuffer_t ib, const void* const data, size_t offset, size_t size);
 void UpdateConstantBufferImpl(ConstantBuffer_t cb, const void* const data, size_t size);
-void UpdateStructuredBufferImpl(StructuredBuffer_t sb, const void* const data, size_t size);
+void UpdateStructuredBufferImpl(StructuredBuffer_t sb, const void* const data, size_t offset, size_t size);
+void UpdateBufferImpl(Buffer_t buf, const void* const data, size_t offset, size_t size);
 
 void DestroyVertexBuffer(VertexBuffer_t handle);
 void DestroyIndexBuffer(IndexBuffer_t handle);
 void DestroyStructuredBuffer(StructuredBuffer_t handle);
 void DestroyConstantBuffer(ConstantBuffer_t handle);
+void DestroyBuffer(Buffer_t handle);
+
+// Called by the backend's Render_EndFrame, geometry freed this frame waits for the fences and retired ranges whose fences have completed are reused.
+void GeometryPools_EndFrame(uint64_t graphicsFence, uint64_t computeFence, uint64_t completedGraphicsFence, uint64_t completedComputeFence);
 
 }
\ No newline at end of file
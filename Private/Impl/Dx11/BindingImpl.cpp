@@ -36,7 +36,7 @@ SparseArray<UavDesc, UnorderedAccessView_t> g_Uavs;
 SparseArray<RtvDesc, RenderTargetView_t> g_Rtvs;
 SparseArray<DsvDesc, DepthStencilView_t> g_Dsvs;
 
-bool CreateTextureSRVImpl(ShaderResourceView_t srv, Texture_t tex, RenderFormat format, TextureDimension dim, uint32_t mipLevels, uint32_t depthOrArraySize)
+bool CreateTextureSRVImpl(ShaderResourceView_t srv, Texture_t tex, RenderFormat format, TextureDimension dim, const TextureViewRange& range)
 {
 	auto& dxSRV = g_Srvs.Alloc(srv);
 
@@ -47,49 +47,50 @@ bool CreateTextureSRVImpl(ShaderResourceView_t srv, Texture_t tex, RenderFormat
 	if (dim == TextureDimension::TEX1D)
 	{
 		desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE1D;
-		desc.Texture1D.MostDetailedMip = 0u;
-		desc.Texture1D.MipLevels = mipLevels;
+		desc.Texture1D.MostDetailedMip = range.FirstMip;
+		desc.Texture1D.MipLevels = range.MipLevels;
 	}
 	else if (dim == TextureDimension::TEX1D_ARRAY)
 	{
 		desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE1DARRAY;
-		desc.Texture1DArray.MostDetailedMip = 0u;
-		desc.Texture1DArray.MipLevels = mipLevels;
-		desc.Texture1DArray.ArraySize = depthOrArraySize;
+		desc.Texture1DArray.MostDetailedMip = range.FirstMip;
+		desc.Texture1DArray.MipLevels = range.MipLevels;
+		desc.Texture1DArray.FirstArraySlice = range.FirstSlice;
+		desc.Texture1DArray.ArraySize = range.SliceCount;
 	}
 	else if (dim == TextureDimension::TEX2D)
 	{
 		desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-		desc.Texture2D.MostDetailedMip = 0u;
-		desc.Texture2D.MipLevels = mipLevels;
+		desc.Texture2D.MostDetailedMip = range.FirstMip;
+		desc.Texture2D.MipLevels = range.MipLevels;
 	}
 	else if (dim == TextureDimension::TEX2D_ARRAY)
 	{
 		desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
-		desc.Texture2DArray.MostDetailedMip = 0u;
-		desc.Texture2DArray.MipLevels = mipLevels;
-		desc.Texture2DArray.FirstArraySlice = 0u;
-		desc.Texture2DArray.ArraySize = depthOrArraySize;
+		desc.Texture2DArray.MostDetailedMip = range.FirstMip;
+		desc.Texture2DArray.MipLevels = range.MipLevels;
+		desc.Texture2DArray.FirstArraySlice = range.FirstSlice;
+		desc.Texture2DArray.ArraySize = range.SliceCount;
 	}
 	else if (dim == TextureDimension::CUBEMAP)
 	{
 		desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
-		desc.TextureCube.MostDetailedMip = 0u;
-		desc.TextureCube.MipLevels = mipLevels;
+		desc.TextureCube.MostDetailedMip = range.FirstMip;
+		desc.TextureCube.MipLevels = range.MipLevels;
 	}
 	else if (dim == TextureDimension::CUBEMAP_ARRAY)
 	{
 		desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBEARRAY;
-		desc.TextureCubeArray.MostDetailedMip = 0u;
-		desc.TextureCubeArray.MipLevels = mipLevels;
-		desc.TextureCubeArray.First2DArrayFace = 0u;
-		desc.TextureCubeArray.NumCubes = depthOrArraySize;
+		desc.TextureCubeArray.MostDetailedMip = range.FirstMip;
+		desc.TextureCubeArray.MipLevels = range.MipLevels;
+		desc.TextureCubeArray.First2DArrayFace = range.FirstSlice;
+		desc.TextureCubeArray.NumCubes = range.SliceCount / 6u;
 	}
 	else if (dim == TextureDimension::TEX3D)
 	{
 		desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE3D;
-		desc.Texture3D.MostDetailedMip = 0u;
-		desc.Texture3D.MipLevels = mipLevels;
+		desc.Texture3D.MostDetailedMip = range.FirstMip;
+		desc.Texture3D.MipLevels = range.MipLevels;
 	}
 	else
 	{
@@ -104,7 +105,7 @@ bool CreateTextureSRVImpl(ShaderResourceView_t srv, Texture_t tex, RenderFormat
 	return SUCCEEDED(g_render.Device->CreateShaderResourceView(res, &desc, &dxSRV.DxSrv));
 }
 
-bool CreateTextureUAVImpl(UnorderedAccessView_t uav, Texture_t tex, RenderFormat format, TextureDimension dim, uint32_t depthOrArraySize)
+bool CreateTextureUAVImpl(UnorderedAccessView_t uav, Texture_t tex, RenderFormat format, TextureDimension dim, const TextureViewRange& range)
 {
 	auto& dxUav = g_Uavs.Alloc(uav);
 
@@ -115,47 +116,47 @@ bool CreateTextureUAVImpl(UnorderedAccessView_t uav, Texture_t tex, RenderFormat
 	if (dim == TextureDimension::TEX1D)
 	{
 		desc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE1D;
-		desc.Texture1D.MipSlice = 0u;
+		desc.Texture1D.MipSlice = range.FirstMip;
 	}
 	else if (dim == TextureDimension::TEX1D_ARRAY)
 	{
 		desc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE1DARRAY;
-		desc.Texture1DArray.MipSlice = 0u;
-		desc.Texture1DArray.FirstArraySlice = 0u;
-		desc.Texture1DArray.ArraySize = depthOrArraySize;
+		desc.Texture1DArray.MipSlice = range.FirstMip;
+		desc.Texture1DArray.FirstArraySlice = range.FirstSlice;
+		desc.Texture1DArray.ArraySize = range.SliceCount;
 	}
 	else if (dim == TextureDimension::TEX2D)
 	{
 		desc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
-		desc.Texture2D.MipSlice = 0u;
+		desc.Texture2D.MipSlice = range.FirstMip;
 	}
 	else if (dim == TextureDimension::TEX2D_ARRAY)
 	{
 		desc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2DARRAY;
-		desc.Texture2DArray.MipSlice = 0u;
-		desc.Texture2DArray.FirstArraySlice = 0u;
-		desc.Texture2DArray.ArraySize = depthOrArraySize;
+		desc.Texture2DArray.MipSlice = range.FirstMip;
+		desc.Texture2DArray.FirstArraySlice = range.FirstSlice;
+		desc.Texture2DArray.ArraySize = range.SliceCount;
 	}
 	else if (dim == TextureDimension::CUBEMAP)
 	{
 		desc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2DARRAY;
-		desc.Texture2DArray.MipSlice = 0u;
-		desc.Texture2DArray.FirstArraySlice = 0u;
-		desc.Texture2DArray.ArraySize = 6u;
+		desc.Texture2DArray.MipSlice = range.FirstMip;
+		desc.Texture2DArray.FirstArraySlice = range.FirstSlice;
+		desc.Texture2DArray.ArraySize = range.SliceCount;
 	}
 	else if (dim == TextureDimension::CUBEMAP_ARRAY)
 	{
 		desc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2DARRAY;
-		desc.Texture2DArray.MipSlice = 0u;
-		desc.Texture2DArray.FirstArraySlice = 0u;
-		desc.Texture2DArray.ArraySize = 6u * depthOrArraySize;
+		desc.Texture2DArray.MipSlice = range.FirstMip;
+		desc.Texture2DArray.FirstArraySlice = range.FirstSlice;
+		desc.Texture2DArray.ArraySize = range.SliceCount;
 	}
 	else if (dim == TextureDimension::TEX3D)
 	{
 		desc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE3D;
-		desc.Texture3D.MipSlice = 0u;
-		desc.Texture3D.FirstWSlice = 0u;
-		desc.Texture3D.WSize = -1;
+		desc.Texture3D.MipSlice = range.FirstMip;
+		desc.Texture3D.FirstWSlice = range.FirstSlice;
+		desc.Texture3D.WSize = range.SliceCount;
 	}
 	else
 	{
@@ -172,7 +173,7 @@ bool CreateTextureUAVImpl(UnorderedAccessView_t uav, Texture_t tex, RenderFormat
 	return true;
 }
 
-bool CreateTextureRTVImpl(RenderTargetView_t rtv, Texture_t tex, RenderFormat format, TextureDimension dim, uint32_t depthOrArraySize)
+bool CreateTextureRTVImpl(RenderTargetView_t rtv, Texture_t tex, RenderFormat format, TextureDimension dim, const TextureViewRange& range)
 {
 	auto& dxRtv = g_Rtvs.Alloc(rtv);
 
@@ -183,47 +184,47 @@ bool CreateTextureRTVImpl(RenderTargetView_t rtv, Texture_t tex, RenderFormat fo
 	if (dim == TextureDimension::TEX1D)
 	{
 		desc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE1D;
-		desc.Texture1D.MipSlice = 0u;
+		desc.Texture1D.MipSlice = range.FirstMip;
 	}
 	else if (dim == TextureDimension::TEX1D_ARRAY)
 	{
 		desc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE1DARRAY;
-		desc.Texture1DArray.MipSlice = 0u;
-		desc.Texture1DArray.FirstArraySlice = 0u;
-		desc.Texture1DArray.ArraySize = depthOrArraySize;
+		desc.Texture1DArray.MipSlice = range.FirstMip;
+		desc.Texture1DArray.FirstArraySlice = range.FirstSlice;
+		desc.Texture1DArray.ArraySize = range.SliceCount;
 	}
 	else if (dim == TextureDimension::TEX2D)
 	{
 		desc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
-		desc.Texture2D.MipSlice = 0u;
+		desc.Texture2D.MipSlice = range.FirstMip;
 	}
 	else if (dim == TextureDimension::TEX2D_ARRAY)
 	{
 		desc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2DARRAY;
-		desc.Texture2DArray.MipSlice = 0u;
-		desc.Texture2DArray.FirstArraySlice = 0u;
-		desc.Texture2DArray.ArraySize = depthOrArraySize;
+		desc.Texture2DArray.MipSlice = range.FirstMip;
+		desc.Texture2DArray.FirstArraySlice = range.FirstSlice;
+		desc.Texture2DArray.ArraySize = range.SliceCount;
 	}
 	else if (dim == TextureDimension::CUBEMAP)
 	{
 		desc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2DARRAY;
-		desc.Texture2DArray.MipSlice = 0u;
-		desc.Texture2DArray.FirstArraySlice = 0u;
-		desc.Texture2DArray.ArraySize = 6u;
+		desc.Texture2DArray.MipSlice = range.FirstMip;
+		desc.Texture2DArray.FirstArraySlice = range.FirstSlice;
+		desc.Texture2DArray.ArraySize = range.SliceCount;
 	}
 	else if (dim == TextureDimension::CUBEMAP_ARRAY)
 	{
 		desc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2DARRAY;
-		desc.Texture2DArray.MipSlice = 0u;
-		desc.Texture2DArray.FirstArraySlice = 0u;
-		desc.Texture2DArray.ArraySize = 6u * depthOrArraySize;
+		desc.Texture2DArray.MipSlice = range.FirstMip;
+		desc.Texture2DArray.FirstArraySlice = range.FirstSlice;
+		desc.Texture2DArray.ArraySize = range.SliceCount;
 	}
 	else if (dim == TextureDimension::TEX3D)
 	{
 		desc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE3D;
-		desc.Texture3D.MipSlice = 0u;
-		desc.Texture3D.FirstWSlice = 0u;
-		desc.Texture3D.WSize = -1;
+		desc.Texture3D.MipSlice = range.FirstMip;
+		desc.Texture3D.FirstWSlice = range.FirstSlice;
+		desc.Texture3D.WSize = range.SliceCount;
 	}
 	else
 	{
@@ -240,7 +241,7 @@ bool CreateTextureRTVImpl(RenderTargetView_t rtv, Texture_t tex, RenderFormat fo
 	return true;	
 }
 
-bool CreateTextureDSVImpl(DepthStencilView_t dsv, Texture_t tex, RenderFormat format, TextureDimension dim, uint32_t depthOrArraySize)
+bool CreateTextureDSVImpl(DepthStencilView_t dsv, Texture_t tex, RenderFormat format, TextureDimension dim, const TextureViewRange& range)
 {
 	auto& dxDsv = g_Dsvs.Alloc(dsv);
 
@@ -251,40 +252,40 @@ bool CreateTextureDSVImpl(DepthStencilView_t dsv, Texture_t tex, RenderFormat fo
 	if (dim == TextureDimension::TEX1D)
 	{
 		desc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE1D;
-		desc.Texture1D.MipSlice = 0u;
+		desc.Texture1D.MipSlice = range.FirstMip;
 	}
 	else if (dim == TextureDimension::TEX1D_ARRAY)
 	{
 		desc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE1DARRAY;
-		desc.Texture1DArray.MipSlice = 0u;
-		desc.Texture1DArray.FirstArraySlice = 0u;
-		desc.Texture1DArray.ArraySize = depthOrArraySize;
+		desc.Texture1DArray.MipSlice = range.FirstMip;
+		desc.Texture1DArray.FirstArraySlice = range.FirstSlice;
+		desc.Texture1DArray.ArraySize = range.SliceCount;
 	}
 	else if (dim == TextureDimension::TEX2D)
 	{
 		desc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
-		desc.Texture2D.MipSlice = 0u;
+		desc.Texture2D.MipSlice = range.FirstMip;
 	}
 	else if (dim == TextureDimension::TEX2D_ARRAY)
 	{
 		desc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2DARRAY;
-		desc.Texture2DArray.MipSlice = 0u;
-		desc.Texture2DArray.FirstArraySlice = 0u;
-		desc.Texture2DArray.ArraySize = depthOrArraySize;
+		desc.Texture2DArray.MipSlice = range.FirstMip;
+		desc.Texture2DArray.FirstArraySlice = range.FirstSlice;
+		desc.Texture2DArray.ArraySize = range.SliceCount;
 	}
 	else if (dim == TextureDimension::CUBEMAP)
 	{
 		desc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2DARRAY;
-		desc.Texture2DArray.MipSlice = 0u;
-		desc.Texture2DArray.FirstArraySlice = 0u;
-		desc.Texture2DArray.ArraySize = 6u;
+		desc.Texture2DArray.MipSlice = range.FirstMip;
+		desc.Texture2DArray.FirstArraySlice = range.FirstSlice;
+		desc.Texture2DArray.ArraySize = range.SliceCount;
 	}
 	else if (dim == TextureDimension::CUBEMAP_ARRAY)
 	{
 		desc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2DARRAY;
-		desc.Texture2DArray.MipSlice = 0u;
-		desc.Texture2DArray.FirstArraySlice = 0u;
-		desc.Texture2DArray.ArraySize = 6u * depthOrArraySize;
+		desc.Texture2DArray.MipSlice = range.FirstMip;
+		desc.Texture2DArray.FirstArraySlice = range.FirstSlice;
+		desc.Texture2DArray.ArraySize = range.SliceCount;
 	}
 	else
 	{
@@ -372,6 +373,59 @@ bool CreateStructuredBufferUAVImpl(UnorderedAccessView_t uav, StructuredBuffer_t
 	return SUCCEEDED(g_render.Device->CreateUnorderedAccessView(res, &desc, &dxUav.DxUav));
 }
 
+bool CreateByteBufferSRVImpl(ShaderResourceView_t srv, StructuredBuffer_t buf, uint32_t firstElement, uint32_t numElements)
+{
+	ID3D11Resource* res = Dx11_GetStructuredBuffer(buf);
+	if (!res)
+		return false;
+
+	auto& dxSrv = g_Srvs.Alloc(srv);
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC& desc = dxSrv.Desc;
+
+	desc.Format = DXGI_FORMAT_R32_TYPELESS;
+	desc.ViewDimension = D3D11_SRV_DIMENSION_BUFFEREX;
+
+	desc.BufferEx.FirstElement = (UINT)firstElement;
+	desc.BufferEx.NumElements = (UINT)numElements;
+	desc.BufferEx.Flags = D3D11_BUFFEREX_SRV_FLAG_RAW;
+
+	return SUCCEEDED(g_render.Device->CreateShaderResourceView(res, &desc, &dxSrv.DxSrv));
+}
+
+bool CreateByteBufferUAVImpl(UnorderedAccessView_t uav, StructuredBuffer_t buf, uint32_t firstElement, uint32_t numElements)
+{
+	ID3D11Resource* res = Dx11_GetStructuredBuffer(buf);
+	if (!res)
+		return false;
+
+	auto& dxUav = g_Uavs.Alloc(uav);
+
+	D3D11_UNORDERED_ACCESS_VIEW_DESC& desc = dxUav.Desc;
+
+	desc.Format = DXGI_FORMAT_R32_TYPELESS;
+	desc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+
+	desc.Buffer.FirstElement = (UINT)firstElement;
+	desc.Buffer.NumElements = (UINT)numElements;
+	desc.Buffer.Flags = D3D11_BUFFER_UAV_FLAG_RAW;
+
+	return SUCCEEDED(g_render.Device->CreateUnorderedAccessView(res, &desc, &dxUav.DxUav));
+}
+
+// Dx11 isn't bindless, bind the dynamic buffer directly instead
+uint32_t CreateDynamicStructuredBufferSRVImpl(DynamicBuffer_t buf, uint32_t structureByteStride)
+{
+	assert(0);
+	return 0u;
+}
+
+uint32_t CreateDynamicByteBufferSRVImpl(DynamicBuffer_t buf)
+{
+	assert(0);
+	return 0u;
+}
+
 void DestroySRV(ShaderResourceView_t srv)
 {
 	g_Srvs.Free(srv);
@@ -3,6 +3,7 @@
 #include "IDArray.h"
 #include "RenderImpl.h"
 
+#include <unordered_set>
 #include <vector>
 
 namespace rl
@@ -12,9 +13,14 @@ std::vector<ComPtr<ID3D11Buffer>> g_DxVertexBuffers;
 std::vector<ComPtr<ID3D11Buffer>> g_DxIndexBuffers;
 std::vector<ComPtr<ID3D11Buffer>> g_DxStructuredBuffers;
 std::vector<ComPtr<ID3D11Buffer>> g_DxConstantBuffers;
+std::vector<ComPtr<ID3D11Buffer>> g_DxGenericBuffers;
 
 std::vector<ComPtr<ID3D11Buffer>> g_DxDynamicBuffers;
 
+// Buffers from AllocateDynamic stay mapped until they are bound or the frame ends, dx11 can't use a buffer while it is mapped.
+// Indexed like g_DxDynamicBuffers, so binding one buffer only unmaps that buffer.
+std::vector<bool> g_DxDynamicBufferMapped;
+
 static ComPtr<ID3D11Buffer>& AllocVertexBuffer(VertexBuffer_t vb)
 {
 	if ((size_t)vb >= g_DxVertexBuffers.size())
@@ -47,10 +53,25 @@ static ComPtr<ID3D11Buffer>& AllocConstantBuffer(ConstantBuffer_t cb)
 	return g_DxConstantBuffers[(uint32_t)cb];
 }
 
-bool CreateBuffer(const void* const data, UINT size, D3D11_USAGE usage, UINT bind, UINT misc, UINT stride, ComPtr<ID3D11Buffer>& buffer)
+static ComPtr<ID3D11Buffer>& AllocGenericBuffer(Buffer_t buf)
+{
+	if ((size_t)buf >= g_DxGenericBuffers.size())
+		g_DxGenericBuffers.resize((uint32_t)buf + 1);
+
+	return g_DxGenericBuffers[(uint32_t)buf];
+}
+
+bool CreateBuffer(const void* const data, size_t size, D3D11_USAGE usage, UINT bind, UINT misc, UINT stride, ComPtr<ID3D11Buffer>& buffer)
 {
+	// Dx11 buffer sizes are 32 bit, and the runtime caps them well below that
+	if (size > UINT32_MAX)
+	{
+		assert(0 && "CreateBuffer dx11 buffers can't exceed 4GB");
+		return false;
+	}
+
 	D3D11_BUFFER_DESC desc = {};
-	desc.ByteWidth = size;
+	desc.ByteWidth = (UINT)size;
 	desc.Usage = usage;
 	desc.BindFlags = bind;
 	desc.CPUAccessFlags = usage == D3D11_USAGE_DYNAMIC ? D3D11_CPU_ACCESS_WRITE : 0;
@@ -65,7 +86,7 @@ bool CreateBuffer(const void* const data, UINT size, D3D11_USAGE usage, UINT bin
 	return SUCCEEDED(g_render.Device->CreateBuffer(&desc, data ? &subRes : nullptr, &buffer));
 }
 
-static bool CopyToBuffer(ID3D11Buffer* target, const void* const data, UINT size)
+static bool CopyToBuffer(ID3D11Buffer* target, const void* const data, UINT offset, UINT size)
 {
 	if (!target)
 		return false;
@@ -85,39 +106,68 @@ static bool CopyToBuffer(ID3D11Buffer* target, const void* const data, UINT size
 	if (FAILED(g_render.Device->CreateBuffer(&desc, data ? &subRes : nullptr, &staging)))
 		return false;
 
-	g_render.DeviceContext->CopySubresourceRegion(target, 0, 0, 0, 0, staging.Get(), 0, nullptr);
+	g_render.DeviceContext->CopySubresourceRegion(target, 0, offset, 0, 0, staging.Get(), 0, nullptr);
 
 	return true;
 }
 
 bool CreateVertexBufferImpl(VertexBuffer_t handle, const void* const data, size_t size)
 {
-	return CreateBuffer(data, (UINT)size, D3D11_USAGE_DEFAULT, D3D11_BIND_VERTEX_BUFFER, 0, 0, AllocVertexBuffer(handle));
+	return CreateBuffer(data, size, D3D11_USAGE_DEFAULT, D3D11_BIND_VERTEX_BUFFER, 0, 0, AllocVertexBuffer(handle));
 }
 
 bool CreateIndexBufferImpl(IndexBuffer_t handle, const void* const data, size_t size)
 {
-	return CreateBuffer(data, (UINT)size, D3D11_USAGE_DEFAULT, D3D11_BIND_INDEX_BUFFER, 0, 0, AllocIndexBuffer(handle));
+	return CreateBuffer(data, size, D3D11_USAGE_DEFAULT, D3D11_BIND_INDEX_BUFFER, 0, 0, AllocIndexBuffer(handle));
 }
 
 bool CreateStructuredBufferImpl(StructuredBuffer_t handle, const void* const data, size_t size, size_t stride, RenderResourceFlags flags)
 {
-	return CreateBuffer(data, (UINT)size, D3D11_USAGE_DEFAULT, Dx11_BindFlags(flags), 0, (UINT)stride, AllocStructuredBuffer(handle));
+	return CreateBuffer(data, size, D3D11_USAGE_DEFAULT, Dx11_BindFlags(flags), 0, (UINT)stride, AllocStructuredBuffer(handle));
 }
 
 bool CreateConstantBufferImpl(ConstantBuffer_t handle, const void* const data, size_t size)
 {
-	return CreateBuffer(data, (UINT)size, D3D11_USAGE_DYNAMIC, D3D11_BIND_CONSTANT_BUFFER, 0, 0, AllocConstantBuffer(handle));
+	return CreateBuffer(data, size, D3D11_USAGE_DYNAMIC, D3D11_BIND_CONSTANT_BUFFER, 0, 0, AllocConstantBuffer(handle));
 }
 
-void UpdateVertexBufferImpl(VertexBuffer_t vb, const void* const data, size_t size)
+bool CreateBufferImpl(Buffer_t handle, const BufferViews& views, const void* const data, size_t size, size_t stride, BufferUsage usage)
 {
-	CopyToBuffer(g_DxVertexBuffers[(uint32_t)vb].Get(), data, (UINT)size);
+	// Structured buffers can't be bound as vertex, index or indirect args buffers or viewed as raw in dx11
+	if (HasEnumFlags(usage, BufferUsage::STRUCTURED) && HasEnumFlags(usage, BufferUsage::VERTEX | BufferUsage::INDEX | BufferUsage::RAW | BufferUsage::INDIRECT_ARGS))
+	{
+		assert(0 && "CreateBufferImpl structured usage can't be combined with vertex, index, raw or indirect args usage in dx11");
+		return false;
+	}
+
+	const UINT structureStride = HasEnumFlags(usage, BufferUsage::STRUCTURED) ? (UINT)stride : 0u;
+
+	ComPtr<ID3D11Buffer>& buffer = AllocGenericBuffer(handle);
+
+	if (!CreateBuffer(data, size, D3D11_USAGE_DEFAULT, Dx11_BindFlags(usage), Dx11_MiscFlags(usage), structureStride, buffer))
+		return false;
+
+	// The views hold their own reference to the same buffer
+	if (views.Vertex != VertexBuffer_t::INVALID)
+		AllocVertexBuffer(views.Vertex) = buffer;
+
+	if (views.Index != IndexBuffer_t::INVALID)
+		AllocIndexBuffer(views.Index) = buffer;
+
+	if (views.Structured != StructuredBuffer_t::INVALID)
+		AllocStructuredBuffer(views.Structured) = buffer;
+
+	return true;
 }
 
-void UpdateIndexBufferImpl(IndexBuffer_t ib, const void* const data, size_t size)
+void UpdateVertexBufferImpl(VertexBuffer_t vb, const void* const data, size_t offset, size_t size)
 {
-	CopyToBuffer(g_DxIndexBuffers[(uint32_t)ib].Get(), data, (UINT)size);
+	CopyToBuffer(g_DxVertexBuffers[(uint32_t)vb].Get(), data, (UINT)offset, (UINT)size);
+}
+
+void UpdateIndexBufferImpl(IndexBuffer_t ib, const void* const data, size_t offset, size_t size)
+{
+	CopyToBuffer(g_DxIndexBuffers[(uint32_t)ib].Get(), data, (UINT)offset, (UINT)size);
 }
 
 void UpdateConstantBufferImpl(ConstantBuffer_t handle, const void* const data, size_t size)
@@ -133,17 +183,15 @@ void UpdateConstantBufferImpl(ConstantBuffer_t handle, const void* const data, s
 	g_render.DeviceContext->Unmap(res, 0);
 }
 
-void UpdateStructuredBufferImpl(StructuredBuffer_t sb, const void* const data, size_t size)
+void UpdateStructuredBufferImpl(StructuredBuffer_t sb, const void* const data, size_t offset, size_t size)
 {
-	ID3D11Resource* res = g_DxStructuredBuffers[(uint32_t)sb].Get();
-
-	D3D11_MAPPED_SUBRESOURCE subRes;
-	if (FAILED(g_render.DeviceContext->Map(res, 0, D3D11_MAP_WRITE_DISCARD, 0, &subRes)))
-		assert(0 && "UpdateStructuredBufferImpl failed to map buffer");
-
-	memcpy(subRes.pData, data, size);
+	// Structured buffers are created with default usage so they can't be mapped, copy the range through a staging buffer instead
+	CopyToBuffer(g_DxStructuredBuffers[(uint32_t)sb].Get(), data, (UINT)offset, (UINT)size);
+}
 
-	g_render.DeviceContext->Unmap(res, 0);
+void UpdateBufferImpl(Buffer_t buf, const void* const data, size_t offset, size_t size)
+{
+	CopyToBuffer(g_DxGenericBuffers[(uint32_t)buf].Get(), data, (UINT)offset, (UINT)size);
 }
 
 void DestroyVertexBuffer(VertexBuffer_t handle)
@@ -166,6 +214,11 @@ void DestroyConstantBuffer(ConstantBuffer_t handle)
 	g_DxConstantBuffers[(uint32_t)handle] = nullptr;
 }
 
+void DestroyBuffer(Buffer_t handle)
+{
+	g_DxGenericBuffers[(uint32_t)handle] = nullptr;
+}
+
 ID3D11Buffer* Dx11_GetVertexBuffer(VertexBuffer_t vb)
 {
 	return g_DxVertexBuffers[(uint32_t)vb].Get();
@@ -186,8 +239,19 @@ ID3D11Buffer* Dx11_GetConstantBuffer(ConstantBuffer_t cb)
 	return g_DxConstantBuffers[(uint32_t)cb].Get();
 }
 
+static void UnmapDynamicBuffer(uint32_t index)
+{
+	if (index < g_DxDynamicBufferMapped.size() && g_DxDynamicBufferMapped[index])
+	{
+		g_render.DeviceContext->Unmap(g_DxDynamicBuffers[index].Get(), 0);
+		g_DxDynamicBufferMapped[index] = false;
+	}
+}
+
 ID3D11Buffer* Dx11_GetDynamicBuffer(DynamicBuffer_t db)
 {
+	UnmapDynamicBuffer((uint32_t)db);
+
 	return g_DxDynamicBuffers[(uint32_t)db].Get();
 }
 
@@ -195,7 +259,7 @@ static DynamicBuffer_t CreateDynamicBuffer(const void* const data, size_t size,
 {
 	ComPtr<ID3D11Buffer> dynBuf;
 
-	if (CreateBuffer(data, (UINT)size, D3D11_USAGE_IMMUTABLE, bind, 0, 0, dynBuf))
+	if (CreateBuffer(data, size, D3D11_USAGE_IMMUTABLE, bind, 0, 0, dynBuf))
 	{
 		g_DxDynamicBuffers.push_back(dynBuf);
 		return (DynamicBuffer_t)(g_DxDynamicBuffers.size() - 1);
@@ -228,6 +292,47 @@ DynamicBuffer_t CreateDynamicByteBuffer(const void* const data, size_t size)
 	return DynamicBuffer_t::INVALID;
 }
 
+DynamicBufferAllocation AllocateDynamic(size_t size, DynamicBufferKind kind)
+{
+	UINT bind = 0;
+
+	switch (kind)
+	{
+	case DynamicBufferKind::VERTEX: bind = D3D11_BIND_VERTEX_BUFFER; break;
+	case DynamicBufferKind::INDEX: bind = D3D11_BIND_INDEX_BUFFER; break;
+	case DynamicBufferKind::CONSTANT: bind = D3D11_BIND_CONSTANT_BUFFER; break;
+	// Dx11 has no way to bind a dynamic buffer as a shader resource, Buffers.h documents BYTE as dx12 only
+	case DynamicBufferKind::BYTE: return {};
+	}
+
+	// Constant buffer sizes have to be a multiple of 16 bytes
+	const size_t bufferSize = kind == DynamicBufferKind::CONSTANT ? (size + 15u) & ~(size_t)15u : size;
+
+	ComPtr<ID3D11Buffer> dynBuf;
+	if (!CreateBuffer(nullptr, bufferSize, D3D11_USAGE_DYNAMIC, bind, 0, 0, dynBuf))
+	{
+		return {};
+	}
+
+	D3D11_MAPPED_SUBRESOURCE mapped = {};
+	if (FAILED(g_render.DeviceContext->Map(dynBuf.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+	{
+		return {};
+	}
+
+	g_DxDynamicBuffers.push_back(dynBuf);
+
+	g_DxDynamicBufferMapped.resize(g_DxDynamicBuffers.size(), false);
+	g_DxDynamicBufferMapped.back() = true;
+
+	DynamicBufferAllocation ret;
+	ret.Buffer = (DynamicBuffer_t)(g_DxDynamicBuffers.size() - 1);
+	ret.pData = mapped.pData;
+	ret.Size = size;
+
+	return ret;
+}
+
 void DynamicBuffers_NewFrame()
 {
 	g_DxDynamicBuffers.resize(1);
@@ -235,7 +340,12 @@ void DynamicBuffers_NewFrame()
 
 void DynamicBuffers_EndFrame()
 {
+	for (uint32_t i = 0; i < (uint32_t)g_DxDynamicBufferMapped.size(); i++)
+	{
+		UnmapDynamicBuffer(i);
+	}
 
+	g_DxDynamicBufferMapped.clear();
 }
 
 void UploadBuffers(CommandList* cl)
@@ -243,4 +353,52 @@ void UploadBuffers(CommandList* cl)
 	(void)cl;
 }
 
+// Updates go through the immediate context, so anything drawn after them already sees the data.
+uint64_t GetBufferUploadFence()
+{
+	return 0u;
+}
+
+bool IsBufferUploadComplete(uint64_t fence)
+{
+	(void)fence;
+	return true;
+}
+
+static void AddBuffersSize(const std::vector<ComPtr<ID3D11Buffer>>& buffers, std::unordered_set<ID3D11Buffer*>& counted, size_t& size)
+{
+	for (const ComPtr<ID3D11Buffer>& buffer : buffers)
+	{
+		// Generic buffers share one buffer between their views, only count it once
+		if (buffer && counted.insert(buffer.Get()).second)
+		{
+			D3D11_BUFFER_DESC desc;
+			buffer->GetDesc(&desc);
+
+			size += desc.ByteWidth;
+		}
+	}
+}
+
+BufferResidencyReport GetBufferResidencyReport()
+{
+	// The driver manages staging for default usage buffers in dx11
+	BufferResidencyReport report;
+
+	std::unordered_set<ID3D11Buffer*> counted;
+	AddBuffersSize(g_DxVertexBuffers, counted, report.DeviceBytes);
+	AddBuffersSize(g_DxIndexBuffers, counted, report.DeviceBytes);
+	AddBuffersSize(g_DxStructuredBuffers, counted, report.DeviceBytes);
+	AddBuffersSize(g_DxConstantBuffers, counted, report.DeviceBytes);
+	AddBuffersSize(g_DxGenericBuffers, counted, report.DeviceBytes);
+
+	return report;
+}
+
+BufferCompactionReport CompactBuffers([[maybe_unused]] size_t byteBudget)
+{
+	// Every dx11 buffer is its own resource, so there are no pages to compact
+	return {};
+}
+
 }
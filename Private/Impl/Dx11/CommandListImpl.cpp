@@ -420,9 +420,12 @@ void CommandList::SetGraphicsRootUAV(uint32_t slot, UnorderedAccessView_t uav) {
 void CommandList::SetComputeRootUAV(uint32_t slot, UnorderedAccessView_t uav) { assert(0); }
 void CommandList::SetGraphicsRootDescriptorTable(uint32_t slot) { assert(0); }
 void CommandList::SetComputeRootDescriptorTable(uint32_t slot) { assert(0); }
+void CommandList::SetGraphicsRootSamplerTable(uint32_t slot) { assert(0); }
+void CommandList::SetComputeRootSamplerTable(uint32_t slot) { assert(0); }
 
 void CommandList::TransitionResource(Texture_t tex, ResourceTransitionState before, ResourceTransitionState after) {}
 void CommandList::TransitionResource(StructuredBuffer_t buf, ResourceTransitionState before, ResourceTransitionState after) {}
+void CommandList::TransitionResource(Texture_t tex, uint32_t mip, uint32_t slice, ResourceTransitionState before, ResourceTransitionState after) {}
 void CommandList::UAVBarrier(Texture_t tex) {}
 void CommandList::UAVBarrier(StructuredBuffer_t buf) {}
 
@@ -147,6 +147,41 @@ UINT Dx11_BindFlags(RenderResourceFlags flags)
     return bind;
 }
 
+UINT Dx11_BindFlags(BufferUsage usage)
+{
+    UINT bind = 0;
+
+    if (HasEnumFlags(usage, BufferUsage::VERTEX))
+        bind |= D3D11_BIND_VERTEX_BUFFER;
+
+    if (HasEnumFlags(usage, BufferUsage::INDEX))
+        bind |= D3D11_BIND_INDEX_BUFFER;
+
+    if (HasEnumFlags(usage, BufferUsage::STRUCTURED | BufferUsage::RAW))
+        bind |= D3D11_BIND_SHADER_RESOURCE;
+
+    if (HasEnumFlags(usage, BufferUsage::UAV))
+        bind |= D3D11_BIND_UNORDERED_ACCESS;
+
+    return bind;
+}
+
+UINT Dx11_MiscFlags(BufferUsage usage)
+{
+    UINT misc = 0;
+
+    if (HasEnumFlags(usage, BufferUsage::STRUCTURED))
+        misc |= D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+
+    if (HasEnumFlags(usage, BufferUsage::RAW))
+        misc |= D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS;
+
+    if (HasEnumFlags(usage, BufferUsage::INDIRECT_ARGS))
+        misc |= D3D11_RESOURCE_MISC_DRAWINDIRECT_ARGS;
+
+    return misc;
+}
+
 D3D11_USAGE Dx11_Usage(ResourceUsage usage)
 {
     switch (usage)
@@ -12,6 +12,8 @@ namespace rl
 
 DXGI_FORMAT Dx11_Format(RenderFormat format);
 UINT Dx11_BindFlags(RenderResourceFlags flags);
+UINT Dx11_BindFlags(BufferUsage usage);
+UINT Dx11_MiscFlags(BufferUsage usage);
 D3D11_USAGE Dx11_Usage(ResourceUsage usage);
 void Dx11_CalculatePitch(DXGI_FORMAT format, UINT width, UINT height, UINT* rowPitch, UINT* slicePitch);
 
@@ -2,6 +2,8 @@
 
 #include "RenderImpl.h"
 
+#include <mutex>
+
 namespace rl
 {
 
@@ -9,6 +11,16 @@ namespace rl
 std::vector<Dx11GraphicsPipelineState> g_graphicsPipelines;
 std::vector<Dx11ComputePipelineState> g_computePipelines;
 
+// D3D11 input layouts are validated against a vertex shader signature, so each interned layout caches one object per vertex shader
+struct Dx11InputLayoutEntry
+{
+	VertexShader_t vs = VertexShader_t::INVALID;
+	ID3DBlob* blob = nullptr;
+	ComPtr<ID3D11InputLayout> il = nullptr;
+};
+std::vector<std::vector<Dx11InputLayoutEntry>> g_inputLayouts;
+std::mutex g_inputLayoutsMutex;
+
 static Dx11GraphicsPipelineState* AllocGraphicsPipeline(GraphicsPipelineState_t pso)
 {
 	if ((size_t)pso >= g_graphicsPipelines.size())
@@ -172,7 +184,78 @@ D3D11_PRIMITIVE_TOPOLOGY GetPrimTopo(PrimitiveTopologyType pt)
 	return D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
 }
 
-bool CompileGraphicsPipelineState(GraphicsPipelineState_t handle, const GraphicsPipelineStateDesc& desc, const InputElementDesc* inputs, size_t inputCount)
+static ComPtr<ID3D11InputLayout> GetDxInputLayout(InputLayout_t layout, VertexShader_t vs)
+{
+	std::scoped_lock lock(g_inputLayoutsMutex);
+
+	if ((size_t)layout >= g_inputLayouts.size())
+		g_inputLayouts.resize((size_t)layout + 1);
+
+	std::vector<Dx11InputLayoutEntry>& entries = g_inputLayouts[(size_t)layout];
+
+	ID3DBlob* blob = Dx11_GetVertexShaderBlob(vs);
+	assert(blob != nullptr && "Failed creating input layout, vertex blob is null");
+
+	// Reloaded shaders get a new blob, the entry for the old blob is replaced so the cache holds one layout per vertex shader
+	Dx11InputLayoutEntry* existing = nullptr;
+	for (Dx11InputLayoutEntry& entry : entries)
+	{
+		if (entry.vs == vs)
+		{
+			if (entry.blob == blob)
+				return entry.il;
+
+			existing = &entry;
+			break;
+		}
+	}
+
+	const InputLayoutData* data = GetInputLayout(layout);
+	assert(data && "GetDxInputLayout invalid layout");
+
+	std::vector<D3D11_INPUT_ELEMENT_DESC> dxLayout;
+	dxLayout.resize(data->Elements.size());
+
+	for (size_t i = 0; i < data->Elements.size(); i++)
+	{
+		const InputElementDesc& input = data->Elements[i];
+
+		dxLayout[i].AlignedByteOffset = (UINT)input.alignedByteOffset;
+		dxLayout[i].Format = Dx11_Format(input.format);
+		dxLayout[i].InputSlot = (UINT)input.inputSlot;
+		dxLayout[i].InstanceDataStepRate = (UINT)input.instanceDataStepRate;
+		dxLayout[i].SemanticIndex = (UINT)input.semanticIndex;
+		dxLayout[i].SemanticName = (LPCSTR)input.semanticName;
+
+		switch (input.inputSlotClass)
+		{
+		case InputClassification::PER_VERTEX:
+			dxLayout[i].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+			break;
+		case InputClassification::PER_INSTANCE:
+			dxLayout[i].InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA;
+			break;
+		};
+	}
+
+	Dx11InputLayoutEntry entry;
+	entry.vs = vs;
+	entry.blob = blob;
+
+	if (FAILED(g_render.Device->CreateInputLayout(dxLayout.data(), (UINT)dxLayout.size(), blob->GetBufferPointer(), blob->GetBufferSize(), &entry.il)))
+	{
+		return nullptr;
+	}
+
+	if (existing)
+		*existing = entry;
+	else
+		entries.push_back(entry);
+
+	return entry.il;
+}
+
+bool CompileGraphicsPipelineState(GraphicsPipelineState_t handle, const GraphicsPipelineStateDesc& desc, InputLayout_t layout)
 {
 	Dx11GraphicsPipelineState* pso = AllocGraphicsPipeline(handle);
 
@@ -211,39 +294,15 @@ bool CompileGraphicsPipelineState(GraphicsPipelineState_t handle, const Graphics
 		}			
 	}
 
-	if (inputs != nullptr && inputCount && desc.VS != VertexShader_t::INVALID)
+	if (layout != InputLayout_t::INVALID && desc.VS != VertexShader_t::INVALID)
 	{
-		ID3DBlob* blob = Dx11_GetVertexShaderBlob(desc.VS);
-		assert(blob != nullptr && "Failed creating input layout, vertex blob is null");
-
-		std::vector<D3D11_INPUT_ELEMENT_DESC> dxLayout;
-		dxLayout.resize(inputCount);
-
-		for (size_t i = 0; i < inputCount; i++)
-		{
-			dxLayout[i].AlignedByteOffset = (UINT)inputs[i].alignedByteOffset;
-			dxLayout[i].Format = Dx11_Format(inputs[i].format);
-			dxLayout[i].InputSlot = (UINT)inputs[i].inputSlot;
-			dxLayout[i].InstanceDataStepRate = (UINT)inputs[i].instanceDataStepRate;
-			dxLayout[i].SemanticIndex = (UINT)inputs[i].semanticIndex;
-			dxLayout[i].SemanticName = (LPCSTR)inputs[i].semanticName;
-
-			switch (inputs[i].inputSlotClass)
-			{
-			case InputClassification::PER_VERTEX:
-				dxLayout[i].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-				break;
-			case InputClassification::PER_INSTANCE:
-				dxLayout[i].InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA;
-				break;
-			};
-		}
+		pso->il = GetDxInputLayout(layout, desc.VS);
 
-		if (FAILED(g_render.Device->CreateInputLayout(dxLayout.data(), (UINT)dxLayout.size(), blob->GetBufferPointer(), blob->GetBufferSize(), &pso->il)))
+		if (!pso->il)
 		{
 			fprintf(stderr, "CompileGraphicsPipelineState failed to create input layout");
 			return false;
-		}				
+		}
 	}
 
 	return true;
@@ -279,4 +338,12 @@ void DestroyComputePipelineState(ComputePipelineState_t pso)
 	g_computePipelines[(uint32_t)pso] = {};
 }
 
+void DestroyInputLayout(InputLayout_t layout)
+{
+	std::scoped_lock lock(g_inputLayoutsMutex);
+
+	if ((size_t)layout < g_inputLayouts.size())
+		g_inputLayouts[(size_t)layout].clear();
+}
+
 }
\ No newline at end of file
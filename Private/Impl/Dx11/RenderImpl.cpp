@@ -1,6 +1,7 @@
 #include "RenderImpl.h"
 #include "Render.h"
 #include "Buffers.h"
+#include "Impl/BuffersImpl.h"
 
 namespace rl
 {
@@ -64,6 +65,9 @@ void Render_BeginRenderFrame()
 void Render_EndFrame()
 {
 	DynamicBuffers_EndFrame();
+
+	// The driver orders updates after draws already submitted, freed geometry can be reused straight away
+	GeometryPools_EndFrame(0u, 0u, 0u, 0u);
 }
 
 void Render_ShutDown()
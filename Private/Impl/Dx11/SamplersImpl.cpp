@@ -0,0 +1,24 @@
+#include "Impl/SamplersImpl.h"
+
+#include "RenderImpl.h"
+
+namespace rl
+{
+
+// Dx11 samplers are bound by slot, runtime samplers only exist so the shared code links.
+bool CreateSamplerImpl(Sampler_t sampler, const SamplerDesc& desc)
+{
+	return true;
+}
+
+void DestroySamplerImpl(Sampler_t sampler)
+{
+}
+
+uint32_t GetDescriptorIndexImpl(Sampler_t sampler)
+{
+	assert(0 && "GetDescriptorIndexImpl Dx11 samplers are not bindless");
+	return 0u;
+}
+
+}
\ No newline at end of file
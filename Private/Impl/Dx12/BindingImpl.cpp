@@ -1,13 +1,16 @@
 #include "Impl/BindingImpl.h"
 
 #include "RenderImpl.h"
+#include "CpuDescriptorPool.h"
+#include "DescriptorSlotAllocator.h"
 #include "Impl/TexturesImpl.h"
 #include "Textures.h"
 #include "IDArray.h"
 
 #include "SparseArray.h"
 
-#include <queue>
+#include <algorithm>
+#include <atomic>
 #include <vector>
 
 namespace rl
@@ -30,18 +33,21 @@ struct SRVUAVDescriptor
 		D3D12_UNORDERED_ACCESS_VIEW_DESC UavDesc;
 	};
 	ID3D12Resource* Resource;
+	uint32_t Slot;
 };
 
 struct RTVDescriptor
 {
 	D3D12_RENDER_TARGET_VIEW_DESC RtvDesc;
 	ID3D12Resource* Resource;
+	uint32_t Slot;
 };
 
 struct DSVDescriptor
 {
 	D3D12_DEPTH_STENCIL_VIEW_DESC DsvDesc;
 	ID3D12Resource* Resource;
+	uint32_t Slot;
 };
 
 IDArray<SRVUAV_t, SRVUAVDescriptor> g_SrvUavDescriptors;
@@ -52,246 +58,232 @@ std::shared_mutex g_RtvMutex;
 SparseArray<DSVDescriptor, DepthStencilView_t> g_DsvDescriptors;
 std::shared_mutex g_DsvMutex;
 
-struct DescriptorHeaps
+// The start of the shader visible srv/uav heap is a ring of views of dynamic buffers, persistent descriptors follow it.
+// The ring is split into a segment per frame, a segment is only written again once the gpu has finished the frame that last used it.
+static constexpr UINT TransientSrvSegmentCount = 4u;
+static constexpr UINT TransientSrvSegmentSize = 4096u;
+static constexpr UINT TransientSrvCount = TransientSrvSegmentCount * TransientSrvSegmentSize;
+
+static constexpr UINT PersistentSrvUavCount = 256u * 1024u;
+
+// One heap for the lifetime of the device, creating or destroying a view only writes its own descriptor.
+struct SrvUavDescriptorHeap
 {
+	ComPtr<ID3D12DescriptorHeap> DxHeap;
 	UINT DescriptorHandleIncrement = 0u;
 
-	std::vector<Dx12DescriptorHeap> FreeHeaps;
-	std::queue<Dx12DescriptorHeap> PendingDeletion;
-	std::queue<Dx12DescriptorHeap> InFlightHeaps;
+	DescriptorSlotAllocator Slots{ PersistentSrvUavCount };
 
-	std::mutex Mutex;
+	// Index 0 of each segment stays null so a 0 descriptor index is still invalid
+	UINT TransientSegment = 0u;
+	std::atomic<uint32_t> TransientCount = 1u;
+	uint64_t TransientGraphicsFences[TransientSrvSegmentCount] = {};
+	uint64_t TransientComputeFences[TransientSrvSegmentCount] = {};
 
-	virtual Dx12DescriptorHeap CreateHeap() = 0;
+	std::once_flag Init;
+};
 
-	void BeginFrame()
-	{
-		auto lock = std::scoped_lock(Mutex);
+SrvUavDescriptorHeap g_SrvUavHeap;
 
-		if (!InFlightHeaps.empty() || !PendingDeletion.empty())
-		{
-			const uint64_t directFenceCurrent = g_render.DirectQueue.DxFence->GetCompletedValue();
-			const uint64_t computeFenceCurrent = g_render.ComputeQueue.DxFence->GetCompletedValue();
+static D3D12_SHADER_RESOURCE_VIEW_DESC GetNullSrvDesc()
+{
+	D3D12_SHADER_RESOURCE_VIEW_DESC nullSrvDesc = {};
+	nullSrvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+	nullSrvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+	nullSrvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
 
-			while (!InFlightHeaps.empty())
-			{
-				if (InFlightHeaps.front().ComputeFenceValue < computeFenceCurrent && InFlightHeaps.front().DirectFenceValue < directFenceCurrent)
-				{
-					FreeHeaps.emplace_back(std::move(InFlightHeaps.front()));
-					InFlightHeaps.pop();
-				}
-				else
-				{
-					break;
-				}
-			}
+	return nullSrvDesc;
+}
 
-			while (!PendingDeletion.empty())
-			{
-				if (PendingDeletion.front().ComputeFenceValue <= computeFenceCurrent && PendingDeletion.front().DirectFenceValue <= directFenceCurrent)
-				{
-					PendingDeletion.pop();
-				}
-				else
-				{
-					break;
-				}
-
-				if (PendingDeletion.empty())
-				{
-					break;
-				}
-			}
-		}
-	}
+static D3D12_UNORDERED_ACCESS_VIEW_DESC GetNullUavDesc()
+{
+	D3D12_UNORDERED_ACCESS_VIEW_DESC nullUavDesc = {};
+	nullUavDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	nullUavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
 
-	Dx12DescriptorHeap AccquireHeap()
-	{
-		auto lock = std::scoped_lock(Mutex);
+	return nullUavDesc;
+}
 
-		Dx12DescriptorHeap heap = {};
+static SrvUavDescriptorHeap& GetSrvUavHeap()
+{
+	std::call_once(g_SrvUavHeap.Init, []
+	{
+		D3D12_DESCRIPTOR_HEAP_DESC desc = {};
+		desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+		desc.NumDescriptors = TransientSrvCount + PersistentSrvUavCount;
+		desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+		desc.NodeMask = 0;
 
-		if (!FreeHeaps.empty())
+		if (!DXENSURE(g_render.DxDevice->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&g_SrvUavHeap.DxHeap))))
 		{
-			heap = std::move(FreeHeaps.back());
-			FreeHeaps.pop_back();
-		}
-		else
-		{
-			heap = CreateHeap();
+			assert(0 && "GetSrvUavHeap : CreateDescriptorHeap failed");
+			return;
 		}
 
-		return heap;
-	}
+		g_SrvUavHeap.DescriptorHandleIncrement = g_render.DxDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 
-	void HeapChanged()
-	{
-		auto lock = std::scoped_lock(Mutex);
+		const D3D12_SHADER_RESOURCE_VIEW_DESC nullSrvDesc = GetNullSrvDesc();
 
-		FreeHeaps.clear();
+		D3D12_CPU_DESCRIPTOR_HANDLE handle = g_SrvUavHeap.DxHeap->GetCPUDescriptorHandleForHeapStart();
 
-		while(!InFlightHeaps.empty())
+		for (UINT i = 0; i < TransientSrvCount; i++)
 		{
-			PendingDeletion.emplace(std::move(InFlightHeaps.front()));
-			InFlightHeaps.pop();
-		}
-	}
-
-	void SubmitHeap(Dx12DescriptorHeap&& heap, uint64_t graphicsFenceValue, uint64_t computeFenceValue)
-	{
-		auto lock = std::scoped_lock(Mutex);
+			g_render.DxDevice->CreateShaderResourceView(nullptr, &nullSrvDesc, handle);
 
-		heap.DirectFenceValue = graphicsFenceValue;
-		heap.ComputeFenceValue = computeFenceValue;
+			handle.ptr += g_SrvUavHeap.DescriptorHandleIncrement;
+		}
+	});
 
-		InFlightHeaps.emplace(std::move(heap));
-	}
-};
+	return g_SrvUavHeap;
+}
 
-struct SrvUavDescriptorHeaps : public DescriptorHeaps
+static D3D12_CPU_DESCRIPTOR_HANDLE GetSrvUavCpuHandle(UINT index)
 {
-	virtual Dx12DescriptorHeap CreateHeap() override
-	{
-		Dx12DescriptorHeap heap = {};
+	SrvUavDescriptorHeap& heap = GetSrvUavHeap();
 
-		auto lock = g_SrvUavDescriptors.ReadScopeLock(); // Lock here so size stays consistent between NumDescriptors and during the loop
+	D3D12_CPU_DESCRIPTOR_HANDLE handle = heap.DxHeap->GetCPUDescriptorHandleForHeapStart();
+	handle.ptr += (size_t)index * heap.DescriptorHandleIncrement;
 
-		D3D12_DESCRIPTOR_HEAP_DESC desc = {};
-		desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-		desc.NumDescriptors = (UINT)g_SrvUavDescriptors.Size();
-		desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-		desc.NodeMask = 0;
+	return handle;
+}
 
-		if (!DXENSURE(g_render.DxDevice->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&heap.DxHeap))))
-		{
-			assert(0 && "SrvUavDescriptorHeaps : CreateHeap failed");
+static void WriteSrvUavDescriptor(const SRVUAVDescriptor& descriptor)
+{
+	const D3D12_CPU_DESCRIPTOR_HANDLE handle = GetSrvUavCpuHandle(TransientSrvCount + descriptor.Slot);
 
-			return {};
-		}
+	if (descriptor.Type == DescriptorType::SRV)
+	{
+		const D3D12_SHADER_RESOURCE_VIEW_DESC nullSrvDesc = GetNullSrvDesc();
+		g_render.DxDevice->CreateShaderResourceView(descriptor.Resource, descriptor.Resource ? &descriptor.SrvDesc : &nullSrvDesc, handle);
+	}
+	else if (descriptor.Type == DescriptorType::UAV)
+	{
+		const D3D12_UNORDERED_ACCESS_VIEW_DESC nullUavDesc = GetNullUavDesc();
+		g_render.DxDevice->CreateUnorderedAccessView(descriptor.Resource, nullptr, descriptor.Resource ? &descriptor.UavDesc : &nullUavDesc, handle);
+	}
+}
 
-		DescriptorHandleIncrement = g_render.DxDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+static SRVUAV_t CreateSrvUavDescriptor(SRVUAVDescriptor& descriptor)
+{
+	if (!GetSrvUavHeap().Slots.Alloc(descriptor.Slot))
+	{
+		assert(0 && "CreateSrvUavDescriptor out of srv/uav descriptors");
+		return SRVUAV_t::INVALID;
+	}
 
-		D3D12_CPU_DESCRIPTOR_HANDLE handle = heap.DxHeap->GetCPUDescriptorHandleForHeapStart();
+	WriteSrvUavDescriptor(descriptor);
 
-		D3D12_SHADER_RESOURCE_VIEW_DESC nullSrvDesc = {};
-		nullSrvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
-		nullSrvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-		nullSrvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	return g_SrvUavDescriptors.Create(descriptor);
+}
 
-		D3D12_UNORDERED_ACCESS_VIEW_DESC nullUavDesc = {};
-		nullUavDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-		nullUavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
+// The slot is only reused once the gpu is done with every frame that could still read it.
+static void ReleaseSrvUavDescriptor(SRVUAV_t handle)
+{
+	uint32_t slot = 0u;
+	bool valid = false;
 
-		g_SrvUavDescriptors.ForEachNullIfValid([&](SRVUAVDescriptor* descriptor) 
-		{
-			if (!descriptor)
-			{
-				g_render.DxDevice->CreateShaderResourceView(nullptr, &nullSrvDesc, handle);
-			}
-			else
-			{
-				if (descriptor->Type == DescriptorType::SRV)
-				{
-					g_render.DxDevice->CreateShaderResourceView(descriptor->Resource, descriptor->Resource ? &descriptor->SrvDesc : &nullSrvDesc, handle);
-				}
-				else if (descriptor->Type == DescriptorType::UAV)
-				{
-					g_render.DxDevice->CreateUnorderedAccessView(descriptor->Resource, nullptr, descriptor->Resource ? &descriptor->UavDesc : &nullUavDesc, handle);
-				}
-			}
+	{
+		auto lock = g_SrvUavDescriptors.ReadScopeLock();
 
-			handle.ptr += DescriptorHandleIncrement;
-		});
+		if (const SRVUAVDescriptor* descriptor = g_SrvUavDescriptors.Get(handle))
+		{
+			slot = descriptor->Slot;
+			valid = true;
+		}
+	}
 
-		return heap;
+	if (g_SrvUavDescriptors.Release(handle) && valid)
+	{
+		g_SrvUavHeap.Slots.Free(slot);
 	}
-};
+}
 
-struct RtvDescriptorHeap : public DescriptorHeaps
+static uint32_t GetSrvUavDescriptorIndex(SRVUAV_t handle)
 {
-	virtual Dx12DescriptorHeap CreateHeap() override
-	{
-		Dx12DescriptorHeap heap = {};
+	auto lock = g_SrvUavDescriptors.ReadScopeLock();
 
-		D3D12_DESCRIPTOR_HEAP_DESC desc = {};
-		desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
-		desc.NumDescriptors = (UINT)g_RtvDescriptors.Size();
-		desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
-		desc.NodeMask = 0;
+	const SRVUAVDescriptor* descriptor = g_SrvUavDescriptors.Get(handle);
 
-		if (!DXENSURE(g_render.DxDevice->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&heap.DxHeap))))
-		{
-			assert(0 && "RtvDescriptorHeap : CreateHeap failed");
+	return descriptor ? TransientSrvCount + descriptor->Slot : 0u;
+}
 
-			return {};
-		}
+// Cpu only descriptors for render target and depth views.
+struct Dx12CpuDescriptorPool
+{
+	static constexpr uint32_t BlockSize = 256u;
 
-		DescriptorHandleIncrement = g_render.DxDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+	D3D12_DESCRIPTOR_HEAP_TYPE Type;
+	UINT DescriptorHandleIncrement = 0u;
 
-		D3D12_CPU_DESCRIPTOR_HANDLE handle = heap.DxHeap->GetCPUDescriptorHandleForHeapStart();
+	CpuDescriptorPool<ComPtr<ID3D12DescriptorHeap>, BlockSize> Slots;
 
-		D3D12_RENDER_TARGET_VIEW_DESC nullDesc = {};
-		nullDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
-		nullDesc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2D;
+	explicit Dx12CpuDescriptorPool(D3D12_DESCRIPTOR_HEAP_TYPE type) : Type(type) {}
 
-		for(const RTVDescriptor& descriptor : g_RtvDescriptors)
+	bool Alloc(uint32_t& outSlot)
+	{
+		return Slots.Alloc([this](ComPtr<ID3D12DescriptorHeap>& outHeap)
 		{
-			g_render.DxDevice->CreateRenderTargetView(descriptor.Resource, descriptor.Resource ? &descriptor.RtvDesc : &nullDesc, handle);
+			D3D12_DESCRIPTOR_HEAP_DESC desc = {};
+			desc.Type = Type;
+			desc.NumDescriptors = BlockSize;
+			desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+			desc.NodeMask = 0;
 
-			handle.ptr += DescriptorHandleIncrement;
-		}
+			if (!DXENSURE(g_render.DxDevice->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&outHeap))))
+			{
+				assert(0 && "Dx12CpuDescriptorPool : CreateDescriptorHeap failed");
+				return false;
+			}
 
-		return heap;
+			DescriptorHandleIncrement = g_render.DxDevice->GetDescriptorHandleIncrementSize(Type);
+
+			return true;
+		}, outSlot);
 	}
-};
 
-struct DsvDescriptorHeap : public DescriptorHeaps
-{
-	virtual Dx12DescriptorHeap CreateHeap() override
+	void Free(uint32_t slot)
 	{
-		Dx12DescriptorHeap heap = {};
-
-		D3D12_DESCRIPTOR_HEAP_DESC desc = {};
-		desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_DSV;
-		desc.NumDescriptors = (UINT)g_DsvDescriptors.Size();
-		desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
-		desc.NodeMask = 0;
+		Slots.Free(slot);
+	}
 
-		if (!DXENSURE(g_render.DxDevice->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&heap.DxHeap))))
+	D3D12_CPU_DESCRIPTOR_HANDLE GetHandle(uint32_t slot)
+	{
+		return Slots.WithSlot(slot, [this](const ComPtr<ID3D12DescriptorHeap>& heap, uint32_t index)
 		{
-			assert(0 && "DsvDescriptorHeap : CreateHeap failed");
-
-			return {};
-		}
-
-		DescriptorHandleIncrement = g_render.DxDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
+			D3D12_CPU_DESCRIPTOR_HANDLE handle = heap->GetCPUDescriptorHandleForHeapStart();
+			handle.ptr += (size_t)index * DescriptorHandleIncrement;
 
-		D3D12_CPU_DESCRIPTOR_HANDLE handle = heap.DxHeap->GetCPUDescriptorHandleForHeapStart();
+			return handle;
+		});
+	}
+};
 
-		D3D12_DEPTH_STENCIL_VIEW_DESC nullDesc = {};
-		nullDesc.Format = DXGI_FORMAT_D16_UNORM;
-		nullDesc.ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2D;
+Dx12CpuDescriptorPool g_RtvPool{ D3D12_DESCRIPTOR_HEAP_TYPE_RTV };
+Dx12CpuDescriptorPool g_DsvPool{ D3D12_DESCRIPTOR_HEAP_TYPE_DSV };
 
-		for(const DSVDescriptor& descriptor : g_DsvDescriptors)
-		{
-			g_render.DxDevice->CreateDepthStencilView(descriptor.Resource, descriptor.Resource ? &descriptor.DsvDesc : &nullDesc, handle);
+static void WriteRtvDescriptor(const RTVDescriptor& descriptor)
+{
+	D3D12_RENDER_TARGET_VIEW_DESC nullDesc = {};
+	nullDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+	nullDesc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2D;
 
-			handle.ptr += DescriptorHandleIncrement;
-		}
+	g_render.DxDevice->CreateRenderTargetView(descriptor.Resource, descriptor.Resource ? &descriptor.RtvDesc : &nullDesc, g_RtvPool.GetHandle(descriptor.Slot));
+}
 
-		return heap;
-	}
-};
+static void WriteDsvDescriptor(const DSVDescriptor& descriptor)
+{
+	D3D12_DEPTH_STENCIL_VIEW_DESC nullDesc = {};
+	nullDesc.Format = DXGI_FORMAT_D16_UNORM;
+	nullDesc.ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2D;
 
-SrvUavDescriptorHeaps g_SrvUavHeap;
-RtvDescriptorHeap g_RtvHeap;
-DsvDescriptorHeap g_DsvHeap;
+	g_render.DxDevice->CreateDepthStencilView(descriptor.Resource, descriptor.Resource ? &descriptor.DsvDesc : &nullDesc, g_DsvPool.GetHandle(descriptor.Slot));
+}
 
 SparseArray<SRVUAV_t, ShaderResourceView_t> g_SrvDescriptorRemap;
 SparseArray<SRVUAV_t, UnorderedAccessView_t> g_UavDescriptorRemap;
 std::shared_mutex g_SrvUavRemapMutex;
 
-bool CreateTextureSRVImpl(ShaderResourceView_t srv, Texture_t tex, RenderFormat format, TextureDimension dim, uint32_t mipLevels, uint32_t depthOrArraySize)
+bool CreateTextureSRVImpl(ShaderResourceView_t srv, Texture_t tex, RenderFormat format, TextureDimension dim, const TextureViewRange& range)
 {
 	SRVUAVDescriptor descriptor = {};
 
@@ -304,57 +296,58 @@ bool CreateTextureSRVImpl(ShaderResourceView_t srv, Texture_t tex, RenderFormat
 	if (dim == TextureDimension::TEX1D)
 	{
 		descriptor.SrvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE1D;
-		descriptor.SrvDesc.Texture1D.MostDetailedMip = 0u;
-		descriptor.SrvDesc.Texture1D.MipLevels = mipLevels;
+		descriptor.SrvDesc.Texture1D.MostDetailedMip = range.FirstMip;
+		descriptor.SrvDesc.Texture1D.MipLevels = range.MipLevels;
 		descriptor.SrvDesc.Texture1D.ResourceMinLODClamp = 0.0f;
 	}
 	else if (dim == TextureDimension::TEX1D_ARRAY)
 	{
 		descriptor.SrvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE1DARRAY;
-		descriptor.SrvDesc.Texture1DArray.MostDetailedMip = 0u;
-		descriptor.SrvDesc.Texture1DArray.MipLevels = mipLevels;
-		descriptor.SrvDesc.Texture1DArray.ArraySize = depthOrArraySize;
+		descriptor.SrvDesc.Texture1DArray.MostDetailedMip = range.FirstMip;
+		descriptor.SrvDesc.Texture1DArray.MipLevels = range.MipLevels;
+		descriptor.SrvDesc.Texture1DArray.FirstArraySlice = range.FirstSlice;
+		descriptor.SrvDesc.Texture1DArray.ArraySize = range.SliceCount;
 		descriptor.SrvDesc.Texture1DArray.ResourceMinLODClamp = 0.0f;
 	}
 	else if (dim == TextureDimension::TEX2D)
 	{
 		descriptor.SrvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-		descriptor.SrvDesc.Texture2D.MostDetailedMip = 0u;
-		descriptor.SrvDesc.Texture2D.MipLevels = mipLevels;
+		descriptor.SrvDesc.Texture2D.MostDetailedMip = range.FirstMip;
+		descriptor.SrvDesc.Texture2D.MipLevels = range.MipLevels;
 		descriptor.SrvDesc.Texture2D.PlaneSlice = 0u;
 		descriptor.SrvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
 	}
 	else if (dim == TextureDimension::TEX2D_ARRAY)
 	{
 		descriptor.SrvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2DARRAY;
-		descriptor.SrvDesc.Texture2DArray.MostDetailedMip = 0u;
-		descriptor.SrvDesc.Texture2DArray.MipLevels = mipLevels;
-		descriptor.SrvDesc.Texture2DArray.FirstArraySlice = 0u;
-		descriptor.SrvDesc.Texture2DArray.ArraySize = depthOrArraySize;
+		descriptor.SrvDesc.Texture2DArray.MostDetailedMip = range.FirstMip;
+		descriptor.SrvDesc.Texture2DArray.MipLevels = range.MipLevels;
+		descriptor.SrvDesc.Texture2DArray.FirstArraySlice = range.FirstSlice;
+		descriptor.SrvDesc.Texture2DArray.ArraySize = range.SliceCount;
 		descriptor.SrvDesc.Texture2DArray.PlaneSlice = 0u;
 		descriptor.SrvDesc.Texture2DArray.ResourceMinLODClamp = 0.0f;
 	}
 	else if (dim == TextureDimension::CUBEMAP)
 	{
 		descriptor.SrvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
-		descriptor.SrvDesc.TextureCube.MostDetailedMip = 0u;
-		descriptor.SrvDesc.TextureCube.MipLevels = mipLevels;
+		descriptor.SrvDesc.TextureCube.MostDetailedMip = range.FirstMip;
+		descriptor.SrvDesc.TextureCube.MipLevels = range.MipLevels;
 		descriptor.SrvDesc.TextureCube.ResourceMinLODClamp = 0.0f;
 	}
 	else if (dim == TextureDimension::CUBEMAP_ARRAY)
 	{
 		descriptor.SrvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBEARRAY;
-		descriptor.SrvDesc.TextureCubeArray.MostDetailedMip = 0u;
-		descriptor.SrvDesc.TextureCubeArray.MipLevels = mipLevels;
-		descriptor.SrvDesc.TextureCubeArray.First2DArrayFace = 0u;
-		descriptor.SrvDesc.TextureCubeArray.NumCubes = depthOrArraySize;
+		descriptor.SrvDesc.TextureCubeArray.MostDetailedMip = range.FirstMip;
+		descriptor.SrvDesc.TextureCubeArray.MipLevels = range.MipLevels;
+		descriptor.SrvDesc.TextureCubeArray.First2DArrayFace = range.FirstSlice;
+		descriptor.SrvDesc.TextureCubeArray.NumCubes = range.SliceCount / 6u;
 		descriptor.SrvDesc.TextureCubeArray.ResourceMinLODClamp = 0.0f;
 	}
 	else if (dim == TextureDimension::TEX3D)
 	{
 		descriptor.SrvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE3D;
-		descriptor.SrvDesc.Texture3D.MostDetailedMip = 0u;
-		descriptor.SrvDesc.Texture3D.MipLevels = mipLevels;
+		descriptor.SrvDesc.Texture3D.MostDetailedMip = range.FirstMip;
+		descriptor.SrvDesc.Texture3D.MipLevels = range.MipLevels;
 		descriptor.SrvDesc.Texture3D.ResourceMinLODClamp = 0.0f;
 	}
 	else
@@ -362,7 +355,11 @@ bool CreateTextureSRVImpl(ShaderResourceView_t srv, Texture_t tex, RenderFormat
 		return false;
 	}
 
-	SRVUAV_t heapHandle = g_SrvUavDescriptors.Create(descriptor);
+	SRVUAV_t heapHandle = CreateSrvUavDescriptor(descriptor);
+	if (heapHandle == SRVUAV_t::INVALID)
+	{
+		return false;
+	}
 
 	{
 		auto lock = std::unique_lock(g_SrvUavRemapMutex);
@@ -370,12 +367,10 @@ bool CreateTextureSRVImpl(ShaderResourceView_t srv, Texture_t tex, RenderFormat
 		g_SrvDescriptorRemap.AllocCopy(srv, heapHandle);
 	}	
 
-	g_SrvUavHeap.HeapChanged();
-
 	return true;
 }
 
-bool CreateTextureUAVImpl(UnorderedAccessView_t uav, Texture_t tex, RenderFormat format, TextureDimension dim, uint32_t depthOrArraySize)
+bool CreateTextureUAVImpl(UnorderedAccessView_t uav, Texture_t tex, RenderFormat format, TextureDimension dim, const TextureViewRange& range)
 {
 	SRVUAVDescriptor descriptor = {};
 
@@ -386,58 +381,62 @@ bool CreateTextureUAVImpl(UnorderedAccessView_t uav, Texture_t tex, RenderFormat
 	if (dim == TextureDimension::TEX1D)
 	{
 		descriptor.UavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE1D;
-		descriptor.UavDesc.Texture1D.MipSlice = 0u;
+		descriptor.UavDesc.Texture1D.MipSlice = range.FirstMip;
 	}
 	else if (dim == TextureDimension::TEX1D_ARRAY)
 	{
 		descriptor.UavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE1DARRAY;
-		descriptor.UavDesc.Texture1DArray.MipSlice = 0u;
-		descriptor.UavDesc.Texture1DArray.FirstArraySlice = 0u;
-		descriptor.UavDesc.Texture1DArray.ArraySize = depthOrArraySize;		
+		descriptor.UavDesc.Texture1DArray.MipSlice = range.FirstMip;
+		descriptor.UavDesc.Texture1DArray.FirstArraySlice = range.FirstSlice;
+		descriptor.UavDesc.Texture1DArray.ArraySize = range.SliceCount;		
 	}
 	else if (dim == TextureDimension::TEX2D)
 	{
 		descriptor.UavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
-		descriptor.UavDesc.Texture2D.MipSlice = 0u;
+		descriptor.UavDesc.Texture2D.MipSlice = range.FirstMip;
 		descriptor.UavDesc.Texture2D.PlaneSlice = 0u;
 	}
 	else if (dim == TextureDimension::TEX2D_ARRAY)
 	{
 		descriptor.UavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2DARRAY;
-		descriptor.UavDesc.Texture2DArray.MipSlice = 0u;
-		descriptor.UavDesc.Texture2DArray.FirstArraySlice = 0u;
-		descriptor.UavDesc.Texture2DArray.ArraySize = depthOrArraySize;
+		descriptor.UavDesc.Texture2DArray.MipSlice = range.FirstMip;
+		descriptor.UavDesc.Texture2DArray.FirstArraySlice = range.FirstSlice;
+		descriptor.UavDesc.Texture2DArray.ArraySize = range.SliceCount;
 		descriptor.UavDesc.Texture2DArray.PlaneSlice = 0u;
 	}
 	else if (dim == TextureDimension::CUBEMAP)
 	{
 		descriptor.UavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2DARRAY;
-		descriptor.UavDesc.Texture2DArray.MipSlice = 0u;
-		descriptor.UavDesc.Texture2DArray.FirstArraySlice = 0u;
-		descriptor.UavDesc.Texture2DArray.ArraySize = 6u;
+		descriptor.UavDesc.Texture2DArray.MipSlice = range.FirstMip;
+		descriptor.UavDesc.Texture2DArray.FirstArraySlice = range.FirstSlice;
+		descriptor.UavDesc.Texture2DArray.ArraySize = range.SliceCount;
 		descriptor.UavDesc.Texture2DArray.PlaneSlice = 0u;
 	}
 	else if (dim == TextureDimension::CUBEMAP_ARRAY)
 	{
 		descriptor.UavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2DARRAY;
-		descriptor.UavDesc.Texture2DArray.MipSlice = 0u;
-		descriptor.UavDesc.Texture2DArray.FirstArraySlice = 0u;
-		descriptor.UavDesc.Texture2DArray.ArraySize = 6u * depthOrArraySize;
+		descriptor.UavDesc.Texture2DArray.MipSlice = range.FirstMip;
+		descriptor.UavDesc.Texture2DArray.FirstArraySlice = range.FirstSlice;
+		descriptor.UavDesc.Texture2DArray.ArraySize = range.SliceCount;
 		descriptor.UavDesc.Texture2DArray.PlaneSlice = 0u;
 	}
 	else if (dim == TextureDimension::TEX3D)
 	{
 		descriptor.UavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE3D;
-		descriptor.UavDesc.Texture3D.MipSlice = 0u;
-		descriptor.UavDesc.Texture3D.FirstWSlice = 0u;
-		descriptor.UavDesc.Texture3D.WSize = -1;
+		descriptor.UavDesc.Texture3D.MipSlice = range.FirstMip;
+		descriptor.UavDesc.Texture3D.FirstWSlice = range.FirstSlice;
+		descriptor.UavDesc.Texture3D.WSize = range.SliceCount;
 	}
 	else
 	{
 		return false;
 	}
 
-	SRVUAV_t heapHandle = g_SrvUavDescriptors.Create(descriptor);
+	SRVUAV_t heapHandle = CreateSrvUavDescriptor(descriptor);
+	if (heapHandle == SRVUAV_t::INVALID)
+	{
+		return false;
+	}
 
 	{
 		auto lock = std::unique_lock(g_SrvUavRemapMutex);
@@ -445,12 +444,10 @@ bool CreateTextureUAVImpl(UnorderedAccessView_t uav, Texture_t tex, RenderFormat
 		g_UavDescriptorRemap.AllocCopy(uav, heapHandle);
 	}	
 
-	g_SrvUavHeap.HeapChanged();
-
 	return true;
 }
 
-bool CreateTextureRTVImpl(RenderTargetView_t rtv, Texture_t tex, RenderFormat format, TextureDimension dim, uint32_t depthOrArraySize)
+bool CreateTextureRTVImpl(RenderTargetView_t rtv, Texture_t tex, RenderFormat format, TextureDimension dim, const TextureViewRange& range)
 {
 	RTVDescriptor descriptor = {};
 
@@ -461,69 +458,74 @@ bool CreateTextureRTVImpl(RenderTargetView_t rtv, Texture_t tex, RenderFormat fo
 	if (dim == TextureDimension::TEX1D)
 	{
 		descriptor.RtvDesc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE1D;
-		descriptor.RtvDesc.Texture1D.MipSlice = 0u;
+		descriptor.RtvDesc.Texture1D.MipSlice = range.FirstMip;
 	}
 	else if (dim == TextureDimension::TEX1D_ARRAY)
 	{
 		descriptor.RtvDesc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE1DARRAY;
-		descriptor.RtvDesc.Texture1DArray.MipSlice = 0u;
-		descriptor.RtvDesc.Texture1DArray.FirstArraySlice = 0u;
-		descriptor.RtvDesc.Texture1DArray.ArraySize = depthOrArraySize;
+		descriptor.RtvDesc.Texture1DArray.MipSlice = range.FirstMip;
+		descriptor.RtvDesc.Texture1DArray.FirstArraySlice = range.FirstSlice;
+		descriptor.RtvDesc.Texture1DArray.ArraySize = range.SliceCount;
 	}
 	else if (dim == TextureDimension::TEX2D)
 	{
 		descriptor.RtvDesc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2D;
-		descriptor.RtvDesc.Texture2D.MipSlice = 0u;
+		descriptor.RtvDesc.Texture2D.MipSlice = range.FirstMip;
 		descriptor.RtvDesc.Texture2D.PlaneSlice = 0u;
 	}
 	else if (dim == TextureDimension::TEX2D_ARRAY)
 	{
 		descriptor.RtvDesc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2DARRAY;
-		descriptor.RtvDesc.Texture2DArray.MipSlice = 0u;
-		descriptor.RtvDesc.Texture2DArray.FirstArraySlice = 0u;
-		descriptor.RtvDesc.Texture2DArray.ArraySize = depthOrArraySize;
+		descriptor.RtvDesc.Texture2DArray.MipSlice = range.FirstMip;
+		descriptor.RtvDesc.Texture2DArray.FirstArraySlice = range.FirstSlice;
+		descriptor.RtvDesc.Texture2DArray.ArraySize = range.SliceCount;
 		descriptor.RtvDesc.Texture2DArray.PlaneSlice = 0u;
 	}
 	else if (dim == TextureDimension::CUBEMAP)
 	{
 		descriptor.RtvDesc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2DARRAY;
-		descriptor.RtvDesc.Texture2DArray.MipSlice = 0u;
-		descriptor.RtvDesc.Texture2DArray.FirstArraySlice = 0u;
-		descriptor.RtvDesc.Texture2DArray.ArraySize = 6u;
+		descriptor.RtvDesc.Texture2DArray.MipSlice = range.FirstMip;
+		descriptor.RtvDesc.Texture2DArray.FirstArraySlice = range.FirstSlice;
+		descriptor.RtvDesc.Texture2DArray.ArraySize = range.SliceCount;
 		descriptor.RtvDesc.Texture2DArray.PlaneSlice = 0u;
 	}
 	else if (dim == TextureDimension::CUBEMAP_ARRAY)
 	{
 		descriptor.RtvDesc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2DARRAY;
-		descriptor.RtvDesc.Texture2DArray.MipSlice = 0u;
-		descriptor.RtvDesc.Texture2DArray.FirstArraySlice = 0u;
-		descriptor.RtvDesc.Texture2DArray.ArraySize = 6u * depthOrArraySize;
+		descriptor.RtvDesc.Texture2DArray.MipSlice = range.FirstMip;
+		descriptor.RtvDesc.Texture2DArray.FirstArraySlice = range.FirstSlice;
+		descriptor.RtvDesc.Texture2DArray.ArraySize = range.SliceCount;
 		descriptor.RtvDesc.Texture2DArray.PlaneSlice = 0u;
 	}
 	else if (dim == TextureDimension::TEX3D)
 	{
 		descriptor.RtvDesc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE3D;
-		descriptor.RtvDesc.Texture3D.MipSlice = 0u;
-		descriptor.RtvDesc.Texture3D.FirstWSlice = 0u;
-		descriptor.RtvDesc.Texture3D.WSize = -1;
+		descriptor.RtvDesc.Texture3D.MipSlice = range.FirstMip;
+		descriptor.RtvDesc.Texture3D.FirstWSlice = range.FirstSlice;
+		descriptor.RtvDesc.Texture3D.WSize = range.SliceCount;
 	}
 	else
 	{
 		return false;
 	}
 
+	if (!g_RtvPool.Alloc(descriptor.Slot))
+	{
+		return false;
+	}
+
+	WriteRtvDescriptor(descriptor);
+
 	{
 		auto lock = std::unique_lock(g_RtvMutex);
 
 		g_RtvDescriptors.AllocCopy(rtv, descriptor);
 	}	
 
-	g_RtvHeap.HeapChanged();
-
 	return true;
 }
 
-bool CreateTextureDSVImpl(DepthStencilView_t dsv, Texture_t tex, RenderFormat format, TextureDimension dim, uint32_t depthOrArraySize)
+bool CreateTextureDSVImpl(DepthStencilView_t dsv, Texture_t tex, RenderFormat format, TextureDimension dim, const TextureViewRange& range)
 {
 	DSVDescriptor descriptor = {};
 
@@ -534,54 +536,58 @@ bool CreateTextureDSVImpl(DepthStencilView_t dsv, Texture_t tex, RenderFormat fo
 	if (dim == TextureDimension::TEX1D)
 	{
 		descriptor.DsvDesc.ViewDimension = D3D12_DSV_DIMENSION_TEXTURE1D;
-		descriptor.DsvDesc.Texture1D.MipSlice = 0u;
+		descriptor.DsvDesc.Texture1D.MipSlice = range.FirstMip;
 	}
 	else if (dim == TextureDimension::TEX1D_ARRAY)
 	{
 		descriptor.DsvDesc.ViewDimension = D3D12_DSV_DIMENSION_TEXTURE1DARRAY;
-		descriptor.DsvDesc.Texture1DArray.MipSlice = 0u;
-		descriptor.DsvDesc.Texture1DArray.FirstArraySlice = 0u;
-		descriptor.DsvDesc.Texture1DArray.ArraySize = depthOrArraySize;
+		descriptor.DsvDesc.Texture1DArray.MipSlice = range.FirstMip;
+		descriptor.DsvDesc.Texture1DArray.FirstArraySlice = range.FirstSlice;
+		descriptor.DsvDesc.Texture1DArray.ArraySize = range.SliceCount;
 	}
 	else if (dim == TextureDimension::TEX2D)
 	{
 		descriptor.DsvDesc.ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2D;
-		descriptor.DsvDesc.Texture2D.MipSlice = 0u;
+		descriptor.DsvDesc.Texture2D.MipSlice = range.FirstMip;
 	}
 	else if (dim == TextureDimension::TEX2D_ARRAY)
 	{
 		descriptor.DsvDesc.ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2DARRAY;
-		descriptor.DsvDesc.Texture2DArray.MipSlice = 0u;
-		descriptor.DsvDesc.Texture2DArray.FirstArraySlice = 0u;
-		descriptor.DsvDesc.Texture2DArray.ArraySize = depthOrArraySize;
+		descriptor.DsvDesc.Texture2DArray.MipSlice = range.FirstMip;
+		descriptor.DsvDesc.Texture2DArray.FirstArraySlice = range.FirstSlice;
+		descriptor.DsvDesc.Texture2DArray.ArraySize = range.SliceCount;
 	}
 	else if (dim == TextureDimension::CUBEMAP)
 	{
 		descriptor.DsvDesc.ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2DARRAY;
-		descriptor.DsvDesc.Texture2DArray.MipSlice = 0u;
-		descriptor.DsvDesc.Texture2DArray.FirstArraySlice = 0u;
-		descriptor.DsvDesc.Texture2DArray.ArraySize = 6u;
+		descriptor.DsvDesc.Texture2DArray.MipSlice = range.FirstMip;
+		descriptor.DsvDesc.Texture2DArray.FirstArraySlice = range.FirstSlice;
+		descriptor.DsvDesc.Texture2DArray.ArraySize = range.SliceCount;
 	}
 	else if (dim == TextureDimension::CUBEMAP_ARRAY)
 	{
 		descriptor.DsvDesc.ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2DARRAY;
-		descriptor.DsvDesc.Texture2DArray.MipSlice = 0u;
-		descriptor.DsvDesc.Texture2DArray.FirstArraySlice = 0u;
-		descriptor.DsvDesc.Texture2DArray.ArraySize = 6u * depthOrArraySize;
+		descriptor.DsvDesc.Texture2DArray.MipSlice = range.FirstMip;
+		descriptor.DsvDesc.Texture2DArray.FirstArraySlice = range.FirstSlice;
+		descriptor.DsvDesc.Texture2DArray.ArraySize = range.SliceCount;
 	}
 	else
 	{
 		return false;
 	}
 
+	if (!g_DsvPool.Alloc(descriptor.Slot))
+	{
+		return false;
+	}
+
+	WriteDsvDescriptor(descriptor);
+
 	{
 		auto lock = std::unique_lock(g_DsvMutex);
 
 		g_DsvDescriptors.AllocCopy(dsv, descriptor);
 	}
-	
-
-	g_DsvHeap.HeapChanged();
 
 	return true;
 }
@@ -593,10 +599,21 @@ void BindTextureSrvUavImpl(SRVUAV_t handle, Texture_t tex)
 
 		SRVUAVDescriptor* descriptor = g_SrvUavDescriptors.Get(handle);
 
+		// Work in flight may still read the old descriptor, so the view moves to a new slot and the old one is retired
+		uint32_t slot = 0u;
+		if (!g_SrvUavHeap.Slots.Alloc(slot))
+		{
+			assert(0 && "BindTextureSrvUavImpl out of srv/uav descriptors");
+			return;
+		}
+
+		g_SrvUavHeap.Slots.Free(descriptor->Slot);
+
+		descriptor->Slot = slot;
 		descriptor->Resource = Dx12_GetTextureResource(tex);
-	}
 
-	g_SrvUavHeap.HeapChanged();
+		WriteSrvUavDescriptor(*descriptor);
+	}
 }
 
 void BindTextureSRVImpl(ShaderResourceView_t srv, Texture_t tex)
@@ -621,9 +638,9 @@ void BindTextureRTVImpl(RenderTargetView_t rtv, Texture_t tex)
 		RTVDescriptor& descriptor = g_RtvDescriptors[rtv];
 
 		descriptor.Resource = Dx12_GetTextureResource(tex);
-	}
 
-	g_RtvHeap.HeapChanged();
+		WriteRtvDescriptor(descriptor);
+	}
 }
 
 void BindTextureDSVImpl(DepthStencilView_t dsv, Texture_t tex)
@@ -634,18 +651,18 @@ void BindTextureDSVImpl(DepthStencilView_t dsv, Texture_t tex)
 		DSVDescriptor& descriptor = g_DsvDescriptors[dsv];
 
 		descriptor.Resource = Dx12_GetTextureResource(tex);
-	}
 
-	g_DsvHeap.HeapChanged();
+		WriteDsvDescriptor(descriptor);
+	}
 }
 
 bool CreateStructuredBufferSRVImpl(ShaderResourceView_t srv, StructuredBuffer_t buf, uint32_t firstElement, uint32_t numElements, uint32_t structureByteStride)
 {
 	SRVUAVDescriptor descriptor = {};
 
-	uint32_t bufferOffset = Dx12_GetBufferOffset(buf);
+	uint64_t bufferOffset = Dx12_GetBufferOffset(buf);
 	assert(bufferOffset % structureByteStride == 0);
-	uint32_t sharedBufferFirstElem = bufferOffset / structureByteStride;
+	uint64_t sharedBufferFirstElem = bufferOffset / structureByteStride;
 
 	descriptor.Type = DescriptorType::SRV;
 	descriptor.Resource = Dx12_GetBufferResource(buf);
@@ -657,7 +674,11 @@ bool CreateStructuredBufferSRVImpl(ShaderResourceView_t srv, StructuredBuffer_t
 	descriptor.SrvDesc.Buffer.StructureByteStride = structureByteStride;
 	descriptor.SrvDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_NONE;
 
-	SRVUAV_t heapHandle = g_SrvUavDescriptors.Create(descriptor);
+	SRVUAV_t heapHandle = CreateSrvUavDescriptor(descriptor);
+	if (heapHandle == SRVUAV_t::INVALID)
+	{
+		return false;
+	}
 
 	{
 		auto lock = std::unique_lock(g_SrvUavRemapMutex);
@@ -665,8 +686,6 @@ bool CreateStructuredBufferSRVImpl(ShaderResourceView_t srv, StructuredBuffer_t
 		g_SrvDescriptorRemap.AllocCopy(srv, heapHandle);
 	}
 
-	g_SrvUavHeap.HeapChanged();
-
 	return true;
 }
 
@@ -674,20 +693,26 @@ bool CreateStructuredBufferUAVImpl(UnorderedAccessView_t uav, StructuredBuffer_t
 {
 	SRVUAVDescriptor descriptor = {};
 
-	uint32_t bufferOffset = Dx12_GetBufferOffset(buf);
-	assert(bufferOffset == 0); // Cannot share UAV buffers due to transitioning limitations
+	// Small UAV buffers share a page, so like srvs the view starts at the buffer's offset
+	uint64_t bufferOffset = Dx12_GetBufferOffset(buf);
+	assert(bufferOffset % structureByteStride == 0);
+	uint64_t sharedBufferFirstElem = bufferOffset / structureByteStride;
 
 	descriptor.Type = DescriptorType::UAV;
 	descriptor.Resource = Dx12_GetBufferResource(buf);
 	descriptor.UavDesc.Format = DXGI_FORMAT_UNKNOWN;
 	descriptor.UavDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
-	descriptor.UavDesc.Buffer.FirstElement = firstElement;
+	descriptor.UavDesc.Buffer.FirstElement = sharedBufferFirstElem + firstElement;
 	descriptor.UavDesc.Buffer.NumElements = numElements;
 	descriptor.UavDesc.Buffer.StructureByteStride = structureByteStride;
 	descriptor.UavDesc.Buffer.CounterOffsetInBytes = 0;
 	descriptor.UavDesc.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_NONE;
 
-	SRVUAV_t heapHandle = g_SrvUavDescriptors.Create(descriptor);
+	SRVUAV_t heapHandle = CreateSrvUavDescriptor(descriptor);
+	if (heapHandle == SRVUAV_t::INVALID)
+	{
+		return false;
+	}
 
 	{
 		auto lock = std::unique_lock(g_SrvUavRemapMutex);
@@ -695,103 +720,209 @@ bool CreateStructuredBufferUAVImpl(UnorderedAccessView_t uav, StructuredBuffer_t
 		g_UavDescriptorRemap.AllocCopy(uav, heapHandle);
 	}
 
-	g_SrvUavHeap.HeapChanged();
-
 	return true;
 }
 
-void DestroySRV(ShaderResourceView_t srv)
+bool CreateByteBufferSRVImpl(ShaderResourceView_t srv, StructuredBuffer_t buf, uint32_t firstElement, uint32_t numElements)
 {
+	SRVUAVDescriptor descriptor = {};
+
+	uint64_t bufferOffset = Dx12_GetBufferOffset(buf);
+	assert(bufferOffset % 4u == 0);
+
+	descriptor.Type = DescriptorType::SRV;
+	descriptor.Resource = Dx12_GetBufferResource(buf);
+	descriptor.SrvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	descriptor.SrvDesc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+	descriptor.SrvDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+	descriptor.SrvDesc.Buffer.FirstElement = bufferOffset / 4u + firstElement;
+	descriptor.SrvDesc.Buffer.NumElements = numElements;
+	descriptor.SrvDesc.Buffer.StructureByteStride = 0u;
+	descriptor.SrvDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_RAW;
+
+	SRVUAV_t heapHandle = CreateSrvUavDescriptor(descriptor);
+	if (heapHandle == SRVUAV_t::INVALID)
 	{
-		auto lock = std::unique_lock(g_SrvUavRemapMutex);
+		return false;
+	}
 
-		g_SrvUavDescriptors.Release(g_SrvDescriptorRemap[srv]);
+	{
+		auto lock = std::unique_lock(g_SrvUavRemapMutex);
 
-		g_SrvDescriptorRemap.Free(srv);
+		g_SrvDescriptorRemap.AllocCopy(srv, heapHandle);
 	}
 
-	g_SrvUavHeap.HeapChanged();
+	return true;
 }
 
-void DestroyUAV(UnorderedAccessView_t uav)
+bool CreateByteBufferUAVImpl(UnorderedAccessView_t uav, StructuredBuffer_t buf, uint32_t firstElement, uint32_t numElements)
 {
+	SRVUAVDescriptor descriptor = {};
+
+	uint64_t bufferOffset = Dx12_GetBufferOffset(buf);
+	assert(bufferOffset % 4u == 0);
+
+	descriptor.Type = DescriptorType::UAV;
+	descriptor.Resource = Dx12_GetBufferResource(buf);
+	descriptor.UavDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+	descriptor.UavDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+	descriptor.UavDesc.Buffer.FirstElement = bufferOffset / 4u + firstElement;
+	descriptor.UavDesc.Buffer.NumElements = numElements;
+	descriptor.UavDesc.Buffer.StructureByteStride = 0u;
+	descriptor.UavDesc.Buffer.CounterOffsetInBytes = 0;
+	descriptor.UavDesc.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_RAW;
+
+	SRVUAV_t heapHandle = CreateSrvUavDescriptor(descriptor);
+	if (heapHandle == SRVUAV_t::INVALID)
 	{
-		auto lock = std::unique_lock(g_SrvUavRemapMutex);
+		return false;
+	}
 
-		g_SrvUavDescriptors.Release(g_UavDescriptorRemap[uav]);
+	{
+		auto lock = std::unique_lock(g_SrvUavRemapMutex);
 
-		g_UavDescriptorRemap.Free(uav);
+		g_UavDescriptorRemap.AllocCopy(uav, heapHandle);
 	}
 
-	g_SrvUavHeap.HeapChanged();
+	return true;
 }
 
-void DestroyRTV(RenderTargetView_t rtv)
+static uint32_t CreateTransientSRV(DynamicBuffer_t buf, DXGI_FORMAT format, uint32_t structureByteStride, D3D12_BUFFER_SRV_FLAGS flags)
 {
+	SrvUavDescriptorHeap& heap = GetSrvUavHeap();
+
+	if (!heap.DxHeap)
 	{
-		auto lock = std::unique_lock(g_RtvMutex);
+		return 0u;
+	}
 
-		g_RtvDescriptors.Free(rtv);
-	}	
+	const uint32_t count = heap.TransientCount.fetch_add(1u, std::memory_order_relaxed);
+	if (count >= TransientSrvSegmentSize)
+	{
+		assert(0 && "CreateTransientSRV out of dynamic buffer views this frame");
+		return 0u;
+	}
+
+	const uint32_t index = heap.TransientSegment * TransientSrvSegmentSize + count;
+
+	size_t offset = 0u;
+	ID3D12Resource* resource = Dx12_GetDynamicBufferResource(buf, &offset);
+	const size_t size = Dx12_GetDynamicBufferSize(buf);
+
+	const size_t elementSize = structureByteStride > 0u ? structureByteStride : 4u;
+	assert(offset % elementSize == 0);
+
+	D3D12_SHADER_RESOURCE_VIEW_DESC desc = {};
+	desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	desc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+	desc.Format = format;
+	desc.Buffer.FirstElement = offset / elementSize;
+	desc.Buffer.NumElements = (UINT)(size / elementSize);
+	desc.Buffer.StructureByteStride = structureByteStride;
+	desc.Buffer.Flags = flags;
 
-	g_RtvHeap.HeapChanged();
+	g_render.DxDevice->CreateShaderResourceView(resource, &desc, GetSrvUavCpuHandle(index));
+
+	return index;
 }
 
-void DestroyDSV(DepthStencilView_t dsv)
+uint32_t CreateDynamicStructuredBufferSRVImpl(DynamicBuffer_t buf, uint32_t structureByteStride)
 {
-	{
-		auto lock = std::unique_lock(g_DsvMutex);
+	return CreateTransientSRV(buf, DXGI_FORMAT_UNKNOWN, structureByteStride, D3D12_BUFFER_SRV_FLAG_NONE);
+}
 
-		g_DsvDescriptors.Free(dsv);
-	}	
+uint32_t CreateDynamicByteBufferSRVImpl(DynamicBuffer_t buf)
+{
+	return CreateTransientSRV(buf, DXGI_FORMAT_R32_TYPELESS, 0u, D3D12_BUFFER_SRV_FLAG_RAW);
+}
+
+void Dx12_TransientDescriptorsNewFrame()
+{
+	SrvUavDescriptorHeap& heap = GetSrvUavHeap();
+
+	// Everything the last frame submitted is covered by the values signalled so far
+	heap.TransientGraphicsFences[heap.TransientSegment] = g_render.DirectQueue.FenceValue;
+	heap.TransientComputeFences[heap.TransientSegment] = g_render.ComputeQueue.FenceValue;
 
-	g_DsvHeap.HeapChanged();
+	heap.TransientSegment = (heap.TransientSegment + 1u) % TransientSrvSegmentCount;
+
+	// Only stalls if the cpu is more than a segment ring ahead of the gpu
+	Dx12_Wait(CommandListType::GRAPHICS, heap.TransientGraphicsFences[heap.TransientSegment]);
+	Dx12_Wait(CommandListType::COMPUTE, heap.TransientComputeFences[heap.TransientSegment]);
+
+	heap.TransientCount.store(1u, std::memory_order_relaxed);
 }
 
-void Dx12_DescriptorsBeginFrame()
+void DestroySRV(ShaderResourceView_t srv)
 {
-	g_SrvUavHeap.BeginFrame();
-	g_RtvHeap.BeginFrame();
-	g_DsvHeap.BeginFrame();
+	auto lock = std::unique_lock(g_SrvUavRemapMutex);
+
+	ReleaseSrvUavDescriptor(g_SrvDescriptorRemap[srv]);
+
+	g_SrvDescriptorRemap.Free(srv);
 }
 
-Dx12DescriptorHeap Dx12_AccquireSrvUavHeap()
+void DestroyUAV(UnorderedAccessView_t uav)
 {
-	return g_SrvUavHeap.AccquireHeap();
+	auto lock = std::unique_lock(g_SrvUavRemapMutex);
+
+	ReleaseSrvUavDescriptor(g_UavDescriptorRemap[uav]);
+
+	g_UavDescriptorRemap.Free(uav);
 }
 
-Dx12DescriptorHeap Dx12_AccquireRtvHeap()
+void DestroyRTV(RenderTargetView_t rtv)
 {
-	return g_RtvHeap.AccquireHeap();
+	auto lock = std::unique_lock(g_RtvMutex);
+
+	g_RtvPool.Free(g_RtvDescriptors[rtv].Slot);
+
+	g_RtvDescriptors.Free(rtv);
 }
 
-Dx12DescriptorHeap Dx12_AccquireDsvHeap()
+void DestroyDSV(DepthStencilView_t dsv)
 {
-	return g_DsvHeap.AccquireHeap();
+	auto lock = std::unique_lock(g_DsvMutex);
+
+	g_DsvPool.Free(g_DsvDescriptors[dsv].Slot);
+
+	g_DsvDescriptors.Free(dsv);
 }
 
-D3D12_CPU_DESCRIPTOR_HANDLE Dx12_RtvDescriptorHandle(ID3D12DescriptorHeap* heap, RenderTargetView_t rtv)
+void Dx12_DescriptorsBeginFrame()
 {
-	D3D12_CPU_DESCRIPTOR_HANDLE handle = heap->GetCPUDescriptorHandleForHeapStart();
+	SrvUavDescriptorHeap& heap = GetSrvUavHeap();
+	heap.Slots.EndFrame(g_render.DirectQueue.FenceValue, g_render.ComputeQueue.FenceValue);
+	heap.Slots.Reclaim(g_render.DirectQueue.DxFence->GetCompletedValue(), g_render.ComputeQueue.DxFence->GetCompletedValue());
+}
 
-	handle.ptr += (UINT)rtv * g_RtvHeap.DescriptorHandleIncrement;
+Dx12DescriptorHeap Dx12_AccquireSrvUavHeap()
+{
+	// Every command list shares the persistent heap
+	Dx12DescriptorHeap heap = {};
+	heap.DxHeap = GetSrvUavHeap().DxHeap;
 
-	return handle;
+	return heap;
 }
 
-D3D12_CPU_DESCRIPTOR_HANDLE Dx12_DsvDescriptorHandle(ID3D12DescriptorHeap* heap, DepthStencilView_t dsv)
+D3D12_CPU_DESCRIPTOR_HANDLE Dx12_RtvDescriptorHandle(RenderTargetView_t rtv)
 {
-	D3D12_CPU_DESCRIPTOR_HANDLE handle = heap->GetCPUDescriptorHandleForHeapStart();
+	auto lock = std::shared_lock(g_RtvMutex);
 
-	handle.ptr += (UINT)dsv * g_DsvHeap.DescriptorHandleIncrement;
+	return g_RtvPool.GetHandle(g_RtvDescriptors[rtv].Slot);
+}
 
-	return handle;
+D3D12_CPU_DESCRIPTOR_HANDLE Dx12_DsvDescriptorHandle(DepthStencilView_t dsv)
+{
+	auto lock = std::shared_lock(g_DsvMutex);
+
+	return g_DsvPool.GetHandle(g_DsvDescriptors[dsv].Slot);
 }
 
 D3D12_GPU_VIRTUAL_ADDRESS Dx12_GetSrvAddress(ID3D12DescriptorHeap* heap, ShaderResourceView_t srv)
 {
 	D3D12_GPU_VIRTUAL_ADDRESS ptr = heap->GetGPUDescriptorHandleForHeapStart().ptr;
-	ptr += (UINT)srv * g_SrvUavHeap.DescriptorHandleIncrement;
+	ptr += (UINT64)GetDescriptorIndexImpl(srv) * g_SrvUavHeap.DescriptorHandleIncrement;
 
 	return ptr;
 }
@@ -799,7 +930,7 @@ D3D12_GPU_VIRTUAL_ADDRESS Dx12_GetSrvAddress(ID3D12DescriptorHeap* heap, ShaderR
 D3D12_GPU_VIRTUAL_ADDRESS Dx12_GetUavAddress(ID3D12DescriptorHeap* heap, UnorderedAccessView_t uav)
 {
 	D3D12_GPU_VIRTUAL_ADDRESS ptr = heap->GetGPUDescriptorHandleForHeapStart().ptr;
-	ptr += (UINT)uav * g_SrvUavHeap.DescriptorHandleIncrement;
+	ptr += (UINT64)GetDescriptorIndexImpl(uav) * g_SrvUavHeap.DescriptorHandleIncrement;
 
 	return ptr;
 }
@@ -811,31 +942,24 @@ D3D12_GPU_DESCRIPTOR_HANDLE Dx12_GetSrvUavTableHandle(ID3D12DescriptorHeap* heap
 
 void Dx12_SubmitSrvUavDescriptorHeap(Dx12DescriptorHeap&& heap, uint64_t graphicsFenceValue, uint64_t computeFenceValue)
 {
-	g_SrvUavHeap.SubmitHeap(std::move(heap), graphicsFenceValue, computeFenceValue);
-}
-
-void Dx12_SubmitRtvDescriptorHeap(Dx12DescriptorHeap&& heap, uint64_t graphicsFenceValue, uint64_t computeFenceValue)
-{
-	g_RtvHeap.SubmitHeap(std::move(heap), graphicsFenceValue, computeFenceValue);
-}
-
-void Dx12_SubmitDsvDescriptorHeap(Dx12DescriptorHeap&& heap, uint64_t graphicsFenceValue, uint64_t computeFenceValue)
-{
-	g_DsvHeap.SubmitHeap(std::move(heap), graphicsFenceValue, computeFenceValue);
+	// The persistent heap outlives every command list, slots are fenced as they're freed instead
+	(void)heap;
+	(void)graphicsFenceValue;
+	(void)computeFenceValue;
 }
 
 uint32_t GetDescriptorIndexImpl(ShaderResourceView_t srv)
 {
 	auto lock = std::shared_lock(g_SrvUavRemapMutex);
 
-	return static_cast<uint32_t>(g_SrvDescriptorRemap[srv]);
+	return GetSrvUavDescriptorIndex(g_SrvDescriptorRemap[srv]);
 }
 
 uint32_t GetDescriptorIndexImpl(UnorderedAccessView_t uav)
 {
 	auto lock = std::shared_lock(g_SrvUavRemapMutex);
 
-	return static_cast<uint32_t>(g_UavDescriptorRemap[uav]);
+	return GetSrvUavDescriptorIndex(g_UavDescriptorRemap[uav]);
 }
 
 }
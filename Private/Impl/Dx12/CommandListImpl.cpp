@@ -28,22 +28,40 @@ struct CommandListImpl
 
 	ID3D12GraphicsCommandList* cl = nullptr;
 
-	// We dont need to accquire all these heaps for every cl.
-	// TODO: consider lazy accquisition
+	// Render target and depth views come from cpu pools shared by every cl, so only the srv/uav heap is held.
 	Dx12DescriptorHeap SrvUavHeap = {};
-	Dx12DescriptorHeap RtvHeap = {};
-	Dx12DescriptorHeap DsvHeap = {};
+
+	// Highest copy queue fence of any uploaded buffer used by this list, waited on by the queue at submission.
+	uint64_t CopyFenceWait = 0u;
 
 	CommandListImpl(Dx12CommandList&& cl) : CL(cl) {}
 
+	void WaitForCopyQueue(uint64_t fenceValue)
+	{
+		if (fenceValue > CopyFenceWait)
+		{
+			CopyFenceWait = fenceValue;
+		}
+	}
+
+	void SubmitCopyQueueWait(ID3D12CommandQueue* queue)
+	{
+		if (CopyFenceWait > g_render.CopyQueue.DxFence->GetCompletedValue())
+		{
+			DXENSURE(queue->Wait(g_render.CopyQueue.DxFence.Get(), CopyFenceWait));
+		}
+
+		CopyFenceWait = 0u;
+	}
+
 	D3D12_CPU_DESCRIPTOR_HANDLE RtvCpuDescriptorHandle(RenderTargetView_t rtv)
 	{
-		return Dx12_RtvDescriptorHandle(RtvHeap.DxHeap.Get(), rtv);
+		return Dx12_RtvDescriptorHandle(rtv);
 	}
 
 	D3D12_CPU_DESCRIPTOR_HANDLE DsvCpuDescriptorHandle(DepthStencilView_t dsv)
 	{
-		return Dx12_DsvDescriptorHandle(DsvHeap.DxHeap.Get(), dsv);
+		return Dx12_DsvDescriptorHandle(dsv);
 	}
 
 	D3D12_GPU_VIRTUAL_ADDRESS SrvGpuAdress(ShaderResourceView_t srv)
@@ -71,18 +89,6 @@ struct CommandListImpl
 			Dx12_SubmitSrvUavDescriptorHeap(std::move(SrvUavHeap), graphicsFence, computeFence);
 			SrvUavHeap = {};
 		}
-
-		if (RtvHeap.DxHeap)
-		{
-			Dx12_SubmitRtvDescriptorHeap(std::move(RtvHeap), graphicsFence, computeFence);
-			RtvHeap = {};
-		}
-
-		if (DsvHeap.DxHeap)
-		{
-			Dx12_SubmitDsvDescriptorHeap(std::move(DsvHeap), graphicsFence, computeFence);
-			DsvHeap = {};
-		}
 	}
 };
 
@@ -133,7 +139,7 @@ static Dx12CommandAllocator AccquireCommandAllocator_AssumeLocked(D3D12_COMMAND_
 		uint32_t i = 0;
 		for (; i < availableAllocatorCnt; i++)
 		{
-			if (pool->AvailableAllocators[i].FenceValue < fenceVal)
+			if (pool->AvailableAllocators[i].FenceValue <= fenceVal)
 			{
 				break;
 			}
@@ -274,17 +280,11 @@ void CommandList::Begin()
 {
 	if (Type != CommandListType::COPY)
 	{
-		if (Type == CommandListType::GRAPHICS)
-		{
-			impl->RtvHeap = Dx12_AccquireRtvHeap();
-			impl->DsvHeap = Dx12_AccquireDsvHeap();
-		}
-
 		impl->SrvUavHeap = Dx12_AccquireSrvUavHeap();
 
 		if (impl->SrvUavHeap.DxHeap)
 		{
-			ID3D12DescriptorHeap* heaps[] = { impl->SrvUavHeap.DxHeap.Get() };
+			ID3D12DescriptorHeap* heaps[] = { impl->SrvUavHeap.DxHeap.Get(), Dx12_GetSamplerHeap() };
 			impl->CL.DxCl->SetDescriptorHeaps(ARRAYSIZE(heaps), heaps);
 		}
 	}
@@ -402,6 +402,8 @@ void CommandList::SetVertexBuffers(uint32_t startSlot, uint32_t count, const Dyn
 
 void CommandList::SetVertexBuffer(uint32_t slot, VertexBuffer_t vb, uint32_t stride, uint32_t offset)
 {
+	impl->WaitForCopyQueue(Dx12_GetCopyFence(vb));
+
 	D3D12_VERTEX_BUFFER_VIEW vbv = Dx12_GetVertexBufferView(vb, offset, stride);
 	impl->CL.DxCl->IASetVertexBuffers(slot, 1u, &vbv);
 }
@@ -414,6 +416,8 @@ void CommandList::SetVertexBuffer(uint32_t slot, DynamicBuffer_t vb, uint32_t st
 
 void CommandList::SetIndexBuffer(IndexBuffer_t ib, RenderFormat format, uint32_t indexOffset)
 {
+	impl->WaitForCopyQueue(Dx12_GetCopyFence(ib));
+
 	D3D12_INDEX_BUFFER_VIEW ibv = Dx12_GetIndexBufferView(ib, format, indexOffset);
 	impl->CL.DxCl->IASetIndexBuffer(&ibv);
 }
@@ -444,9 +448,12 @@ void CommandList::DrawInstanced(uint32_t numVerts, uint32_t numInstances, uint32
 
 void CommandList::ExecuteIndirect(IndirectCommand_t ic, StructuredBuffer_t argBuf, uint64_t argBufferOffset)
 {
+	impl->WaitForCopyQueue(Dx12_GetCopyFence(argBuf));
+
 	ID3D12CommandSignature* dxCommandSig = Dx12_GetCommandSignature(ic);
 	ID3D12Resource* dxArgRes = Dx12_GetBufferResource(argBuf);
-	impl->CL.DxCl->ExecuteIndirect(dxCommandSig, 1u, dxArgRes, (UINT64)argBufferOffset, nullptr, 0u);
+	const UINT64 dxArgOffset = Dx12_GetBufferOffset(argBuf) + (UINT64)argBufferOffset;
+	impl->CL.DxCl->ExecuteIndirect(dxCommandSig, 1u, dxArgRes, dxArgOffset, nullptr, 0u);
 }
 
 void CommandList::Dispatch(uint32_t x, uint32_t y, uint32_t z)
@@ -497,11 +504,15 @@ void CommandList::SetComputeRootValue(uint32_t slot, uint32_t offset, uint32_t v
 
 void CommandList::SetGraphicsRootCBV(uint32_t slot, ConstantBuffer_t cb)
 {
+	impl->WaitForCopyQueue(Dx12_GetCopyFence(cb));
+
 	impl->CL.DxCl->SetGraphicsRootConstantBufferView(slot, Dx12_GetCbvAddress(cb));
 }
 
 void CommandList::SetComputeRootCBV(uint32_t slot, ConstantBuffer_t cb)
 {
+	impl->WaitForCopyQueue(Dx12_GetCopyFence(cb));
+
 	impl->CL.DxCl->SetComputeRootConstantBufferView(slot, Dx12_GetCbvAddress(cb));
 }
 
@@ -545,6 +556,16 @@ void CommandList::SetComputeRootDescriptorTable(uint32_t slot)
 	impl->CL.DxCl->SetComputeRootDescriptorTable(slot, impl->SrvUavTableDescriptorHandle());
 }
 
+void CommandList::SetGraphicsRootSamplerTable(uint32_t slot)
+{
+	impl->CL.DxCl->SetGraphicsRootDescriptorTable(slot, Dx12_GetSamplerHeap()->GetGPUDescriptorHandleForHeapStart());
+}
+
+void CommandList::SetComputeRootSamplerTable(uint32_t slot)
+{
+	impl->CL.DxCl->SetComputeRootDescriptorTable(slot, Dx12_GetSamplerHeap()->GetGPUDescriptorHandleForHeapStart());
+}
+
 void CommandList::TransitionResource(Texture_t tex, ResourceTransitionState before, ResourceTransitionState after)
 {
 	D3D12_RESOURCE_BARRIER barrier = Dx12_TransitionBarrier(
@@ -558,6 +579,8 @@ void CommandList::TransitionResource(Texture_t tex, ResourceTransitionState befo
 
 void CommandList::TransitionResource(StructuredBuffer_t buf, ResourceTransitionState before, ResourceTransitionState after)
 {
+	impl->WaitForCopyQueue(Dx12_GetCopyFence(buf));
+
 	D3D12_RESOURCE_BARRIER barrier = Dx12_TransitionBarrier(
 		Dx12_GetBufferResource(buf),
 		Dx12_ResourceState(before),
@@ -567,6 +590,24 @@ void CommandList::TransitionResource(StructuredBuffer_t buf, ResourceTransitionS
 	impl->CL.DxCl->ResourceBarrier(1u, &barrier);
 }
 
+void CommandList::TransitionResource(Texture_t tex, uint32_t mip, uint32_t slice, ResourceTransitionState before, ResourceTransitionState after)
+{
+	const TextureCreateDescEx* desc = GetTextureDesc(tex);
+	if (!desc)
+	{
+		return;
+	}
+
+	D3D12_RESOURCE_BARRIER barrier = Dx12_TransitionBarrier(
+		Dx12_GetTextureResource(tex),
+		Dx12_ResourceState(before),
+		Dx12_ResourceState(after),
+		mip + slice * desc->MipCount
+	);
+
+	impl->CL.DxCl->ResourceBarrier(1u, &barrier);
+}
+
 void CommandList::UAVBarrier(Texture_t tex)
 {
 	D3D12_RESOURCE_BARRIER barrier = Dx12_UavBarrier(Dx12_GetTextureResource(tex));
@@ -608,6 +649,8 @@ void CommandList::Execute(CommandListPtr& cl)
 
 	Dx12CommandQueue* queue = Dx12_GetCommandQueue(cl->Type);	
 
+	cl->impl->SubmitCopyQueueWait(queue->DxCommandQueue.Get());
+
 	ID3D12CommandList* cls[] = { cl->impl->CL.DxCl.Get() };
 	queue->DxCommandQueue->ExecuteCommandLists(1u, cls);
 
@@ -640,6 +683,16 @@ ID3D12GraphicsCommandList* Dx12_GetCommandList(CommandList* cl)
 	return cl->GetCommandListImpl()->CL.DxCl.Get();
 }
 
+uint64_t Dx12_GetCommandListFenceValue(CommandList* cl)
+{
+	return cl->GetCommandListImpl()->CL.Allocator.FenceValue;
+}
+
+void Dx12_WaitForCopyQueue(CommandList* cl, uint64_t copyFenceValue)
+{
+	cl->GetCommandListImpl()->WaitForCopyQueue(copyFenceValue);
+}
+
 CommandList* CommandListSubmissionGroup::CreateCommandList()
 {
 	CommandLists.emplace_back(std::unique_ptr<CommandList>(CommandList::CreateRaw(Type)));
@@ -661,6 +714,11 @@ void CommandListSubmissionGroup::Submit()
 
 	Dx12CommandQueue* queue = Dx12_GetCommandQueue(Type);
 
+	for (size_t i = 0; i < CommandLists.size(); i++)
+	{
+		CommandLists[i]->GetCommandListImpl()->SubmitCopyQueueWait(queue->DxCommandQueue.Get());
+	}
+
 	queue->DxCommandQueue->ExecuteCommandLists((UINT)dxCls.size(), (ID3D12CommandList**)dxCls.data());
 	
 	const uint64_t fenceVaue = Dx12_Signal(Type);
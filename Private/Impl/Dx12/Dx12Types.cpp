@@ -360,6 +360,7 @@ D3D12_DESCRIPTOR_RANGE_TYPE Dx12_DescriptorRangeType(RootSignatureDescriptorTabl
     {
     case RootSignatureDescriptorTableType::SRV: return D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
     case RootSignatureDescriptorTableType::UAV: return D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
+    case RootSignatureDescriptorTableType::SAMPLER: return D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER;
     }
 
     assert(0 && "Dx12_DescriptorRangeType unsupported range type");
@@ -381,14 +382,14 @@ D3D12_PRIMITIVE_TOPOLOGY Dx12_PrimitiveTopology(PrimitiveTopologyType ptt)
     return (D3D12_PRIMITIVE_TOPOLOGY)0;
 }
 
-D3D12_RESOURCE_BARRIER Dx12_TransitionBarrier(ID3D12Resource* pRes, D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after)
+D3D12_RESOURCE_BARRIER Dx12_TransitionBarrier(ID3D12Resource* pRes, D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after, UINT subresource)
 {
     D3D12_RESOURCE_BARRIER barrier;
     barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
     barrier.Transition.pResource = pRes;
     barrier.Transition.StateBefore = before;
     barrier.Transition.StateAfter = after;
-    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    barrier.Transition.Subresource = subresource;
     barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
 
     return barrier;
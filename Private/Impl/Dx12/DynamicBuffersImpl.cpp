@@ -1,8 +1,14 @@
 #include "Impl/BuffersImpl.h"
 
+#include "AppendOnlyList.h"
+#include "FramePagePool.h"
 #include "RenderImpl.h"
+#include "ThreadSlotAllocator.h"
 
+#include <atomic>
 #include <deque>
+#include <memory>
+#include <mutex>
 
 namespace rl
 {
@@ -20,209 +26,303 @@ struct DynamicAllocation
 {
 	void* pCpuMem = nullptr;
 	D3D12_GPU_VIRTUAL_ADDRESS pGpuMem = (D3D12_GPU_VIRTUAL_ADDRESS)0;
-	uint32_t Size = 0u;
+	size_t Size = 0u;
 	ID3D12Resource* DxResource = nullptr;
 };
 
-struct DynamicUploadBuffer
+struct DynamicAllocationPage
 {
-	explicit DynamicUploadBuffer() {}
-
-	static const size_t GetPageSize() { return AllocationPageSize; }
-
-	DynamicAllocation Allocate(size_t sizeInBytes, size_t alignment)
+	explicit DynamicAllocationPage(size_t pageSize = AllocationPageSize)
+		: PageSize(pageSize)
 	{
-		assert(sizeInBytes < AllocationPageSize && "DynamicUploadBuffer::AllocateBuffer allocation exceeds max page size for dynamic buffers");
+		DxRes = Dx12_CreateBuffer(PageSize, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE);
 
-		if (!CurrentPage || !CurrentPage->HasSpace(sizeInBytes, alignment))
-		{
-			CurrentPage = RequestPage();
-		}
+		pGpuMem = DxRes->GetGPUVirtualAddress();
+		DxRes->Map(0, nullptr, &pCpuMem);
+	}
 
-		return CurrentPage->Allocate(sizeInBytes, alignment);
+	~DynamicAllocationPage()
+	{
+		DxRes->Unmap(0, nullptr);
 	}
 
-	DynamicAllocation AllocateBuffer(size_t sizeInBytes)
+	bool HasSpace(size_t sizeInBytes, size_t alignment) const
 	{
-		return Allocate(sizeInBytes, D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT);
+		size_t alignedSize = AlignUp(sizeInBytes, alignment);
+		size_t alignedOffset = AlignUp(Offset, alignment);
+
+		return (alignedOffset + alignedSize) <= PageSize;
 	}
 
-	DynamicAllocation AllocateConstantBuffer(size_t sizeInBytes)
+	size_t GetPageSize() const { return PageSize; }
+
+	DynamicAllocation Allocate(size_t sizeInBytes, size_t alignment)
 	{
-		return Allocate(sizeInBytes, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+		size_t alignedSize = AlignUp(sizeInBytes, alignment);
+		Offset = AlignUp(Offset, alignment);
+
+		DynamicAllocation alloc;
+		alloc.pCpuMem = static_cast<uint8_t*>(pCpuMem) + Offset;
+		alloc.pGpuMem = pGpuMem + Offset;
+		alloc.Size = alignedSize;
+		alloc.DxResource = DxRes.Get();
+
+		Offset += alignedSize;
+
+		return alloc;
 	}
 
-	void Reset(uint64_t graphicsFrameFence, uint64_t ComputeFrameFence)
+	void Retire(uint64_t graphicsFrameFence, uint64_t computeFrameFence)
 	{
-		CurrentPage = nullptr;
-		AvailablePages = Pages;
+		Offset = 0;
 		GraphicsFrameFence = graphicsFrameFence;
-		ComputeFrameFence = ComputeFrameFence;
-
-		for (auto& page : AvailablePages)
-		{
-			page->Reset();
-		}
+		ComputeFrameFence = computeFrameFence;
 	}
 
 	bool InFlight(uint64_t graphicsFrameFence, uint64_t computeFrameFence) const
 	{
-		return graphicsFrameFence <= GraphicsFrameFence || computeFrameFence <= ComputeFrameFence;
+		return graphicsFrameFence < GraphicsFrameFence || computeFrameFence < ComputeFrameFence;
 	}
 
 private:
+	ComPtr<ID3D12Resource> DxRes;
 
-	struct AllocationPage
-	{
-		AllocationPage()
-		{
-			DxRes = Dx12_CreateBuffer(AllocationPageSize, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE);
+	void* pCpuMem = nullptr;
+	D3D12_GPU_VIRTUAL_ADDRESS pGpuMem = (D3D12_GPU_VIRTUAL_ADDRESS)0;
 
-			pGpuMem = DxRes->GetGPUVirtualAddress();
-			DxRes->Map(0, nullptr, &pCpuMem);
-		}
+	size_t PageSize = 0;
+	size_t Offset = 0;
 
-		~AllocationPage()
-		{
-			DxRes->Unmap(0, nullptr);
-		}
+	uint64_t GraphicsFrameFence = 0u;
+	uint64_t ComputeFrameFence = 0u;
+};
 
-		bool HasSpace(size_t sizeInBytes, size_t alignment) const
-		{
-			size_t alignedSize = AlignUp(sizeInBytes, alignment);
-			size_t alignedOffset = AlignUp(Offset, alignment);
+FramePagePool<DynamicAllocationPage> g_dynamicPagePool;
 
-			return (alignedOffset + alignedSize) <= AllocationPageSize;
-		}
+// Allocations that don't fit a page get a whole page of their own, sized to the next power of two so pages can be reused by similar sizes.
+static constexpr uint32_t LargePageBucketCount = 11u;
 
-		DynamicAllocation Allocate(size_t sizeInBytes, size_t alignment)
-		{
-			size_t alignedSize = AlignUp(sizeInBytes, alignment);
-			Offset = AlignUp(Offset, alignment);
+static uint32_t GetLargePageBucket(size_t sizeInBytes)
+{
+	uint32_t bucket = 0u;
+
+	while ((AllocationPageSize << bucket) < sizeInBytes)
+	{
+		bucket++;
+	}
 
-			DynamicAllocation alloc;
-			alloc.pCpuMem = static_cast<uint8_t*>(pCpuMem) + Offset;
-			alloc.pGpuMem = pGpuMem + Offset;
-			alloc.Size = (uint32_t)alignedSize;
-			alloc.DxResource = DxRes.Get();
+	return bucket;
+}
 
-			Offset += alignedSize;
+// Large allocations are rare, so unlike the page pool these are taken under a lock.
+struct DynamicLargePagePool
+{
+	std::mutex Mutex;
+	std::vector<std::unique_ptr<DynamicAllocationPage>> Available[LargePageBucketCount];
 
-			return alloc;
-		}
+	std::deque<std::unique_ptr<DynamicAllocationPage>> InFlight;
+
+	FrameHighWaterMark HighWaterMarks[LargePageBucketCount];
+
+	std::unique_ptr<DynamicAllocationPage> TakePage(size_t sizeInBytes)
+	{
+		const uint32_t bucket = GetLargePageBucket(sizeInBytes);
+
+		assert(bucket < LargePageBucketCount && "DynamicLargePagePool::TakePage allocation too large for a dynamic buffer");
 
-		void Reset()
 		{
-			Offset = 0;
+			std::scoped_lock lock(Mutex);
+
+			if (!Available[bucket].empty())
+			{
+				std::unique_ptr<DynamicAllocationPage> page = std::move(Available[bucket].back());
+				Available[bucket].pop_back();
+				return page;
+			}
 		}
 
-	private:
-		ComPtr<ID3D12Resource> DxRes;
+		return std::make_unique<DynamicAllocationPage>(AllocationPageSize << bucket);
+	}
+};
 
-		void* pCpuMem = nullptr;
-		D3D12_GPU_VIRTUAL_ADDRESS pGpuMem = (D3D12_GPU_VIRTUAL_ADDRESS)0;
+DynamicLargePagePool g_dynamicLargePagePool;
 
-		size_t Offset = 0;
-	};
+// DynamicBuffer_t packs the recording thread's slot above the index of the allocation in that thread's list.
+static constexpr uint32_t DynamicThreadBits = 6u;
+static constexpr uint32_t MaxDynamicThreads = 1u << DynamicThreadBits;
+static constexpr uint32_t DynamicIndexBits = 32u - DynamicThreadBits;
 
-	using PagePool = std::deque<std::shared_ptr<AllocationPage>>;
+// Other threads look up handles while the owner keeps allocating, a thread can create about a million dynamic buffers a frame.
+static constexpr uint32_t DynamicAllocationBlockSize = 4096u;
+static constexpr uint32_t MaxDynamicAllocationBlocks = 256u;
 
-	AllocationPage* RequestPage()
-	{
-		AllocationPage* page = nullptr;
+using DynamicAllocationList = AppendOnlyList<DynamicAllocation, DynamicAllocationBlockSize, MaxDynamicAllocationBlocks>;
 
-		if (AvailablePages.empty())
+struct DynamicThreadAllocator
+{
+	DynamicAllocationPage* CurrentPage = nullptr;
+
+	// Pages this thread had to create once the pool ran dry, handed to the pool at the end of the frame.
+	std::vector<std::unique_ptr<DynamicAllocationPage>> CreatedPages;
+	std::vector<std::unique_ptr<DynamicAllocationPage>> LargePages;
+
+	DynamicAllocationList Allocations;
+
+	DynamicAllocation Allocate(size_t sizeInBytes, size_t alignment)
+	{
+		if (AlignUp(sizeInBytes, alignment) >= AllocationPageSize)
 		{
-			Pages.emplace_back(std::make_shared<AllocationPage>());
-			page = Pages.back().get();
+			LargePages.emplace_back(g_dynamicLargePagePool.TakePage(AlignUp(sizeInBytes, alignment)));
+
+			return LargePages.back()->Allocate(sizeInBytes, alignment);
 		}
-		else
+
+		if (!CurrentPage || !CurrentPage->HasSpace(sizeInBytes, alignment))
 		{
-			page = AvailablePages.front().get();
-			AvailablePages.pop_front();
+			CurrentPage = g_dynamicPagePool.TakePage();
+
+			if (!CurrentPage)
+			{
+				CreatedPages.emplace_back(std::make_unique<DynamicAllocationPage>());
+				CurrentPage = CreatedPages.back().get();
+			}
 		}
 
-		return page;
+		return CurrentPage->Allocate(sizeInBytes, alignment);
 	}
+};
 
-	PagePool Pages;
-	PagePool AvailablePages;
+DynamicThreadAllocator g_dynamicThreadAllocators[MaxDynamicThreads];
 
-	AllocationPage* CurrentPage = nullptr;
+// A thread's slot is released when it exits and recycled at the end of the frame, once its pages have been handed to the pool.
+ThreadSlotAllocator g_dynamicThreadSlots(MaxDynamicThreads);
 
-	uint64_t GraphicsFrameFence = 0u;
-	uint64_t ComputeFrameFence = 0u;
-};
+bool g_dynamicFrameActive = false;
 
-DynamicUploadBuffer* g_dynamicUploadBuffer = nullptr;
-std::vector<DynamicAllocation> g_dynamicBuffers;
+static uint32_t GetDynamicThreadSlot()
+{
+	thread_local ThreadSlot slot;
+
+	return slot.Get(g_dynamicThreadSlots);
+}
+
+static const DynamicAllocation& GetDynamicAllocation(DynamicBuffer_t db)
+{
+	const uint32_t slot = (uint32_t)db >> DynamicIndexBits;
+	const uint32_t index = ((uint32_t)db & ((1u << DynamicIndexBits) - 1u)) - 1u;
+
+	const DynamicAllocation* alloc = slot < MaxDynamicThreads ? g_dynamicThreadAllocators[slot].Allocations.Find(index) : nullptr;
 
-std::vector<DynamicUploadBuffer> g_ActiveDynamicBuffers;
-std::vector<DynamicUploadBuffer> g_InFlightDynamicBuffers;
-std::vector<DynamicUploadBuffer> g_AvailableDynamicBuffers;
+	assert(db != DynamicBuffer_t::INVALID && alloc && "GetDynamicAllocation invalid db");
+
+	return *alloc;
+}
 
-DynamicBuffer_t CreateDynamicBuffer(const void* const data, size_t size, bool isConstantBuf)
+DynamicBufferAllocation AllocateDynamic(size_t size, DynamicBufferKind kind)
 {
-	assert(g_dynamicUploadBuffer && "g_dynamicUploadBuffer null, DynamicBuffers_NewFrame not called");
+	assert(g_dynamicFrameActive && "AllocateDynamic called outside a frame, DynamicBuffers_NewFrame not called");
+
+	const uint32_t slot = GetDynamicThreadSlot();
+
+	if (slot == ThreadSlotAllocator::InvalidSlot)
+	{
+		assert(0 && "AllocateDynamic too many threads creating dynamic buffers at once");
+		return {};
+	}
+
+	DynamicThreadAllocator& allocator = g_dynamicThreadAllocators[slot];
+
+	const size_t alignment = kind == DynamicBufferKind::CONSTANT ? D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT : D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT;
+
+	const DynamicAllocation alloc = allocator.Allocate(size, alignment);
 
-	auto alloc = isConstantBuf ? g_dynamicUploadBuffer->AllocateConstantBuffer(size) : g_dynamicUploadBuffer->AllocateBuffer(size);
+	const uint32_t index = allocator.Allocations.Push(alloc);
 
-	memcpy(alloc.pCpuMem, data, size);
+	if (index == DynamicAllocationList::InvalidIndex)
+	{
+		assert(0 && "AllocateDynamic too many dynamic buffers this frame");
+		return {};
+	}
 
-	g_dynamicBuffers.push_back(alloc);
+	DynamicBufferAllocation ret;
+	// Index 0 is kept free so thread 0's first allocation isn't INVALID
+	ret.Buffer = (DynamicBuffer_t)((slot << DynamicIndexBits) | (index + 1u));
+	ret.pData = alloc.pCpuMem;
+	ret.Size = size;
 
-	return (DynamicBuffer_t)(g_dynamicBuffers.size() - 1u);
+	return ret;
+}
+
+static DynamicBuffer_t CreateDynamicBuffer(const void* const data, size_t size, DynamicBufferKind kind)
+{
+	const DynamicBufferAllocation alloc = AllocateDynamic(size, kind);
+
+	if (alloc.pData)
+	{
+		memcpy(alloc.pData, data, size);
+	}
+
+	return alloc.Buffer;
 }
 
 DynamicBuffer_t CreateDynamicVertexBuffer(const void* const data, size_t size)
 {
-	return CreateDynamicBuffer(data, size, false);
+	return CreateDynamicBuffer(data, size, DynamicBufferKind::VERTEX);
 }
 
 DynamicBuffer_t CreateDynamicIndexBuffer(const void* const data, size_t size)
 {
-	return CreateDynamicBuffer(data, size, false);
+	return CreateDynamicBuffer(data, size, DynamicBufferKind::INDEX);
 }
 
 DynamicBuffer_t CreateDynamicConstantBuffer(const void* const data, size_t size)
 {
-	return CreateDynamicBuffer(data, size, true);
+	return CreateDynamicBuffer(data, size, DynamicBufferKind::CONSTANT);
 }
 
 DynamicBuffer_t CreateDynamicByteBuffer(const void* const data, size_t size)
 {
-	return CreateDynamicBuffer(data, size, false);
+	return CreateDynamicBuffer(data, size, DynamicBufferKind::BYTE);
 }
 
+// Both are called between frames, while no other thread is creating dynamic buffers.
 void DynamicBuffers_NewFrame()
 {
-	assert(g_dynamicUploadBuffer == nullptr && "DynamicBuffers_NewFrame called without DynamicBuffers_EndFrame");
+	assert(!g_dynamicFrameActive && "DynamicBuffers_NewFrame called without DynamicBuffers_EndFrame");
+
+	const uint32_t threadCount = g_dynamicThreadSlots.GetUsedCount();
 
-	g_dynamicBuffers.clear();
-	g_dynamicBuffers.push_back({});
+	for (uint32_t i = 0; i < threadCount; i++)
+	{
+		g_dynamicThreadAllocators[i].Allocations.Clear();
+	}
 
 	const uint64_t graphicsFrameFence = g_render.DirectQueue.DxFence->GetCompletedValue();
 	const uint64_t computeFrameFence = g_render.ComputeQueue.DxFence->GetCompletedValue();
 
-	for (int32_t i = (int32_t)g_InFlightDynamicBuffers.size() - 1; i >= 0; --i)
-	{
-		if (!g_InFlightDynamicBuffers[i].InFlight(graphicsFrameFence, computeFrameFence))
-		{
-			g_AvailableDynamicBuffers.emplace_back(std::move(g_InFlightDynamicBuffers[i]));
-			g_InFlightDynamicBuffers.erase(g_InFlightDynamicBuffers.begin() + i);
-		}
-	}
+	g_dynamicPagePool.NewFrame(graphicsFrameFence, computeFrameFence);
+
+	DynamicLargePagePool& largePool = g_dynamicLargePagePool;
 
-	if (g_AvailableDynamicBuffers.empty())
+	while (!largePool.InFlight.empty() && !largePool.InFlight.front()->InFlight(graphicsFrameFence, computeFrameFence))
 	{
-		g_AvailableDynamicBuffers.resize(1);
+		const uint32_t bucket = GetLargePageBucket(largePool.InFlight.front()->GetPageSize());
+
+		largePool.Available[bucket].emplace_back(std::move(largePool.InFlight.front()));
+		largePool.InFlight.pop_front();
 	}
 
-	g_ActiveDynamicBuffers.emplace_back(std::move(g_AvailableDynamicBuffers.back()));
+	for (uint32_t bucket = 0; bucket < LargePageBucketCount; bucket++)
+	{
+		const size_t highWaterMark = largePool.HighWaterMarks[bucket].Get();
 
-	g_AvailableDynamicBuffers.pop_back();
+		if (largePool.Available[bucket].size() > highWaterMark)
+		{
+			largePool.Available[bucket].resize(highWaterMark);
+		}
+	}
 
-	g_dynamicUploadBuffer = &g_ActiveDynamicBuffers.back();
+	g_dynamicFrameActive = true;
 }
 
 void DynamicBuffers_EndFrame()
@@ -230,23 +330,52 @@ void DynamicBuffers_EndFrame()
 	const uint64_t graphicsFrameFence = Dx12_Signal(CommandListType::GRAPHICS);
 	const uint64_t computeFrameFence = Dx12_Signal(CommandListType::COMPUTE);
 
-	for (DynamicUploadBuffer& buf : g_ActiveDynamicBuffers)
+	g_dynamicPagePool.RetireTakenPages(graphicsFrameFence, computeFrameFence);
+
+	size_t largePagesUsed[LargePageBucketCount] = {};
+
+	const uint32_t threadCount = g_dynamicThreadSlots.GetUsedCount();
+
+	for (uint32_t i = 0; i < threadCount; i++)
 	{
-		buf.Reset(graphicsFrameFence, computeFrameFence);
+		DynamicThreadAllocator& allocator = g_dynamicThreadAllocators[i];
 
-		g_InFlightDynamicBuffers.emplace_back(std::move(buf));
+		for (std::unique_ptr<DynamicAllocationPage>& page : allocator.CreatedPages)
+		{
+			g_dynamicPagePool.RetirePage(std::move(page), graphicsFrameFence, computeFrameFence);
+		}
+
+		allocator.CreatedPages.clear();
+
+		for (std::unique_ptr<DynamicAllocationPage>& page : allocator.LargePages)
+		{
+			largePagesUsed[GetLargePageBucket(page->GetPageSize())]++;
+
+			page->Retire(graphicsFrameFence, computeFrameFence);
+			g_dynamicLargePagePool.InFlight.emplace_back(std::move(page));
+		}
+
+		allocator.LargePages.clear();
+		allocator.CurrentPage = nullptr;
 	}
 
-	g_ActiveDynamicBuffers.clear();
+	// Exited threads' handles are no longer valid, so their slots can go to new threads next frame
+	g_dynamicThreadSlots.Recycle([](uint32_t slot)
+	{
+		g_dynamicThreadAllocators[slot].Allocations.Clear();
+	});
+
+	for (uint32_t bucket = 0; bucket < LargePageBucketCount; bucket++)
+	{
+		g_dynamicLargePagePool.HighWaterMarks[bucket].Push(largePagesUsed[bucket]);
+	}
 
-	g_dynamicUploadBuffer = nullptr;
+	g_dynamicFrameActive = false;
 }
 
 D3D12_VERTEX_BUFFER_VIEW Dx12_GetVertexBufferView(DynamicBuffer_t db, uint32_t offset, uint32_t stride)
 {
-	assert((size_t)db < g_dynamicBuffers.size() && "Dx12_GetIndexBufferView invalid db");
-
-	const DynamicAllocation& alloc = g_dynamicBuffers[(size_t)db];
+	const DynamicAllocation& alloc = GetDynamicAllocation(db);
 
 	D3D12_VERTEX_BUFFER_VIEW view;
 	view.BufferLocation = alloc.pGpuMem + (D3D12_GPU_VIRTUAL_ADDRESS)offset;
@@ -258,18 +387,14 @@ D3D12_VERTEX_BUFFER_VIEW Dx12_GetVertexBufferView(DynamicBuffer_t db, uint32_t o
 
 D3D12_GPU_VIRTUAL_ADDRESS Dx12_GetCbvAddress(DynamicBuffer_t db)
 {
-	assert((size_t)db < g_dynamicBuffers.size() && "Dx12_GetIndexBufferView invalid db");
-
-	const DynamicAllocation& alloc = g_dynamicBuffers[(size_t)db];
+	const DynamicAllocation& alloc = GetDynamicAllocation(db);
 
 	return alloc.pGpuMem;
 }
 
 D3D12_INDEX_BUFFER_VIEW Dx12_GetIndexBufferView(DynamicBuffer_t db, RenderFormat format, uint32_t offset)
 {
-	assert((size_t)db < g_dynamicBuffers.size() && "Dx12_GetIndexBufferView invalid db");
-
-	const DynamicAllocation& alloc = g_dynamicBuffers[(size_t)db];
+	const DynamicAllocation& alloc = GetDynamicAllocation(db);
 
 	D3D12_INDEX_BUFFER_VIEW view;
 	view.BufferLocation = alloc.pGpuMem + (D3D12_GPU_VIRTUAL_ADDRESS)offset;
@@ -279,11 +404,14 @@ D3D12_INDEX_BUFFER_VIEW Dx12_GetIndexBufferView(DynamicBuffer_t db, RenderFormat
 	return view;
 }
 
-ID3D12Resource* Dx12_GetDynamicBufferResource(DynamicBuffer_t db, size_t* outOffset)
+size_t Dx12_GetDynamicBufferSize(DynamicBuffer_t db)
 {
-	assert((size_t)db < g_dynamicBuffers.size() && "Dx12_GetDynamicBufferResource invalid db");
+	return GetDynamicAllocation(db).Size;
+}
 
-	const DynamicAllocation& alloc = g_dynamicBuffers[(size_t)db];
+ID3D12Resource* Dx12_GetDynamicBufferResource(DynamicBuffer_t db, size_t* outOffset)
+{
+	const DynamicAllocation& alloc = GetDynamicAllocation(db);
 
 	if (outOffset && alloc.DxResource)
 	{
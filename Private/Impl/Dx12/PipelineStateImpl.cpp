@@ -5,6 +5,7 @@
 #include "SparseArray.h"
 
 #include <dxcapi.h>
+#include <mutex>
 
 struct IDxcBlob;
 
@@ -15,6 +16,10 @@ struct
 {
 	SparseArray<Dx12GraphicsPipelineStateDesc, GraphicsPipelineState_t> GraphicsPipelines;
 	SparseArray<ComPtr<ID3D12PipelineState>, ComputePipelineState_t> ComputePipelines;
+	SparseArray<std::vector<D3D12_INPUT_ELEMENT_DESC>, InputLayout_t> InputLayouts;
+
+	// Pipelines compile in parallel, the shared layouts are guarded separately.
+	std::mutex InputLayoutsMutex;
 } g_pipelines;
 
 static D3D12_BLEND GetBlend(BlendType b)
@@ -129,7 +134,39 @@ D3D12_PRIMITIVE_TOPOLOGY_TYPE GetPrimTopoType(PrimitiveTopologyType pt)
 	return D3D12_PRIMITIVE_TOPOLOGY_TYPE_UNDEFINED;
 }
 
-bool CompileGraphicsPipelineState(GraphicsPipelineState_t handle, const GraphicsPipelineStateDesc& desc, const InputElementDesc* inputs, size_t inputCount)
+// Layouts are interned, so the dx elements are built once and copied out for every pipeline using the layout.
+static std::vector<D3D12_INPUT_ELEMENT_DESC> GetDxInputLayout(InputLayout_t layout)
+{
+	std::scoped_lock lock(g_pipelines.InputLayoutsMutex);
+
+	std::vector<D3D12_INPUT_ELEMENT_DESC>& dxElements = g_pipelines.InputLayouts.Alloc(layout);
+
+	if (dxElements.empty())
+	{
+		const InputLayoutData* data = GetInputLayout(layout);
+		assert(data && "GetDxInputLayout invalid layout");
+
+		dxElements.resize(data->Elements.size());
+
+		for (size_t i = 0; i < data->Elements.size(); i++)
+		{
+			const InputElementDesc& input = data->Elements[i];
+
+			// Semantic names are interned so the pointer remains valid for the lifetime of the layout
+			dxElements[i].SemanticName = (LPCSTR)input.semanticName;
+			dxElements[i].SemanticIndex = (UINT)input.semanticIndex;
+			dxElements[i].Format = Dx12_Format(input.format);
+			dxElements[i].InputSlot = (UINT)input.inputSlot;
+			dxElements[i].AlignedByteOffset = (UINT)input.alignedByteOffset;
+			dxElements[i].InputSlotClass = GetInputClassification(input.inputSlotClass);
+			dxElements[i].InstanceDataStepRate = (UINT)input.instanceDataStepRate;
+		}
+	}
+
+	return dxElements;
+}
+
+bool CompileGraphicsPipelineState(GraphicsPipelineState_t handle, const GraphicsPipelineStateDesc& desc, InputLayout_t layout)
 {
 	struct Dx12PipelineStateStream
 	{
@@ -263,22 +300,12 @@ bool CompileGraphicsPipelineState(GraphicsPipelineState_t handle, const Graphics
 	}
 
 	std::vector<D3D12_INPUT_ELEMENT_DESC> dxElements;
+	if (layout != InputLayout_t::INVALID)
 	{
-		D3D12_INPUT_LAYOUT_DESC& dxLayout = StateStream.InputLayout;		
-		dxElements.resize(inputCount);
-
-		for (size_t i = 0; i < inputCount; i++)
-		{
-			dxElements[i].SemanticName = (LPCSTR)inputs[i].semanticName;
-			dxElements[i].SemanticIndex = (UINT)inputs[i].semanticIndex;
-			dxElements[i].Format = Dx12_Format(inputs[i].format);
-			dxElements[i].InputSlot = (UINT)inputs[i].inputSlot;
-			dxElements[i].AlignedByteOffset = (UINT)inputs[i].alignedByteOffset;
-			dxElements[i].InputSlotClass = GetInputClassification(inputs[i].inputSlotClass);
-			dxElements[i].InstanceDataStepRate = (UINT)inputs[i].instanceDataStepRate;
-		}
+		D3D12_INPUT_LAYOUT_DESC& dxLayout = StateStream.InputLayout;
+		dxElements = GetDxInputLayout(layout);
 
-		dxLayout.NumElements = (UINT)inputCount;
+		dxLayout.NumElements = (UINT)dxElements.size();
 		dxLayout.pInputElementDescs = dxElements.data();
 	}
 
@@ -372,6 +399,13 @@ void DestroyComputePipelineState(ComputePipelineState_t pso)
 	g_pipelines.ComputePipelines.Free(pso);
 }
 
+void DestroyInputLayout(InputLayout_t layout)
+{
+	std::scoped_lock lock(g_pipelines.InputLayoutsMutex);
+
+	g_pipelines.InputLayouts.Free(layout);
+}
+
 Dx12GraphicsPipelineStateDesc* Dx12_GetPipelineState(GraphicsPipelineState_t pso)
 {
 	if (g_pipelines.GraphicsPipelines.Valid(pso))
@@ -3,6 +3,7 @@
 #include "Render.h"
 #include "RenderDefines.h"
 #include "Buffers.h"
+#include "Impl/BuffersImpl.h"
 
 #include <dxgi1_6.h>
 
@@ -207,17 +208,22 @@ bool Render_Initialised()
 void Render_BeginFrame()
 {
 	DynamicBuffers_NewFrame();
+	Dx12_TransientDescriptorsNewFrame();
 }
 
 void Render_BeginRenderFrame()
 {
 	Dx12_DescriptorsBeginFrame();
+	Dx12_SamplersBeginFrame();
 	Dx12_TexturesBeginFrame();
 }
 
 void Render_EndFrame()
 {
 	DynamicBuffers_EndFrame();
+	Dx12_StaticBuffersEndFrame();
+
+	GeometryPools_EndFrame(g_render.DirectQueue.FenceValue, g_render.ComputeQueue.FenceValue, g_render.DirectQueue.DxFence->GetCompletedValue(), g_render.ComputeQueue.DxFence->GetCompletedValue());
 }
 
 void Render_ShutDown()
@@ -290,7 +296,8 @@ uint64_t Dx12_Signal(CommandListType queue)
 {
 	Dx12CommandQueue* commandQueue = Dx12_GetCommandQueue(queue);
 
-	uint64_t value = commandQueue->FenceValue.fetch_add(1u);	
+	// Signal the incremented value, the fence starts at 0 so signalling the old value would complete immediately
+	uint64_t value = commandQueue->FenceValue.fetch_add(1u) + 1u;
 
 	DXENSURE(commandQueue->DxCommandQueue->Signal(commandQueue->DxFence.Get(), value));
 
@@ -356,7 +363,7 @@ D3D12_RESOURCE_DESC Dx12_BufferDesc(size_t size, D3D12_RESOURCE_FLAGS flags)
 	D3D12_RESOURCE_DESC desc = {};
 	desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
 	desc.Alignment = 0;
-	desc.Width = (UINT)size;
+	desc.Width = (UINT64)size;
 	desc.Height = 1u;
 	desc.DepthOrArraySize = 1u;
 	desc.MipLevels = 1u;
@@ -389,4 +396,37 @@ ComPtr<ID3D12Resource> Dx12_CreateBuffer(size_t size, D3D12_HEAP_TYPE heapType,
 	return res;
 }
 
+ComPtr<ID3D12Heap> Dx12_CreateBufferHeap(size_t size, D3D12_HEAP_TYPE heapType)
+{
+	ComPtr<ID3D12Heap> heap = nullptr;
+
+	D3D12_HEAP_DESC desc = {};
+	desc.SizeInBytes = size;
+	desc.Properties = Dx12_HeapProps(heapType);
+	desc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+	desc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+
+	DXENSURE(g_render.DxDevice->CreateHeap(&desc, IID_PPV_ARGS(&heap)));
+
+	return heap;
+}
+
+ComPtr<ID3D12Resource> Dx12_CreatePlacedBuffer(ID3D12Heap* heap, uint64_t heapOffset, size_t size, D3D12_RESOURCE_STATES initialState, D3D12_RESOURCE_FLAGS flags)
+{
+	ComPtr<ID3D12Resource> res = nullptr;
+
+	const D3D12_RESOURCE_DESC desc = Dx12_BufferDesc(size, flags);
+
+	DXENSURE(g_render.DxDevice->CreatePlacedResource(
+		heap,
+		heapOffset,
+		&desc,
+		initialState,
+		nullptr,
+		IID_PPV_ARGS(&res)
+	));
+
+	return res;
+}
+
 }
\ No newline at end of file
@@ -88,6 +88,17 @@ struct Dx12StaticBufferAllocation
 	ID3D12Resource* pResource;
 
 	bool SingleBuffer = false;
+	bool Slab = false;
+
+	// Suballocated from a page shared with other small UAV buffers.
+	bool UavPage = false;
+
+	// Aliases the memory of a generic buffer, which owns and frees it.
+	bool View = false;
+
+	// Index of the owning page, single buffer or slab page, and the allocator block or slot within it, so updates and frees don't search.
+	uint32_t Page = ~0u;
+	uint32_t Block = ~0u;
 };
 
 extern Dx12RenderGlobals g_render;
@@ -105,28 +116,37 @@ IDxcBlob* Dx12_GetRayGenShaderBlob(RaytracingRayGenShader_t rgs);
 Dx12CommandList Dx12_AccquireCommandList(CommandListType type);
 Dx12CommandList Dx12_AccquireCommandList(D3D12_COMMAND_LIST_TYPE type);
 ID3D12GraphicsCommandList* Dx12_GetCommandList(CommandList* cl);
+uint64_t Dx12_GetCommandListFenceValue(CommandList* cl);
+
+// Makes the queue wait on the gpu for the copy queue to reach this value before the command list executes.
+void Dx12_WaitForCopyQueue(CommandList* cl, uint64_t copyFenceValue);
 
 void Dx12_DescriptorsBeginFrame();
 
+void Dx12_SamplersBeginFrame();
+ID3D12DescriptorHeap* Dx12_GetSamplerHeap();
+
+// Moves dynamic buffer views on to the next segment of the srv/uav heap.
+void Dx12_TransientDescriptorsNewFrame();
+
 void Dx12_TexturesBeginFrame();
 void Dx12_TexturesProcessPendingDeletes(bool flush);
 void Dx12_TexturesMarkAsUsedByQueue(Texture_t tex, CommandListType type, uint64_t fenceValue);
 ID3D12Resource* Dx12_GetTextureResource(Texture_t tex);
 
 Dx12DescriptorHeap Dx12_AccquireSrvUavHeap();
-Dx12DescriptorHeap Dx12_AccquireRtvHeap();
-Dx12DescriptorHeap Dx12_AccquireDsvHeap();
 
 void Dx12_SubmitSrvUavDescriptorHeap(Dx12DescriptorHeap&& heap, uint64_t graphicsFenceValue, uint64_t computeFenceValue);
-void Dx12_SubmitRtvDescriptorHeap(Dx12DescriptorHeap&& heap, uint64_t graphicsFenceValue, uint64_t computeFenceValue);
-void Dx12_SubmitDsvDescriptorHeap(Dx12DescriptorHeap&& heap, uint64_t graphicsFenceValue, uint64_t computeFenceValue);
 
-D3D12_CPU_DESCRIPTOR_HANDLE Dx12_RtvDescriptorHandle(ID3D12DescriptorHeap* heap, RenderTargetView_t rtv);
-D3D12_CPU_DESCRIPTOR_HANDLE Dx12_DsvDescriptorHandle(ID3D12DescriptorHeap* heap, DepthStencilView_t dsv);
+D3D12_CPU_DESCRIPTOR_HANDLE Dx12_RtvDescriptorHandle(RenderTargetView_t rtv);
+D3D12_CPU_DESCRIPTOR_HANDLE Dx12_DsvDescriptorHandle(DepthStencilView_t dsv);
 
 Dx12GraphicsPipelineStateDesc* Dx12_GetPipelineState(GraphicsPipelineState_t pso);
 ID3D12PipelineState* Dx12_GetPipelineState(ComputePipelineState_t pso);
 
+// Retires staging memory used by static buffer uploads submitted this frame.
+void Dx12_StaticBuffersEndFrame();
+
 // It is up to the calling code to free this memory reponsibly
 Dx12StaticBufferAllocation Dx12_CreateByteBuffer(const void* const Data, size_t Size);
 Dx12StaticBufferAllocation Dx12_CreateRWByteBuffer(const void* const Data, size_t Size);
@@ -139,6 +159,13 @@ D3D12_VERTEX_BUFFER_VIEW Dx12_GetVertexBufferView(DynamicBuffer_t db, uint32_t o
 D3D12_INDEX_BUFFER_VIEW Dx12_GetIndexBufferView(IndexBuffer_t ib, RenderFormat format, uint32_t offset);
 D3D12_INDEX_BUFFER_VIEW Dx12_GetIndexBufferView(DynamicBuffer_t db, RenderFormat format, uint32_t offset);
 ID3D12Resource* Dx12_GetDynamicBufferResource(DynamicBuffer_t db, size_t* outOffset);
+size_t Dx12_GetDynamicBufferSize(DynamicBuffer_t db);
+
+// Copy queue fence value of the last upload to the buffer's memory.
+uint64_t Dx12_GetCopyFence(VertexBuffer_t vb);
+uint64_t Dx12_GetCopyFence(IndexBuffer_t ib);
+uint64_t Dx12_GetCopyFence(StructuredBuffer_t sb);
+uint64_t Dx12_GetCopyFence(ConstantBuffer_t cb);
 
 D3D12_GPU_VIRTUAL_ADDRESS Dx12_GetCbvAddress(ConstantBuffer_t cb);
 D3D12_GPU_VIRTUAL_ADDRESS Dx12_GetCbvAddress(DynamicBuffer_t db);
@@ -152,7 +179,7 @@ D3D12_GPU_DESCRIPTOR_HANDLE Dx12_GetSrvUavTableHandle(ID3D12DescriptorHeap* heap
 
 D3D12_RESOURCE_STATES Dx12_ResourceState(ResourceTransitionState state);
 
-D3D12_RESOURCE_BARRIER Dx12_TransitionBarrier(ID3D12Resource* pRes, D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after);
+D3D12_RESOURCE_BARRIER Dx12_TransitionBarrier(ID3D12Resource* pRes, D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after, UINT subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES);
 D3D12_RESOURCE_BARRIER Dx12_UavBarrier(ID3D12Resource* pRes);
 
 void Dx12_SetTextureResource(Texture_t tex, const ComPtr<ID3D12Resource>& resource);
@@ -167,8 +194,11 @@ void Dx12_Wait(CommandListType queue, uint64_t value);
 D3D12_HEAP_PROPERTIES Dx12_HeapProps(D3D12_HEAP_TYPE type);
 D3D12_RESOURCE_DESC Dx12_BufferDesc(size_t size, D3D12_RESOURCE_FLAGS flags);
 ComPtr<ID3D12Resource> Dx12_CreateBuffer(size_t size, D3D12_HEAP_TYPE heapType, D3D12_RESOURCE_STATES initialState, D3D12_RESOURCE_FLAGS flags);
+// Heaps that only hold buffers, resources placed in them must be D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT aligned.
+ComPtr<ID3D12Heap> Dx12_CreateBufferHeap(size_t size, D3D12_HEAP_TYPE heapType);
+ComPtr<ID3D12Resource> Dx12_CreatePlacedBuffer(ID3D12Heap* heap, uint64_t heapOffset, size_t size, D3D12_RESOURCE_STATES initialState, D3D12_RESOURCE_FLAGS flags);
 ID3D12Resource* Dx12_GetBufferResource(StructuredBuffer_t buf);
-uint32_t Dx12_GetBufferOffset(StructuredBuffer_t buf);
+uint64_t Dx12_GetBufferOffset(StructuredBuffer_t buf);
 
 ComPtr<ID3D12Fence> Dx12_CreateFence(uint64_t fenceValue);
 
@@ -1,6 +1,11 @@
 #include "Samplers.h"
+#include "Impl/SamplersImpl.h"
 
 #include "RenderImpl.h"
+#include "DescriptorSlotAllocator.h"
+#include "SparseArray.h"
+
+#include <mutex>
 
 #undef min
 
@@ -100,4 +105,119 @@ D3D12_STATIC_BORDER_COLOR Dx12_BorderColor(SamplerBorderColor bc)
 	return (D3D12_STATIC_BORDER_COLOR)0;
 }
 
+static void Dx12_BorderColorValue(SamplerBorderColor bc, FLOAT outColor[4])
+{
+	const FLOAT alpha = bc == SamplerBorderColor::TRANSPARENT_BLACK ? 0.0f : 1.0f;
+	const FLOAT rgb = bc == SamplerBorderColor::OPAQUE_WHITE ? 1.0f : 0.0f;
+
+	outColor[0] = outColor[1] = outColor[2] = rgb;
+	outColor[3] = alpha;
+}
+
+// Runtime samplers live in one shader visible heap for the device's lifetime, freed slots wait for the frames that could still read them.
+struct SamplerHeap
+{
+	ComPtr<ID3D12DescriptorHeap> DxHeap;
+	UINT DescriptorHandleIncrement = 0u;
+
+	DescriptorSlotAllocator Slots{ D3D12_MAX_SHADER_VISIBLE_SAMPLER_HEAP_SIZE };
+
+	SparseArray<uint32_t, Sampler_t> SamplerSlots;
+	std::mutex Mutex;
+
+	std::once_flag Init;
+};
+
+SamplerHeap g_SamplerHeap;
+
+static SamplerHeap& GetSamplerHeap()
+{
+	std::call_once(g_SamplerHeap.Init, []
+	{
+		D3D12_DESCRIPTOR_HEAP_DESC desc = {};
+		desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER;
+		desc.NumDescriptors = D3D12_MAX_SHADER_VISIBLE_SAMPLER_HEAP_SIZE;
+		desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+		desc.NodeMask = 0;
+
+		if (!DXENSURE(g_render.DxDevice->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&g_SamplerHeap.DxHeap))))
+		{
+			assert(0 && "GetSamplerHeap : CreateDescriptorHeap failed");
+			return;
+		}
+
+		g_SamplerHeap.DescriptorHandleIncrement = g_render.DxDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER);
+	});
+
+	return g_SamplerHeap;
+}
+
+bool CreateSamplerImpl(Sampler_t sampler, const SamplerDesc& desc)
+{
+	SamplerHeap& heap = GetSamplerHeap();
+
+	uint32_t slot = 0u;
+	if (!heap.DxHeap || !heap.Slots.Alloc(slot))
+	{
+		assert(0 && "CreateSamplerImpl out of sampler descriptors");
+		return false;
+	}
+
+	D3D12_SAMPLER_DESC dxDesc = {};
+	dxDesc.Filter = Dx12_Filter(desc.Comparison != SamplerComparisonFunc::NONE, desc.FilterMode.Min, desc.FilterMode.Mag, desc.FilterMode.Mip);
+	dxDesc.AddressU = Dx12_TextureAddressMode(desc.AddressMode.U);
+	dxDesc.AddressV = Dx12_TextureAddressMode(desc.AddressMode.V);
+	dxDesc.AddressW = Dx12_TextureAddressMode(desc.AddressMode.W);
+	dxDesc.MipLODBias = desc.MipLODBias;
+	dxDesc.MaxAnisotropy = desc.MaxAnisotropy;
+	dxDesc.ComparisonFunc = Dx12_ComparisonFunc(desc.Comparison);
+	Dx12_BorderColorValue(desc.BorderColor, dxDesc.BorderColor);
+	dxDesc.MinLOD = desc.MinLOD;
+	dxDesc.MaxLOD = desc.MaxLOD;
+
+	D3D12_CPU_DESCRIPTOR_HANDLE handle = heap.DxHeap->GetCPUDescriptorHandleForHeapStart();
+	handle.ptr += (size_t)slot * heap.DescriptorHandleIncrement;
+
+	g_render.DxDevice->CreateSampler(&dxDesc, handle);
+
+	{
+		auto lock = std::scoped_lock(heap.Mutex);
+
+		heap.SamplerSlots.AllocCopy(sampler, slot);
+	}
+
+	return true;
+}
+
+void DestroySamplerImpl(Sampler_t sampler)
+{
+	auto lock = std::scoped_lock(g_SamplerHeap.Mutex);
+
+	if (g_SamplerHeap.SamplerSlots.Valid(sampler))
+	{
+		g_SamplerHeap.Slots.Free(g_SamplerHeap.SamplerSlots[sampler]);
+		g_SamplerHeap.SamplerSlots.Free(sampler);
+	}
+}
+
+uint32_t GetDescriptorIndexImpl(Sampler_t sampler)
+{
+	auto lock = std::scoped_lock(g_SamplerHeap.Mutex);
+
+	return g_SamplerHeap.SamplerSlots.Valid(sampler) ? g_SamplerHeap.SamplerSlots[sampler] : 0u;
+}
+
+void Dx12_SamplersBeginFrame()
+{
+	SamplerHeap& heap = GetSamplerHeap();
+
+	heap.Slots.EndFrame(g_render.DirectQueue.FenceValue, g_render.ComputeQueue.FenceValue);
+	heap.Slots.Reclaim(g_render.DirectQueue.DxFence->GetCompletedValue(), g_render.ComputeQueue.DxFence->GetCompletedValue());
+}
+
+ID3D12DescriptorHeap* Dx12_GetSamplerHeap()
+{
+	return GetSamplerHeap().DxHeap.Get();
+}
+
 }
\ No newline at end of file
@@ -1,11 +1,18 @@
 #include "Impl/BuffersImpl.h"
 
+#include "BufferCopies.h"
+#include "CommandList.h"
+#include "DefragPlanner.h"
 #include "IDArray.h"
+#include "MpscQueue.h"
 #include "RenderImpl.h"
 #include "SparseArray.h"
+#include "StaticBufferPool.h"
 
-#include <map>
-#include <set>
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
 #include <vector>
 
 namespace rl
@@ -26,531 +33,1439 @@ static constexpr size_t AlignUp(size_t size, size_t alignment)
 	return remainder ? size + (alignment - remainder) : size;
 }
 
-struct BufferAllocationBlock;
-using FreeBlocksByOffsetMap = std::map<size_t, BufferAllocationBlock>;
-using FreeBlocksBySizeMap = std::multimap<size_t, FreeBlocksByOffsetMap::iterator>;
+// Static buffers only live in device local memory, their data is staged through a shared upload ring recycled by copy fences.
+static const size_t StagingRingSize = 16u * 1024u * 1024u;
+static const size_t StagingAlignment = 16u;
+
+// Uploads larger than a chunk are split and streamed through the ring, so staging memory stays bounded for any buffer size.
+// A quarter of the ring keeps several chunks in flight while the next one is copied in.
+static const size_t StagingChunkSize = StagingRingSize / 4u;
+
+struct StagingAllocation
+{
+	ID3D12Resource* pResource = nullptr;
+	size_t Offset = 0u;
+};
+
+// Staged data is only read by the copy queue, so space is reused as soon as the copies reading it complete.
+struct StagingRing
+{
+private:
+	struct Submission
+	{
+		size_t Used = 0u;
+		uint64_t CopyFence = 0u;
+	};
+
+	struct OverflowBuffer
+	{
+		ComPtr<ID3D12Resource> pBuffer = nullptr;
+		size_t Size = 0u;
+		uint64_t CopyFence = 0u;
+	};
+
+	// Only guards the ring bookkeeping, loader threads copy their data into reserved space in parallel.
+	std::mutex Mutex;
+
+	ComPtr<ID3D12Resource> pBuffer = nullptr;
+	void* pCpuMemory = nullptr;
+
+	size_t Head = 0u;
+	size_t Used = 0u;
+
+	// Staged since the last Submit, the copies reading it may not have been submitted yet.
+	size_t PendingUsed = 0u;
+
+	std::deque<Submission> InFlight;
+
+	// Requests that don't fit in the ring get a temporary upload buffer, released with the copies that used it.
+	std::vector<OverflowBuffer> PendingOverflow;
+	std::deque<OverflowBuffer> InFlightOverflow;
+	size_t OverflowSize = 0u;
+
+	bool AllocFromRing(size_t size, size_t& outOffset)
+	{
+		if (!pBuffer)
+		{
+			pBuffer = Dx12_CreateBuffer(StagingRingSize, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE);
+			pBuffer->Map(0, nullptr, &pCpuMemory);
+		}
+
+		if (size > StagingRingSize)
+		{
+			return false;
+		}
+
+		size_t offset = AlignUpPowerOfTwo(Head, StagingAlignment);
+		size_t padding = offset - Head;
+
+		// Skip the tail end of the ring if the allocation would straddle it, the skipped bytes retire with this submission.
+		if (offset + size > StagingRingSize)
+		{
+			offset = 0u;
+			padding = StagingRingSize - Head;
+		}
+
+		const size_t consumed = padding + size;
+
+		if (Used + consumed > StagingRingSize)
+		{
+			return false;
+		}
+
+		Head = offset + size;
+		Used += consumed;
+		PendingUsed += consumed;
+
+		outOffset = offset;
+
+		return true;
+	}
+
+	void Retire_AssumeLocked()
+	{
+		const uint64_t completedCopyFence = g_render.CopyQueue.DxFence->GetCompletedValue();
+
+		while (!InFlight.empty() && InFlight.front().CopyFence <= completedCopyFence)
+		{
+			Used -= InFlight.front().Used;
+			InFlight.pop_front();
+		}
+
+		while (!InFlightOverflow.empty() && InFlightOverflow.front().CopyFence <= completedCopyFence)
+		{
+			OverflowSize -= InFlightOverflow.front().Size;
+			InFlightOverflow.pop_front();
+		}
+	}
+
+public:
+
+	// Never overflows, false means the ring is full of copies still in flight.
+	bool TryStageInRing(const void* const pData, size_t size, StagingAllocation& outStaging)
+	{
+		size_t offset = 0u;
+		{
+			std::scoped_lock lock(Mutex);
+
+			if (!AllocFromRing(size, offset))
+			{
+				Retire_AssumeLocked();
+
+				if (!AllocFromRing(size, offset))
+				{
+					return false;
+				}
+			}
+		}
+
+		memcpy((uint8_t*)pCpuMemory + offset, pData, size);
+
+		outStaging.pResource = pBuffer.Get();
+		outStaging.Offset = offset;
+
+		return true;
+	}
+
+	StagingAllocation Stage(const void* const pData, size_t size)
+	{
+		StagingAllocation staging;
+
+		if (TryStageInRing(pData, size, staging))
+		{
+			return staging;
+		}
+
+		OverflowBuffer overflow;
+		overflow.pBuffer = Dx12_CreateBuffer(size, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE);
+		overflow.Size = size;
+
+		void* pOverflowMemory = nullptr;
+		overflow.pBuffer->Map(0, nullptr, &pOverflowMemory);
+		memcpy(pOverflowMemory, pData, size);
+		overflow.pBuffer->Unmap(0, nullptr);
+
+		staging.pResource = overflow.pBuffer.Get();
+		staging.Offset = 0u;
+
+		std::scoped_lock lock(Mutex);
+
+		OverflowSize += size;
+		PendingOverflow.emplace_back(std::move(overflow));
+
+		return staging;
+	}
+
+	// Every copy reading what was staged since the last call must already be submitted, that space is reused once copyFence completes.
+	void Submit(uint64_t copyFence)
+	{
+		std::scoped_lock lock(Mutex);
+
+		if (PendingUsed > 0u)
+		{
+			InFlight.push_back({ PendingUsed, copyFence });
+			PendingUsed = 0u;
+		}
+
+		for (OverflowBuffer& overflow : PendingOverflow)
+		{
+			overflow.CopyFence = copyFence;
+
+			InFlightOverflow.emplace_back(std::move(overflow));
+		}
+
+		PendingOverflow.clear();
+
+		Retire_AssumeLocked();
+	}
+
+	// Copy fence of the oldest submission still holding ring space, 0 if there is none.
+	uint64_t GetOldestCopyFence()
+	{
+		std::scoped_lock lock(Mutex);
+
+		return InFlight.empty() ? 0u : InFlight.front().CopyFence;
+	}
+
+	size_t GetResidentSize()
+	{
+		std::scoped_lock lock(Mutex);
+
+		return (pBuffer ? StagingRingSize : 0u) + OverflowSize;
+	}
+};
+
+StagingRing g_stagingRing;
+
+// Identifies the page or single buffer an upload targets, so the copy fence can be recorded once the copy is submitted.
+struct BufferAllocationOwner
+{
+	bool SingleBuffer = false;
+	uint32_t Index = 0u;
+	bool Slab = false;
+	bool UavPage = false;
+};
 
 struct BufferAllocationUploadRequest
 {
-	Dx12StaticBufferAllocation Allocation;
+	// Holds a reference so a buffer freed before the copy is submitted stays alive until the copy queue is done with it.
+	ComPtr<ID3D12Resource> pDst = nullptr;
+	size_t DstOffset = 0u;
 
-	ID3D12Resource* pDst = nullptr;
 	ID3D12Resource* pSrc = nullptr;
+	size_t SrcOffset = 0u;
+
+	size_t Size = 0u;
+
+	BufferAllocationOwner Owner;
+
+	// Updates may overwrite memory still read by earlier graphics or compute work.
+	// Initial uploads can't, freed memory is only reused once the frame that freed it has completed on every queue.
+	bool Update = false;
 };
 
-std::vector<BufferAllocationUploadRequest> g_uploadRequests;
-std::set<ID3D12Resource*> g_uploadTargetBuffers;
+// Filled from any thread, consumed under g_uploadSubmitMutex.
+MpscQueue<BufferAllocationUploadRequest> g_uploadRequests;
+
+// Held while copies are submitted to the copy queue, so batches and chunked uploads land in the order they were queued.
+std::mutex g_uploadSubmitMutex;
 
-static void RequestUploadAlloc(const Dx12StaticBufferAllocation& alloc, ID3D12Resource* pDst, ID3D12Resource* pSrc)
+// Shared while a request is staged and queued.
+// The end of frame and each upload chunk take it exclusively, so everything staged is submitted before the ring's copy fence is recorded.
+std::shared_mutex g_uploadMutex;
+
+struct SubmittedUpload
 {
-	g_uploadRequests.emplace_back(alloc, pDst, pSrc);
-	g_uploadTargetBuffers.emplace(pDst);
+	ComPtr<ID3D12Resource> pDst = nullptr;
+	uint64_t CopyFence = 0u;
+};
+
+std::deque<SubmittedUpload> g_submittedUploads;
+
+// Copy fence of the last upload submitted, guarded by g_uploadSubmitMutex.
+uint64_t g_lastUploadCopyFence = 0u;
+
+static void SubmitUploads_AssumeLocked(CommandList* cl);
+static void SetOwnerCopyFence(BufferAllocationOwner owner, uint64_t fence);
+
+// Only updates need ordering against earlier work reading the same memory, this is a gpu side wait on everything already submitted.
+// The copy queue runs in order, so it also holds back whatever is submitted after the update.
+static void WaitForSubmittedWork(ID3D12CommandQueue* copyQueue)
+{
+	DXENSURE(copyQueue->Wait(g_render.DirectQueue.DxFence.Get(), g_render.DirectQueue.FenceValue));
+	DXENSURE(copyQueue->Wait(g_render.ComputeQueue.DxFence.Get(), g_render.ComputeQueue.FenceValue));
 }
 
-struct BufferAllocationBlock
+// Each chunk is staged in the ring and submitted straight away, so the next chunk is copied in while earlier ones are still on the copy queue.
+// The thread only waits when the ring is full, and then only for the oldest copy holding space.
+static void RequestChunkedUpload(ID3D12Resource* pDst, size_t dstOffset, const void* const pData, size_t size, BufferAllocationOwner owner, bool update)
 {
-	FreeBlocksBySizeMap::iterator OrderBySizeIt;
+	const std::vector<UploadChunk> chunks = SplitUpload(size, StagingChunkSize);
 
-	size_t Size() { return OrderBySizeIt->first; }
-};
+	for (size_t chunk = 0u; chunk < chunks.size();)
+	{
+		const size_t offset = (size_t)chunks[chunk].Offset;
+		const size_t chunkSize = (size_t)chunks[chunk].Size;
+
+		std::unique_lock uploadLock(g_uploadMutex);
+		std::unique_lock submitLock(g_uploadSubmitMutex);
+
+		// Anything already queued was requested first, it has to land before this chunk
+		SubmitUploads_AssumeLocked(nullptr);
+
+		StagingAllocation staging;
+		if (!g_stagingRing.TryStageInRing((const uint8_t*)pData + offset, chunkSize, staging))
+		{
+			// Everything staged so far was just submitted, so the ring can retire it by the last copy fence
+			g_stagingRing.Submit(g_render.CopyQueue.FenceValue);
+
+			const uint64_t oldestCopyFence = g_stagingRing.GetOldestCopyFence();
+
+			submitLock.unlock();
+			uploadLock.unlock();
+
+			Dx12_Wait(CommandListType::COPY, oldestCopyFence);
+			continue;
+		}
+
+		if (update && offset == 0u)
+		{
+			WaitForSubmittedWork(g_render.CopyQueue.DxCommandQueue.Get());
+		}
+
+		CommandListPtr uploadCl = CommandList::Create(CommandListType::COPY);
 
-struct BufferAllocationPage
+		Dx12_GetCommandList(uploadCl.get())->CopyBufferRegion(pDst, dstOffset + offset, staging.pResource, staging.Offset, chunkSize);
+
+		CommandList::Execute(uploadCl);
+
+		const uint64_t copyFence = Dx12_GetCommandListFenceValue(uploadCl.get());
+
+		g_stagingRing.Submit(copyFence);
+
+		SetOwnerCopyFence(owner, copyFence);
+
+		g_submittedUploads.emplace_back(pDst, copyFence);
+		g_lastUploadCopyFence = copyFence;
+
+		chunk++;
+	}
+}
+
+static void RequestUpload(ID3D12Resource* pDst, size_t dstOffset, const void* const pData, size_t size, BufferAllocationOwner owner, bool update)
+{
+	if (size > StagingChunkSize)
+	{
+		RequestChunkedUpload(pDst, dstOffset, pData, size, owner, update);
+		return;
+	}
+
+	std::shared_lock lock(g_uploadMutex);
+
+	const StagingAllocation staging = g_stagingRing.Stage(pData, size);
+
+	g_uploadRequests.Push({ pDst, dstOffset, staging.pResource, staging.Offset, size, owner, update });
+}
+
+static BufferAllocationOwner GetOwner(const Dx12StaticBufferAllocation& alloc)
+{
+	return { alloc.SingleBuffer, alloc.Page, alloc.Slab, alloc.UavPage };
+}
+
+// The allocator and its lock live in StaticBufferPage, the page adds the resource its allocations are placed in.
+struct BufferAllocationPage : StaticBufferPage
 {
 private:
-	size_t FreeSize = AllocationPageSize;
+	uint32_t Index = 0u;
+	std::atomic<uint64_t> CopyFence = 0u;
 
-	void* pCpuMemory = nullptr;
 	D3D12_GPU_VIRTUAL_ADDRESS pGpuMemory = D3D12_GPU_VIRTUAL_ADDRESS{ 0 };
 
-	ComPtr<ID3D12Resource> pUploadBuffer = nullptr;
 	ComPtr<ID3D12Resource> pBuffer = nullptr;
 
-	FreeBlocksByOffsetMap FreeBlocksByOffset;
-	FreeBlocksBySizeMap FreeBlocksBySize;
+	bool Uav = false;
+
+public:
+
+	explicit BufferAllocationPage(uint32_t index)
+		: StaticBufferPage(AllocationPageSize)
+		, Index(index)
+	{
+		pBuffer = Dx12_CreateBuffer(AllocationPageSize, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_FLAG_NONE);
+
+		if (pBuffer)
+		{
+			pGpuMemory = pBuffer->GetGPUVirtualAddress();
+		}
+	}
+
+	// Pages for small UAV buffers are placed in the pooled heaps like slab pages.
+	BufferAllocationPage(uint32_t index, ID3D12Heap* pHeap, uint64_t heapOffset)
+		: StaticBufferPage(AllocationPageSize)
+		, Index(index)
+		, Uav(true)
+	{
+		pBuffer = Dx12_CreatePlacedBuffer(pHeap, heapOffset, AllocationPageSize, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+
+		if (pBuffer)
+		{
+			pGpuMemory = pBuffer->GetGPUVirtualAddress();
+		}
+	}
+
+	D3D12_GPU_VIRTUAL_ADDRESS GetGpuAddress() { return pGpuMemory; }
+
+	uint64_t GetCopyFence() const { return CopyFence.load(std::memory_order_acquire); }
+	void SetCopyFence(uint64_t fence) { CopyFence.store(fence, std::memory_order_release); }
 
-	void AddFreeBlock(size_t offset, size_t size)
+	Dx12StaticBufferAllocation MakeAllocation(const TlsfAllocation& block) const
 	{
-		FreeBlocksByOffsetMap::iterator newBlockIt = FreeBlocksByOffset.emplace(offset, BufferAllocationBlock{}).first;
-		FreeBlocksBySizeMap::iterator orderIt = FreeBlocksBySize.emplace(size, newBlockIt);
+		Dx12StaticBufferAllocation alloc = { pGpuMemory, (size_t)block.Offset, (size_t)block.Size, pBuffer.Get() };
+
+		alloc.SingleBuffer = false;
+		alloc.UavPage = Uav;
+		alloc.Page = Index;
+		alloc.Block = block.Block;
 
-		newBlockIt->second.OrderBySizeIt = orderIt;
+		return alloc;
 	}
+};
+
+// Large and UAV buffers are placed resources carved out of pooled heaps, buffers bigger than a heap get a dedicated one.
+// A placed resource takes a whole 64KB placement block, so smaller UAV buffers are suballocated from shared UAV pages instead.
+static const size_t PlacementHeapSize = 64u * 1024u * 1024u;
+
+struct BufferPlacementHeap
+{
+private:
+	ComPtr<ID3D12Heap> pHeap = nullptr;
+
+	TlsfAllocator Allocator;
 
 public:
 
-	BufferAllocationPage()
+	explicit BufferPlacementHeap(size_t size)
+		: Allocator(size)
 	{
-		pUploadBuffer = Dx12_CreateBuffer(AllocationPageSize, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE);
-		pBuffer = Dx12_CreateBuffer(AllocationPageSize, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_FLAG_NONE);
+		pHeap = Dx12_CreateBufferHeap(size, D3D12_HEAP_TYPE_DEFAULT);
+	}
+
+	ID3D12Heap* GetHeap() const { return pHeap.Get(); }
+
+	size_t GetSize() const { return (size_t)Allocator.GetSize(); }
+
+	bool IsEmpty() const { return Allocator.GetAllocationCount() == 0u; }
+
+	// Every size is rounded to the placement alignment and heaps start at zero, so every block boundary is already aligned.
+	// Asking for the alignment as well would search for 64KB - 1 bytes of slack a heap sized for the buffer doesn't have.
+	bool Alloc(size_t size, TlsfAllocation& outBlock)
+	{
+		return Allocator.Alloc(AlignUp(size, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT), 1u, outBlock);
+	}
+
+	void Free(const TlsfAllocation& block)
+	{
+		Allocator.Free(block);
+	}
+};
+
+struct BufferAllocationSingleBuffer
+{
+private:
+	uint32_t Index = 0u;
+	std::atomic<uint64_t> CopyFence = 0u;
+
+	size_t Size = 0;
+	D3D12_GPU_VIRTUAL_ADDRESS pGpuMemory = D3D12_GPU_VIRTUAL_ADDRESS{ 0 };
+
+	ComPtr<ID3D12Resource> pBuffer = nullptr;
 
-		pUploadBuffer->Map(0, nullptr, &pCpuMemory);
+	uint32_t HeapIndex = 0u;
+	TlsfAllocation HeapBlock;
 
-		pGpuMemory = pBuffer->GetGPUVirtualAddress();
+public:
+
+	BufferAllocationSingleBuffer(uint32_t index, size_t size, bool uav, uint32_t heapIndex, ID3D12Heap* pHeap, const TlsfAllocation& heapBlock)
+		: Index(index)
+		, Size(size)
+		, HeapIndex(heapIndex)
+		, HeapBlock(heapBlock)
+	{
+		pBuffer = Dx12_CreatePlacedBuffer(pHeap, heapBlock.Offset, size, D3D12_RESOURCE_STATE_COMMON, uav ? D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS : D3D12_RESOURCE_FLAG_NONE);
 
-		AddFreeBlock(0u, AllocationPageSize);
+		if (pBuffer)
+		{
+			pGpuMemory = pBuffer->GetGPUVirtualAddress();
+		}
 	}
 
 	void Release()
 	{
-		pUploadBuffer->Unmap(0, nullptr);
-		pCpuMemory = nullptr;
 		pGpuMemory = D3D12_GPU_VIRTUAL_ADDRESS{ 0 };
 	}
 
 	D3D12_GPU_VIRTUAL_ADDRESS GetGpuAddress() { return pGpuMemory; }
 
-	Dx12StaticBufferAllocation Alloc(size_t size, size_t alignment, const void* const pData)
+	size_t GetSize() const { return Size; }
+
+	uint32_t GetHeapIndex() const { return HeapIndex; }
+	const TlsfAllocation& GetHeapBlock() const { return HeapBlock; }
+
+	uint64_t GetCopyFence() const { return CopyFence.load(std::memory_order_acquire); }
+	void SetCopyFence(uint64_t fence) { CopyFence.store(fence, std::memory_order_release); }
+
+	Dx12StaticBufferAllocation GetAllocation() const
+	{
+		Dx12StaticBufferAllocation alloc = { pGpuMemory, 0, Size, pBuffer.Get(), true };
+		alloc.Page = Index;
+
+		return alloc;
+	}
+};
+
+// Constant buffers live in slab pages so they never fragment the pages used for vertex and index data.
+struct BufferAllocationSlabPage
+{
+private:
+	uint32_t Index = 0u;
+	std::atomic<uint64_t> CopyFence = 0u;
+
+	D3D12_GPU_VIRTUAL_ADDRESS pGpuMemory = D3D12_GPU_VIRTUAL_ADDRESS{ 0 };
+
+	ComPtr<ID3D12Resource> pBuffer = nullptr;
+
+public:
+
+	BufferAllocationSlabPage(uint32_t index, ID3D12Heap* pHeap, uint64_t heapOffset)
+		: Index(index)
+	{
+		pBuffer = Dx12_CreatePlacedBuffer(pHeap, heapOffset, SlabAllocator::PageSize, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_FLAG_NONE);
+
+		if (pBuffer)
+		{
+			pGpuMemory = pBuffer->GetGPUVirtualAddress();
+		}
+	}
+
+	uint64_t GetCopyFence() const { return CopyFence.load(std::memory_order_acquire); }
+	void SetCopyFence(uint64_t fence) { CopyFence.store(fence, std::memory_order_release); }
+
+	Dx12StaticBufferAllocation GetAllocation(const SlabAllocation& slab, size_t size) const
 	{
-		size_t alignedSize = AlignUp(size, alignment);
+		Dx12StaticBufferAllocation alloc = { pGpuMemory, (size_t)slab.Offset, AlignUp(size, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT), pBuffer.Get() };
+
+		alloc.Slab = true;
+		alloc.Page = Index;
+		alloc.Block = slab.Slot;
+
+		return alloc;
+	}
+};
+
+// Safe to allocate, update and free from any thread.
+// Small buffer pages and constant buffer slabs use the api agnostic sets from StaticBufferPool.h.
+// Mutex guards the single buffer and heap arrays, shared to read them and exclusive while slots are added or released.
+// Slow resource creation happens outside it, in slots reserved beforehand. The sets take it last, when a page needs heap memory.
+struct BufferAllocationPool
+{
+	mutable std::shared_mutex Mutex;
 
-		FreeBlocksBySizeMap::const_iterator smallestBlockBySizeIt = FreeBlocksBySize.lower_bound(alignedSize);
-		FreeBlocksByOffsetMap::const_iterator smallestBlockIt = FreeBlocksByOffset.cend();
+	StaticBufferPageSet<BufferAllocationPage> SmallPages;
 
-		size_t alignedOffset = 0;
-		size_t offsetDiff = 0;
+	// Shared pages for UAV buffers smaller than a placement block.
+	// Their buffers are pinned by their descriptors so compaction never empties them, they are kept for reuse.
+	StaticBufferPageSet<BufferAllocationPage> UavPages;
 
-		size_t blockOffset = 0;
-		size_t blockSize = 0;
+	std::vector<std::unique_ptr<BufferAllocationSingleBuffer>> SingleBuffers;
+	std::vector<uint32_t> FreeSingleBuffers;
 
-		while (smallestBlockBySizeIt != FreeBlocksBySize.cend())
+	std::vector<std::unique_ptr<BufferPlacementHeap>> Heaps;
+	std::vector<uint32_t> FreeHeaps;
+
+	// Slab pages are placed in the pooled heaps and kept for reuse by any size class once they empty.
+	StaticBufferSlabSet<BufferAllocationSlabPage> Slabs;
+
+	struct RetiringFrees
+	{
+		std::vector<Dx12StaticBufferAllocation> Allocations;
+
+		uint64_t GraphicsFence = 0u;
+		uint64_t ComputeFence = 0u;
+		uint64_t CopyFence = 0u;
+	};
+
+	// Freed allocations wait for the fences of the frame that freed them before their memory can be handed out again.
+	// Taken on its own, the memory is only released after it is dropped.
+	std::mutex RetiringMutex;
+	std::vector<Dx12StaticBufferAllocation> FreedThisFrame;
+	std::deque<RetiringFrees> Retiring;
+
+	// Buffers created without data are left undefined until they are updated.
+	static void RequestInitialUpload(const Dx12StaticBufferAllocation& alloc, const void* const pData, size_t size)
+	{
+		if (alloc.pGPUMem != 0 && pData != nullptr)
 		{
-			smallestBlockIt = smallestBlockBySizeIt->second;
+			// Using size instead of aligned size is intentional so that the source alloc doesnt also need to be aligned.
+			RequestUpload(alloc.pResource, alloc.Offset, pData, size, GetOwner(alloc), false);
+		}
+	}
 
-			blockSize = smallestBlockBySizeIt->first;
-			blockOffset = smallestBlockIt->first;
+	// Null if the page's resource couldn't be created, a uav page gives its heap memory back.
+	std::unique_ptr<BufferAllocationPage> CreatePage(uint32_t pageIndex, bool uav)
+	{
+		if (!uav)
+		{
+			std::unique_ptr<BufferAllocationPage> page = std::make_unique<BufferAllocationPage>(pageIndex);
+			return page->GetGpuAddress() != 0 ? std::move(page) : nullptr;
+		}
 
-			alignedOffset = AlignUp(blockOffset, alignment);
+		TlsfAllocation heapBlock;
+		uint32_t heapIndex;
+		ID3D12Heap* pHeap;
+		{
+			std::unique_lock lock(Mutex);
 
-			// Calculate the change in alignment, may leave a small initial block.
-			offsetDiff = alignedOffset - blockOffset;
+			heapIndex = AllocFromHeaps_AssumeLocked(AllocationPageSize, heapBlock);
 
-			if ((offsetDiff + alignedSize) <= blockSize)
+			if (heapIndex == InvalidHeap)
 			{
-				break;
+				return nullptr;
 			}
 
-			smallestBlockBySizeIt++;
+			pHeap = Heaps[heapIndex]->GetHeap();
 		}
 
-		if (smallestBlockBySizeIt == FreeBlocksBySize.cend())
+		std::unique_ptr<BufferAllocationPage> page = std::make_unique<BufferAllocationPage>(pageIndex, pHeap, heapBlock.Offset);
+
+		if (page->GetGpuAddress() == 0)
 		{
+			std::unique_lock lock(Mutex);
+
+			FreeFromHeap_AssumeLocked(heapIndex, heapBlock);
+
+			return nullptr;
+		}
+
+		return page;
+	}
+
+	Dx12StaticBufferAllocation AllocSmallBuffer(size_t size, size_t alignment, bool uav)
+	{
+		StaticBufferPageSet<BufferAllocationPage>& pages = uav ? UavPages : SmallPages;
+
+		uint32_t pageIndex;
+		TlsfAllocation block;
+
+		if (!pages.Alloc(size, alignment, [this, uav](uint32_t index) { return CreatePage(index, uav); }, pageIndex, block))
+		{
+			assert(0 && "Failed to allocate small buffer");
+			return {};
+		}
+
+		Dx12StaticBufferAllocation alloc;
+		pages.WithPage(pageIndex, [&alloc, &block](const BufferAllocationPage& page) { alloc = page.MakeAllocation(block); });
+
+		return alloc;
+	}
+
+	// Slab pages are placed in the pooled heaps, called under the slab lock.
+	std::unique_ptr<BufferAllocationSlabPage> CreateSlabPage(uint32_t pageIndex)
+	{
+		std::unique_lock lock(Mutex);
+
+		TlsfAllocation heapBlock;
+		const uint32_t heapIndex = AllocFromHeaps_AssumeLocked(SlabAllocator::PageSize, heapBlock);
+
+		if (heapIndex == InvalidHeap)
+		{
+			return nullptr;
+		}
+
+		return std::make_unique<BufferAllocationSlabPage>(pageIndex, Heaps[heapIndex]->GetHeap(), heapBlock.Offset);
+	}
+
+	static constexpr uint32_t InvalidHeap = ~0u;
+
+	// Returns InvalidHeap if no heap has room and a new one can't be created.
+	uint32_t AllocFromHeaps_AssumeLocked(size_t size, TlsfAllocation& outBlock)
+	{
+		for (uint32_t heapIndex = 0; heapIndex < (uint32_t)Heaps.size(); heapIndex++)
+		{
+			if (Heaps[heapIndex] && Heaps[heapIndex]->Alloc(size, outBlock))
+			{
+				return heapIndex;
+			}
+		}
+
+		uint32_t heapIndex;
+
+		if (!FreeHeaps.empty())
+		{
+			heapIndex = FreeHeaps.back();
+			FreeHeaps.pop_back();
+		}
+		else
+		{
+			heapIndex = (uint32_t)Heaps.size();
+			Heaps.emplace_back();
+		}
+
+		const size_t heapSize = size > PlacementHeapSize ? AlignUp(size, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT) : PlacementHeapSize;
+
+		Heaps[heapIndex] = std::make_unique<BufferPlacementHeap>(heapSize);
+
+		if (!Heaps[heapIndex]->GetHeap() || !Heaps[heapIndex]->Alloc(size, outBlock))
+		{
+			Heaps[heapIndex] = nullptr;
+			FreeHeaps.push_back(heapIndex);
+
+			outBlock = {};
+			return InvalidHeap;
+		}
+
+		return heapIndex;
+	}
+
+	void FreeFromHeap_AssumeLocked(uint32_t heapIndex, const TlsfAllocation& block)
+	{
+		assert(heapIndex < Heaps.size() && Heaps[heapIndex] && "Trying to free from a non-existent heap");
+
+		Heaps[heapIndex]->Free(block);
+
+		// Pooled heaps are kept for reuse, dedicated heaps go as soon as their buffer does.
+		if (Heaps[heapIndex]->IsEmpty() && Heaps[heapIndex]->GetSize() > PlacementHeapSize)
+		{
+			Heaps[heapIndex] = nullptr;
+			FreeHeaps.push_back(heapIndex);
+		}
+	}
+
+	Dx12StaticBufferAllocation AllocSingleBuffer(size_t size, bool uav)
+	{
+		TlsfAllocation heapBlock;
+		uint32_t heapIndex;
+		ID3D12Heap* pHeap;
+
+		uint32_t index;
+		{
+			std::unique_lock lock(Mutex);
+
+			heapIndex = AllocFromHeaps_AssumeLocked(size, heapBlock);
+
+			if (heapIndex == InvalidHeap)
+			{
+				return {};
+			}
+
+			pHeap = Heaps[heapIndex]->GetHeap();
+
+			if (!FreeSingleBuffers.empty())
+			{
+				index = FreeSingleBuffers.back();
+				FreeSingleBuffers.pop_back();
+			}
+			else
+			{
+				index = (uint32_t)SingleBuffers.size();
+				SingleBuffers.emplace_back();
+			}
+		}
+
+		std::unique_ptr<BufferAllocationSingleBuffer> buffer = std::make_unique<BufferAllocationSingleBuffer>(index, size, uav, heapIndex, pHeap, heapBlock);
+
+		const Dx12StaticBufferAllocation alloc = buffer->GetAllocation();
+
+		std::unique_lock lock(Mutex);
+
+		if (alloc.pGPUMem == 0)
+		{
+			FreeFromHeap_AssumeLocked(heapIndex, heapBlock);
+			FreeSingleBuffers.push_back(index);
+
 			return {};
 		}
 
-		if (alignedOffset + alignedSize > AllocationPageSize)
+		SingleBuffers[index] = std::move(buffer);
+
+		return alloc;
+	}
+
+	Dx12StaticBufferAllocation AllocRW(size_t size, size_t alignment, const void* const pData)
+	{
+		assert(size > 0);
+
+		const Dx12StaticBufferAllocation alloc = size < D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT ? AllocSmallBuffer(size, alignment, true) : AllocSingleBuffer(size, true);
+
+		RequestInitialUpload(alloc, pData, size);
+
+		return alloc;
+	}
+
+	Dx12StaticBufferAllocation Alloc(size_t size, size_t alignment, const void* const pData)
+	{
+		assert(size > 0);
+
+		const Dx12StaticBufferAllocation alloc = size < AllocationPageSize ? AllocSmallBuffer(size, alignment, false) : AllocSingleBuffer(AlignUp(size, alignment), false);
+
+		RequestInitialUpload(alloc, pData, size);
+
+		return alloc;
+	}
+
+	Dx12StaticBufferAllocation AllocConstant(size_t size, const void* const pData)
+	{
+		assert(size > 0 && pData != nullptr);
+
+		// Slab pages without backing memory are created again by the next allocation, this one falls back to a page
+		SlabAllocation slab;
+		if (!Slabs.Alloc(size, [this](uint32_t pageIndex) { return CreateSlabPage(pageIndex); }, slab))
+		{
+			return Alloc(size, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, pData);
+		}
+
+		Dx12StaticBufferAllocation alloc;
+		Slabs.WithPage(slab.Page, [&](const BufferAllocationSlabPage& page) { alloc = page.GetAllocation(slab, size); });
+
+		RequestInitialUpload(alloc, pData, size);
+
+		return alloc;
+	}
+
+	// The allocation records its resource, so updates only need to queue the copy.
+	void Update(const Dx12StaticBufferAllocation& alloc, const void* const pData, size_t offset, size_t size)
+	{
+		assert(alloc.Size > 0 && pData != nullptr);
+		assert(offset < alloc.Size && size <= alloc.Size - offset && "Update range is outside of the allocation");
+
+		if (offset >= alloc.Size)
 		{
-			__debugbreak();
+			return;
 		}
 
-		FreeBlocksBySize.erase(smallestBlockBySizeIt);
-		FreeBlocksByOffset.erase(smallestBlockIt);
+		if (offset + size > alloc.Size)
+		{
+			size = alloc.Size - offset;
+		}
 
-		const size_t newOffset = alignedOffset + alignedSize;
-		const size_t newSize = blockSize - alignedSize - offsetDiff;
+		RequestUpload(alloc.pResource, alloc.Offset + offset, pData, size, GetOwner(alloc), true);
+	}
 
-		if (offsetDiff > 0)
+	uint64_t GetCopyFence(const Dx12StaticBufferAllocation& alloc) const
+	{
+		if (alloc.SingleBuffer)
 		{
-			AddFreeBlock(blockOffset, offsetDiff);
+			std::shared_lock lock(Mutex);
+
+			return alloc.Page < SingleBuffers.size() && SingleBuffers[alloc.Page] ? SingleBuffers[alloc.Page]->GetCopyFence() : 0u;
 		}
 
-		if (newSize > 0)
+		uint64_t fence = 0u;
+		auto getFence = [&fence](const auto& page) { fence = page.GetCopyFence(); };
+
+		if (alloc.Slab)
 		{
-			AddFreeBlock(newOffset, newSize);
+			Slabs.WithPage(alloc.Page, getFence);
+		}
+		else
+		{
+			(alloc.UavPage ? UavPages : SmallPages).WithPage(alloc.Page, getFence);
 		}
 
-		// Using size instead of aligned size is intentional so that the source alloc doesnt also need to be aligned.
-		memcpy((uint8_t*)pCpuMemory + alignedOffset, pData, size);
+		return fence;
+	}
 
-		Dx12StaticBufferAllocation alloc = { pGpuMemory, alignedOffset, alignedSize, pBuffer.Get()};
+	void SetCopyFence(BufferAllocationOwner owner, uint64_t fence)
+	{
+		// The slot may have been freed, or reused, since the upload was requested, a later fence is only conservative.
+		if (owner.SingleBuffer)
+		{
+			std::shared_lock lock(Mutex);
+
+			if (owner.Index < SingleBuffers.size() && SingleBuffers[owner.Index])
+			{
+				SingleBuffers[owner.Index]->SetCopyFence(fence);
+			}
+
+			return;
+		}
+
+		auto setFence = [fence](auto& page) { page.SetCopyFence(fence); };
+
+		if (owner.Slab)
+		{
+			Slabs.WithPage(owner.Index, setFence);
+		}
+		else
+		{
+			(owner.UavPage ? UavPages : SmallPages).WithPage(owner.Index, setFence);
+		}
+	}
+
+	size_t GetResidentSize() const
+	{
+		// Slab and uav pages are placed in the heaps
+		size_t size = SmallPages.GetPageCount() * AllocationPageSize;
+
+		std::shared_lock lock(Mutex);
+
+		for (const std::unique_ptr<BufferPlacementHeap>& heap : Heaps)
+		{
+			size += heap ? heap->GetSize() : 0u;
+		}
+
+		return size;
+	}
+
+	// Submitted work, or lists recorded this frame, may still read the allocation, so it goes back to its page, heap or slab after the frame completes.
+	void Free(const Dx12StaticBufferAllocation& alloc)
+	{
+		std::scoped_lock lock(RetiringMutex);
+
+		FreedThisFrame.push_back(alloc);
+	}
+
+	// Call between frames, allocations freed since the last call wait for these fences.
+	void EndFrame(uint64_t graphicsFence, uint64_t computeFence, uint64_t copyFence)
+	{
+		const uint64_t completedGraphicsFence = g_render.DirectQueue.DxFence->GetCompletedValue();
+		const uint64_t completedComputeFence = g_render.ComputeQueue.DxFence->GetCompletedValue();
+		const uint64_t completedCopyFence = g_render.CopyQueue.DxFence->GetCompletedValue();
+
+		std::vector<Dx12StaticBufferAllocation> completed;
+		{
+			std::scoped_lock lock(RetiringMutex);
+
+			if (!FreedThisFrame.empty())
+			{
+				Retiring.push_back({ std::move(FreedThisFrame), graphicsFence, computeFence, copyFence });
+				FreedThisFrame.clear();
+			}
+
+			while (!Retiring.empty() &&
+				Retiring.front().GraphicsFence <= completedGraphicsFence &&
+				Retiring.front().ComputeFence <= completedComputeFence &&
+				Retiring.front().CopyFence <= completedCopyFence)
+			{
+				completed.insert(completed.end(), Retiring.front().Allocations.begin(), Retiring.front().Allocations.end());
+				Retiring.pop_front();
+			}
+		}
+
+		for (const Dx12StaticBufferAllocation& alloc : completed)
+		{
+			FreeRetired(alloc);
+		}
+	}
+
+	void FreeRetired(const Dx12StaticBufferAllocation& alloc)
+	{
+		if (alloc.SingleBuffer)
+		{
+			std::unique_lock lock(Mutex);
+
+			if (alloc.Page < SingleBuffers.size() && SingleBuffers[alloc.Page])
+			{
+				const uint32_t heapIndex = SingleBuffers[alloc.Page]->GetHeapIndex();
+				const TlsfAllocation heapBlock = SingleBuffers[alloc.Page]->GetHeapBlock();
+
+				SingleBuffers[alloc.Page]->Release();
+				SingleBuffers[alloc.Page] = nullptr;
+
+				FreeFromHeap_AssumeLocked(heapIndex, heapBlock);
+
+				FreeSingleBuffers.push_back(alloc.Page);
+			}
+			else
+			{
+				assert(0 && "Trying to free a non-existent allocation");
+			}
+		}
+		else if (alloc.Slab)
+		{
+			SlabAllocation slab;
+			slab.Offset = alloc.Offset;
+			slab.Page = alloc.Page;
+			slab.Slot = alloc.Block;
+
+			Slabs.Free(slab);
+		}
+		else
+		{
+			TlsfAllocation block;
+			block.Offset = alloc.Offset;
+			block.Size = alloc.Size;
+			block.Block = alloc.Block;
+
+			(alloc.UavPage ? UavPages : SmallPages).Free(alloc.Page, block);
+		}
+	}
+};
+
+BufferAllocationPool g_BufferAllocator;
+
+SparseArray<Dx12StaticBufferAllocation, VertexBuffer_t> g_DxVertexBuffers;
+SparseArray<Dx12StaticBufferAllocation, IndexBuffer_t> g_DxIndexBuffers;
+SparseArray<Dx12StaticBufferAllocation, StructuredBuffer_t> g_DxStructuredBuffers;
+SparseArray<Dx12StaticBufferAllocation, ConstantBuffer_t> g_DxConstantBuffers;
+SparseArray<Dx12StaticBufferAllocation, Buffer_t> g_DxGenericBuffers;
+
+// Guards the arrays above, allocations are made before taking it and lookups copy the allocation out.
+// Updates hold it shared until their copy is queued, so compaction can't move a buffer underneath them.
+std::shared_mutex g_DxBuffersMutex;
+
+template<typename Handle>
+static Dx12StaticBufferAllocation GetAllocation(const SparseArray<Dx12StaticBufferAllocation, Handle>& buffers, Handle handle)
+{
+	std::shared_lock lock(g_DxBuffersMutex);
+
+	return buffers.Valid(handle) ? buffers[handle] : Dx12StaticBufferAllocation{};
+}
+
+template<typename Handle>
+static bool SetAllocation(SparseArray<Dx12StaticBufferAllocation, Handle>& buffers, Handle handle, const Dx12StaticBufferAllocation& alloc)
+{
+	std::unique_lock lock(g_DxBuffersMutex);
+
+	buffers.Alloc(handle) = alloc;
+
+	return alloc.pGPUMem != 0;
+}
+
+template<typename Handle>
+static void UpdateAllocation(SparseArray<Dx12StaticBufferAllocation, Handle>& buffers, Handle handle, const void* const data, size_t offset, size_t size)
+{
+	std::shared_lock lock(g_DxBuffersMutex);
+
+	g_BufferAllocator.Update(buffers[handle], data, offset, size);
+}
+
+template<typename Handle>
+static void FreeAllocation(SparseArray<Dx12StaticBufferAllocation, Handle>& buffers, Handle handle)
+{
+	Dx12StaticBufferAllocation alloc;
+	{
+		std::unique_lock lock(g_DxBuffersMutex);
+
+		alloc = buffers[handle];
+		buffers.Free(handle);
+	}
+
+	if (!alloc.View)
+	{
+		g_BufferAllocator.Free(alloc);
+	}
+}
+
+bool CreateVertexBufferImpl(VertexBuffer_t vb, const void* const data, size_t size)
+{
+	return SetAllocation(g_DxVertexBuffers, vb, g_BufferAllocator.Alloc(size, D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT, data));
+}
+
+bool CreateIndexBufferImpl(IndexBuffer_t ib, const void* const data, size_t size)
+{
+	return SetAllocation(g_DxIndexBuffers, ib, g_BufferAllocator.Alloc(size, D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT, data));
+}
+
+bool CreateStructuredBufferImpl(StructuredBuffer_t sb, const void* const data, size_t size, size_t stride, RenderResourceFlags flags)
+{
+	if (HasEnumFlags(flags, RenderResourceFlags::UAV))
+	{
+		return SetAllocation(g_DxStructuredBuffers, sb, g_BufferAllocator.AllocRW(size, stride, data));
+	}
+
+	return SetAllocation(g_DxStructuredBuffers, sb, g_BufferAllocator.Alloc(size, stride, data));
+}
+
+bool CreateConstantBufferImpl(ConstantBuffer_t cb, const void* const data, size_t size)
+{
+	return SetAllocation(g_DxConstantBuffers, cb, g_BufferAllocator.AllocConstant(size, data));
+}
+
+bool CreateBufferImpl(Buffer_t handle, const BufferViews& views, const void* const data, size_t size, size_t stride, BufferUsage usage)
+{
+	Dx12StaticBufferAllocation alloc;
+
+	// Structured views need the offset to be a whole number of elements
+	const size_t alignment = HasEnumFlags(usage, BufferUsage::STRUCTURED) ? stride : D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT;
+
+	if (HasEnumFlags(usage, BufferUsage::UAV))
+	{
+		alloc = g_BufferAllocator.AllocRW(size, alignment, data);
+	}
+	else
+	{
+		alloc = g_BufferAllocator.Alloc(size, alignment, data);
+	}
+
+	if (alloc.pGPUMem == 0)
+	{
+		return false;
+	}
 
-		RequestUploadAlloc(alloc, pBuffer.Get(), pUploadBuffer.Get());
+	Dx12StaticBufferAllocation view = alloc;
+	view.View = true;
 
-		//FreeSize -= size;
+	std::unique_lock lock(g_DxBuffersMutex);
 
-		alloc.SingleBuffer = false;
+	g_DxGenericBuffers.Alloc(handle) = alloc;
 
-		return alloc;
+	if (views.Vertex != VertexBuffer_t::INVALID)
+	{
+		g_DxVertexBuffers.Alloc(views.Vertex) = view;
 	}
 
-	void Update(const Dx12StaticBufferAllocation& alloc, const void* const pData)
+	if (views.Index != IndexBuffer_t::INVALID)
 	{
-		memcpy((uint8_t*)pCpuMemory + alloc.Offset, pData, alloc.Size);
-
-		RequestUploadAlloc(alloc, pBuffer.Get(), pUploadBuffer.Get());
+		g_DxIndexBuffers.Alloc(views.Index) = view;
 	}
 
-	void Free(const Dx12StaticBufferAllocation& alloc)
+	if (views.Structured != StructuredBuffer_t::INVALID)
 	{
-		FreeBlocksByOffsetMap::iterator nextBlockIt = FreeBlocksByOffset.upper_bound(alloc.Offset);
-		FreeBlocksByOffsetMap::iterator prevBlockIt = nextBlockIt != FreeBlocksByOffset.begin() ? --nextBlockIt : FreeBlocksByOffset.end();
-
-		size_t newSize, newOffset;
+		g_DxStructuredBuffers.Alloc(views.Structured) = view;
+	}
 
-		if (prevBlockIt != FreeBlocksByOffset.end() && alloc.Offset == prevBlockIt->first + prevBlockIt->second.Size())
-		{
-			newSize = prevBlockIt->second.Size() + alloc.Size;
-			newOffset = prevBlockIt->first;
+	return true;
+}
 
-			if (nextBlockIt != FreeBlocksByOffset.end() && alloc.Offset + alloc.Size == nextBlockIt->first)
-			{
-				newSize += nextBlockIt->second.Size();
+void UpdateVertexBufferImpl(VertexBuffer_t vb, const void* const data, size_t offset, size_t size)
+{
+	UpdateAllocation(g_DxVertexBuffers, vb, data, offset, size);
+}
 
-				FreeBlocksBySize.erase(prevBlockIt->second.OrderBySizeIt);
-				FreeBlocksBySize.erase(nextBlockIt->second.OrderBySizeIt);
+void UpdateIndexBufferImpl(IndexBuffer_t ib, const void* const data, size_t offset, size_t size)
+{
+	UpdateAllocation(g_DxIndexBuffers, ib, data, offset, size);
+}
 
-				FreeBlocksByOffset.erase(prevBlockIt, ++nextBlockIt);
-			}
-			else
-			{
-				FreeBlocksBySize.erase(prevBlockIt->second.OrderBySizeIt);
+void UpdateConstantBufferImpl(ConstantBuffer_t cb, const void* const data, size_t size)
+{
+	UpdateAllocation(g_DxConstantBuffers, cb, data, 0u, size);
+}
 
-				FreeBlocksByOffset.erase(prevBlockIt);
-			}
-		}
-		else if (nextBlockIt != FreeBlocksByOffset.end() && alloc.Offset + alloc.Size == nextBlockIt->first)
-		{
-			newSize = alloc.Size + nextBlockIt->second.Size();
-			newOffset = alloc.Offset;
+void UpdateStructuredBufferImpl(StructuredBuffer_t sb, const void* const data, size_t offset, size_t size)
+{
+	UpdateAllocation(g_DxStructuredBuffers, sb, data, offset, size);
+}
 
-			FreeBlocksBySize.erase(nextBlockIt->second.OrderBySizeIt);
+void UpdateBufferImpl(Buffer_t buf, const void* const data, size_t offset, size_t size)
+{
+	UpdateAllocation(g_DxGenericBuffers, buf, data, offset, size);
+}
 
-			FreeBlocksByOffset.erase(nextBlockIt);
-		}
-		else
-		{
-			newSize = alloc.Size;
-			newOffset = alloc.Offset;
-		}
+void DestroyVertexBuffer(VertexBuffer_t vb)
+{
+	FreeAllocation(g_DxVertexBuffers, vb);
+}
 
-		AddFreeBlock(newOffset, newSize);
+void DestroyIndexBuffer(IndexBuffer_t ib)
+{
+	FreeAllocation(g_DxIndexBuffers, ib);
+}
 
-		//FreeSize += newSize;
-	}
-};
+void DestroyStructuredBuffer(StructuredBuffer_t sb)
+{
+	FreeAllocation(g_DxStructuredBuffers, sb);
+}
 
-struct BufferAllocationSingleBuffer
+void DestroyConstantBuffer(ConstantBuffer_t cb)
 {
-private:
-	size_t Size = 0;
-	void* pCpuMemory = nullptr;
-	D3D12_GPU_VIRTUAL_ADDRESS pGpuMemory = D3D12_GPU_VIRTUAL_ADDRESS{ 0 };
+	FreeAllocation(g_DxConstantBuffers, cb);
+}
 
-	ComPtr<ID3D12Resource> pUploadBuffer = nullptr;
-	ComPtr<ID3D12Resource> pBuffer = nullptr;
+void DestroyBuffer(Buffer_t buf)
+{
+	FreeAllocation(g_DxGenericBuffers, buf);
+}
 
-public:
+static void SetOwnerCopyFence(BufferAllocationOwner owner, uint64_t fence)
+{
+	g_BufferAllocator.SetCopyFence(owner, fence);
+}
 
-	BufferAllocationSingleBuffer(size_t size, bool uav)
-		: Size(size)
+// Records the requests on one copy list and returns its copy fence.
+static uint64_t SubmitUploadBatch_AssumeLocked(std::vector<BufferAllocationUploadRequest>::iterator begin, std::vector<BufferAllocationUploadRequest>::iterator end, bool update)
+{
+	if (update)
 	{
-		pUploadBuffer = Dx12_CreateBuffer(size, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE);
-		pBuffer = Dx12_CreateBuffer(size, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON, uav ? D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS : D3D12_RESOURCE_FLAG_NONE);
+		WaitForSubmittedWork(g_render.CopyQueue.DxCommandQueue.Get());
+	}
 
-		pUploadBuffer->Map(0, nullptr, &pCpuMemory);
+	// Buffers in the common state are promoted to copy dest on the copy queue and decay back once it completes, so no barriers are needed.
+	CommandListPtr uploadCl = CommandList::Create(CommandListType::COPY);
 
-		pGpuMemory = pBuffer->GetGPUVirtualAddress();
-	}
+	ID3D12GraphicsCommandList* dxcl = Dx12_GetCommandList(uploadCl.get());
 
-	void Release()
+	std::vector<BufferCopyRegion> copies;
+	copies.reserve(end - begin);
+
+	for (auto it = begin; it != end; it++)
 	{
-		pUploadBuffer->Unmap(0, nullptr);
-		pCpuMemory = nullptr;
-		pGpuMemory = D3D12_GPU_VIRTUAL_ADDRESS{ 0 };
+		copies.push_back({ it->pDst.Get(), it->DstOffset, it->pSrc, it->SrcOffset, it->Size });
 	}
 
-	D3D12_GPU_VIRTUAL_ADDRESS GetGpuAddress() { return pGpuMemory; }
+	CoalesceBufferCopies(copies);
 
-	Dx12StaticBufferAllocation Alloc(size_t size, const void* const pData)
+	for (const BufferCopyRegion& copy : copies)
 	{
-		if (size > Size)
-		{
-			return Dx12StaticBufferAllocation{};
-		}
+		dxcl->CopyBufferRegion((ID3D12Resource*)copy.Dst, copy.DstOffset, (ID3D12Resource*)copy.Src, copy.SrcOffset, copy.Size);
+	}
 
-		memcpy((uint8_t*)pCpuMemory, pData, size);
+	CommandList::Execute(uploadCl);
 
-		Dx12StaticBufferAllocation alloc = { pGpuMemory, 0, size, pBuffer.Get(), true };
+	const uint64_t copyFence = Dx12_GetCommandListFenceValue(uploadCl.get());
 
-		RequestUploadAlloc(alloc, pBuffer.Get(), pUploadBuffer.Get());
+	for (auto it = begin; it != end; it++)
+	{
+		g_BufferAllocator.SetCopyFence(it->Owner, copyFence);
 
-		return alloc;
+		g_submittedUploads.emplace_back(std::move(it->pDst), copyFence);
 	}
 
-	void Update(const void* const data)
+	g_lastUploadCopyFence = copyFence;
+
+	return copyFence;
+}
+
+static void SubmitUploads_AssumeLocked(CommandList* cl)
+{
+	std::vector<BufferAllocationUploadRequest> requests;
+	g_uploadRequests.PopAll(requests);
+
+	if (requests.empty())
+		return;
+
+	// Initial uploads and compaction moves are submitted first without waiting, so streaming isn't held behind rendering.
+	// Only the updates wait for earlier graphics and compute work, an update can't target a buffer before its initial upload or move is queued.
+	const auto updates = std::stable_partition(requests.begin(), requests.end(), [](const BufferAllocationUploadRequest& request) { return !request.Update; });
+
+	uint64_t copyFence = 0u;
+
+	if (updates != requests.begin())
 	{
-		memcpy((uint8_t*)pCpuMemory, data, Size);
+		copyFence = SubmitUploadBatch_AssumeLocked(requests.begin(), updates, false);
+	}
 
-		Dx12StaticBufferAllocation alloc = { pGpuMemory, 0, Size, pBuffer.Get(), true};
+	if (updates != requests.end())
+	{
+		copyFence = SubmitUploadBatch_AssumeLocked(updates, requests.end(), true);
+	}
 
-		RequestUploadAlloc(alloc, pBuffer.Get(), pUploadBuffer.Get());
+	// Buffers can also be used through descriptors, so the list given here waits for the whole batch.
+	if (cl)
+	{
+		Dx12_WaitForCopyQueue(cl, copyFence);
 	}
-};
+}
 
-struct BufferAllocationPool
+void UploadBuffers(CommandList* cl)
 {
-	std::vector<std::unique_ptr<BufferAllocationPage>> Pages;
-	std::vector<BufferAllocationSingleBuffer> SingleBuffers;
+	std::scoped_lock submitLock(g_uploadSubmitMutex);
 
-	Dx12StaticBufferAllocation AllocSmallBuffer(size_t size, size_t alignment, const void* const pData)
-	{
-		assert(size > 0 && pData != nullptr);
+	SubmitUploads_AssumeLocked(cl);
+}
 
-		Dx12StaticBufferAllocation alloc = {};
+uint64_t GetBufferUploadFence()
+{
+	std::scoped_lock submitLock(g_uploadSubmitMutex);
 
-		for (std::unique_ptr<BufferAllocationPage>& page : Pages)
-		{
-			alloc = page->Alloc(size, alignment, pData);
+	// The calling thread's requests are already queued, so submitting the queue covers them
+	SubmitUploads_AssumeLocked(nullptr);
 
-			if (alloc.Size > 0)
-			{
-				return alloc;
-			}
-		}
+	return g_lastUploadCopyFence;
+}
+
+bool IsBufferUploadComplete(uint64_t fence)
+{
+	return g_render.CopyQueue.DxFence->GetCompletedValue() >= fence;
+}
 
-		std::unique_ptr<BufferAllocationPage>& page = Pages.emplace_back(std::make_unique<BufferAllocationPage>());
+// Pages emptied by compaction, released once the moves have landed and submitted work has finished reading the old copies.
+struct RetiringPage
+{
+	uint32_t Page = 0u;
 
-		alloc = page->Alloc(size, alignment, pData);
+	uint64_t GraphicsFence = 0u;
+	uint64_t ComputeFence = 0u;
+	uint64_t CopyFence = 0u;
+};
 
-		if (alloc.Size < size)
-		{
-			assert(0 && "Failed to allocate small buffer");
-		}
+std::deque<RetiringPage> g_retiringPages;
 
-		return alloc;
-	}
+static BufferFragmentationReport GetFragmentationReport(const DefragStats& stats)
+{
+	BufferFragmentationReport report;
+	report.PageCount = stats.PageCount;
+	report.ReservedBytes = (size_t)stats.ReservedBytes;
+	report.UsedBytes = (size_t)stats.UsedBytes;
 
-	Dx12StaticBufferAllocation AllocLargeBuffer(size_t size, const void* const pData)
-	{
-		assert(size > 0 && pData != nullptr);
+	return report;
+}
 
-		BufferAllocationSingleBuffer& buffer = SingleBuffers.emplace_back(size, false);
+BufferCompactionReport CompactBuffers(size_t byteBudget)
+{
+	// Waits for in flight updates to be queued, then submits them so the moves copy their results.
+	std::unique_lock buffersLock(g_DxBuffersMutex);
 
-		return buffer.Alloc(size, pData);
-	}
+	UploadBuffers(nullptr);
 
-	Dx12StaticBufferAllocation AllocRW(size_t size, const void* const pData)
-	{
-		assert(size > 0 && pData != nullptr);
+	StaticBufferPageSet<BufferAllocationPage>& smallPages = g_BufferAllocator.SmallPages;
 
-		BufferAllocationSingleBuffer& buffer = SingleBuffers.emplace_back(size, true);
+	std::unique_lock poolLock(smallPages.Mutex);
 
-		return buffer.Alloc(size, pData);
-	}
+	std::vector<DefragPage> pages;
+	std::vector<uint32_t> defragPageIndices(smallPages.Pages.size(), ~0u);
 
-	Dx12StaticBufferAllocation Alloc(size_t size, size_t alignment, const void* const pData)
+	for (uint32_t pageIndex = 0; pageIndex < (uint32_t)smallPages.Pages.size(); pageIndex++)
 	{
-		assert(size > 0 && pData != nullptr);
+		BufferAllocationPage* page = smallPages.Pages[pageIndex].get();
 
-		if (size < AllocationPageSize)
-		{
-			return AllocSmallBuffer(size, alignment, pData);
-		}
-		else
+		if (page && !page->IsRetiring())
 		{
-			size_t alignedSize = AlignUp(size, alignment);
-			return AllocLargeBuffer(alignedSize, pData);
+			defragPageIndices[pageIndex] = (uint32_t)pages.size();
+
+			DefragPage& defragPage = pages.emplace_back();
+			defragPage.Page = pageIndex;
+			defragPage.Allocator = &page->GetAllocator();
 		}
 	}
 
-	void Update(const Dx12StaticBufferAllocation& alloc, const void* const pData)
-	{
-		assert(alloc.Size > 0 && pData != nullptr);
+	// Vertex, index and constant buffers are addressed when they are bound so they can move freely.
+	// Structured, byte and generic buffers have their resource and offset baked into descriptors or shared between views, they pin their pages.
+	std::vector<Dx12StaticBufferAllocation*> movables;
 
-		if (alloc.SingleBuffer)
+	auto addMovable = [&](Dx12StaticBufferAllocation& alloc, size_t alignment)
+	{
+		if (alloc.pGPUMem == 0 || alloc.SingleBuffer || alloc.Slab || alloc.UavPage || alloc.View || alloc.Page >= defragPageIndices.size() || defragPageIndices[alloc.Page] == ~0u)
 		{
-			auto it = SingleBuffers.begin();
-			for (; it != SingleBuffers.end(); it++)
-			{
-				if (it->GetGpuAddress() == alloc.pGPUMem)
-				{
-					it->Update(pData);
-
-					return;
-				}
-			}
+			return;
 		}
-		else
-		{
-			auto it = Pages.begin();
-			for (; it != Pages.end(); it++)
-			{
-				if (it->get()->GetGpuAddress() == alloc.pGPUMem)
-				{
-					it->get()->Update(alloc, pData);
 
-					return;
-				}
-			}
-		}
+		pages[defragPageIndices[alloc.Page]].Allocations.push_back({ (uint32_t)movables.size(), alloc.Offset, alloc.Size, alignment });
 
-		assert(0 && "Trying to free a non-existent allocation");
-	}
+		movables.push_back(&alloc);
+	};
 
-	void Free(const Dx12StaticBufferAllocation& alloc)
+	for (Dx12StaticBufferAllocation& alloc : g_DxVertexBuffers)
 	{
-		if (alloc.SingleBuffer)
-		{
-			auto it = SingleBuffers.begin();
-			for (; it != SingleBuffers.end(); it++)
-			{
-				if (it->GetGpuAddress() == alloc.pGPUMem)
-				{
-					break;
-				}
-			}
-
-			if (it != SingleBuffers.end())
-			{
-				it->Release();
-				SingleBuffers.erase(it);
-			}
-			else
-			{
-				assert(0 && "Trying to free a non-existent allocation");
-			}
-		}
-		else
-		{
-			auto it = Pages.begin();
-			for (; it != Pages.end(); it++)
-			{
-				if (it->get()->GetGpuAddress() == alloc.pGPUMem)
-				{
-					it->get()->Free(alloc);
-				}
-			}
-		}
+		addMovable(alloc, D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT);
 	}
-};
-
-BufferAllocationPool g_BufferAllocator;
 
-SparseArray<Dx12StaticBufferAllocation, VertexBuffer_t> g_DxVertexBuffers;
-SparseArray<Dx12StaticBufferAllocation, IndexBuffer_t> g_DxIndexBuffers;
-SparseArray<Dx12StaticBufferAllocation, StructuredBuffer_t> g_DxStructuredBuffers;
-SparseArray<Dx12StaticBufferAllocation, ConstantBuffer_t> g_DxConstantBuffers;
+	for (Dx12StaticBufferAllocation& alloc : g_DxIndexBuffers)
+	{
+		addMovable(alloc, D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT);
+	}
 
-bool CreateVertexBufferImpl(VertexBuffer_t vb, const void* const data, size_t size)
-{
-	g_DxVertexBuffers.Alloc(vb);
+	for (Dx12StaticBufferAllocation& alloc : g_DxConstantBuffers)
+	{
+		addMovable(alloc, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+	}
 
-	g_DxVertexBuffers[vb] = g_BufferAllocator.Alloc(size, D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT, data);
+	for (DefragPage& page : pages)
+	{
+		page.Pinned = page.Allocator->GetAllocationCount() != (uint32_t)page.Allocations.size();
+	}
 
-	return g_DxVertexBuffers[vb].pGPUMem != 0;
-}
+	const DefragPlan plan = PlanDefrag(pages, byteBudget);
 
-bool CreateIndexBufferImpl(IndexBuffer_t ib, const void* const data, size_t size)
-{
-	g_DxIndexBuffers.Alloc(ib);
+	for (const DefragMove& move : plan.Moves)
+	{
+		Dx12StaticBufferAllocation& alloc = *movables[move.Id];
 
-	g_DxIndexBuffers[ib] = g_BufferAllocator.Alloc(size, D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT, data);
+		const Dx12StaticBufferAllocation moved = smallPages.Pages[move.DstPage]->MakeAllocation(move.Dst);
 
-	return g_DxIndexBuffers[ib].pGPUMem != 0;
-}
+		// The old copy stays allocated until its page is released, so the handle can point at the new one straight away.
+		g_uploadRequests.Push({ moved.pResource, moved.Offset, alloc.pResource, alloc.Offset, alloc.Size, GetOwner(moved), false });
 
-bool CreateStructuredBufferImpl(StructuredBuffer_t sb, const void* const data, size_t size, size_t stride, RenderResourceFlags flags)
-{
-	g_DxStructuredBuffers.Alloc(sb);
+		alloc = moved;
+	}
 
-	if (HasEnumFlags(flags, RenderResourceFlags::UAV))
+	for (uint32_t page : plan.EvacuatedPages)
 	{
-		g_DxStructuredBuffers[sb] = g_BufferAllocator.AllocRW(size, data);
+		smallPages.Pages[page]->SetRetiring();
 	}
-	else
-	{
-		size_t alignment = stride < D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT ? D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT : stride;
 
-		g_DxStructuredBuffers[sb] = g_BufferAllocator.Alloc(size, stride, data);
+	// No page lock is held here, but the pages are locked exclusively so nothing else can be publishing
+	for (const DefragPage& page : pages)
+	{
+		smallPages.Publish(page.Page, smallPages.Pages[page.Page]->GetLargestFreeBlock());
 	}
 
-	return g_DxStructuredBuffers[sb].pGPUMem != 0;
-}
-
-bool CreateConstantBufferImpl(ConstantBuffer_t cb, const void* const data, size_t size)
-{
-	g_DxConstantBuffers.Alloc(cb);
+	poolLock.unlock();
 
-	g_DxConstantBuffers[cb] = g_BufferAllocator.Alloc(size, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, data);
+	if (!plan.Moves.empty())
+	{
+		UploadBuffers(nullptr);
 
-	return g_DxConstantBuffers[cb].pGPUMem != 0;
-}
+		const uint64_t graphicsFence = Dx12_Signal(CommandListType::GRAPHICS);
+		const uint64_t computeFence = Dx12_Signal(CommandListType::COMPUTE);
 
-void UpdateVertexBufferImpl(VertexBuffer_t vb, const void* const data, size_t size)
-{
-	g_BufferAllocator.Update(g_DxVertexBuffers[vb], data);
-}
+		for (uint32_t page : plan.EvacuatedPages)
+		{
+			g_retiringPages.push_back({ page, graphicsFence, computeFence, g_render.CopyQueue.FenceValue });
+		}
+	}
 
-void UpdateIndexBufferImpl(IndexBuffer_t ib, const void* const data, size_t size)
-{
-	g_BufferAllocator.Update(g_DxIndexBuffers[ib], data);
-}
+	BufferCompactionReport report;
+	report.Before = GetFragmentationReport(plan.Before);
+	report.After = GetFragmentationReport(plan.After);
+	report.MovedBytes = (size_t)plan.MovedBytes;
+	report.MovedBuffers = (uint32_t)plan.Moves.size();
+	report.ReleasedPages = (uint32_t)plan.EvacuatedPages.size();
 
-void UpdateConstantBufferImpl(ConstantBuffer_t cb, const void* const data, size_t size)
-{
-	g_BufferAllocator.Update(g_DxConstantBuffers[cb], data);
+	return report;
 }
 
-void UpdateStructuredBufferImpl(StructuredBuffer_t sb, const void* const data, size_t size)
+void Dx12_StaticBuffersEndFrame()
 {
-	g_BufferAllocator.Update(g_DxStructuredBuffers[sb], data);
-}
+	// Waits for other threads to queue what they have staged, then submits it so the ring's copy fence covers every staged byte.
+	std::unique_lock uploadLock(g_uploadMutex);
 
-void DestroyVertexBuffer(VertexBuffer_t vb)
-{
-	g_BufferAllocator.Free(g_DxVertexBuffers[vb]);
-	g_DxVertexBuffers.Free(vb);
-}
+	UploadBuffers(nullptr);
 
-void DestroyIndexBuffer(IndexBuffer_t ib)
-{
-	g_BufferAllocator.Free(g_DxIndexBuffers[ib]);
-	g_DxIndexBuffers.Free(ib);
-}
+	const uint64_t graphicsFrameFence = Dx12_Signal(CommandListType::GRAPHICS);
+	const uint64_t computeFrameFence = Dx12_Signal(CommandListType::COMPUTE);
 
-void DestroyStructuredBuffer(StructuredBuffer_t sb)
-{
-	g_BufferAllocator.Free(g_DxStructuredBuffers[sb]);
-	g_DxStructuredBuffers.Free(sb);
-}
+	const uint64_t copyFrameFence = g_render.CopyQueue.FenceValue;
 
-void DestroyConstantBuffer(ConstantBuffer_t cb)
-{
-	g_BufferAllocator.Free(g_DxConstantBuffers[cb]);
-	g_DxConstantBuffers.Free(cb);
-}
+	g_stagingRing.Submit(copyFrameFence);
 
-void UploadBuffers(CommandList* cl)
-{
-	if (g_uploadRequests.empty())
-		return;
+	uploadLock.unlock();
 
-	ID3D12GraphicsCommandList* dxcl = Dx12_GetCommandList(cl);
+	// Copies still queued for freed buffers are submitted ahead of any upload to the memory's next owner, the copy queue runs them in order
+	g_BufferAllocator.EndFrame(graphicsFrameFence, computeFrameFence, copyFrameFence);
 
-	std::vector<D3D12_RESOURCE_BARRIER> barriers;
-	barriers.reserve(g_uploadTargetBuffers.size());
+	const uint64_t completedCopyFence = g_render.CopyQueue.DxFence->GetCompletedValue();
 
-	for (ID3D12Resource* pDst : g_uploadTargetBuffers)
 	{
-		barriers.emplace_back(Dx12_TransitionBarrier(pDst, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_COPY_DEST));
+		std::scoped_lock submitLock(g_uploadSubmitMutex);
+
+		// Chunked uploads complete out of order with the batches, so drop every finished one
+		std::erase_if(g_submittedUploads, [completedCopyFence](const SubmittedUpload& upload) { return upload.CopyFence <= completedCopyFence; });
 	}
 
-	dxcl->ResourceBarrier((UINT)barriers.size(), barriers.data());
+	const uint64_t completedGraphicsFence = g_render.DirectQueue.DxFence->GetCompletedValue();
+	const uint64_t completedComputeFence = g_render.ComputeQueue.DxFence->GetCompletedValue();
 
-	for (BufferAllocationUploadRequest& request : g_uploadRequests)
+	while (!g_retiringPages.empty() &&
+		g_retiringPages.front().GraphicsFence <= completedGraphicsFence &&
+		g_retiringPages.front().ComputeFence <= completedComputeFence &&
+		g_retiringPages.front().CopyFence <= completedCopyFence)
 	{
-		dxcl->CopyBufferRegion(request.pDst, request.Allocation.Offset, request.pSrc, request.Allocation.Offset, request.Allocation.Size);
+		g_BufferAllocator.SmallPages.ReleasePage(g_retiringPages.front().Page);
+		g_retiringPages.pop_front();
 	}
+}
 
-	for (D3D12_RESOURCE_BARRIER& barrier : barriers)
-	{
-		barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
-		barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_GENERIC_READ;
-	}
+BufferResidencyReport GetBufferResidencyReport()
+{
+	BufferResidencyReport report;
+	report.DeviceBytes = g_BufferAllocator.GetResidentSize();
+	report.StagingBytes = g_stagingRing.GetResidentSize();
 
-	dxcl->ResourceBarrier((UINT)barriers.size(), barriers.data());
+	// Every static buffer used to keep a mapped upload mirror the same size as its device memory
+	report.SavedBytes = report.DeviceBytes > report.StagingBytes ? report.DeviceBytes - report.StagingBytes : 0u;
 
-	g_uploadRequests.clear();
-	g_uploadTargetBuffers.clear();
+	return report;
 }
 
 Dx12StaticBufferAllocation Dx12_CreateByteBuffer(const void* const Data, size_t Size)
@@ -560,7 +1475,7 @@ Dx12StaticBufferAllocation Dx12_CreateByteBuffer(const void* const Data, size_t
 
 Dx12StaticBufferAllocation Dx12_CreateRWByteBuffer(const void* const Data, size_t Size)
 {
-	return g_BufferAllocator.AllocRW(Size, Data);
+	return g_BufferAllocator.AllocRW(Size, D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT, Data);
 }
 
 D3D12_GPU_VIRTUAL_ADDRESS Dx12_GetByteBufferAddress(const Dx12StaticBufferAllocation& Alloc)
@@ -578,18 +1493,50 @@ void Dx12_FreeByteBuffer(const Dx12StaticBufferAllocation& Alloc)
 	g_BufferAllocator.Free(Alloc);
 }
 
+uint64_t Dx12_GetCopyFence(VertexBuffer_t vb)
+{
+	const Dx12StaticBufferAllocation alloc = GetAllocation(g_DxVertexBuffers, vb);
+	return alloc.pGPUMem != 0 ? g_BufferAllocator.GetCopyFence(alloc) : 0u;
+}
+
+uint64_t Dx12_GetCopyFence(IndexBuffer_t ib)
+{
+	const Dx12StaticBufferAllocation alloc = GetAllocation(g_DxIndexBuffers, ib);
+	return alloc.pGPUMem != 0 ? g_BufferAllocator.GetCopyFence(alloc) : 0u;
+}
+
+uint64_t Dx12_GetCopyFence(StructuredBuffer_t sb)
+{
+	const Dx12StaticBufferAllocation alloc = GetAllocation(g_DxStructuredBuffers, sb);
+	return alloc.pGPUMem != 0 ? g_BufferAllocator.GetCopyFence(alloc) : 0u;
+}
+
+uint64_t Dx12_GetCopyFence(ConstantBuffer_t cb)
+{
+	const Dx12StaticBufferAllocation alloc = GetAllocation(g_DxConstantBuffers, cb);
+	return alloc.pGPUMem != 0 ? g_BufferAllocator.GetCopyFence(alloc) : 0u;
+}
+
+// Vertex and index buffer views have 32 bit sizes, larger buffers can only be bound through their first 4GB.
+static UINT GetViewSize(const Dx12StaticBufferAllocation& alloc, uint32_t offset)
+{
+	const size_t size = offset < alloc.Size ? alloc.Size - offset : 0u;
+
+	return size < (size_t)UINT32_MAX ? (UINT)size : UINT32_MAX;
+}
+
 D3D12_VERTEX_BUFFER_VIEW Dx12_GetVertexBufferView(VertexBuffer_t vb, uint32_t offset, uint32_t stride)
 {
-	if (!g_DxVertexBuffers.Valid(vb))
+	const Dx12StaticBufferAllocation alloc = GetAllocation(g_DxVertexBuffers, vb);
+
+	if (alloc.pGPUMem == 0)
 	{
 		return {};
 	}
 
-	const Dx12StaticBufferAllocation& alloc = g_DxVertexBuffers[vb];
-
 	D3D12_VERTEX_BUFFER_VIEW view;
 	view.BufferLocation = alloc.pGPUMem + (D3D12_GPU_VIRTUAL_ADDRESS)alloc.Offset + (D3D12_GPU_VIRTUAL_ADDRESS)offset;
-	view.SizeInBytes = (UINT)alloc.Size;
+	view.SizeInBytes = GetViewSize(alloc, offset);
 	view.StrideInBytes = (UINT)stride;
 
 	return view;
@@ -597,16 +1544,16 @@ D3D12_VERTEX_BUFFER_VIEW Dx12_GetVertexBufferView(VertexBuffer_t vb, uint32_t of
 
 D3D12_INDEX_BUFFER_VIEW Dx12_GetIndexBufferView(IndexBuffer_t ib, RenderFormat format, uint32_t offset)
 {
-	if (!g_DxIndexBuffers.Valid(ib))
+	const Dx12StaticBufferAllocation alloc = GetAllocation(g_DxIndexBuffers, ib);
+
+	if (alloc.pGPUMem == 0)
 	{
 		return {};
 	}
 
-	const Dx12StaticBufferAllocation& alloc = g_DxIndexBuffers[ib];
-
 	D3D12_INDEX_BUFFER_VIEW view;
 	view.BufferLocation = alloc.pGPUMem + (D3D12_GPU_VIRTUAL_ADDRESS)alloc.Offset + (D3D12_GPU_VIRTUAL_ADDRESS)offset;
-	view.SizeInBytes = (UINT)alloc.Size;
+	view.SizeInBytes = GetViewSize(alloc, offset);
 	view.Format = Dx12_Format(format);
 
 	return view;
@@ -614,71 +1561,60 @@ D3D12_INDEX_BUFFER_VIEW Dx12_GetIndexBufferView(IndexBuffer_t ib, RenderFormat f
 
 D3D12_GPU_VIRTUAL_ADDRESS Dx12_GetCbvAddress(ConstantBuffer_t cb)
 {
-	if (!g_DxConstantBuffers.Valid(cb))
+	const Dx12StaticBufferAllocation alloc = GetAllocation(g_DxConstantBuffers, cb);
+
+	if (alloc.pGPUMem == 0)
 	{
 		return {};
 	}
 
-	const Dx12StaticBufferAllocation& alloc = g_DxConstantBuffers[cb];
-
 	return alloc.pGPUMem + (D3D12_GPU_VIRTUAL_ADDRESS)alloc.Offset;
 }
 
 D3D12_GPU_VIRTUAL_ADDRESS Dx12_GetVbAddress(VertexBuffer_t vb)
 {
-	if (!g_DxVertexBuffers.Valid(vb))
+	const Dx12StaticBufferAllocation alloc = GetAllocation(g_DxVertexBuffers, vb);
+
+	if (alloc.pGPUMem == 0)
 	{
 		return (D3D12_GPU_VIRTUAL_ADDRESS)0;
 	}
 
-	const Dx12StaticBufferAllocation& alloc = g_DxVertexBuffers[vb];
 	return alloc.pGPUMem + (D3D12_GPU_VIRTUAL_ADDRESS)alloc.Offset;
 }
 
 D3D12_GPU_VIRTUAL_ADDRESS Dx12_GetIbAddress(IndexBuffer_t ib)
 {
-	if (!g_DxIndexBuffers.Valid(ib))
+	const Dx12StaticBufferAllocation alloc = GetAllocation(g_DxIndexBuffers, ib);
+
+	if (alloc.pGPUMem == 0)
 	{
 		return (D3D12_GPU_VIRTUAL_ADDRESS)0;
 	}
 
-	const Dx12StaticBufferAllocation& alloc = g_DxIndexBuffers[ib];
 	return alloc.pGPUMem + (D3D12_GPU_VIRTUAL_ADDRESS)alloc.Offset;
 }
 
 D3D12_GPU_VIRTUAL_ADDRESS Dx12_GetSbAddress(StructuredBuffer_t sb)
 {
-	if (!g_DxStructuredBuffers.Valid(sb))
+	const Dx12StaticBufferAllocation alloc = GetAllocation(g_DxStructuredBuffers, sb);
+
+	if (alloc.pGPUMem == 0)
 	{
 		return (D3D12_GPU_VIRTUAL_ADDRESS)0;
 	}
 
-	const Dx12StaticBufferAllocation& alloc = g_DxStructuredBuffers[sb];
 	return alloc.pGPUMem + (D3D12_GPU_VIRTUAL_ADDRESS)alloc.Offset;
 }
 
 ID3D12Resource* Dx12_GetBufferResource(StructuredBuffer_t sb)
 {
-	if (!g_DxStructuredBuffers.Valid(sb))
-	{
-		return {};
-	}
-
-	const Dx12StaticBufferAllocation& alloc = g_DxStructuredBuffers[sb];
-
-	return alloc.pResource;
+	return GetAllocation(g_DxStructuredBuffers, sb).pResource;
 }
 
-uint32_t Dx12_GetBufferOffset(StructuredBuffer_t sb)
+uint64_t Dx12_GetBufferOffset(StructuredBuffer_t sb)
 {
-	if (!g_DxStructuredBuffers.Valid(sb))
-	{
-		return {};
-	}
-
-	const Dx12StaticBufferAllocation& alloc = g_DxStructuredBuffers[sb];
-
-	return (uint32_t)alloc.Offset;
+	return (uint64_t)GetAllocation(g_DxStructuredBuffers, sb).Offset;
 }
 
 }
\ No newline at end of file
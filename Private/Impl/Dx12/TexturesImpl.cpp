@@ -220,9 +220,10 @@ void DestroyTexture(Texture_t tex)
 {
 	auto lock = std::unique_lock(g_TexturesMutex);
 
-	g_DxTextures[tex].CopyFence = g_render.CopyQueue.FenceValue;
-	g_DxTextures[tex].GraphicsFence = g_render.DirectQueue.FenceValue;
-	g_DxTextures[tex].ComputeFence = g_render.ComputeQueue.FenceValue;
+	// FenceValue is the last value signalled, lists already recorded this frame are only covered by the next one
+	g_DxTextures[tex].CopyFence = g_render.CopyQueue.FenceValue + 1u;
+	g_DxTextures[tex].GraphicsFence = g_render.DirectQueue.FenceValue + 1u;
+	g_DxTextures[tex].ComputeFence = g_render.ComputeQueue.FenceValue + 1u;
 
 	{
 		auto lock = std::scoped_lock(g_FreeQueueMutex);
@@ -1,14 +1,18 @@
 #pragma once
 
 #include "PipelineState.h"
+#include "InputLayouts.h"
 
 namespace rl
 {
 
-bool CompileGraphicsPipelineState(GraphicsPipelineState_t handle, const GraphicsPipelineStateDesc& desc, const InputElementDesc* inputs, size_t inputCount);
+bool CompileGraphicsPipelineState(GraphicsPipelineState_t handle, const GraphicsPipelineStateDesc& desc, InputLayout_t layout);
 bool CompileComputePipelineState(ComputePipelineState_t handle, const ComputePipelineStateDesc& desc);
 
 void DestroyGraphicsPipelineState(GraphicsPipelineState_t pso);
 void DestroyComputePipelineState(ComputePipelineState_t pso);
 
+// Frees any native objects the backend cached for an interned layout.
+void DestroyInputLayout(InputLayout_t layout);
+
 }
\ No newline at end of file
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "Samplers.h"
+
+namespace rl
+{
+
+bool CreateSamplerImpl(Sampler_t sampler, const SamplerDesc& desc);
+void DestroySamplerImpl(Sampler_t sampler);
+
+uint32_t GetDescriptorIndexImpl(Sampler_t sampler);
+
+}
\ No newline at end of file
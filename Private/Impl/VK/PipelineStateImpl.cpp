@@ -107,7 +107,7 @@ namespace rl
 		return (VkBlendOp)0;
 	}
 
-	bool CompileGraphicsPipelineState(GraphicsPipelineState_t handle, const GraphicsPipelineStateDesc& desc, const InputElementDesc* inputs, size_t inputCount)
+	bool CompileGraphicsPipelineState(GraphicsPipelineState_t handle, const GraphicsPipelineStateDesc& desc, InputLayout_t layout)
 	{
 		VkShaderModule vertShaderModule;
 		VkShaderModule pixShaderModule;
@@ -160,6 +160,10 @@ namespace rl
 		VkVertexInputBindingDescription bindingDescriptions[16];
 		VkVertexInputAttributeDescription attributeDescriptions[16];
 
+		const InputLayoutData* layoutData = GetInputLayout(layout);
+		const InputElementDesc* inputs = layoutData ? layoutData->Elements.data() : nullptr;
+		const size_t inputCount = layoutData ? layoutData->Elements.size() : 0u;
+
 		const uint32_t vertexInputDescriptionCount = inputCount < 16u ? (uint32_t)inputCount : 16u;
 		for (uint32_t i = 0; i < vertexInputDescriptionCount; i++)
 		{
@@ -286,5 +290,9 @@ namespace rl
 	{
 	}
 
+	void DestroyInputLayout(InputLayout_t layout)
+	{
+	}
+
 
 }
\ No newline at end of file
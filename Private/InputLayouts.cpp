@@ -0,0 +1,185 @@
+#include "InputLayouts.h"
+
+#include "Hash.h"
+#include "IDArray.h"
+#include "Impl/PipelineStateImpl.h"
+
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace rl
+{
+
+IDArray<InputLayout_t, std::shared_ptr<const InputLayoutData>> g_InputLayouts;
+
+// Guards the interning tables, releases are also taken under this lock so a lookup never returns a layout being destroyed.
+std::mutex g_InputLayoutMutex;
+std::unordered_multimap<uint64_t, InputLayout_t> g_InputLayoutLookup;
+
+// Node based so the c_str pointers stay valid for the lifetime of the program.
+std::unordered_set<std::string> g_SemanticNames;
+
+static const char* InternSemanticName_AssumeLocked(const char* name)
+{
+	return g_SemanticNames.emplace(name ? name : "").first->c_str();
+}
+
+static uint64_t HashInputElements(const InputElementDesc* inputs, size_t inputCount)
+{
+	uint64_t hash = 0u;
+
+	hash_combine(hash, inputCount);
+
+	for (size_t i = 0; i < inputCount; i++)
+	{
+		hash_combine(hash, std::string_view(inputs[i].semanticName ? inputs[i].semanticName : ""));
+		hash_combine(hash, inputs[i].semanticIndex);
+		hash_combine(hash, (uint32_t)inputs[i].format);
+		hash_combine(hash, inputs[i].inputSlot);
+		hash_combine(hash, inputs[i].alignedByteOffset);
+		hash_combine(hash, (uint32_t)inputs[i].inputSlotClass);
+		hash_combine(hash, inputs[i].instanceDataStepRate);
+	}
+
+	return hash;
+}
+
+// Interned elements compare semantic names by pointer, the incoming elements must already use interned names.
+static bool SameInputElements(const InputLayoutData& layout, const InputElementDesc* inputs, size_t inputCount)
+{
+	if (layout.Elements.size() != inputCount)
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < inputCount; i++)
+	{
+		const InputElementDesc& a = layout.Elements[i];
+		const InputElementDesc& b = inputs[i];
+
+		if (a.semanticName != b.semanticName ||
+			a.semanticIndex != b.semanticIndex ||
+			a.format != b.format ||
+			a.inputSlot != b.inputSlot ||
+			a.alignedByteOffset != b.alignedByteOffset ||
+			a.inputSlotClass != b.inputSlotClass ||
+			a.instanceDataStepRate != b.instanceDataStepRate)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+InputLayout_t InternInputLayout(const InputElementDesc* inputs, size_t inputCount)
+{
+	if (!inputs || inputCount == 0)
+	{
+		return InputLayout_t::INVALID;
+	}
+
+	const uint64_t hash = HashInputElements(inputs, inputCount);
+
+	std::scoped_lock lock(g_InputLayoutMutex);
+
+	std::vector<InputElementDesc> elements(inputs, inputs + inputCount);
+
+	for (InputElementDesc& element : elements)
+	{
+		element.semanticName = InternSemanticName_AssumeLocked(element.semanticName);
+	}
+
+	auto range = g_InputLayoutLookup.equal_range(hash);
+	for (auto it = range.first; it != range.second; it++)
+	{
+		bool same = false;
+		{
+			auto readLock = g_InputLayouts.ReadScopeLock();
+
+			const std::shared_ptr<const InputLayoutData>* existing = g_InputLayouts.Get(it->second);
+			same = existing && *existing && SameInputElements(**existing, elements.data(), elements.size());
+		}
+
+		if (same)
+		{
+			g_InputLayouts.AddRef(it->second);
+			return it->second;
+		}
+	}
+
+	std::shared_ptr<InputLayoutData> data = std::make_shared<InputLayoutData>();
+	data->Elements = std::move(elements);
+	data->Hash = hash;
+
+	InputLayout_t layout = g_InputLayouts.Create(std::shared_ptr<const InputLayoutData>(std::move(data)));
+
+	g_InputLayoutLookup.emplace(hash, layout);
+
+	return layout;
+}
+
+const InputLayoutData* GetInputLayout(InputLayout_t layout)
+{
+	auto lock = g_InputLayouts.ReadScopeLock();
+
+	const std::shared_ptr<const InputLayoutData>* data = g_InputLayouts.Get(layout);
+
+	return data ? data->get() : nullptr;
+}
+
+void RenderRef(InputLayout_t layout)
+{
+	g_InputLayouts.AddRef(layout);
+}
+
+void RenderRelease(InputLayout_t layout)
+{
+	if (layout == InputLayout_t::INVALID)
+	{
+		return;
+	}
+
+	std::scoped_lock lock(g_InputLayoutMutex);
+
+	uint64_t hash = 0u;
+	{
+		auto readLock = g_InputLayouts.ReadScopeLock();
+
+		const std::shared_ptr<const InputLayoutData>* data = g_InputLayouts.Get(layout);
+
+		if (!data)
+		{
+			return;
+		}
+
+		hash = (*data)->Hash;
+	}
+
+	if (g_InputLayouts.Release(layout))
+	{
+		auto range = g_InputLayoutLookup.equal_range(hash);
+		for (auto it = range.first; it != range.second; it++)
+		{
+			if (it->second == layout)
+			{
+				g_InputLayoutLookup.erase(it);
+				break;
+			}
+		}
+
+		DestroyInputLayout(layout);
+
+		std::shared_ptr<const InputLayoutData> empty;
+		g_InputLayouts.Update(layout, empty);
+	}
+}
+
+size_t GetInputLayoutCount()
+{
+	return g_InputLayouts.UsedSize();
+}
+
+}
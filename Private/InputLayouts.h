@@ -0,0 +1,30 @@
+#pragma once
+
+#include "RenderTypes.h"
+
+namespace rl
+{
+
+// Input layouts are interned so that identical layouts share a single immutable entry and a single native object per backend.
+// Pipelines refer to layouts by handle, so layout hashing and equality between pipelines is an integer compare.
+RENDER_TYPE(InputLayout_t);
+
+struct InputLayoutData
+{
+	// Semantic names point at interned strings, two elements with the same semantic share the same pointer.
+	std::vector<InputElementDesc> Elements;
+	uint64_t Hash = 0u;
+};
+
+// Returns a reffed handle to the layout matching the inputs, creating it if needed. An empty layout returns INVALID.
+InputLayout_t InternInputLayout(const InputElementDesc* inputs, size_t inputCount);
+
+// Layouts are immutable once interned, the returned pointer remains valid while the handle is reffed.
+const InputLayoutData* GetInputLayout(InputLayout_t layout);
+
+void RenderRef(InputLayout_t layout);
+void RenderRelease(InputLayout_t layout);
+
+size_t GetInputLayoutCount();
+
+}
@@ -0,0 +1,153 @@
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rl
+{
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MapFileRange(MappedFile& file, const char* path, size_t offset, size_t& size)
+{
+	if (!file.Open(path) || offset >= file.Size())
+	{
+		return false;
+	}
+
+	if (size == 0u)
+	{
+		size = file.Size() - offset;
+	}
+
+	return size <= file.Size() - offset;
+}
+
+#if defined(_WIN32)
+
+bool MappedFile::Open(const char* path)
+{
+	Close();
+
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	_file = file;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		// Empty files can't be mapped
+		Close();
+		return false;
+	}
+
+	_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!_mapping)
+	{
+		Close();
+		return false;
+	}
+
+	_data = (const uint8_t*)MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!_data)
+	{
+		Close();
+		return false;
+	}
+
+	_size = (size_t)size.QuadPart;
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (_data)
+	{
+		UnmapViewOfFile(_data);
+	}
+
+	if (_mapping)
+	{
+		CloseHandle(_mapping);
+	}
+
+	if (_file)
+	{
+		CloseHandle(_file);
+	}
+
+	_data = nullptr;
+	_size = 0u;
+	_mapping = nullptr;
+	_file = nullptr;
+}
+
+#else
+
+bool MappedFile::Open(const char* path)
+{
+	Close();
+
+	_file = open(path, O_RDONLY);
+	if (_file < 0)
+	{
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(_file, &st) != 0 || st.st_size == 0)
+	{
+		Close();
+		return false;
+	}
+
+	void* data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, _file, 0);
+	if (data == MAP_FAILED)
+	{
+		Close();
+		return false;
+	}
+
+	madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+	_data = (const uint8_t*)data;
+	_size = (size_t)st.st_size;
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (_data)
+	{
+		munmap((void*)_data, _size);
+	}
+
+	if (_file >= 0)
+	{
+		close(_file);
+	}
+
+	_data = nullptr;
+	_size = 0u;
+	_file = -1;
+}
+
+#endif
+
+}
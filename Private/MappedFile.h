@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace rl
+{
+
+// Read only view of a whole file through the os page cache, so file contents can be copied straight to upload memory without an intermediate read buffer.
+// The view is only valid until the MappedFile is closed or destroyed.
+struct MappedFile
+{
+	MappedFile() = default;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	~MappedFile();
+
+	// Hints the os that the file is read front to back once, so it reads ahead and drops pages behind the copy.
+	bool Open(const char* path);
+	void Close();
+
+	const uint8_t* Data() const { return _data; }
+	size_t Size() const { return _size; }
+
+private:
+	const uint8_t* _data = nullptr;
+	size_t _size = 0u;
+
+#if defined(_WIN32)
+	void* _file = nullptr;
+	void* _mapping = nullptr;
+#else
+	int _file = -1;
+#endif
+};
+
+// Opens path and checks size bytes from offset are in the file, a size of 0 is replaced with the rest of the file.
+bool MapFileRange(MappedFile& file, const char* path, size_t offset, size_t& size);
+
+}
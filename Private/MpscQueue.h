@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+namespace rl
+{
+
+// Lock free multiple producer, single consumer queue.
+// Producers push onto an intrusive stack with a compare exchange loop, the consumer takes the whole stack with a single exchange and reverses it back into push order.
+template<typename T>
+struct MpscQueue
+{
+	MpscQueue() = default;
+	MpscQueue(const MpscQueue&) = delete;
+	MpscQueue& operator=(const MpscQueue&) = delete;
+
+	~MpscQueue()
+	{
+		Node* node = Head.exchange(nullptr, std::memory_order_acquire);
+
+		while (node)
+		{
+			Node* next = node->Next;
+			delete node;
+			node = next;
+		}
+	}
+
+	// Safe from any thread.
+	void Push(T&& value)
+	{
+		Node* node = new Node{ std::move(value), nullptr };
+
+		node->Next = Head.load(std::memory_order_relaxed);
+
+		while (!Head.compare_exchange_weak(node->Next, node, std::memory_order_release, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	// Consumer only, appends everything pushed so far to out in the order each producer pushed it.
+	void PopAll(std::vector<T>& out)
+	{
+		Node* node = Head.exchange(nullptr, std::memory_order_acquire);
+
+		const size_t first = out.size();
+
+		while (node)
+		{
+			out.push_back(std::move(node->Value));
+
+			Node* next = node->Next;
+			delete node;
+			node = next;
+		}
+
+		std::reverse(out.begin() + first, out.end());
+	}
+
+	bool Empty() const
+	{
+		return Head.load(std::memory_order_relaxed) == nullptr;
+	}
+
+private:
+	struct Node
+	{
+		T Value;
+		Node* Next;
+	};
+
+	std::atomic<Node*> Head = nullptr;
+};
+
+}
@@ -1,6 +1,11 @@
 #include "PipelineState.h"
 #include "Impl/PipelineStateImpl.h"
+#include "Hash.h"
 #include "IDArray.h"
+#include "InputLayouts.h"
+
+#include <mutex>
+#include <unordered_map>
 
 namespace rl
 {
@@ -8,7 +13,8 @@ namespace rl
 struct GraphicsPipelineStateData
 {
     GraphicsPipelineStateDesc Desc;
-    std::vector<InputElementDesc> Inputs;
+    InputLayout_t Layout = InputLayout_t::INVALID;
+    uint64_t Hash = 0u;
 };
 
 struct ComputePipelineStateData
@@ -28,13 +34,6 @@ GraphicsPipelineTargetDesc::GraphicsPipelineTargetDesc(std::initializer_list<Ren
     DepthFormat = depthFormat;
 }
 
-template<typename T>
-inline void hash_combine(uint64_t& hash, const T& value)
-{
-    std::hash<T> h;
-    hash ^= h(value) + 0x9e3779b9 + (hash << 9) + (hash >> 2);
-}
-
 uint64_t GraphicsPipelineTargetDesc::Hash() const
 {
     if (Hashed != 0)
@@ -55,28 +54,157 @@ uint64_t GraphicsPipelineTargetDesc::Hash() const
     return Hashed;
 }
 
+// Hashes everything that affects the compiled pipeline, plus the debug name so differently named pipelines keep their own handle.
+static uint64_t HashGraphicsPipeline(const GraphicsPipelineStateDesc& desc, InputLayout_t layout)
+{
+    uint64_t hash = desc.TargetDesc.Hash();
+
+    hash_combine(hash, (uint8_t)desc.PrimTopo);
+    hash_combine(hash, (uint8_t)desc.Fill);
+    hash_combine(hash, (uint8_t)desc.Cull);
+    hash_combine(hash, desc.DepthBias);
+    hash_combine(hash, desc.DepthBiasClamp);
+    hash_combine(hash, desc.SlopeScaleDepthBias);
+    hash_combine(hash, desc.DepthEnabled);
+    hash_combine(hash, (uint8_t)desc.DepthCompare);
+    hash_combine(hash, (uint32_t)desc.VS);
+    hash_combine(hash, (uint32_t)desc.GS);
+    hash_combine(hash, (uint32_t)desc.MS);
+    hash_combine(hash, (uint32_t)desc.AS);
+    hash_combine(hash, (uint32_t)desc.PS);
+    hash_combine(hash, (uint32_t)desc.RootSignatureOverride);
+    hash_combine(hash, (uint32_t)layout);
+    hash_combine(hash, desc.DebugName);
+
+    return hash;
+}
+
+static bool SameTargetDesc(const GraphicsPipelineTargetDesc& a, const GraphicsPipelineTargetDesc& b)
+{
+    if (a.NumRenderTargets != b.NumRenderTargets || a.DepthFormat != b.DepthFormat)
+    {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < a.NumRenderTargets; i++)
+    {
+        if (a.Formats[i] != b.Formats[i] || a.Blends[i].Opaque != b.Blends[i].Opaque)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Layouts are interned so comparing the handles is enough to compare the full input layout.
+static bool SameGraphicsPipeline(const GraphicsPipelineStateData& data, const GraphicsPipelineStateDesc& desc, InputLayout_t layout)
+{
+    return data.Layout == layout &&
+        data.Desc.PrimTopo == desc.PrimTopo &&
+        data.Desc.Fill == desc.Fill &&
+        data.Desc.Cull == desc.Cull &&
+        data.Desc.DepthBias == desc.DepthBias &&
+        data.Desc.DepthBiasClamp == desc.DepthBiasClamp &&
+        data.Desc.SlopeScaleDepthBias == desc.SlopeScaleDepthBias &&
+        data.Desc.DepthEnabled == desc.DepthEnabled &&
+        data.Desc.DepthCompare == desc.DepthCompare &&
+        data.Desc.VS == desc.VS &&
+        data.Desc.GS == desc.GS &&
+        data.Desc.MS == desc.MS &&
+        data.Desc.AS == desc.AS &&
+        data.Desc.PS == desc.PS &&
+        data.Desc.RootSignatureOverride == desc.RootSignatureOverride &&
+        SameTargetDesc(data.Desc.TargetDesc, desc.TargetDesc) &&
+        data.Desc.DebugName == desc.DebugName;
+}
+
 IDArray<GraphicsPipelineState_t, GraphicsPipelineStateData> g_GraphicsPipelineStates;
 IDArray<ComputePipelineState_t, ComputePipelineStateData> g_ComputePipelineStates;
 
+// Identical graphics pipelines share one handle. The lock only guards the lookup, pipelines are compiled outside it.
+std::mutex g_GraphicsPipelineLookupMutex;
+std::unordered_multimap<uint64_t, GraphicsPipelineState_t> g_GraphicsPipelineLookup;
+
+// Returns a reffed handle to a matching pipeline, entries in the lookup always hold a ref so the add ref can't race the last release.
+static GraphicsPipelineState_t FindGraphicsPipeline_AssumeLocked(const GraphicsPipelineStateDesc& desc, InputLayout_t layout, uint64_t hash)
+{
+    auto range = g_GraphicsPipelineLookup.equal_range(hash);
+    for (auto it = range.first; it != range.second; it++)
+    {
+        bool same = false;
+        {
+            auto lock = g_GraphicsPipelineStates.ReadScopeLock();
+
+            const GraphicsPipelineStateData* data = g_GraphicsPipelineStates.Get(it->second);
+            same = data && SameGraphicsPipeline(*data, desc, layout);
+        }
+
+        if (same)
+        {
+            g_GraphicsPipelineStates.AddRef(it->second);
+            return it->second;
+        }
+    }
+
+    return GraphicsPipelineState_t::INVALID;
+}
+
 GraphicsPipelineState_t CreateGraphicsPipelineState(const GraphicsPipelineStateDesc& desc, const InputElementDesc* inputs, size_t inputCount)
 {
+    InputLayout_t layout = InternInputLayout(inputs, inputCount);
+
+    const uint64_t hash = HashGraphicsPipeline(desc, layout);
+
+    GraphicsPipelineState_t existing = GraphicsPipelineState_t::INVALID;
+    {
+        std::scoped_lock lookupLock(g_GraphicsPipelineLookupMutex);
+
+        existing = FindGraphicsPipeline_AssumeLocked(desc, layout, hash);
+    }
+
+    if (existing != GraphicsPipelineState_t::INVALID)
+    {
+        // The existing pipeline already holds a ref on the layout
+        RenderRelease(layout);
+        return existing;
+    }
+
     GraphicsPipelineState_t pso = g_GraphicsPipelineStates.Create();
 
-    if (!CompileGraphicsPipelineState(pso, desc, inputs, inputCount))
+    if (!CompileGraphicsPipelineState(pso, desc, layout))
     {
         g_GraphicsPipelineStates.Release(pso);
+        RenderRelease(layout);
         return GraphicsPipelineState_t::INVALID;
     }
 
-    // TODO Multithread: If we can accept the input elements as a slice or similar we can forward the args right into the Create() call, avoiding a second lock.
     {
         auto lock = g_GraphicsPipelineStates.ReadScopeLock();
 
         GraphicsPipelineStateData* data = g_GraphicsPipelineStates.Get(pso);
 
         data->Desc = desc;
-        data->Inputs.resize(inputCount);
-        memcpy(data->Inputs.data(), inputs, inputCount * sizeof(InputElementDesc));
+        data->Layout = layout;
+        data->Hash = hash;
+    }
+
+    {
+        std::scoped_lock lookupLock(g_GraphicsPipelineLookupMutex);
+
+        // Another thread may have compiled the same pipeline while this one was compiling, keep the first one inserted.
+        existing = FindGraphicsPipeline_AssumeLocked(desc, layout, hash);
+
+        if (existing == GraphicsPipelineState_t::INVALID)
+        {
+            g_GraphicsPipelineLookup.emplace(hash, pso);
+        }
+    }
+
+    if (existing != GraphicsPipelineState_t::INVALID)
+    {
+        RenderRelease(pso);
+        return existing;
     }
     
     return pso;
@@ -107,8 +235,37 @@ void RenderRef(ComputePipelineState_t pso)
 
 void RenderRelease(GraphicsPipelineState_t pso)
 {
+    std::scoped_lock lookupLock(g_GraphicsPipelineLookupMutex);
+
+    InputLayout_t layout = InputLayout_t::INVALID;
+    uint64_t hash = 0u;
+    {
+        auto lock = g_GraphicsPipelineStates.ReadScopeLock();
+
+        const GraphicsPipelineStateData* data = g_GraphicsPipelineStates.Get(pso);
+
+        if (!data)
+            return;
+
+        layout = data->Layout;
+        hash = data->Hash;
+    }
+
     if (g_GraphicsPipelineStates.Release(pso))
+    {
+        auto range = g_GraphicsPipelineLookup.equal_range(hash);
+        for (auto it = range.first; it != range.second; it++)
+        {
+            if (it->second == pso)
+            {
+                g_GraphicsPipelineLookup.erase(it);
+                break;
+            }
+        }
+
         DestroyGraphicsPipelineState(pso);
+        RenderRelease(layout);
+    }
 }
 
 void RenderRelease(ComputePipelineState_t pso)
@@ -131,7 +288,7 @@ void ReloadPipelines()
 {
     g_GraphicsPipelineStates.ForEachValid([](GraphicsPipelineState_t Handle, const GraphicsPipelineStateData& Data)
     {
-         return CompileGraphicsPipelineState(Handle, Data.Desc, Data.Inputs.data(), Data.Inputs.size());
+         return CompileGraphicsPipelineState(Handle, Data.Desc, Data.Layout);
     });
 
     g_ComputePipelineStates.ForEachValid([](ComputePipelineState_t Handle, const ComputePipelineStateData& Data)
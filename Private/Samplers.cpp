@@ -0,0 +1,136 @@
+#include "Samplers.h"
+#include "Impl/SamplersImpl.h"
+
+#include "Hash.h"
+#include "IDArray.h"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace rl
+{
+
+struct SamplerData
+{
+	SamplerDesc Desc;
+	uint64_t Hash = 0u;
+};
+
+IDArray<Sampler_t, SamplerData> g_Samplers;
+
+// Samplers by the hash of their desc, a desc that collides with a different one gets its own sampler and isn't looked up.
+std::unordered_map<uint64_t, Sampler_t> g_SamplerLookup;
+std::mutex g_SamplerLookupMutex;
+
+static uint64_t HashSamplerDesc(const SamplerDesc& desc)
+{
+	uint64_t hash = 0u;
+
+	hash_combine(hash, desc.AddressMode.U);
+	hash_combine(hash, desc.AddressMode.V);
+	hash_combine(hash, desc.AddressMode.W);
+	hash_combine(hash, desc.FilterMode.Min);
+	hash_combine(hash, desc.FilterMode.Mag);
+	hash_combine(hash, desc.FilterMode.Mip);
+	hash_combine(hash, desc.Comparison);
+	hash_combine(hash, desc.MinLOD);
+	hash_combine(hash, desc.MaxLOD);
+	hash_combine(hash, desc.MipLODBias);
+	hash_combine(hash, desc.BorderColor);
+	hash_combine(hash, desc.MaxAnisotropy);
+
+	return hash;
+}
+
+static bool SamplerDescsMatch(const SamplerDesc& a, const SamplerDesc& b)
+{
+	return a.AddressMode.U == b.AddressMode.U && a.AddressMode.V == b.AddressMode.V && a.AddressMode.W == b.AddressMode.W &&
+		a.FilterMode.Min == b.FilterMode.Min && a.FilterMode.Mag == b.FilterMode.Mag && a.FilterMode.Mip == b.FilterMode.Mip &&
+		a.Comparison == b.Comparison &&
+		a.MinLOD == b.MinLOD && a.MaxLOD == b.MaxLOD && a.MipLODBias == b.MipLODBias &&
+		a.BorderColor == b.BorderColor &&
+		a.MaxAnisotropy == b.MaxAnisotropy;
+}
+
+Sampler_t CreateSampler(const SamplerDesc& desc)
+{
+	const uint64_t hash = HashSamplerDesc(desc);
+
+	std::scoped_lock lock(g_SamplerLookupMutex);
+
+	auto it = g_SamplerLookup.find(hash);
+	if (it != g_SamplerLookup.end())
+	{
+		bool match = false;
+		{
+			auto readLock = g_Samplers.ReadScopeLock();
+
+			const SamplerData* data = g_Samplers.Get(it->second);
+			match = data && SamplerDescsMatch(data->Desc, desc);
+		}
+
+		if (match)
+		{
+			g_Samplers.AddRef(it->second);
+			return it->second;
+		}
+	}
+
+	Sampler_t sampler = g_Samplers.Create(SamplerData{ desc, hash });
+
+	if (!CreateSamplerImpl(sampler, desc))
+	{
+		g_Samplers.Release(sampler);
+		return Sampler_t::INVALID;
+	}
+
+	if (it == g_SamplerLookup.end())
+	{
+		g_SamplerLookup.emplace(hash, sampler);
+	}
+
+	return sampler;
+}
+
+uint32_t GetDescriptorIndex(Sampler_t sampler)
+{
+	return sampler != Sampler_t::INVALID ? GetDescriptorIndexImpl(sampler) : 0u;
+}
+
+void RenderRef(Sampler_t sampler)
+{
+	g_Samplers.AddRef(sampler);
+}
+
+void RenderRelease(Sampler_t sampler)
+{
+	std::scoped_lock lock(g_SamplerLookupMutex);
+
+	uint64_t hash = 0u;
+	{
+		auto readLock = g_Samplers.ReadScopeLock();
+
+		if (const SamplerData* data = g_Samplers.Get(sampler))
+		{
+			hash = data->Hash;
+		}
+	}
+
+	if (g_Samplers.Release(sampler))
+	{
+		DestroySamplerImpl(sampler);
+
+		auto it = g_SamplerLookup.find(hash);
+		if (it != g_SamplerLookup.end() && it->second == sampler)
+		{
+			g_SamplerLookup.erase(it);
+		}
+	}
+}
+
+size_t GetSamplerCount()
+{
+	return g_Samplers.UsedSize();
+}
+
+}
\ No newline at end of file
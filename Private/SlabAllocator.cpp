@@ -0,0 +1,171 @@
+#include "SlabAllocator.h"
+
+#include <assert.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace rl
+{
+
+static uint32_t BitScanForward(uint64_t value)
+{
+	assert(value != 0u);
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return (uint32_t)index;
+#else
+	return (uint32_t)__builtin_ctzll(value);
+#endif
+}
+
+static uint32_t SizeClassFromSize(uint64_t size)
+{
+	uint32_t log2 = SlabAllocator::MinSizeClassLog2;
+
+	while ((1ull << log2) < size)
+	{
+		log2++;
+	}
+
+	return log2 - SlabAllocator::MinSizeClassLog2;
+}
+
+bool SlabAllocator::Alloc(uint64_t size, SlabAllocation& outAllocation)
+{
+	assert(size > 0u);
+
+	if (size > GetMaxSize())
+	{
+		return false;
+	}
+
+	const uint32_t sizeClass = SizeClassFromSize(size);
+
+	const uint32_t page = PartialPages[sizeClass].empty() ? AcquirePage(sizeClass) : PartialPages[sizeClass].back();
+
+	Page& p = Pages[page];
+
+	uint32_t word = 0u;
+	while (p.FreeBits[word] == 0u)
+	{
+		word++;
+	}
+
+	const uint32_t slot = word * 64u + BitScanForward(p.FreeBits[word]);
+
+	p.FreeBits[word] &= p.FreeBits[word] - 1u;
+	p.FreeCount--;
+
+	if (p.FreeCount == 0u)
+	{
+		RemovePartial(page);
+	}
+
+	AllocationCount++;
+
+	const uint64_t slotSize = 1ull << (sizeClass + MinSizeClassLog2);
+
+	outAllocation.Offset = slot * slotSize;
+	outAllocation.Size = slotSize;
+	outAllocation.Page = page;
+	outAllocation.Slot = slot;
+
+	return true;
+}
+
+void SlabAllocator::Free(const SlabAllocation& allocation)
+{
+	assert(allocation.Page < Pages.size() && "SlabAllocator::Free invalid allocation");
+
+	Page& p = Pages[allocation.Page];
+
+	const uint32_t word = allocation.Slot / 64u;
+	const uint64_t bit = 1ull << (allocation.Slot % 64u);
+
+	assert(allocation.Slot < p.SlotCount && (p.FreeBits[word] & bit) == 0u && "SlabAllocator::Free slot is not allocated");
+
+	p.FreeBits[word] |= bit;
+	p.FreeCount++;
+
+	AllocationCount--;
+
+	if (p.FreeCount == 1u)
+	{
+		AddPartial(allocation.Page);
+	}
+
+	if (p.FreeCount == p.SlotCount)
+	{
+		RemovePartial(allocation.Page);
+
+		EmptyPages.push_back(allocation.Page);
+	}
+}
+
+uint32_t SlabAllocator::AcquirePage(uint32_t sizeClass)
+{
+	uint32_t page;
+
+	if (!EmptyPages.empty())
+	{
+		page = EmptyPages.back();
+		EmptyPages.pop_back();
+	}
+	else
+	{
+		page = (uint32_t)Pages.size();
+		Pages.emplace_back();
+	}
+
+	Page& p = Pages[page];
+	p = Page{};
+
+	p.SizeClass = sizeClass;
+	p.SlotCount = MaxSlotsPerPage >> sizeClass;
+	p.FreeCount = p.SlotCount;
+
+	for (uint32_t slot = 0; slot < p.SlotCount; slot += 64u)
+	{
+		const uint32_t count = p.SlotCount - slot;
+		p.FreeBits[slot / 64u] = count >= 64u ? ~0ull : (1ull << count) - 1u;
+	}
+
+	AddPartial(page);
+
+	return page;
+}
+
+void SlabAllocator::AddPartial(uint32_t page)
+{
+	Page& p = Pages[page];
+
+	assert(p.PartialIndex == NotPartial);
+
+	std::vector<uint32_t>& partial = PartialPages[p.SizeClass];
+
+	p.PartialIndex = (uint32_t)partial.size();
+	partial.push_back(page);
+}
+
+void SlabAllocator::RemovePartial(uint32_t page)
+{
+	Page& p = Pages[page];
+
+	assert(p.PartialIndex != NotPartial);
+
+	std::vector<uint32_t>& partial = PartialPages[p.SizeClass];
+
+	const uint32_t last = partial.back();
+
+	partial[p.PartialIndex] = last;
+	Pages[last].PartialIndex = p.PartialIndex;
+
+	partial.pop_back();
+
+	p.PartialIndex = NotPartial;
+}
+
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace rl
+{
+
+// Power of two size classes carved from equally sized pages, like TlsfAllocator it only hands out offsets.
+// Each page holds a single size class at a time, a page that empties can be reused by any class.
+struct SlabAllocation
+{
+	static constexpr uint32_t InvalidPage = ~0u;
+
+	uint64_t Offset = 0u;
+	uint64_t Size = 0u;
+
+	uint32_t Page = InvalidPage;
+	uint32_t Slot = 0u;
+
+	bool Valid() const { return Page != InvalidPage; }
+};
+
+struct SlabAllocator
+{
+	static constexpr uint32_t MinSizeClassLog2 = 8u;
+	static constexpr uint32_t MaxSizeClassLog2 = 16u;
+	static constexpr uint32_t SizeClassCount = MaxSizeClassLog2 - MinSizeClassLog2 + 1u;
+
+	static constexpr uint64_t PageSize = 1ull << MaxSizeClassLog2;
+	static constexpr uint32_t MaxSlotsPerPage = 1u << (MaxSizeClassLog2 - MinSizeClassLog2);
+
+	static constexpr uint64_t GetMaxSize() { return 1ull << MaxSizeClassLog2; }
+
+	// Offsets are relative to the page, new pages are appended so callers create backing memory when GetPageCount grows.
+	// A freed slot can be handed out by the next Alloc, callers hold frees back until the gpu is done with the slot.
+	bool Alloc(uint64_t size, SlabAllocation& outAllocation);
+	void Free(const SlabAllocation& allocation);
+
+	uint32_t GetPageCount() const { return (uint32_t)Pages.size(); }
+	uint32_t GetAllocationCount() const { return AllocationCount; }
+
+private:
+	static constexpr uint32_t BitmapWords = MaxSlotsPerPage / 64u;
+	static constexpr uint32_t NotPartial = ~0u;
+
+	struct Page
+	{
+		// Set bits are free slots.
+		uint64_t FreeBits[BitmapWords] = {};
+
+		uint32_t SizeClass = 0u;
+		uint32_t SlotCount = 0u;
+		uint32_t FreeCount = 0u;
+
+		// Position in the partial list of its size class, so full and empty pages are removed without a search.
+		uint32_t PartialIndex = NotPartial;
+	};
+
+	std::vector<Page> Pages;
+	std::vector<uint32_t> PartialPages[SizeClassCount];
+	std::vector<uint32_t> EmptyPages;
+
+	uint32_t AllocationCount = 0u;
+
+	uint32_t AcquirePage(uint32_t sizeClass);
+
+	void AddPartial(uint32_t page);
+	void RemovePartial(uint32_t page);
+};
+
+}
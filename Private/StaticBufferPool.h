@@ -0,0 +1,317 @@
+#pragma once
+
+#include "FreeSpaceIndex.h"
+#include "SlabAllocator.h"
+#include "TlsfAllocator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+namespace rl
+{
+
+// A page of static buffer memory suballocated by its own TlsfAllocator, backends derive their page from it and add the gpu resource.
+// Each page has its own lock so loader threads allocating from different pages don't contend.
+struct StaticBufferPage
+{
+	explicit StaticBufferPage(uint64_t size)
+		: Allocator(size)
+	{
+	}
+
+	// Publish is given the new largest free block while the page is still locked, so concurrent publishes for a page can't land out of order.
+	template<typename Publish>
+	bool Alloc(uint64_t size, uint64_t alignment, TlsfAllocation& outBlock, Publish&& publish)
+	{
+		const uint64_t alignedSize = (size + alignment - 1u) / alignment * alignment;
+
+		std::scoped_lock lock(Mutex);
+
+		const bool allocated = Allocator.Alloc(alignedSize, alignment, outBlock);
+
+		publish(GetLargestFreeBlock());
+
+		return allocated;
+	}
+
+	template<typename Publish>
+	void Free(const TlsfAllocation& block, Publish&& publish)
+	{
+		std::scoped_lock lock(Mutex);
+
+		Allocator.Free(block);
+
+		publish(GetLargestFreeBlock());
+	}
+
+	// The unlocked accessors are for compaction, which holds the page set exclusively.
+	uint64_t GetLargestFreeBlock() const { return Retiring ? 0u : Allocator.GetLargestFreeBlockUpperBound(); }
+
+	TlsfAllocator& GetAllocator() { return Allocator; }
+
+	bool IsRetiring() const { return Retiring; }
+	void SetRetiring() { Retiring = true; }
+
+private:
+	std::mutex Mutex;
+	TlsfAllocator Allocator;
+
+	// Set once compaction has moved everything out, nothing new is placed here while the gpu finishes with it.
+	bool Retiring = false;
+};
+
+// Pages of one kind of static buffer memory, safe to allocate and free from any thread.
+// Mutex is shared while the page array is read and exclusive while slots are added or released, slow page creation happens outside it in a reserved slot.
+// Pages are bucketed by the upper bound of their largest free block, so allocations only visit pages with room.
+// Lock order is Mutex, then a page's own lock, then IndexMutex.
+template<typename Page>
+struct StaticBufferPageSet
+{
+	static constexpr uint32_t InvalidPage = FreeSpaceIndex::InvalidPage;
+
+	mutable std::shared_mutex Mutex;
+	std::vector<std::unique_ptr<Page>> Pages;
+
+	// Slots of released pages.
+	std::vector<uint32_t> FreePages;
+
+	// createPage(pageIndex) is called without any lock held when no page has room, returning null fails the allocation.
+	template<typename CreatePage>
+	bool Alloc(uint64_t size, uint64_t alignment, CreatePage&& createPage, uint32_t& outPage, TlsfAllocation& outBlock)
+	{
+		// Worst case space needed to align the allocation within a free block
+		const uint64_t requiredSize = (size + alignment - 1u) / alignment * alignment + alignment - 1u;
+
+		{
+			std::shared_lock lock(Mutex);
+
+			// The upper bound can promise more than an aligned allocation finds, pages that failed aren't offered again
+			std::vector<uint32_t> triedPages;
+
+			for (;;)
+			{
+				uint32_t pageIndex;
+				{
+					std::scoped_lock indexLock(IndexMutex);
+
+					pageIndex = Index.Find(requiredSize, [&triedPages](uint32_t page)
+					{
+						return std::find(triedPages.begin(), triedPages.end(), page) == triedPages.end();
+					});
+				}
+
+				if (pageIndex == InvalidPage)
+				{
+					break;
+				}
+
+				if (Pages[pageIndex]->Alloc(size, alignment, outBlock, [this, pageIndex](uint64_t largestFreeBlock) { Publish(pageIndex, largestFreeBlock); }))
+				{
+					outPage = pageIndex;
+					return true;
+				}
+
+				triedPages.push_back(pageIndex);
+			}
+		}
+
+		uint32_t pageIndex;
+		{
+			std::unique_lock lock(Mutex);
+
+			if (!FreePages.empty())
+			{
+				pageIndex = FreePages.back();
+				FreePages.pop_back();
+			}
+			else
+			{
+				pageIndex = (uint32_t)Pages.size();
+				Pages.emplace_back();
+			}
+		}
+
+		std::unique_ptr<Page> page = createPage(pageIndex);
+
+		if (!page)
+		{
+			std::unique_lock lock(Mutex);
+
+			FreePages.push_back(pageIndex);
+
+			return false;
+		}
+
+		// Not published yet, the page goes in the index once it is in Pages
+		uint64_t largestFreeBlock = 0u;
+		const bool allocated = page->Alloc(size, alignment, outBlock, [&largestFreeBlock](uint64_t largest) { largestFreeBlock = largest; });
+
+		assert(allocated && "Allocation doesn't fit in a new page");
+
+		std::unique_lock lock(Mutex);
+
+		Pages[pageIndex] = std::move(page);
+		Publish(pageIndex, largestFreeBlock);
+
+		outPage = pageIndex;
+
+		return allocated;
+	}
+
+	void Free(uint32_t pageIndex, const TlsfAllocation& block)
+	{
+		std::shared_lock lock(Mutex);
+
+		assert(pageIndex < Pages.size() && Pages[pageIndex] && "Trying to free from a non-existent page");
+
+		if (pageIndex < Pages.size() && Pages[pageIndex])
+		{
+			Pages[pageIndex]->Free(block, [this, pageIndex](uint64_t largestFreeBlock) { Publish(pageIndex, largestFreeBlock); });
+		}
+	}
+
+	// Calls func with the page while the array is held shared, false if the slot is empty.
+	template<typename Func>
+	bool WithPage(uint32_t pageIndex, Func&& func) const
+	{
+		std::shared_lock lock(Mutex);
+
+		if (pageIndex >= Pages.size() || !Pages[pageIndex])
+		{
+			return false;
+		}
+
+		func(*Pages[pageIndex]);
+
+		return true;
+	}
+
+	// Releases a page compaction has emptied, the caller waits for the gpu to finish with it first.
+	void ReleasePage(uint32_t pageIndex)
+	{
+		std::unique_lock lock(Mutex);
+
+		assert(pageIndex < Pages.size() && Pages[pageIndex] && Pages[pageIndex]->IsRetiring());
+
+		Pages[pageIndex] = nullptr;
+		Publish(pageIndex, 0u);
+
+		FreePages.push_back(pageIndex);
+	}
+
+	// Pages publish while holding their own lock, compaction may publish while holding Mutex exclusively instead.
+	void Publish(uint32_t pageIndex, uint64_t largestFreeBlock)
+	{
+		std::scoped_lock indexLock(IndexMutex);
+
+		Index.Update(pageIndex, largestFreeBlock);
+	}
+
+	uint32_t GetPageCount() const
+	{
+		std::shared_lock lock(Mutex);
+
+		return (uint32_t)std::count_if(Pages.begin(), Pages.end(), [](const std::unique_ptr<Page>& page) { return page != nullptr; });
+	}
+
+private:
+	std::mutex IndexMutex;
+	FreeSpaceIndex Index;
+};
+
+// Constant buffer slabs, the bookkeeping is a few instructions so every size class shares one lock.
+// Slab pages are only ever added, so the page array has its own lock and lookups don't wait behind allocations creating pages.
+// Lock order is Mutex, then whatever createPage takes, then PagesMutex.
+template<typename SlabPage>
+struct StaticBufferSlabSet
+{
+	// createPage(pageIndex) is called under the lock when the allocator grows, returning null fails the allocation and the page is created again next time.
+	template<typename CreatePage>
+	bool Alloc(uint64_t size, CreatePage&& createPage, SlabAllocation& outSlab)
+	{
+		std::scoped_lock lock(Mutex);
+
+		if (!Slabs.Alloc(size, outSlab))
+		{
+			outSlab = {};
+			return false;
+		}
+
+		// Pages only grow under Mutex, so its size can be read without PagesMutex
+		if (Pages.size() < Slabs.GetPageCount())
+		{
+			std::vector<std::unique_ptr<SlabPage>> created;
+
+			for (uint32_t pageIndex = (uint32_t)Pages.size(); pageIndex < Slabs.GetPageCount(); pageIndex++)
+			{
+				std::unique_ptr<SlabPage> page = createPage(pageIndex);
+
+				if (!page)
+				{
+					break;
+				}
+
+				created.push_back(std::move(page));
+			}
+
+			std::unique_lock pagesLock(PagesMutex);
+
+			for (std::unique_ptr<SlabPage>& page : created)
+			{
+				Pages.push_back(std::move(page));
+			}
+		}
+
+		if (outSlab.Page >= Pages.size())
+		{
+			Slabs.Free(outSlab);
+			outSlab = {};
+			return false;
+		}
+
+		return true;
+	}
+
+	void Free(const SlabAllocation& slab)
+	{
+		std::scoped_lock lock(Mutex);
+
+		Slabs.Free(slab);
+	}
+
+	// Calls func with the page while the array is held shared, false if the page doesn't exist.
+	template<typename Func>
+	bool WithPage(uint32_t pageIndex, Func&& func) const
+	{
+		std::shared_lock lock(PagesMutex);
+
+		if (pageIndex >= Pages.size())
+		{
+			return false;
+		}
+
+		func(*Pages[pageIndex]);
+
+		return true;
+	}
+
+	uint32_t GetAllocationCount()
+	{
+		std::scoped_lock lock(Mutex);
+
+		return Slabs.GetAllocationCount();
+	}
+
+private:
+	std::mutex Mutex;
+	SlabAllocator Slabs;
+
+	mutable std::shared_mutex PagesMutex;
+	std::vector<std::unique_ptr<SlabPage>> Pages;
+};
+
+}
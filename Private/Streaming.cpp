@@ -0,0 +1,424 @@
+#include "Streaming.h"
+
+#include "AsyncFileReader.h"
+#include "Render.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+
+namespace rl
+{
+
+struct PendingStream
+{
+	StreamRequest Request;
+	uint64_t Sequence = 0u;
+};
+
+struct PendingStreamOrder
+{
+	bool operator()(const PendingStream& a, const PendingStream& b) const
+	{
+		if (a.Request.Priority != b.Request.Priority)
+		{
+			return a.Request.Priority < b.Request.Priority;
+		}
+
+		return a.Sequence > b.Sequence;
+	}
+};
+
+// Read on the worker but not yet copied, only used when the api can't record copies off the submitting thread.
+struct ReadStream
+{
+	StreamRequest Request;
+	std::vector<uint8_t> Data;
+};
+
+struct InFlightStream
+{
+	StreamCallback OnComplete;
+	Buffer_t Dst = Buffer_t::INVALID;
+	size_t Size = 0u;
+	uint64_t UploadFence = 0u;
+	bool Success = false;
+};
+
+struct StreamingService
+{
+	std::mutex Mutex;
+	std::condition_variable BudgetAvailable;
+	std::thread Worker;
+	bool Running = false;
+
+	size_t MaxInFlightBytes = 0u;
+	uint32_t ReadQueueDepth = 0u;
+
+	std::priority_queue<PendingStream, std::vector<PendingStream>, PendingStreamOrder> Pending;
+	uint64_t NextSequence = 0u;
+
+	std::vector<ReadStream> Read;
+	std::vector<InFlightStream> InFlight;
+
+	// Reserved when the worker takes a request and returned once its upload fence completes.
+	size_t InFlightBytes = 0u;
+	size_t StreamedBytes = 0u;
+};
+
+StreamingService g_streaming;
+
+static bool CanTakeRequest_AssumeLocked()
+{
+	// A request bigger than what is left of the budget still starts, so oversized requests can't stall the queue.
+	return !g_streaming.Pending.empty() && g_streaming.InFlightBytes < g_streaming.MaxInFlightBytes;
+}
+
+// Owned by the worker while its file is read.
+// Reads land in Data rather than straight in staging memory, UpdateBufferRange is the only api agnostic upload path and it copies from caller memory.
+// That costs a second copy of each request, bounded by MaxInFlightBytes, and keeps staging memory free for uploads that are ready to record.
+struct ReadingStream
+{
+	StreamRequest Request;
+	AsyncFileHandle File = InvalidAsyncFile;
+	std::vector<uint8_t> Data;
+};
+
+// Opens the file and checks the range fits both the file and the destination, then queues the read.
+static bool StartRead(AsyncFileReader& reader, ReadingStream& stream, uint64_t id, size_t& outResolvedBytes)
+{
+	StreamRequest& request = stream.Request;
+
+	size_t fileSize = 0u;
+	stream.File = reader.Open(request.Path.c_str(), fileSize);
+
+	if (stream.File == InvalidAsyncFile || request.FileOffset >= fileSize)
+	{
+		return false;
+	}
+
+	const size_t size = request.Size > 0u ? request.Size : fileSize - request.FileOffset;
+	const size_t dstSize = GetBufferSize(request.Dst);
+
+	if (size > fileSize - request.FileOffset || request.DstOffset > dstSize || size > dstSize - request.DstOffset)
+	{
+		return false;
+	}
+
+	outResolvedBytes += size - request.Size;
+	request.Size = size;
+
+	stream.Data.resize(size);
+	reader.Read(stream.File, request.FileOffset, stream.Data.data(), size, id);
+
+	return true;
+}
+
+static void StreamingWorker()
+{
+	const bool recordOnWorker = Render_IsThreadSafe();
+
+	// Every request fails if the reader can't start, rather than the worker exiting with requests queued
+	AsyncFileReader reader;
+	const bool readerReady = reader.Init(g_streaming.ReadQueueDepth);
+
+	std::unordered_map<uint64_t, ReadingStream> reading;
+	std::vector<PendingStream> batch;
+	std::vector<AsyncFileReader::Completion> completions;
+
+	while (true)
+	{
+		{
+			std::unique_lock lock(g_streaming.Mutex);
+
+			// Only sleep here when nothing is being read, otherwise new requests are picked up between read completions
+			if (reading.empty())
+			{
+				g_streaming.BudgetAvailable.wait(lock, [] { return !g_streaming.Running || CanTakeRequest_AssumeLocked(); });
+			}
+
+			if (!g_streaming.Running)
+			{
+				break;
+			}
+
+			while (CanTakeRequest_AssumeLocked())
+			{
+				PendingStream stream = g_streaming.Pending.top();
+				g_streaming.Pending.pop();
+
+				g_streaming.InFlightBytes += stream.Request.Size;
+
+				const bool sizeKnown = stream.Request.Size > 0u;
+
+				batch.push_back(std::move(stream));
+
+				// Whole file requests are only sized once opened, so end the batch there rather than overrun the budget
+				if (!sizeKnown)
+				{
+					break;
+				}
+			}
+		}
+
+		std::vector<InFlightStream> inFlight;
+		size_t resolvedBytes = 0u;
+
+		for (PendingStream& pending : batch)
+		{
+			ReadingStream stream;
+			stream.Request = std::move(pending.Request);
+
+			if (!readerReady || !StartRead(reader, stream, pending.Sequence, resolvedBytes))
+			{
+				reader.Close(stream.File);
+				inFlight.push_back({ std::move(stream.Request.OnComplete), stream.Request.Dst, stream.Request.Size, 0u, false });
+				continue;
+			}
+
+			reading.emplace(pending.Sequence, std::move(stream));
+		}
+
+		batch.clear();
+
+		// Blocks until a part finishes when reads are in flight, parts are at most 1MB so new requests don't wait long
+		completions.clear();
+		reader.Poll(completions, true);
+
+		std::vector<ReadStream> read;
+		bool recorded = false;
+
+		for (const AsyncFileReader::Completion& completion : completions)
+		{
+			auto it = reading.find(completion.UserData);
+			ReadingStream& stream = it->second;
+
+			reader.Close(stream.File);
+
+			if (!completion.Success)
+			{
+				inFlight.push_back({ std::move(stream.Request.OnComplete), stream.Request.Dst, stream.Request.Size, 0u, false });
+			}
+			else if (recordOnWorker)
+			{
+				UpdateBufferRange(stream.Request.Dst, stream.Data.data(), stream.Request.DstOffset, stream.Data.size());
+
+				inFlight.push_back({ std::move(stream.Request.OnComplete), stream.Request.Dst, stream.Request.Size, 0u, true });
+				recorded = true;
+			}
+			else
+			{
+				read.push_back({ std::move(stream.Request), std::move(stream.Data) });
+			}
+
+			reading.erase(it);
+		}
+
+		if (recorded)
+		{
+			const uint64_t uploadFence = GetBufferUploadFence();
+
+			for (InFlightStream& stream : inFlight)
+			{
+				stream.UploadFence = stream.Success ? uploadFence : 0u;
+			}
+		}
+
+		std::scoped_lock lock(g_streaming.Mutex);
+
+		g_streaming.InFlightBytes += resolvedBytes;
+
+		g_streaming.Read.insert(g_streaming.Read.end(), std::make_move_iterator(read.begin()), std::make_move_iterator(read.end()));
+		g_streaming.InFlight.insert(g_streaming.InFlight.end(), std::make_move_iterator(inFlight.begin()), std::make_move_iterator(inFlight.end()));
+	}
+
+	// Waits for the reads in flight, then hands what was being read to Streaming_ShutDown to fail
+	reader.ShutDown();
+
+	std::scoped_lock lock(g_streaming.Mutex);
+
+	for (auto& [id, stream] : reading)
+	{
+		reader.Close(stream.File);
+		g_streaming.InFlight.push_back({ std::move(stream.Request.OnComplete), stream.Request.Dst, stream.Request.Size, 0u, false });
+	}
+}
+
+bool Streaming_Init(const StreamingDesc& desc)
+{
+	assert(!g_streaming.Running && "Streaming_Init called twice");
+
+	if (desc.MaxInFlightBytes == 0u || desc.ReadQueueDepth == 0u)
+	{
+		return false;
+	}
+
+	g_streaming.MaxInFlightBytes = desc.MaxInFlightBytes;
+	g_streaming.ReadQueueDepth = desc.ReadQueueDepth;
+	g_streaming.Running = true;
+	g_streaming.Worker = std::thread(StreamingWorker);
+
+	return true;
+}
+
+static void FailStream(StreamCallback& onComplete, Buffer_t dst)
+{
+	if (onComplete)
+	{
+		onComplete(false);
+	}
+
+	RenderRelease(dst);
+}
+
+void Streaming_ShutDown()
+{
+	{
+		std::scoped_lock lock(g_streaming.Mutex);
+		g_streaming.Running = false;
+	}
+
+	g_streaming.BudgetAvailable.notify_all();
+
+	if (g_streaming.Worker.joinable())
+	{
+		g_streaming.Worker.join();
+	}
+
+	// Anything not reported yet is failed, uploads already recorded still land but nothing waits for them.
+	while (!g_streaming.Pending.empty())
+	{
+		PendingStream stream = g_streaming.Pending.top();
+		g_streaming.Pending.pop();
+
+		FailStream(stream.Request.OnComplete, stream.Request.Dst);
+	}
+
+	for (ReadStream& stream : g_streaming.Read)
+	{
+		FailStream(stream.Request.OnComplete, stream.Request.Dst);
+	}
+
+	for (InFlightStream& stream : g_streaming.InFlight)
+	{
+		FailStream(stream.OnComplete, stream.Dst);
+	}
+
+	g_streaming.Read.clear();
+	g_streaming.InFlight.clear();
+	g_streaming.InFlightBytes = 0u;
+}
+
+bool StreamToBuffer(StreamRequest&& request)
+{
+	if (request.Dst == Buffer_t::INVALID || request.Path.empty())
+	{
+		return false;
+	}
+
+	RenderRef(request.Dst);
+
+	{
+		std::scoped_lock lock(g_streaming.Mutex);
+
+		if (!g_streaming.Running)
+		{
+			RenderRelease(request.Dst);
+			return false;
+		}
+
+		g_streaming.Pending.push({ std::move(request), g_streaming.NextSequence++ });
+	}
+
+	g_streaming.BudgetAvailable.notify_one();
+
+	return true;
+}
+
+void Streaming_Update()
+{
+	std::vector<ReadStream> read;
+	{
+		std::scoped_lock lock(g_streaming.Mutex);
+		read.swap(g_streaming.Read);
+	}
+
+	if (!read.empty())
+	{
+		for (ReadStream& stream : read)
+		{
+			UpdateBufferRange(stream.Request.Dst, stream.Data.data(), stream.Request.DstOffset, stream.Data.size());
+		}
+
+		const uint64_t uploadFence = GetBufferUploadFence();
+
+		std::scoped_lock lock(g_streaming.Mutex);
+
+		for (ReadStream& stream : read)
+		{
+			g_streaming.InFlight.push_back({ std::move(stream.Request.OnComplete), stream.Request.Dst, stream.Request.Size, uploadFence, true });
+		}
+	}
+
+	std::vector<InFlightStream> completed;
+	{
+		std::scoped_lock lock(g_streaming.Mutex);
+
+		for (size_t i = 0; i < g_streaming.InFlight.size();)
+		{
+			InFlightStream& stream = g_streaming.InFlight[i];
+
+			if (!IsBufferUploadComplete(stream.UploadFence))
+			{
+				i++;
+				continue;
+			}
+
+			g_streaming.InFlightBytes -= stream.Size;
+
+			if (stream.Success)
+			{
+				g_streaming.StreamedBytes += stream.Size;
+			}
+
+			completed.push_back(std::move(stream));
+
+			g_streaming.InFlight[i] = std::move(g_streaming.InFlight.back());
+			g_streaming.InFlight.pop_back();
+		}
+	}
+
+	if (completed.empty())
+	{
+		return;
+	}
+
+	g_streaming.BudgetAvailable.notify_one();
+
+	for (InFlightStream& stream : completed)
+	{
+		if (stream.OnComplete)
+		{
+			stream.OnComplete(stream.Success);
+		}
+
+		RenderRelease(stream.Dst);
+	}
+}
+
+StreamingStats GetStreamingStats()
+{
+	std::scoped_lock lock(g_streaming.Mutex);
+
+	StreamingStats stats;
+	stats.QueuedRequests = (uint32_t)g_streaming.Pending.size();
+	stats.InFlightRequests = (uint32_t)(g_streaming.Read.size() + g_streaming.InFlight.size());
+	stats.InFlightBytes = g_streaming.InFlightBytes;
+	stats.StreamedBytes = g_streaming.StreamedBytes;
+
+	return stats;
+}
+
+}
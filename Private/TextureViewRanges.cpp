@@ -0,0 +1,46 @@
+#include "TextureViewRanges.h"
+
+#include <algorithm>
+
+namespace rl
+{
+
+TextureViewRange GetFullTextureRange(TextureDimension dim, uint32_t mipLevels, uint32_t depthOrArraySize)
+{
+	TextureViewRange range;
+	range.MipLevels = mipLevels;
+
+	if (dim == TextureDimension::CUBEMAP)
+		range.SliceCount = 6u;
+	else if (dim == TextureDimension::CUBEMAP_ARRAY)
+		range.SliceCount = 6u * depthOrArraySize;
+	else if (dim == TextureDimension::TEX3D)
+		range.SliceCount = ~0u;
+	else
+		range.SliceCount = depthOrArraySize;
+
+	return range;
+}
+
+// Compared against what is left past the first mip or slice, so large counts can't wrap around.
+bool IsRangeInTexture(const TextureCreateDescEx& desc, const TextureViewRange& range)
+{
+	if (range.MipLevels == 0u || range.SliceCount == 0u)
+		return false;
+
+	if (range.FirstMip >= desc.MipCount || (range.MipLevels != ~0u && range.MipLevels > desc.MipCount - range.FirstMip))
+		return false;
+
+	if (desc.Dimension == TextureDimension::TEX3D)
+	{
+		const uint32_t mipDepth = std::max(desc.DepthOrArraySize >> range.FirstMip, 1u);
+
+		return range.FirstSlice < mipDepth && (range.SliceCount == ~0u || range.SliceCount <= mipDepth - range.FirstSlice);
+	}
+
+	const uint32_t sliceCount = GetFullTextureRange(desc.Dimension, desc.MipCount, desc.DepthOrArraySize).SliceCount;
+
+	return range.FirstSlice < sliceCount && range.SliceCount <= sliceCount - range.FirstSlice;
+}
+
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Binding.h"
+#include "Textures.h"
+
+namespace rl
+{
+
+// What the views without a range cover, every slice and mip 0 for anything but SRVs.
+TextureViewRange GetFullTextureRange(TextureDimension dim, uint32_t mipLevels, uint32_t depthOrArraySize);
+
+// False for empty ranges and ranges past the texture's mips or slices, 3D slices are the depth of FirstMip.
+bool IsRangeInTexture(const TextureCreateDescEx& desc, const TextureViewRange& range);
+
+}
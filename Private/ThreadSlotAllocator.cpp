@@ -0,0 +1,44 @@
+#include "ThreadSlotAllocator.h"
+
+#include <cassert>
+
+namespace rl
+{
+
+ThreadSlotAllocator::ThreadSlotAllocator(uint32_t capacity)
+	: Capacity(capacity)
+{
+}
+
+uint32_t ThreadSlotAllocator::Acquire()
+{
+	std::scoped_lock lock(Mutex);
+
+	if (!FreeSlots.empty())
+	{
+		const uint32_t slot = FreeSlots.back();
+		FreeSlots.pop_back();
+		return slot;
+	}
+
+	const uint32_t used = UsedCount.load(std::memory_order_relaxed);
+	if (used == Capacity)
+	{
+		return InvalidSlot;
+	}
+
+	UsedCount.store(used + 1u, std::memory_order_release);
+
+	return used;
+}
+
+void ThreadSlotAllocator::Release(uint32_t slot)
+{
+	std::scoped_lock lock(Mutex);
+
+	assert(slot < UsedCount.load(std::memory_order_relaxed) && "ThreadSlotAllocator::Release invalid slot");
+
+	ReleasedSlots.push_back(slot);
+}
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace rl
+{
+
+// Hands out small dense indices to the threads using a per thread resource, so the resources can live in a fixed array indexed by slot.
+// A thread keeps its slot until it exits, the slot is then only reused after Recycle, which the owner calls once nothing can refer to the old thread's data.
+struct ThreadSlotAllocator
+{
+	static constexpr uint32_t InvalidSlot = ~0u;
+
+	explicit ThreadSlotAllocator(uint32_t capacity);
+
+	// Safe from any thread, InvalidSlot while every slot belongs to a live thread or waits to be recycled.
+	uint32_t Acquire();
+	void Release(uint32_t slot);
+
+	// Makes the released slots available again, reset(slot) clears the old thread's state before any thread can acquire it.
+	template<typename Func>
+	void Recycle(Func&& reset)
+	{
+		std::scoped_lock lock(Mutex);
+
+		for (uint32_t slot : ReleasedSlots)
+		{
+			reset(slot);
+			FreeSlots.push_back(slot);
+		}
+
+		ReleasedSlots.clear();
+	}
+
+	// Slots below this may have been used, they are the only ones the owner needs to visit.
+	uint32_t GetUsedCount() const { return UsedCount.load(std::memory_order_acquire); }
+
+	uint32_t GetCapacity() const { return Capacity; }
+
+private:
+	std::mutex Mutex;
+
+	uint32_t Capacity = 0u;
+	std::atomic<uint32_t> UsedCount = 0u;
+
+	std::vector<uint32_t> FreeSlots;
+	std::vector<uint32_t> ReleasedSlots;
+};
+
+// Keep one of these thread_local per allocator, it acquires on first use and releases the slot when the thread exits.
+// A thread that couldn't get a slot tries again on its next call.
+struct ThreadSlot
+{
+	ThreadSlot() = default;
+	ThreadSlot(const ThreadSlot&) = delete;
+	ThreadSlot& operator=(const ThreadSlot&) = delete;
+
+	~ThreadSlot()
+	{
+		if (Slot != ThreadSlotAllocator::InvalidSlot)
+		{
+			Owner->Release(Slot);
+		}
+	}
+
+	uint32_t Get(ThreadSlotAllocator& owner)
+	{
+		if (Slot == ThreadSlotAllocator::InvalidSlot)
+		{
+			Owner = &owner;
+			Slot = owner.Acquire();
+		}
+
+		return Slot;
+	}
+
+private:
+	ThreadSlotAllocator* Owner = nullptr;
+	uint32_t Slot = ThreadSlotAllocator::InvalidSlot;
+};
+
+}
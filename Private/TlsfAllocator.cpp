@@ -0,0 +1,413 @@
+#include "TlsfAllocator.h"
+
+#include <assert.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace rl
+{
+
+static uint32_t BitScanForward(uint64_t value)
+{
+	assert(value != 0u);
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return (uint32_t)index;
+#else
+	return (uint32_t)__builtin_ctzll(value);
+#endif
+}
+
+static uint32_t BitScanReverse(uint64_t value)
+{
+	assert(value != 0u);
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanReverse64(&index, value);
+	return (uint32_t)index;
+#else
+	return 63u - (uint32_t)__builtin_clzll(value);
+#endif
+}
+
+static uint64_t AlignUp(uint64_t offset, uint64_t alignment)
+{
+	const uint64_t remainder = offset % alignment;
+	return remainder ? offset + (alignment - remainder) : offset;
+}
+
+// Sizes below SecondLevelCount are stored linearly in the first list, everything else by highest bit then the next SecondLevelCountLog2 bits.
+static void MappingInsert(uint64_t size, uint32_t& outFirst, uint32_t& outSecond)
+{
+	if (size < TlsfAllocator::SecondLevelCount)
+	{
+		outFirst = 0u;
+		outSecond = (uint32_t)size;
+	}
+	else
+	{
+		const uint32_t log2 = BitScanReverse(size);
+
+		outFirst = log2 - TlsfAllocator::SecondLevelCountLog2 + 1u;
+		outSecond = (uint32_t)(size >> (log2 - TlsfAllocator::SecondLevelCountLog2)) ^ TlsfAllocator::SecondLevelCount;
+	}
+}
+
+// Rounds the size up to the next list so any block found there is large enough.
+static void MappingSearch(uint64_t size, uint32_t& outFirst, uint32_t& outSecond)
+{
+	if (size >= TlsfAllocator::SecondLevelCount)
+	{
+		const uint64_t round = (1ull << (BitScanReverse(size) - TlsfAllocator::SecondLevelCountLog2)) - 1u;
+
+		if (size + round < size)
+		{
+			outFirst = TlsfAllocator::FirstLevelCount;
+			outSecond = 0u;
+			return;
+		}
+
+		size += round;
+	}
+
+	MappingInsert(size, outFirst, outSecond);
+}
+
+TlsfAllocator::TlsfAllocator()
+{
+	Init(0u);
+}
+
+TlsfAllocator::TlsfAllocator(uint64_t size)
+{
+	Init(size);
+}
+
+void TlsfAllocator::Init(uint64_t size)
+{
+	Size = size;
+	FreeSize = size;
+	AllocationCount = 0u;
+
+	FirstLevelBitmap = 0u;
+
+	for (uint32_t fl = 0; fl < FirstLevelCount; fl++)
+	{
+		SecondLevelBitmaps[fl] = 0u;
+
+		for (uint32_t sl = 0; sl < SecondLevelCount; sl++)
+		{
+			FreeHeads[fl][sl] = TlsfAllocation::InvalidBlock;
+		}
+	}
+
+	Blocks.clear();
+	UnusedBlocks.clear();
+
+	if (size > 0u)
+	{
+		InsertFreeBlock(CreateBlock(0u, size));
+	}
+}
+
+bool TlsfAllocator::Alloc(uint64_t size, uint64_t alignment, TlsfAllocation& outAllocation)
+{
+	assert(size > 0u);
+
+	if (alignment == 0u)
+	{
+		alignment = 1u;
+	}
+
+	// The block offset is not known until one is found, so search with enough slack to align within any block.
+	// The search also rounds up to the next size class, so blocks that fit exactly are only found by checking the size's own class.
+	const uint64_t searchSize = size + (alignment - 1u);
+
+	uint32_t block = searchSize >= size ? FindFreeBlock(searchSize) : TlsfAllocation::InvalidBlock;
+	if (block == TlsfAllocation::InvalidBlock)
+	{
+		block = FindFittingBlockInClass(size, alignment);
+	}
+
+	if (block == TlsfAllocation::InvalidBlock)
+	{
+		return false;
+	}
+
+	RemoveFreeBlock(block);
+
+	// Physical neighbours of a free block are never free, so split off pieces can be inserted without merging.
+	const uint64_t padding = AlignUp(Blocks[block].Offset, alignment) - Blocks[block].Offset;
+	if (padding > 0u)
+	{
+		const uint32_t front = CreateBlock(Blocks[block].Offset, padding);
+		const uint32_t prev = Blocks[block].PrevPhysical;
+
+		Blocks[front].PrevPhysical = prev;
+		Blocks[front].NextPhysical = block;
+
+		if (prev != TlsfAllocation::InvalidBlock)
+		{
+			Blocks[prev].NextPhysical = front;
+		}
+
+		Blocks[block].PrevPhysical = front;
+		Blocks[block].Offset += padding;
+		Blocks[block].Size -= padding;
+
+		InsertFreeBlock(front);
+	}
+
+	const uint64_t remainder = Blocks[block].Size - size;
+	if (remainder > 0u)
+	{
+		const uint32_t back = CreateBlock(Blocks[block].Offset + size, remainder);
+		const uint32_t next = Blocks[block].NextPhysical;
+
+		Blocks[back].PrevPhysical = block;
+		Blocks[back].NextPhysical = next;
+
+		if (next != TlsfAllocation::InvalidBlock)
+		{
+			Blocks[next].PrevPhysical = back;
+		}
+
+		Blocks[block].NextPhysical = back;
+		Blocks[block].Size = size;
+
+		InsertFreeBlock(back);
+	}
+
+	FreeSize -= size;
+	AllocationCount++;
+
+	outAllocation.Offset = Blocks[block].Offset;
+	outAllocation.Size = size;
+	outAllocation.Block = block;
+
+	return true;
+}
+
+void TlsfAllocator::Free(const TlsfAllocation& allocation)
+{
+	uint32_t block = allocation.Block;
+
+	assert(block < Blocks.size() && !Blocks[block].Free && "TlsfAllocator::Free invalid allocation");
+	assert(Blocks[block].Offset == allocation.Offset && "TlsfAllocator::Free allocation does not match block");
+
+	FreeSize += Blocks[block].Size;
+	AllocationCount--;
+
+	const uint32_t prev = Blocks[block].PrevPhysical;
+	if (prev != TlsfAllocation::InvalidBlock && Blocks[prev].Free)
+	{
+		RemoveFreeBlock(prev);
+
+		const uint32_t next = Blocks[block].NextPhysical;
+
+		Blocks[prev].Size += Blocks[block].Size;
+		Blocks[prev].NextPhysical = next;
+
+		if (next != TlsfAllocation::InvalidBlock)
+		{
+			Blocks[next].PrevPhysical = prev;
+		}
+
+		DestroyBlock(block);
+
+		block = prev;
+	}
+
+	const uint32_t next = Blocks[block].NextPhysical;
+	if (next != TlsfAllocation::InvalidBlock && Blocks[next].Free)
+	{
+		RemoveFreeBlock(next);
+
+		const uint32_t nextNext = Blocks[next].NextPhysical;
+
+		Blocks[block].Size += Blocks[next].Size;
+		Blocks[block].NextPhysical = nextNext;
+
+		if (nextNext != TlsfAllocation::InvalidBlock)
+		{
+			Blocks[nextNext].PrevPhysical = block;
+		}
+
+		DestroyBlock(next);
+	}
+
+	InsertFreeBlock(block);
+}
+
+uint64_t TlsfAllocator::GetLargestFreeBlockHint() const
+{
+	if (FirstLevelBitmap == 0u)
+	{
+		return 0u;
+	}
+
+	const uint32_t fl = BitScanReverse(FirstLevelBitmap);
+	const uint32_t sl = BitScanReverse(SecondLevelBitmaps[fl]);
+
+	return Blocks[FreeHeads[fl][sl]].Size;
+}
+
+uint64_t TlsfAllocator::GetLargestFreeBlockUpperBound() const
+{
+	if (FirstLevelBitmap == 0u)
+	{
+		return 0u;
+	}
+
+	const uint32_t fl = BitScanReverse(FirstLevelBitmap);
+	const uint32_t sl = BitScanReverse(SecondLevelBitmaps[fl]);
+
+	if (fl == 0u)
+	{
+		return sl;
+	}
+
+	// Last size that maps into this list, see MappingInsert
+	return (((uint64_t)(SecondLevelCount | sl) + 1u) << (fl - 1u)) - 1u;
+}
+
+uint32_t TlsfAllocator::CreateBlock(uint64_t offset, uint64_t size)
+{
+	uint32_t block;
+
+	if (!UnusedBlocks.empty())
+	{
+		block = UnusedBlocks.back();
+		UnusedBlocks.pop_back();
+	}
+	else
+	{
+		block = (uint32_t)Blocks.size();
+		Blocks.emplace_back();
+	}
+
+	Blocks[block] = Block{};
+	Blocks[block].Offset = offset;
+	Blocks[block].Size = size;
+
+	return block;
+}
+
+void TlsfAllocator::DestroyBlock(uint32_t block)
+{
+	Blocks[block] = Block{};
+
+	UnusedBlocks.push_back(block);
+}
+
+void TlsfAllocator::InsertFreeBlock(uint32_t block)
+{
+	uint32_t fl, sl;
+	MappingInsert(Blocks[block].Size, fl, sl);
+
+	const uint32_t head = FreeHeads[fl][sl];
+
+	Blocks[block].Free = true;
+	Blocks[block].PrevFree = TlsfAllocation::InvalidBlock;
+	Blocks[block].NextFree = head;
+
+	if (head != TlsfAllocation::InvalidBlock)
+	{
+		Blocks[head].PrevFree = block;
+	}
+
+	FreeHeads[fl][sl] = block;
+
+	FirstLevelBitmap |= 1ull << fl;
+	SecondLevelBitmaps[fl] |= 1u << sl;
+}
+
+void TlsfAllocator::RemoveFreeBlock(uint32_t block)
+{
+	uint32_t fl, sl;
+	MappingInsert(Blocks[block].Size, fl, sl);
+
+	const uint32_t prev = Blocks[block].PrevFree;
+	const uint32_t next = Blocks[block].NextFree;
+
+	if (prev != TlsfAllocation::InvalidBlock)
+	{
+		Blocks[prev].NextFree = next;
+	}
+	else
+	{
+		FreeHeads[fl][sl] = next;
+	}
+
+	if (next != TlsfAllocation::InvalidBlock)
+	{
+		Blocks[next].PrevFree = prev;
+	}
+
+	if (FreeHeads[fl][sl] == TlsfAllocation::InvalidBlock)
+	{
+		SecondLevelBitmaps[fl] &= ~(1u << sl);
+
+		if (SecondLevelBitmaps[fl] == 0u)
+		{
+			FirstLevelBitmap &= ~(1ull << fl);
+		}
+	}
+
+	Blocks[block].Free = false;
+	Blocks[block].PrevFree = TlsfAllocation::InvalidBlock;
+	Blocks[block].NextFree = TlsfAllocation::InvalidBlock;
+}
+
+uint32_t TlsfAllocator::FindFittingBlockInClass(uint64_t size, uint64_t alignment) const
+{
+	uint32_t fl, sl;
+	MappingInsert(size, fl, sl);
+
+	for (uint32_t block = FreeHeads[fl][sl]; block != TlsfAllocation::InvalidBlock; block = Blocks[block].NextFree)
+	{
+		const uint64_t padding = AlignUp(Blocks[block].Offset, alignment) - Blocks[block].Offset;
+
+		if (padding <= Blocks[block].Size && Blocks[block].Size - padding >= size)
+		{
+			return block;
+		}
+	}
+
+	return TlsfAllocation::InvalidBlock;
+}
+
+uint32_t TlsfAllocator::FindFreeBlock(uint64_t size) const
+{
+	uint32_t fl, sl;
+	MappingSearch(size, fl, sl);
+
+	if (fl >= FirstLevelCount)
+	{
+		return TlsfAllocation::InvalidBlock;
+	}
+
+	uint32_t secondLevelMap = SecondLevelBitmaps[fl] & (~0u << sl);
+
+	if (secondLevelMap == 0u)
+	{
+		const uint64_t firstLevelMap = (fl + 1u < 64u) ? FirstLevelBitmap & (~0ull << (fl + 1u)) : 0u;
+
+		if (firstLevelMap == 0u)
+		{
+			return TlsfAllocation::InvalidBlock;
+		}
+
+		fl = BitScanForward(firstLevelMap);
+		secondLevelMap = SecondLevelBitmaps[fl];
+	}
+
+	sl = BitScanForward(secondLevelMap);
+
+	return FreeHeads[fl][sl];
+}
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace rl
+{
+
+// Two level segregated fit allocator over an abstract range of offsets, it never touches the memory it manages.
+// Alloc and Free are constant time, blocks are stored out of line so it can suballocate gpu memory for any backend.
+struct TlsfAllocation
+{
+	static constexpr uint32_t InvalidBlock = ~0u;
+
+	uint64_t Offset = 0u;
+	uint64_t Size = 0u;
+
+	uint32_t Block = InvalidBlock;
+
+	bool Valid() const { return Block != InvalidBlock; }
+};
+
+struct TlsfAllocator
+{
+	static constexpr uint32_t SecondLevelCountLog2 = 5u;
+	static constexpr uint32_t SecondLevelCount = 1u << SecondLevelCountLog2;
+	static constexpr uint32_t FirstLevelCount = 64u - SecondLevelCountLog2 + 1u;
+
+	TlsfAllocator();
+	explicit TlsfAllocator(uint64_t size);
+
+	void Init(uint64_t size);
+
+	// Alignment does not need to be a power of two, the returned size is exactly the requested size.
+	bool Alloc(uint64_t size, uint64_t alignment, TlsfAllocation& outAllocation);
+	void Free(const TlsfAllocation& allocation);
+
+	uint64_t GetSize() const { return Size; }
+	uint64_t GetFreeSize() const { return FreeSize; }
+	uint32_t GetAllocationCount() const { return AllocationCount; }
+
+	// Lower bound of the largest free block, exact when the largest size class holds a single block.
+	uint64_t GetLargestFreeBlockHint() const;
+
+	// Upper bound of the largest free block, any allocation needing more than this is guaranteed to fail.
+	uint64_t GetLargestFreeBlockUpperBound() const;
+
+private:
+	struct Block
+	{
+		uint64_t Offset = 0u;
+		uint64_t Size = 0u;
+
+		uint32_t PrevPhysical = TlsfAllocation::InvalidBlock;
+		uint32_t NextPhysical = TlsfAllocation::InvalidBlock;
+		uint32_t PrevFree = TlsfAllocation::InvalidBlock;
+		uint32_t NextFree = TlsfAllocation::InvalidBlock;
+
+		bool Free = false;
+	};
+
+	uint64_t Size = 0u;
+	uint64_t FreeSize = 0u;
+	uint32_t AllocationCount = 0u;
+
+	uint64_t FirstLevelBitmap = 0u;
+	uint32_t SecondLevelBitmaps[FirstLevelCount] = {};
+	uint32_t FreeHeads[FirstLevelCount][SecondLevelCount];
+
+	std::vector<Block> Blocks;
+	std::vector<uint32_t> UnusedBlocks;
+
+	uint32_t CreateBlock(uint64_t offset, uint64_t size);
+	void DestroyBlock(uint32_t block);
+
+	void InsertFreeBlock(uint32_t block);
+	void RemoveFreeBlock(uint32_t block);
+
+	uint32_t FindFreeBlock(uint64_t size) const;
+
+	// Walks the free list of the size's own class, slower than FindFreeBlock but finds blocks that fit with no slack to spare.
+	uint32_t FindFittingBlockInClass(uint64_t size, uint64_t alignment) const;
+};
+
+}
@@ -11,11 +11,23 @@ RENDER_TYPE(DepthStencilView_t);
 
 FWD_RENDER_TYPE(Texture_t);
 FWD_RENDER_TYPE(StructuredBuffer_t);
+FWD_RENDER_TYPE(DynamicBuffer_t);
 
 enum class TextureDimension : uint8_t;
 
 struct TextureCreateDescEx;
 
+// The mips and slices of a texture a view covers, so a pass can read one mip or slice of a texture while writing another.
+// Slices are array slices, faces for cubemaps (6 per cube) and depth slices of FirstMip for 3D UAVs and RTVs, non array dimensions ignore them.
+// Only SRVs use MipLevels, the other views cover FirstMip alone.
+struct TextureViewRange
+{
+	uint32_t FirstMip = 0u;
+	uint32_t MipLevels = ~0u;	// ~0u for every mip from FirstMip
+	uint32_t FirstSlice = 0u;
+	uint32_t SliceCount = 1u;
+};
+
 ShaderResourceView_t CreateTextureSRV(Texture_t tex, RenderFormat format, TextureDimension dim, uint32_t mipLevels, uint32_t depthOrArraySize);
 UnorderedAccessView_t CreateTextureUAV(Texture_t tex, RenderFormat format, TextureDimension dim, uint32_t depthOrArraySize);
 RenderTargetView_t CreateTextureRTV(Texture_t tex, RenderFormat format, TextureDimension dim, uint32_t depthOrArraySize);
@@ -28,9 +40,29 @@ UnorderedAccessView_t CreateTextureUAV(Texture_t tex);
 RenderTargetView_t CreateTextureRTV(Texture_t tex);
 DepthStencilView_t CreateTextureDSV(Texture_t tex, RenderFormat depthFormat);
 
+ShaderResourceView_t CreateTextureSRV(Texture_t tex, RenderFormat format, TextureDimension dim, const TextureViewRange& range);
+UnorderedAccessView_t CreateTextureUAV(Texture_t tex, RenderFormat format, TextureDimension dim, const TextureViewRange& range);
+RenderTargetView_t CreateTextureRTV(Texture_t tex, RenderFormat format, TextureDimension dim, const TextureViewRange& range);
+DepthStencilView_t CreateTextureDSV(Texture_t tex, RenderFormat format, TextureDimension dim, const TextureViewRange& range);
+
+// Ranges of a texture using its own format and dimension.
+ShaderResourceView_t CreateTextureSRV(Texture_t tex, const TextureViewRange& range);
+UnorderedAccessView_t CreateTextureUAV(Texture_t tex, const TextureViewRange& range);
+RenderTargetView_t CreateTextureRTV(Texture_t tex, const TextureViewRange& range);
+DepthStencilView_t CreateTextureDSV(Texture_t tex, RenderFormat depthFormat, const TextureViewRange& range);
+
 ShaderResourceView_t CreateStructuredBufferSRV(StructuredBuffer_t buf, uint32_t firstElem, uint32_t numElems, uint32_t stride);
 UnorderedAccessView_t CreateStructuredBufferUAV(StructuredBuffer_t buf, uint32_t firstElem, uint32_t numElems, uint32_t stride);
 
+// Raw views of buffers created with BufferUsage::RAW, elements are 4 byte words.
+ShaderResourceView_t CreateByteBufferSRV(StructuredBuffer_t buf, uint32_t firstElem, uint32_t numElems);
+UnorderedAccessView_t CreateByteBufferUAV(StructuredBuffer_t buf, uint32_t firstElem, uint32_t numElems);
+
+// Bindless views of a dynamic buffer's memory, returned as descriptor indices that are valid until the end of the frame.
+// They come from a per frame range of the descriptor heap so nothing needs releasing, 0 if the api isn't bindless.
+uint32_t CreateDynamicStructuredBufferSRV(DynamicBuffer_t buf, uint32_t stride);
+uint32_t CreateDynamicByteBufferSRV(DynamicBuffer_t buf);
+
 //TODO: Buffer SRV and UAV
 ShaderResourceView_t AllocSRV(RenderFormat format, TextureDimension dim, uint32_t mipLevels, uint32_t depthOrArraySize);
 UnorderedAccessView_t AllocUAV(RenderFormat format, TextureDimension dim, uint32_t depthOrArraySize);
@@ -2,13 +2,6 @@
 
 #include "RenderTypes.h"
 
-// TODO:
-// Add support for byte buffers
-//	I think the best approach for byte buffers would be to create a GenericBuffer_t type with BufferUsage flags passed to it telling it what kind of buffer
-//	it can be. Currently we can't have a struct buf and a vertex buf mapped to the same memory, even though this is possible in our APIs.
-//	As well as having explicitly typed buffers having one that we can reinterpret in different ways would be a lot more flexible.
-//	The explicit buffer creation code could then just create a generic buffer with fixed flags, then perhaps the returned explicit buffers are just casted from the generic buffer ID.
-
 namespace rl
 {
 
@@ -17,27 +10,79 @@ RENDER_TYPE(IndexBuffer_t);
 RENDER_TYPE(StructuredBuffer_t);
 RENDER_TYPE(ConstantBuffer_t);
 RENDER_TYPE(DynamicBuffer_t);
+RENDER_TYPE(Buffer_t);
 
 VertexBuffer_t CreateVertexBuffer(const void* const data, size_t size);
 IndexBuffer_t CreateIndexBuffer(const void* const data, size_t size);
 StructuredBuffer_t CreateStructuredBuffer(const void* const data, size_t size, size_t stride, RenderResourceFlags flags);
 ConstantBuffer_t CreateConstantBuffer(const void* const data, size_t size);
 
+// One allocation that can be used in every role in usage, so geometry used for both rasterization and compute or raytracing is only uploaded once.
+// Structured, raw, indirect args and UAV usage are all reached through the structured buffer view, stride is only needed for structured usage.
+// On dx11 structured usage can't be combined with vertex, index, raw or indirect args usage, view the buffer as raw instead.
+Buffer_t CreateBuffer(const void* const data, size_t size, size_t stride, BufferUsage usage);
+
+// Views of a generic buffer, INVALID if the buffer wasn't created with that usage.
+// They are owned by the buffer and stay valid until it is released, so don't release them separately.
+VertexBuffer_t GetVertexBuffer(Buffer_t buf);
+IndexBuffer_t GetIndexBuffer(Buffer_t buf);
+StructuredBuffer_t GetStructuredBuffer(Buffer_t buf);
+
+// Size the buffer was created with, 0 for an invalid handle.
+size_t GetBufferSize(Buffer_t buf);
+
+// Creates the buffer from size bytes of a file starting at offset, a size of 0 takes the rest of the file.
+// The file is memory mapped and copied straight into upload memory, so large files never need a second copy in a read buffer.
+VertexBuffer_t CreateVertexBufferFromFile(const char* path, size_t offset = 0u, size_t size = 0u);
+IndexBuffer_t CreateIndexBufferFromFile(const char* path, size_t offset = 0u, size_t size = 0u);
+StructuredBuffer_t CreateStructuredBufferFromFile(const char* path, size_t stride, RenderResourceFlags flags, size_t offset = 0u, size_t size = 0u);
+Buffer_t CreateBufferFromFile(const char* path, size_t stride, BufferUsage usage, size_t offset = 0u, size_t size = 0u);
+
+// Dynamic buffers only live until the end of the frame, on dx12 they can be created from any thread between Render_BeginFrame and Render_EndFrame.
+// On dx12 up to 64 threads can create them at once, a thread's slot is reused once it has exited and the frame has ended, beyond that creation fails with INVALID.
 DynamicBuffer_t CreateDynamicVertexBuffer(const void* const data, size_t size);
 DynamicBuffer_t CreateDynamicIndexBuffer(const void* const data, size_t size);
 DynamicBuffer_t CreateDynamicConstantBuffer(const void* const data, size_t size);
 DynamicBuffer_t CreateDynamicByteBuffer(const void* const data, size_t size);
 
+enum class DynamicBufferKind : uint8_t
+{
+	VERTEX,
+	INDEX,
+	CONSTANT,
+	BYTE,	// Dx12 only, read through CreateDynamicByteBufferSRV
+};
+
+struct DynamicBufferAllocation
+{
+	DynamicBuffer_t Buffer = DynamicBuffer_t::INVALID;
+	void* pData = nullptr;	// Write combined upload memory, write it sequentially and never read it back
+	size_t Size = 0u;
+};
+
+// Returns a dynamic buffer with a pointer to its memory, so per frame data can be written in place instead of built elsewhere and copied in.
+// On dx11 the memory can only be written until that buffer is first bound or the frame ends, binding it unmaps only that buffer.
+// Dx11 can't bind dynamic buffers as shader resources, so BYTE allocations return an empty DynamicBufferAllocation there.
+DynamicBufferAllocation AllocateDynamic(size_t size, DynamicBufferKind kind);
+
 void UpdateVertexBuffer(VertexBuffer_t vb, const void* const data, size_t size);
 void UpdateIndexBuffer(IndexBuffer_t ib, const void* const data, size_t size);
 void UpdateConstantBuffer(ConstantBuffer_t cb, const void* const data, size_t size);
 void UpdateStructuredBuffer(StructuredBuffer_t sb, const void* const data, size_t size);
+void UpdateBuffer(Buffer_t buf, const void* const data, size_t size);
+
+// Updates size bytes starting at offset, only the changed range is uploaded.
+void UpdateVertexBufferRange(VertexBuffer_t vb, const void* const data, size_t offset, size_t size);
+void UpdateIndexBufferRange(IndexBuffer_t ib, const void* const data, size_t offset, size_t size);
+void UpdateStructuredBufferRange(StructuredBuffer_t sb, const void* const data, size_t offset, size_t size);
+void UpdateBufferRange(Buffer_t buf, const void* const data, size_t offset, size_t size);
 
 template<typename T> inline VertexBuffer_t CreateVertexBufferFromArray(const T* const data, size_t count) { return CreateVertexBuffer(data, sizeof(T) * count); }
 template<typename T> inline IndexBuffer_t CreateIndexBufferFromArray(const T* const data, size_t count) { return CreateIndexBuffer(data, sizeof(T) * count); }
 template<typename T> inline StructuredBuffer_t CreateStructuredBuffer(const T* const data, size_t count) { return CreateStructuredBuffer(data, sizeof(T) * count, sizeof(T), RenderResourceFlags::SRV); }
 template<typename T> inline StructuredBuffer_t CreateRWStructuredBuffer(const T* const data, size_t count) { return CreateStructuredBuffer(data, sizeof(T) * count, sizeof(T), RenderResourceFlags::UAV); }
 template<typename T> inline ConstantBuffer_t CreateConstantBuffer(const T* const data) { return CreateConstantBuffer(data, sizeof(T)); }
+template<typename T> inline Buffer_t CreateBufferFromArray(const T* const data, size_t count, BufferUsage usage) { return CreateBuffer(data, sizeof(T) * count, sizeof(T), usage); }
 
 template<typename T> inline DynamicBuffer_t CreateDynamicVertexBufferFromArray(const T* const data, size_t count) { return CreateDynamicVertexBuffer(data, sizeof(T) * count); }
 template<typename T> inline DynamicBuffer_t CreateDynamicIndexBufferFromArray(const T* const data, size_t count) { return CreateDynamicIndexBuffer(data, sizeof(T) * count); }
@@ -46,28 +91,74 @@ template<typename T> inline DynamicBuffer_t CreateDynamicByteBufferFromArray(con
 
 template<typename T> inline void UpdateVertexBufferFromArray(VertexBuffer_t vb, const T* const data, size_t count) { UpdateVertexBuffer(vb, data, sizeof(T) * count); }
 template<typename T> inline void UpdateIndexBufferFromArray(IndexBuffer_t ib, const T* const data, size_t count) { UpdateIndexBuffer(ib, data, sizeof(T) * count); }
-template<typename T> inline void UpdateConstantBuffer(ConstantBuffer_t cb, const T* const data) { UpdateConstantBuffer(cb, sizeof(T)); }
+template<typename T> inline void UpdateConstantBuffer(ConstantBuffer_t cb, const T* const data) { UpdateConstantBuffer(cb, data, sizeof(T)); }
 template<typename T> inline void UpdateStructuredBufferFromArray(StructuredBuffer_t sb, const T* const data, size_t count) { UpdateStructuredBuffer(sb, data, sizeof(T) * count); }
+template<typename T> inline void UpdateBufferFromArray(Buffer_t buf, const T* const data, size_t count) { UpdateBuffer(buf, data, sizeof(T) * count); }
+
+template<typename T> inline void UpdateVertexBufferRangeFromArray(VertexBuffer_t vb, const T* const data, size_t first, size_t count) { UpdateVertexBufferRange(vb, data, sizeof(T) * first, sizeof(T) * count); }
+template<typename T> inline void UpdateIndexBufferRangeFromArray(IndexBuffer_t ib, const T* const data, size_t first, size_t count) { UpdateIndexBufferRange(ib, data, sizeof(T) * first, sizeof(T) * count); }
+template<typename T> inline void UpdateStructuredBufferRangeFromArray(StructuredBuffer_t sb, const T* const data, size_t first, size_t count) { UpdateStructuredBufferRange(sb, data, sizeof(T) * first, sizeof(T) * count); }
+template<typename T> inline void UpdateBufferRangeFromArray(Buffer_t buf, const T* const data, size_t first, size_t count) { UpdateBufferRange(buf, data, sizeof(T) * first, sizeof(T) * count); }
 
 void RenderRelease(VertexBuffer_t vb);
 void RenderRelease(IndexBuffer_t ib);
 void RenderRelease(StructuredBuffer_t sb);
 void RenderRelease(ConstantBuffer_t cb);
+void RenderRelease(Buffer_t buf);
 
 void RenderRef(VertexBuffer_t vb);
 void RenderRef(IndexBuffer_t ib);
 void RenderRef(StructuredBuffer_t sb);
 void RenderRef(ConstantBuffer_t cb);
+void RenderRef(Buffer_t buf);
 
 void DynamicBuffers_NewFrame();
 void DynamicBuffers_EndFrame();
 
 struct CommandList;
+// Submits pending static buffer uploads, on dx12 these go to the copy queue and cl waits for them on the gpu when executed.
+// Call from the thread that submits command lists, buffers can be created, updated and destroyed from any thread.
 void UploadBuffers(CommandList* cl);
 
+// Returns a fence that completes once every static buffer create and update made so far by this thread has landed on the gpu.
+// On dx12 this submits pending uploads, so poll IsBufferUploadComplete rather than asking for a new fence every frame.
+uint64_t GetBufferUploadFence();
+bool IsBufferUploadComplete(uint64_t fence);
+
+struct BufferResidencyReport
+{
+	size_t DeviceBytes = 0u;	// Device local memory backing static buffers
+	size_t StagingBytes = 0u;	// Upload memory currently held for staging static buffer data
+	size_t SavedBytes = 0u;		// Upload memory saved compared to keeping a full upload copy of every static buffer
+};
+
+BufferResidencyReport GetBufferResidencyReport();
+
+struct BufferFragmentationReport
+{
+	uint32_t PageCount = 0u;	// Pages static buffers are suballocated from
+	size_t ReservedBytes = 0u;	// Device memory held by those pages
+	size_t UsedBytes = 0u;		// Bytes allocated from them
+};
+
+struct BufferCompactionReport
+{
+	BufferFragmentationReport Before;
+	BufferFragmentationReport After;	// Once the emptied pages are released, which waits for the gpu to finish with them
+
+	size_t MovedBytes = 0u;
+	uint32_t MovedBuffers = 0u;
+	uint32_t ReleasedPages = 0u;
+};
+
+// Moves live static buffers out of sparsely used pages so the pages can be released, copying at most byteBudget bytes.
+// Handles stay valid, call it between frames after the command lists using the buffers have been executed.
+BufferCompactionReport CompactBuffers(size_t byteBudget);
+
 size_t GetVertexBufferCount();
 size_t GetIndexBufferCount();
 size_t GetStructuredBufferCount();
 size_t GetConstantBufferCount();
+size_t GetBufferCount();
 
 }
\ No newline at end of file
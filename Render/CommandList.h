@@ -119,8 +119,16 @@ struct CommandList
 	void SetGraphicsRootDescriptorTable(uint32_t slot);
 	void SetComputeRootDescriptorTable(uint32_t slot);
 
+	// Binds every runtime sampler, index the table with GetDescriptorIndex(Sampler_t).
+	void SetGraphicsRootSamplerTable(uint32_t slot);
+	void SetComputeRootSamplerTable(uint32_t slot);
+
 	void TransitionResource(Texture_t tex, ResourceTransitionState before, ResourceTransitionState after);
+	// On dx12 UAV buffers under 64KB share a resource, a transition or barrier applies to every buffer in it.
 	void TransitionResource(StructuredBuffer_t buf, ResourceTransitionState before, ResourceTransitionState after);
+
+	// One mip of one slice, so passes using range views can read and write different parts of the same texture.
+	void TransitionResource(Texture_t tex, uint32_t mip, uint32_t slice, ResourceTransitionState before, ResourceTransitionState after);
 	void UAVBarrier(Texture_t tex);
 	void UAVBarrier(StructuredBuffer_t buf);
 
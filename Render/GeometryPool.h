@@ -0,0 +1,65 @@
+#pragma once
+
+#include "RenderTypes.h"
+
+namespace rl
+{
+
+RENDER_TYPE(GeometryPool_t);
+
+FWD_RENDER_TYPE(VertexBuffer_t);
+FWD_RENDER_TYPE(IndexBuffer_t);
+FWD_RENDER_TYPE(StructuredBuffer_t);
+
+struct CommandList;
+
+// Suballocates the vertex and index data of many meshes from one vertex buffer and one index buffer.
+// Every mesh in a pool draws with the same input assembler bindings, so draws can be merged into indirect calls or fetch vertices bindlessly.
+struct GeometryPoolDesc
+{
+	uint32_t VertexStride = 0u;
+	uint32_t VertexCapacity = 0u;	// In vertices
+
+	RenderFormat IndexFormat = RenderFormat::R32_UINT;
+	uint32_t IndexCapacity = 0u;	// In indices
+};
+
+// A mesh's range within its pool, indices are relative to the mesh's first vertex.
+struct GeometryAllocation
+{
+	uint32_t BaseVertex = 0u;
+	uint32_t VertexCount = 0u;
+
+	uint32_t FirstIndex = 0u;
+	uint32_t IndexCount = 0u;
+
+	uint32_t VertexBlock = ~0u;
+	uint32_t IndexBlock = ~0u;
+
+	bool Valid() const { return VertexBlock != ~0u; }
+};
+
+// Pools have a fixed capacity, create another pool once allocations start failing.
+GeometryPool_t CreateGeometryPool(const GeometryPoolDesc& desc);
+
+// Uploads the mesh into the pool, indices are optional for non indexed meshes.
+bool AllocGeometry(GeometryPool_t pool, const void* const vertices, uint32_t vertexCount, const void* const indices, uint32_t indexCount, GeometryAllocation& outAllocation);
+// The range is reused once the gpu has finished the frames that could still draw it.
+void FreeGeometry(GeometryPool_t pool, const GeometryAllocation& allocation);
+
+// The pool's buffers, the structured buffers are raw views for bindless vertex and index fetch.
+VertexBuffer_t GetGeometryPoolVertexBuffer(GeometryPool_t pool);
+IndexBuffer_t GetGeometryPoolIndexBuffer(GeometryPool_t pool);
+StructuredBuffer_t GetGeometryPoolVertexData(GeometryPool_t pool);
+StructuredBuffer_t GetGeometryPoolIndexData(GeometryPool_t pool);
+
+// Binds the pool's vertex buffer to slot 0 and its index buffer, shared by every draw from the pool.
+void SetGeometryPool(CommandList* cl, GeometryPool_t pool);
+void DrawGeometry(CommandList* cl, const GeometryAllocation& allocation, uint32_t numInstances = 1u, uint32_t startInstance = 0u);
+
+void RenderRelease(GeometryPool_t pool);
+void RenderRef(GeometryPool_t pool);
+
+size_t GetGeometryPoolCount();
+
+}
\ No newline at end of file
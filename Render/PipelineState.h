@@ -208,6 +208,7 @@ struct ComputePipelineStateDesc
 	std::wstring DebugName;
 };
 
+// Creating a pipeline identical to a live one, debug name included, returns another ref to the existing handle.
 GraphicsPipelineState_t CreateGraphicsPipelineState(const GraphicsPipelineStateDesc& desc, const InputElementDesc* inputs = nullptr, size_t inputCount = 0);
 ComputePipelineState_t CreateComputePipelineState(const ComputePipelineStateDesc& desc);
 
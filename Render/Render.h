@@ -5,12 +5,14 @@
 #include "Binding.h"
 #include "Buffers.h"
 #include "CommandList.h"
+#include "GeometryPool.h"
 #include "IndirectCommands.h"
 #include "PipelineState.h"
 #include "RenderTypes.h"
 #include "RootSignature.h"
 #include "Samplers.h"
 #include "Shaders.h"
+#include "Streaming.h"
 #include "Textures.h"
 #include "View.h"
 
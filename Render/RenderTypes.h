@@ -4,12 +4,15 @@
 
 #include <assert.h>
 #include <cstdint>
+#include <cstring>
 
 #include <memory>
 #include <string>
 #include <vector>
 
+#if defined(_WIN32)
 #include <wrl.h>
+#endif
 
 #define RENDER_TYPE(t) enum class t : uint32_t {INVALID}
 #define FWD_RENDER_TYPE(t) enum class t : uint32_t
@@ -26,6 +29,8 @@ FWD_RENDER_TYPE(IndexBuffer_t);
 FWD_RENDER_TYPE(StructuredBuffer_t);
 FWD_RENDER_TYPE(ConstantBuffer_t);
 FWD_RENDER_TYPE(DynamicBuffer_t);
+FWD_RENDER_TYPE(Buffer_t);
+FWD_RENDER_TYPE(GeometryPool_t);
 FWD_RENDER_TYPE(GraphicsPipelineState_t);
 FWD_RENDER_TYPE(ComputePipelineState_t);
 FWD_RENDER_TYPE(RootSignature_t);
@@ -51,6 +56,8 @@ using VertexBufferPtr = RenderPtr<VertexBuffer_t>;
 using IndexBufferPtr = RenderPtr<IndexBuffer_t>;
 using StructuredBufferPtr = RenderPtr<StructuredBuffer_t>;
 using ConstantBufferPtr = RenderPtr<ConstantBuffer_t>;
+using BufferPtr = RenderPtr<Buffer_t>;
+using GeometryPoolPtr = RenderPtr<GeometryPool_t>;
 using GraphicsPipelineStatePtr = RenderPtr<GraphicsPipelineState_t>;
 using ComputePipelineStatePtr = RenderPtr<ComputePipelineState_t>;
 using RootSignaturePtr = RenderPtr<RootSignature_t>;
@@ -69,8 +76,10 @@ struct RenderInitParams;
 
 using ShaderMacros = std::vector<ShaderMacro>;
 
+#if defined(_WIN32)
 template<typename T>
 using ComPtr = Microsoft::WRL::ComPtr<T>;
+#endif
 
 #define IMPLEMENT_FLAGS(e, underlyingType) \
 constexpr inline e operator&(e lhs, e rhs) noexcept {return (e)((underlyingType)lhs & (underlyingType)rhs); } \
@@ -303,6 +312,19 @@ enum class RenderResourceFlags : uint8_t
 };
 IMPLEMENT_FLAGS(RenderResourceFlags, uint8_t)
 
+// Every role a generic buffer can be bound or viewed as, they all share the buffer's memory.
+enum class BufferUsage : uint8_t
+{
+    NONE = 0u,
+    VERTEX = (1u << 0u),
+    INDEX = (1u << 1u),
+    STRUCTURED = (1u << 2u),
+    RAW = (1u << 3u),
+    INDIRECT_ARGS = (1u << 4u),
+    UAV = (1u << 5u),
+};
+IMPLEMENT_FLAGS(BufferUsage, uint8_t)
+
 enum class ResourceUsage : uint8_t
 {
     DEFAULT,
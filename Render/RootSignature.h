@@ -28,6 +28,7 @@ enum class RootSignatureDescriptorTableType : uint32_t
 	NONE,
 	SRV,
 	UAV,
+	SAMPLER,
 };
 
 struct RootSignatureSlot
@@ -2,6 +2,8 @@
 
 #include "RenderTypes.h"
 
+#include <cfloat>
+
 namespace rl
 {
 
@@ -53,7 +55,7 @@ struct SamplerDesc
 			SamplerAddressMode V;
 			SamplerAddressMode W;
 		} AddressMode;
-		uint32_t Opaque = 0;
+		uint32_t AddressModeOpaque = 0;
 	};
 
 	union
@@ -64,7 +66,7 @@ struct SamplerDesc
 			SamplerFilterMode Mag;
 			SamplerFilterMode Mip;
 		} FilterMode;
-		uint32_t Opaque = 0;
+		uint32_t FilterModeOpaque = 0;
 	};
 
 	SamplerComparisonFunc Comparison = SamplerComparisonFunc::NONE;
@@ -74,7 +76,7 @@ struct SamplerDesc
 	SamplerBorderColor BorderColor = SamplerBorderColor::TRANSPARENT_BLACK;
 	uint32_t MaxAnisotropy = 16;
 
-	ShaderVisibility Visibility = ShaderVisibility::ALL;
+	rl::ShaderVisibility Visibility = rl::ShaderVisibility::ALL;
 
 	inline SamplerDesc& AddressModeUVW(SamplerAddressMode am) noexcept
 	{
@@ -96,10 +98,24 @@ struct SamplerDesc
 		BorderColor = col; return *this;
 	}
 
-	inline SamplerDesc& ShaderVisibility(ShaderVisibility InVisibility) noexcept
+	inline SamplerDesc& ShaderVisibility(rl::ShaderVisibility InVisibility) noexcept
 	{
 		Visibility = InVisibility; return *this;
 	}
 };
 
+RENDER_TYPE(Sampler_t);
+
+// Samplers created at runtime live in a bindless sampler heap, so materials can pick one by index without a new root signature.
+// Identical descs share one sampler, visibility is ignored since heap samplers are visible to every stage.
+Sampler_t CreateSampler(const SamplerDesc& desc);
+
+// Index into a root signature's sampler descriptor table, see CommandList::SetGraphicsRootSamplerTable.
+uint32_t GetDescriptorIndex(Sampler_t sampler);
+
+void RenderRef(Sampler_t sampler);
+void RenderRelease(Sampler_t sampler);
+
+size_t GetSamplerCount();
+
 }
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Buffers.h"
+
+#include <functional>
+
+namespace rl
+{
+
+enum class StreamPriority : uint8_t
+{
+	LOW,
+	NORMAL,
+	HIGH,
+};
+
+// Called from Streaming_Update once the data has landed on the gpu.
+// success is false if the file range couldn't be read or doesn't fit in the destination buffer from DstOffset, nothing is written then.
+using StreamCallback = std::function<void(bool success)>;
+
+struct StreamRequest
+{
+	std::string Path;
+	size_t FileOffset = 0u;
+	size_t Size = 0u;	// 0 streams the rest of the file
+
+	Buffer_t Dst = Buffer_t::INVALID;
+	size_t DstOffset = 0u;
+
+	StreamPriority Priority = StreamPriority::NORMAL;
+	StreamCallback OnComplete;
+};
+
+struct StreamingDesc
+{
+	// Bytes read but not yet known to be on the gpu, the worker stops taking requests while it is exceeded.
+	size_t MaxInFlightBytes = 64u * 1024u * 1024u;
+
+	// Reads of up to 1MB the worker keeps in flight at once.
+	uint32_t ReadQueueDepth = 32u;
+};
+
+struct StreamingStats
+{
+	uint32_t QueuedRequests = 0u;
+	uint32_t InFlightRequests = 0u;
+	size_t InFlightBytes = 0u;
+	size_t StreamedBytes = 0u;
+};
+
+// Streams file ranges into buffers on a worker thread.
+// The worker keeps many reads in flight, with io_uring on linux and overlapped reads on windows, and records each copy once its read completes.
+// Higher priority requests are started first and same priority requests in order.
+bool Streaming_Init(const StreamingDesc& desc);
+void Streaming_ShutDown();
+
+// Holds a reference to the destination buffer until the request completes.
+bool StreamToBuffer(StreamRequest&& request);
+
+// Call once a frame from the thread that submits command lists, it records copies for apis that aren't thread safe and runs completion callbacks.
+void Streaming_Update();
+
+StreamingStats GetStreamingStats();
+
+}
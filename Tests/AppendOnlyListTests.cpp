@@ -0,0 +1,128 @@
+#include "Test.h"
+
+#include "AppendOnlyList.h"
+
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace rl;
+
+struct Entry
+{
+	uint64_t Offset = 0u;
+	uint64_t Size = 0u;
+};
+
+static void TestPushAndFind()
+{
+	AppendOnlyList<Entry, 4u, 2u> list;
+
+	TEST_CHECK(list.Find(0u) == nullptr);
+
+	for (uint32_t i = 0; i < 8u; i++)
+	{
+		TEST_CHECK(list.Push({ i * 256u, 256u }) == i);
+	}
+
+	// Full, nothing past the last block is written
+	TEST_CHECK(list.Push({}) == (AppendOnlyList<Entry, 4u, 2u>::InvalidIndex));
+	TEST_CHECK(list.GetCount() == 8u);
+
+	for (uint32_t i = 0; i < 8u; i++)
+	{
+		const Entry* entry = list.Find(i);
+		TEST_CHECK(entry && entry->Offset == i * 256u);
+	}
+
+	TEST_CHECK(list.Find(8u) == nullptr);
+}
+
+// Cleared entries can't be found, and pushing again reuses the blocks in place.
+static void TestClearKeepsBlocks()
+{
+	AppendOnlyList<Entry, 4u, 2u> list;
+
+	for (uint32_t i = 0; i < 6u; i++)
+	{
+		list.Push({ i, 1u });
+	}
+
+	const Entry* first = list.Find(0u);
+
+	list.Clear();
+	TEST_CHECK(list.GetCount() == 0u && list.Find(0u) == nullptr);
+
+	TEST_CHECK(list.Push({ 100u, 1u }) == 0u);
+	TEST_CHECK(list.Find(0u) == first && first->Offset == 100u);
+}
+
+// One thread records dynamic buffers while others resolve handles to what it has pushed so far, like command lists recorded on other threads binding them.
+// Each entry is derived from its frame and index, so a reader seeing a block or entry before it was published fails a check and ThreadSanitizer sees the handover.
+static void TestReadersWhileOwnerPushes()
+{
+	constexpr uint32_t ReaderCount = 4u;
+	constexpr uint32_t FrameCount = 10u;
+	constexpr uint32_t EntriesPerFrame = 20000u;
+
+	AppendOnlyList<Entry, 1024u, 32u> list;
+
+	for (uint32_t frame = 0; frame < FrameCount; frame++)
+	{
+		std::atomic<bool> recording = true;
+		std::vector<std::thread> readers;
+
+		for (uint32_t reader = 0; reader < ReaderCount; reader++)
+		{
+			readers.emplace_back([&, reader]
+			{
+				std::mt19937 rng(frame * ReaderCount + reader + 1u);
+
+				while (recording.load(std::memory_order_relaxed))
+				{
+					const uint32_t count = list.GetCount();
+
+					if (count == 0u)
+					{
+						continue;
+					}
+
+					const uint32_t index = rng() % count;
+					const Entry* entry = list.Find(index);
+
+					TEST_CHECK(entry != nullptr);
+
+					if (entry)
+					{
+						TEST_CHECK(entry->Offset == ((uint64_t)frame << 32u | index) && entry->Size == index * 16u + 16u);
+					}
+				}
+			});
+		}
+
+		for (uint32_t index = 0; index < EntriesPerFrame; index++)
+		{
+			TEST_CHECK(list.Push({ (uint64_t)frame << 32u | index, index * 16u + 16u }) == index);
+		}
+
+		recording.store(false, std::memory_order_relaxed);
+
+		for (std::thread& reader : readers)
+		{
+			reader.join();
+		}
+
+		// Between frames, nothing resolves the old handles any more
+		list.Clear();
+	}
+}
+
+int main()
+{
+	TestPushAndFind();
+	TestClearKeepsBlocks();
+	TestReadersWhileOwnerPushes();
+
+	return TestResult("AppendOnlyListTests");
+}
@@ -0,0 +1,131 @@
+#include "Benchmark.h"
+
+#include "AsyncFileReader.h"
+#include "MappedFile.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace rl;
+
+// Streams one file into memory the way the streaming worker does, in 4MB requests.
+// The file is usually still in the page cache after it is written, so this mostly measures per read overhead and memory bandwidth rather than the disk.
+static const size_t FileSize = 256u * 1024u * 1024u;
+static const size_t RequestSize = 4u * 1024u * 1024u;
+
+static std::string WriteBenchmarkFile()
+{
+	const char* tmp = getenv("TMPDIR");
+	const std::string path = std::string(tmp ? tmp : "/tmp") + "/AsyncFileReaderBenchmark.bin";
+
+	std::vector<uint8_t> chunk(RequestSize);
+	for (size_t i = 0; i < chunk.size(); i++)
+	{
+		chunk[i] = (uint8_t)(i * 13u);
+	}
+
+	FILE* file = fopen(path.c_str(), "wb");
+	if (!file)
+	{
+		return {};
+	}
+
+	for (size_t written = 0u; written < FileSize; written += chunk.size())
+	{
+		fwrite(chunk.data(), 1u, chunk.size(), file);
+	}
+
+	fclose(file);
+
+	return path;
+}
+
+static void PrintThroughput(const char* name, double nsPerRequest)
+{
+	const double bytesPerSecond = (double)RequestSize / (nsPerRequest * 1e-9);
+
+	printf("%-56s %12.1f MB/s\n", name, bytesPerSecond / (1024.0 * 1024.0));
+}
+
+static void BenchmarkReader(const std::string& path, uint32_t queueDepth, const char* name)
+{
+	std::vector<uint8_t> destination(FileSize);
+
+	AsyncFileReader reader;
+	reader.Init(queueDepth);
+
+	size_t size = 0u;
+	const AsyncFileHandle file = reader.Open(path.c_str(), size);
+
+	uint64_t succeeded = 0u;
+
+	const double ns = Benchmark(name, FileSize / RequestSize, [&]
+	{
+		for (size_t offset = 0u; offset < FileSize; offset += RequestSize)
+		{
+			reader.Read(file, offset, destination.data() + offset, RequestSize, offset);
+		}
+
+		std::vector<AsyncFileReader::Completion> completions;
+		while (reader.GetPendingCount() > 0u)
+		{
+			reader.Poll(completions, true);
+		}
+
+		for (const AsyncFileReader::Completion& completion : completions)
+		{
+			succeeded += completion.Success;
+		}
+	});
+
+	PrintThroughput(name, ns);
+	DoNotOptimize(succeeded + destination[FileSize / 2u]);
+
+	reader.Close(file);
+}
+
+// The memory mapped copy the streaming worker used before, every page fault is serviced on the calling thread.
+static void BenchmarkMappedCopy(const std::string& path)
+{
+	std::vector<uint8_t> destination(FileSize);
+
+	const char* name = "mapped file, synchronous copy";
+
+	const double ns = Benchmark(name, FileSize / RequestSize, [&]
+	{
+		for (size_t offset = 0u; offset < FileSize; offset += RequestSize)
+		{
+			MappedFile file;
+			size_t size = RequestSize;
+
+			if (MapFileRange(file, path.c_str(), offset, size))
+			{
+				memcpy(destination.data() + offset, file.Data() + offset, size);
+			}
+		}
+	});
+
+	PrintThroughput(name, ns);
+	DoNotOptimize(destination[FileSize / 2u]);
+}
+
+int main()
+{
+	const std::string path = WriteBenchmarkFile();
+	if (path.empty())
+	{
+		printf("Couldn't write the benchmark file\n");
+		return 1;
+	}
+
+	BenchmarkMappedCopy(path);
+	BenchmarkReader(path, 1u, "async reader, queue depth 1");
+	BenchmarkReader(path, 8u, "async reader, queue depth 8");
+	BenchmarkReader(path, 32u, "async reader, queue depth 32");
+
+	remove(path.c_str());
+
+	return 0;
+}
@@ -0,0 +1,199 @@
+#include "Test.h"
+
+#include "AsyncFileReader.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace rl;
+
+static const size_t FileSize = 5u * AsyncFileReader::ReadPartSize + 1234u;
+
+static uint8_t FileByte(size_t offset)
+{
+	return (uint8_t)((offset * 31u) ^ (offset >> 11u));
+}
+
+static std::string WriteTestFile()
+{
+	const char* tmp = getenv("TMPDIR");
+	const std::string path = std::string(tmp ? tmp : "/tmp") + "/AsyncFileReaderTests.bin";
+
+	std::vector<uint8_t> data(FileSize);
+	for (size_t i = 0; i < FileSize; i++)
+	{
+		data[i] = FileByte(i);
+	}
+
+	FILE* file = fopen(path.c_str(), "wb");
+	TEST_CHECK(file != nullptr);
+
+	if (file)
+	{
+		TEST_CHECK(fwrite(data.data(), 1u, data.size(), file) == data.size());
+		fclose(file);
+	}
+
+	return path;
+}
+
+static bool MatchesFile(const std::vector<uint8_t>& data, size_t offset)
+{
+	for (size_t i = 0; i < data.size(); i++)
+	{
+		if (data[i] != FileByte(offset + i))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void WaitForAll(AsyncFileReader& reader, std::vector<AsyncFileReader::Completion>& completions)
+{
+	while (reader.GetPendingCount() > 0u)
+	{
+		reader.Poll(completions, true);
+	}
+}
+
+// More reads than the queue is deep, spanning several parts and starting at odd offsets.
+static void TestReadsMatchFile(const std::string& path)
+{
+	AsyncFileReader reader;
+	TEST_CHECK(reader.Init(4u));
+
+	size_t size = 0u;
+	const AsyncFileHandle file = reader.Open(path.c_str(), size);
+	TEST_CHECK(file != InvalidAsyncFile && size == FileSize);
+
+	struct Range
+	{
+		size_t Offset;
+		size_t Size;
+	};
+
+	const Range ranges[] =
+	{
+		{ 0u, FileSize },
+		{ 1u, 1u },
+		{ 4095u, AsyncFileReader::ReadPartSize + 3u },
+		{ FileSize - 17u, 17u },
+		{ 3u * AsyncFileReader::ReadPartSize, 2u * AsyncFileReader::ReadPartSize },
+		{ 777u, 65536u },
+	};
+
+	const size_t rangeCount = sizeof(ranges) / sizeof(ranges[0]);
+
+	std::vector<std::vector<uint8_t>> data(rangeCount);
+	for (size_t i = 0; i < rangeCount; i++)
+	{
+		data[i].resize(ranges[i].Size);
+		reader.Read(file, ranges[i].Offset, data[i].data(), ranges[i].Size, i);
+	}
+
+	TEST_CHECK(reader.GetPendingCount() == rangeCount);
+
+	std::vector<AsyncFileReader::Completion> completions;
+	WaitForAll(reader, completions);
+
+	TEST_CHECK(completions.size() == rangeCount);
+
+	std::vector<bool> seen(rangeCount, false);
+	for (const AsyncFileReader::Completion& completion : completions)
+	{
+		TEST_CHECK(completion.UserData < rangeCount && !seen[completion.UserData]);
+		TEST_CHECK(completion.Success);
+
+		seen[completion.UserData] = true;
+	}
+
+	for (size_t i = 0; i < rangeCount; i++)
+	{
+		TEST_CHECK(MatchesFile(data[i], ranges[i].Offset));
+	}
+
+	reader.Close(file);
+}
+
+// A range running off the end of the file fails as a whole, other reads are unaffected.
+static void TestReadPastEndFails(const std::string& path)
+{
+	AsyncFileReader reader;
+	TEST_CHECK(reader.Init(8u));
+
+	size_t size = 0u;
+	const AsyncFileHandle file = reader.Open(path.c_str(), size);
+
+	std::vector<uint8_t> pastEnd(3u * AsyncFileReader::ReadPartSize);
+	std::vector<uint8_t> valid(1024u);
+
+	reader.Read(file, FileSize - AsyncFileReader::ReadPartSize, pastEnd.data(), pastEnd.size(), 1u);
+	reader.Read(file, 100u, valid.data(), valid.size(), 2u);
+
+	std::vector<AsyncFileReader::Completion> completions;
+	WaitForAll(reader, completions);
+
+	TEST_CHECK(completions.size() == 2u);
+
+	for (const AsyncFileReader::Completion& completion : completions)
+	{
+		TEST_CHECK(completion.Success == (completion.UserData == 2u));
+	}
+
+	TEST_CHECK(MatchesFile(valid, 100u));
+
+	reader.Close(file);
+}
+
+static void TestMissingFile()
+{
+	AsyncFileReader reader;
+	TEST_CHECK(reader.Init(1u));
+
+	size_t size = 0u;
+	TEST_CHECK(reader.Open("/nonexistent/AsyncFileReaderTests.bin", size) == InvalidAsyncFile);
+
+	std::vector<AsyncFileReader::Completion> completions;
+	reader.Poll(completions, true);
+	TEST_CHECK(completions.empty());
+}
+
+// Reads still in flight are waited for, the destination memory is only released after ShutDown returns.
+static void TestShutDownWithReadsInFlight(const std::string& path)
+{
+	std::vector<uint8_t> data(FileSize);
+
+	AsyncFileReader reader;
+	TEST_CHECK(reader.Init(2u));
+
+	size_t size = 0u;
+	const AsyncFileHandle file = reader.Open(path.c_str(), size);
+
+	reader.Read(file, 0u, data.data(), data.size(), 0u);
+
+	std::vector<AsyncFileReader::Completion> completions;
+	reader.Poll(completions, false);
+
+	reader.ShutDown();
+	TEST_CHECK(reader.GetPendingCount() == 0u);
+
+	reader.Close(file);
+}
+
+int main()
+{
+	const std::string path = WriteTestFile();
+
+	TestReadsMatchFile(path);
+	TestReadPastEndFails(path);
+	TestMissingFile();
+	TestShutDownWithReadsInFlight(path);
+
+	remove(path.c_str());
+
+	return TestResult("AsyncFileReaderTests");
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+namespace rl
+{
+
+// Runs the function once and prints the average time of each of its operations.
+template<typename Func>
+double Benchmark(const char* name, uint64_t operations, Func&& func)
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	func();
+
+	const auto end = std::chrono::steady_clock::now();
+
+	const double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+	const double nsPerOp = operations > 0u ? ns / (double)operations : 0.0;
+
+	printf("%-56s %12.2f ns/op\n", name, nsPerOp);
+
+	return nsPerOp;
+}
+
+// Keeps the optimiser from discarding results that are otherwise unused.
+inline void DoNotOptimize(uint64_t value)
+{
+	static volatile uint64_t sink;
+	sink = value;
+}
+
+}
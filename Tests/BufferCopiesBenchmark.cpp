@@ -0,0 +1,94 @@
+#include "Benchmark.h"
+
+#include "BufferCopies.h"
+
+#include <random>
+#include <vector>
+
+using namespace rl;
+
+struct CopyPattern
+{
+	const char* Name;
+	std::vector<BufferCopyRegion> Regions;
+};
+
+static int g_Buffers[256];
+static int g_StagingRing;
+
+// Mesh data streamed into neighbouring page offsets, staged back to back in the ring.
+static CopyPattern MakeStreamingPattern()
+{
+	CopyPattern pattern = { "streaming, contiguous pages and staging" };
+
+	uint64_t ringOffset = 0u;
+	for (uint32_t i = 0; i < 4096u; i++)
+	{
+		const uint64_t size = 4096u;
+		pattern.Regions.push_back({ &g_Buffers[i / 512u], (i % 512u) * size, &g_StagingRing, ringOffset, size });
+		ringOffset += size;
+	}
+
+	return pattern;
+}
+
+// The same constant buffers rewritten many times before a submit, only the last write of each survives.
+static CopyPattern MakeRewritePattern()
+{
+	CopyPattern pattern = { "rewrites, 64 constant buffers written 64 times" };
+
+	uint64_t ringOffset = 0u;
+	for (uint32_t i = 0; i < 4096u; i++)
+	{
+		pattern.Regions.push_back({ &g_Buffers[i % 64u], 0u, &g_StagingRing, ringOffset, 256u });
+		ringOffset += 256u;
+	}
+
+	return pattern;
+}
+
+// Ranged updates landing anywhere in a few large buffers, partially overlapping each other.
+static CopyPattern MakeScatteredPattern()
+{
+	CopyPattern pattern = { "scattered, overlapping ranged updates" };
+
+	std::mt19937 rng(5u);
+
+	uint64_t ringOffset = 0u;
+	for (uint32_t i = 0; i < 4096u; i++)
+	{
+		const uint64_t size = 16u + rng() % 2048u;
+		pattern.Regions.push_back({ &g_Buffers[rng() % 8u], rng() % (1024u * 1024u), &g_StagingRing, ringOffset, size });
+		ringOffset += size;
+	}
+
+	return pattern;
+}
+
+int main()
+{
+	constexpr uint32_t Iterations = 200u;
+
+	const CopyPattern patterns[] = { MakeStreamingPattern(), MakeRewritePattern(), MakeScatteredPattern() };
+
+	for (const CopyPattern& pattern : patterns)
+	{
+		std::vector<BufferCopyRegion> regions = pattern.Regions;
+		CoalesceBufferCopies(regions);
+
+		printf("%-56s %6zu copies -> %6zu\n", pattern.Name, pattern.Regions.size(), regions.size());
+
+		Benchmark(pattern.Name, Iterations * pattern.Regions.size(), [&]
+		{
+			for (uint32_t i = 0; i < Iterations; i++)
+			{
+				regions = pattern.Regions;
+				CoalesceBufferCopies(regions);
+			}
+
+			DoNotOptimize(regions.size());
+		});
+	}
+
+	return 0;
+}
@@ -0,0 +1,225 @@
+#include "Test.h"
+
+#include "BufferCopies.h"
+
+#include <functional>
+#include <random>
+#include <vector>
+
+using namespace rl;
+
+// Each destination byte remembers which source byte last landed on it, zero means untouched.
+using ByteSources = std::vector<uint64_t>;
+
+static uint64_t SourceByte(const void* src, uint64_t offset)
+{
+	return ((uint64_t)(uintptr_t)src << 32u) | (offset + 1u);
+}
+
+static void Apply(const std::vector<BufferCopyRegion>& regions, const void* dst, ByteSources& bytes)
+{
+	for (const BufferCopyRegion& region : regions)
+	{
+		if (region.Dst != dst)
+			continue;
+
+		for (uint64_t i = 0; i < region.Size; i++)
+		{
+			bytes[region.DstOffset + i] = SourceByte(region.Src, region.SrcOffset + i);
+		}
+	}
+}
+
+static void TestOverwritesAreDropped()
+{
+	int dst = 0;
+	int srcA = 0;
+	int srcB = 0;
+
+	std::vector<BufferCopyRegion> regions =
+	{
+		{ &dst, 0u, &srcA, 0u, 256u },
+		{ &dst, 0u, &srcB, 512u, 256u },
+	};
+
+	CoalesceBufferCopies(regions);
+
+	TEST_CHECK(regions.size() == 1u);
+	TEST_CHECK(regions[0].Src == &srcB && regions[0].SrcOffset == 512u && regions[0].Size == 256u);
+}
+
+static void TestPartialOverwriteSplits()
+{
+	int dst = 0;
+	int srcA = 0;
+	int srcB = 0;
+
+	std::vector<BufferCopyRegion> regions =
+	{
+		{ &dst, 0u, &srcA, 1000u, 300u },
+		{ &dst, 100u, &srcB, 0u, 100u },
+	};
+
+	CoalesceBufferCopies(regions);
+
+	TEST_CHECK(regions.size() == 3u);
+	TEST_CHECK(regions[0].Src == &srcA && regions[0].DstOffset == 0u && regions[0].SrcOffset == 1000u && regions[0].Size == 100u);
+	TEST_CHECK(regions[1].Src == &srcB && regions[1].DstOffset == 100u && regions[1].Size == 100u);
+	TEST_CHECK(regions[2].Src == &srcA && regions[2].DstOffset == 200u && regions[2].SrcOffset == 1200u && regions[2].Size == 100u);
+}
+
+static void TestContiguousCopiesMerge()
+{
+	int dst = 0;
+	int ring = 0;
+
+	std::vector<BufferCopyRegion> regions;
+	for (uint64_t i = 0; i < 16u; i++)
+	{
+		regions.push_back({ &dst, i * 64u, &ring, 4096u + i * 64u, 64u });
+	}
+
+	CoalesceBufferCopies(regions);
+
+	TEST_CHECK(regions.size() == 1u);
+	TEST_CHECK(regions[0].DstOffset == 0u && regions[0].SrcOffset == 4096u && regions[0].Size == 1024u);
+}
+
+static void TestOutputIsSortedByDestination()
+{
+	int buffers[4] = {};
+	int src = 0;
+
+	std::vector<BufferCopyRegion> regions;
+	for (int i = 3; i >= 0; i--)
+	{
+		regions.push_back({ &buffers[i], 128u, &src, (uint64_t)i * 1024u, 16u });
+		regions.push_back({ &buffers[i], 0u, &src, (uint64_t)i * 1024u + 512u, 16u });
+	}
+
+	CoalesceBufferCopies(regions);
+
+	TEST_CHECK(regions.size() == 8u);
+
+	for (size_t i = 1; i < regions.size(); i++)
+	{
+		const bool ordered = std::less<const void*>()(regions[i - 1].Dst, regions[i].Dst) ||
+			(regions[i - 1].Dst == regions[i].Dst && regions[i - 1].DstOffset + regions[i - 1].Size <= regions[i].DstOffset);
+
+		TEST_CHECK(ordered);
+	}
+}
+
+// Random batches checked byte for byte against applying the original copies in order.
+static void TestMatchesSequentialCopies()
+{
+	constexpr uint64_t BufferSize = 4096u;
+
+	int dsts[3] = {};
+	int srcs[2] = {};
+
+	std::mt19937 rng(11u);
+
+	for (uint32_t batch = 0; batch < 500u; batch++)
+	{
+		std::vector<BufferCopyRegion> regions;
+
+		const uint32_t count = 1u + rng() % 40u;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const uint64_t size = rng() % 512u;
+			const uint64_t dstOffset = rng() % (BufferSize - size);
+
+			regions.push_back({ &dsts[rng() % 3u], dstOffset, &srcs[rng() % 2u], rng() % BufferSize, size });
+		}
+
+		std::vector<BufferCopyRegion> coalesced = regions;
+		CoalesceBufferCopies(coalesced);
+
+		TEST_CHECK(coalesced.size() <= 2u * regions.size());
+
+		for (const int& dst : dsts)
+		{
+			ByteSources expected(BufferSize, 0u);
+			ByteSources actual(BufferSize, 0u);
+
+			Apply(regions, &dst, expected);
+			Apply(coalesced, &dst, actual);
+
+			TEST_CHECK(expected == actual);
+
+			// No byte may be written twice, so the copies can run in any order
+			uint64_t written = 0u;
+			uint64_t touched = 0u;
+			for (const BufferCopyRegion& region : coalesced)
+			{
+				written += region.Dst == &dst ? region.Size : 0u;
+				TEST_CHECK(region.Size > 0u);
+			}
+			for (uint64_t byte : actual)
+			{
+				touched += byte != 0u;
+			}
+
+			TEST_CHECK(written == touched);
+		}
+	}
+}
+
+// A 6GB upload split into the dx12 staging ring's 4MB chunks, every byte is covered once and in order.
+static void TestSplitsMultiGigabyteUpload()
+{
+	constexpr uint64_t MB = 1024u * 1024u;
+	constexpr uint64_t GB = 1024u * MB;
+	constexpr uint64_t ChunkSize = 4 * MB;
+
+	const uint64_t size = 6 * GB + 123u;
+	const std::vector<UploadChunk> chunks = SplitUpload(size, ChunkSize);
+
+	TEST_CHECK(chunks.size() == 6 * GB / ChunkSize + 1u);
+
+	uint64_t covered = 0u;
+	for (const UploadChunk& chunk : chunks)
+	{
+		TEST_CHECK(chunk.Offset == covered && chunk.Size > 0u && chunk.Size <= ChunkSize);
+		covered += chunk.Size;
+	}
+
+	TEST_CHECK(covered == size);
+	TEST_CHECK(chunks.back().Offset == 6 * GB && chunks.back().Size == 123u);
+
+	TEST_CHECK(SplitUpload(ChunkSize, ChunkSize).size() == 1u);
+	TEST_CHECK(SplitUpload(0u, ChunkSize).empty());
+}
+
+// Chunks of a large upload land contiguously past 4GB and merge back into one copy.
+static void TestMultiGigabyteCopiesMerge()
+{
+	constexpr uint64_t GB = 1024ull * 1024u * 1024u;
+
+	int dst = 0;
+	int src = 0;
+
+	std::vector<BufferCopyRegion> regions = {
+		{ &dst, 5 * GB, &src, 5 * GB, 3 * GB },
+		{ &dst, 2 * GB, &src, 2 * GB, 3 * GB },
+	};
+
+	CoalesceBufferCopies(regions);
+
+	TEST_CHECK(regions.size() == 1u);
+	TEST_CHECK(regions[0].DstOffset == 2 * GB && regions[0].SrcOffset == 2 * GB && regions[0].Size == 6 * GB);
+}
+
+int main()
+{
+	TestOverwritesAreDropped();
+	TestPartialOverwriteSplits();
+	TestContiguousCopiesMerge();
+	TestOutputIsSortedByDestination();
+	TestMatchesSequentialCopies();
+	TestSplitsMultiGigabyteUpload();
+	TestMultiGigabyteCopiesMerge();
+
+	return TestResult("BufferCopiesTests");
+}
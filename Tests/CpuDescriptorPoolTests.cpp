@@ -0,0 +1,146 @@
+#include "Test.h"
+
+#include "CpuDescriptorPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace rl;
+
+// Stands in for a backend descriptor heap, each block remembers the order it was created in.
+struct TestBlock
+{
+	uint32_t Index = ~0u;
+};
+
+using TestPool = CpuDescriptorPool<TestBlock, 4u>;
+
+static auto CountingCreateBlock(uint32_t& created)
+{
+	return [&created](TestBlock& outBlock) { outBlock.Index = created++; return true; };
+}
+
+// Slots are handed out in order and a block is only added once every slot is in use.
+static void TestBlocksAddedWhenFull()
+{
+	TestPool pool;
+	uint32_t created = 0u;
+
+	for (uint32_t i = 0; i < 6u; i++)
+	{
+		uint32_t slot = ~0u;
+		TEST_CHECK(pool.Alloc(CountingCreateBlock(created), slot) && slot == i);
+	}
+
+	TEST_CHECK(created == 2u && pool.GetBlockCount() == 2u);
+
+	TEST_CHECK(pool.WithSlot(5u, [](TestBlock& block, uint32_t index) { return block.Index == 1u && index == 1u; }));
+	TEST_CHECK(pool.WithSlot(3u, [](TestBlock& block, uint32_t index) { return block.Index == 0u && index == 3u; }));
+}
+
+// A freed slot is reused straight away, before the rest of the block, and no block is added for it.
+static void TestFreedSlotsReusedImmediately()
+{
+	TestPool pool;
+	uint32_t created = 0u;
+
+	uint32_t slots[4];
+	for (uint32_t& slot : slots)
+	{
+		TEST_CHECK(pool.Alloc(CountingCreateBlock(created), slot));
+	}
+
+	pool.Free(slots[1]);
+	pool.Free(slots[2]);
+
+	uint32_t slot = ~0u;
+	TEST_CHECK(pool.Alloc(CountingCreateBlock(created), slot) && slot == slots[2]);
+	TEST_CHECK(pool.Alloc(CountingCreateBlock(created), slot) && slot == slots[1]);
+
+	TEST_CHECK(created == 1u);
+
+	TEST_CHECK(pool.Alloc(CountingCreateBlock(created), slot) && slot == 4u && created == 2u);
+}
+
+// A block that fails to create fails the allocation and leaves the pool as it was, the next allocation tries again.
+static void TestFailedBlockCreation()
+{
+	TestPool pool;
+
+	uint32_t slot = ~0u;
+	TEST_CHECK(!pool.Alloc([](TestBlock&) { return false; }, slot));
+	TEST_CHECK(pool.GetBlockCount() == 0u);
+
+	uint32_t created = 0u;
+	TEST_CHECK(pool.Alloc(CountingCreateBlock(created), slot) && slot == 0u);
+	TEST_CHECK(pool.GetBlockCount() == 1u);
+}
+
+// Views are created and destroyed from loading threads, no slot is ever held by two views at once.
+static void TestConcurrentAllocAndFree()
+{
+	constexpr uint32_t ThreadCount = 8u;
+	constexpr uint32_t OpsPerThread = 10000u;
+	constexpr uint32_t MaxSlots = 1024u;
+
+	TestPool pool;
+	std::atomic<uint32_t> created = 0u;
+
+	std::vector<std::atomic<uint32_t>> owners(MaxSlots);
+
+	std::vector<std::thread> threads;
+
+	for (uint32_t thread = 0; thread < ThreadCount; thread++)
+	{
+		threads.emplace_back([&]
+		{
+			std::vector<uint32_t> live;
+
+			for (uint32_t op = 0; op < OpsPerThread; op++)
+			{
+				if (live.size() >= 16u || (!live.empty() && op % 3u == 0u))
+				{
+					owners[live.back()].fetch_sub(1u);
+					pool.Free(live.back());
+					live.pop_back();
+					continue;
+				}
+
+				uint32_t slot = ~0u;
+				TEST_CHECK(pool.Alloc([&created](TestBlock& outBlock) { outBlock.Index = created.fetch_add(1u); return true; }, slot));
+				TEST_CHECK(slot < MaxSlots && owners[slot].fetch_add(1u) == 0u);
+
+				// Reading the descriptor while other threads may be adding blocks
+				TEST_CHECK(pool.WithSlot(slot, [slot](TestBlock& block, uint32_t index) { return block.Index == slot / 4u && index == slot % 4u; }));
+
+				live.push_back(slot);
+			}
+
+			for (uint32_t slot : live)
+			{
+				owners[slot].fetch_sub(1u);
+				pool.Free(slot);
+			}
+		});
+	}
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	// Only as many blocks as the most slots live at once
+	TEST_CHECK(pool.GetBlockCount() == created.load() && created.load() <= ThreadCount * 16u / 4u);
+}
+
+int main()
+{
+	TestBlocksAddedWhenFull();
+	TestFreedSlotsReusedImmediately();
+	TestFailedBlockCreation();
+	TestConcurrentAllocAndFree();
+
+	return TestResult("CpuDescriptorPoolTests");
+}
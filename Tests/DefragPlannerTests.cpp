@@ -0,0 +1,228 @@
+#include "Test.h"
+
+#include "DefragPlanner.h"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace rl;
+
+static constexpr uint64_t PageSize = 64u * 1024u;
+
+// Owns the allocators the planner works on, allocations get ids in creation order.
+struct TestPages
+{
+	std::vector<std::unique_ptr<TlsfAllocator>> Allocators;
+	std::vector<DefragPage> Pages;
+	uint32_t NextId = 0u;
+
+	uint32_t AddPage()
+	{
+		Allocators.push_back(std::make_unique<TlsfAllocator>(PageSize));
+
+		DefragPage& page = Pages.emplace_back();
+		page.Page = (uint32_t)Pages.size() - 1u;
+		page.Allocator = Allocators.back().get();
+
+		return page.Page;
+	}
+
+	void Alloc(uint32_t page, uint64_t size, uint64_t alignment = 256u)
+	{
+		TlsfAllocation block;
+		TEST_CHECK(Pages[page].Allocator->Alloc(size, alignment, block));
+
+		Pages[page].Allocations.push_back({ NextId++, block.Offset, block.Size, alignment });
+	}
+};
+
+static void TestSparsePageMovesIntoFullest()
+{
+	TestPages pages;
+	const uint32_t sparse = pages.AddPage();
+	const uint32_t half = pages.AddPage();
+	const uint32_t full = pages.AddPage();
+
+	pages.Alloc(sparse, 4096u);
+	pages.Alloc(sparse, 1024u);
+	pages.Alloc(half, PageSize / 2u);
+	pages.Alloc(full, PageSize - 16384u);
+
+	const DefragPlan plan = PlanDefrag(pages.Pages, ~0ull);
+
+	TEST_CHECK(plan.EvacuatedPages.size() == 1u && plan.EvacuatedPages[0] == sparse);
+	TEST_CHECK(plan.Moves.size() == 2u);
+	TEST_CHECK(plan.MovedBytes == 5120u);
+
+	for (const DefragMove& move : plan.Moves)
+	{
+		TEST_CHECK(move.SrcPage == sparse && move.DstPage == full);
+		TEST_CHECK(move.Dst.Offset % 256u == 0u && move.Dst.Size == move.Size);
+	}
+
+	TEST_CHECK(plan.Before.PageCount == 3u && plan.After.PageCount == 2u);
+	// The moved bytes now count towards the destination instead of the released page
+	TEST_CHECK(plan.Before.UsedBytes == plan.After.UsedBytes);
+	TEST_CHECK(plan.After.ReservedBytes == 2u * PageSize);
+}
+
+static void TestBudgetLimitsEvacuations()
+{
+	TestPages pages;
+	const uint32_t a = pages.AddPage();
+	const uint32_t b = pages.AddPage();
+	const uint32_t destination = pages.AddPage();
+
+	pages.Alloc(a, 2048u);
+	pages.Alloc(b, 8192u);
+	pages.Alloc(destination, PageSize / 4u);
+
+	const DefragPlan plan = PlanDefrag(pages.Pages, 4096u);
+
+	// The emptiest page fits the budget, the next would go over it
+	TEST_CHECK(plan.EvacuatedPages.size() == 1u && plan.EvacuatedPages[0] == a);
+	TEST_CHECK(plan.MovedBytes <= 4096u);
+}
+
+static void TestPinnedPagesStay()
+{
+	TestPages pages;
+	const uint32_t pinned = pages.AddPage();
+	const uint32_t sparse = pages.AddPage();
+
+	pages.Alloc(pinned, 1024u);
+	pages.Alloc(sparse, 512u);
+	pages.Pages[pinned].Pinned = true;
+
+	const DefragPlan plan = PlanDefrag(pages.Pages, ~0ull);
+
+	// The pinned page can't be emptied but still takes the other page's allocation
+	TEST_CHECK(plan.EvacuatedPages.size() == 1u && plan.EvacuatedPages[0] == sparse);
+	TEST_CHECK(plan.Moves.size() == 1u && plan.Moves[0].DstPage == pinned);
+}
+
+static void TestOccupiedPagesAreNotSources()
+{
+	TestPages pages;
+	const uint32_t a = pages.AddPage();
+	const uint32_t b = pages.AddPage();
+
+	pages.Alloc(a, PageSize * 3u / 4u);
+	pages.Alloc(b, PageSize / 8u);
+
+	const DefragPlan plan = PlanDefrag(pages.Pages, ~0ull, 0.1f);
+
+	TEST_CHECK(plan.EvacuatedPages.empty() && plan.Moves.empty());
+	TEST_CHECK(plan.Before.UsedBytes == plan.After.UsedBytes);
+}
+
+static void TestPartialEvacuationIsUndone()
+{
+	TestPages pages;
+	const uint32_t source = pages.AddPage();
+	const uint32_t destination = pages.AddPage();
+
+	// Two 20KB blocks don't both fit in the 24KB left in the destination
+	pages.Alloc(source, 20u * 1024u);
+	pages.Alloc(source, 20u * 1024u);
+	pages.Alloc(destination, PageSize - 24u * 1024u);
+
+	const uint32_t allocationCount = pages.Pages[destination].Allocator->GetAllocationCount();
+	const uint64_t freeSize = pages.Pages[destination].Allocator->GetFreeSize();
+
+	const DefragPlan plan = PlanDefrag(pages.Pages, ~0ull, 1.0f);
+
+	TEST_CHECK(plan.Moves.empty() && plan.EvacuatedPages.empty());
+	TEST_CHECK(pages.Pages[destination].Allocator->GetAllocationCount() == allocationCount);
+	TEST_CHECK(pages.Pages[destination].Allocator->GetFreeSize() == freeSize);
+}
+
+// Random page sets, every move must land in free space of a page that isn't evacuated and never overlap anything still live.
+static void TestRandomPlansAreConsistent()
+{
+	std::mt19937 rng(17u);
+
+	for (uint32_t round = 0; round < 200u; round++)
+	{
+		TestPages pages;
+
+		const uint32_t pageCount = 2u + rng() % 8u;
+		for (uint32_t i = 0; i < pageCount; i++)
+		{
+			const uint32_t page = pages.AddPage();
+			const uint32_t count = rng() % 12u;
+
+			for (uint32_t j = 0; j < count; j++)
+			{
+				TlsfAllocation block;
+				const uint64_t size = 64u + rng() % 8192u;
+				if (pages.Pages[page].Allocator->Alloc(size, 256u, block))
+				{
+					pages.Pages[page].Allocations.push_back({ pages.NextId++, block.Offset, block.Size, 256u });
+				}
+			}
+		}
+
+		std::vector<std::vector<DefragAllocation>> before;
+		for (const DefragPage& page : pages.Pages)
+		{
+			before.push_back(page.Allocations);
+		}
+
+		const DefragPlan plan = PlanDefrag(pages.Pages, rng() % 2u ? ~0ull : 32u * 1024u);
+
+		TEST_CHECK(plan.After.UsedBytes == plan.Before.UsedBytes);
+		TEST_CHECK(plan.After.PageCount + plan.EvacuatedPages.size() == plan.Before.PageCount);
+
+		// Live ranges per page: what stays where it was, plus the move destinations
+		std::vector<std::vector<std::pair<uint64_t, uint64_t>>> live(pageCount);
+
+		for (uint32_t page = 0; page < pageCount; page++)
+		{
+			if (std::find(plan.EvacuatedPages.begin(), plan.EvacuatedPages.end(), page) != plan.EvacuatedPages.end())
+				continue;
+
+			for (const DefragAllocation& allocation : before[page])
+			{
+				live[page].push_back({ allocation.Offset, allocation.Size });
+			}
+		}
+
+		uint64_t movedBytes = 0u;
+		for (const DefragMove& move : plan.Moves)
+		{
+			TEST_CHECK(std::find(plan.EvacuatedPages.begin(), plan.EvacuatedPages.end(), move.SrcPage) != plan.EvacuatedPages.end());
+			TEST_CHECK(std::find(plan.EvacuatedPages.begin(), plan.EvacuatedPages.end(), move.DstPage) == plan.EvacuatedPages.end());
+			TEST_CHECK(move.Dst.Offset % 256u == 0u);
+
+			live[move.DstPage].push_back({ move.Dst.Offset, move.Size });
+			movedBytes += move.Size;
+		}
+
+		TEST_CHECK(movedBytes == plan.MovedBytes);
+
+		for (std::vector<std::pair<uint64_t, uint64_t>>& ranges : live)
+		{
+			std::sort(ranges.begin(), ranges.end());
+
+			for (size_t i = 1; i < ranges.size(); i++)
+			{
+				TEST_CHECK(ranges[i - 1].first + ranges[i - 1].second <= ranges[i].first);
+			}
+		}
+	}
+}
+
+int main()
+{
+	TestSparsePageMovesIntoFullest();
+	TestBudgetLimitsEvacuations();
+	TestPinnedPagesStay();
+	TestOccupiedPagesAreNotSources();
+	TestPartialEvacuationIsUndone();
+	TestRandomPlansAreConsistent();
+
+	return TestResult("DefragPlannerTests");
+}
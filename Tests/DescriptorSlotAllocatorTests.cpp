@@ -0,0 +1,194 @@
+#include "Test.h"
+
+#include "DescriptorSlotAllocator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace rl;
+
+// The slot allocator behind the persistent srv/uav heap, creating or destroying a view only touches its own slot.
+
+static void TestAllocUntilFull()
+{
+	DescriptorSlotAllocator slots(4u);
+
+	for (uint32_t i = 0; i < 4u; i++)
+	{
+		uint32_t slot = ~0u;
+		TEST_CHECK(slots.Alloc(slot) && slot == i);
+	}
+
+	uint32_t slot = ~0u;
+	TEST_CHECK(!slots.Alloc(slot));
+	TEST_CHECK(slots.GetCapacity() == 4u);
+}
+
+// A freed slot stays out of the free list until the gpu has finished the frame that freed it.
+static void TestFreedSlotWaitsForItsFrame()
+{
+	DescriptorSlotAllocator slots(2u);
+
+	uint32_t a = 0u;
+	uint32_t b = 0u;
+	TEST_CHECK(slots.Alloc(a) && slots.Alloc(b));
+
+	slots.Free(a);
+
+	// Not retired to a frame yet, so no fence can make it reusable
+	slots.Reclaim(~0ull, ~0ull);
+
+	uint32_t slot = 0u;
+	TEST_CHECK(!slots.Alloc(slot));
+
+	slots.EndFrame(10u, 20u);
+
+	slots.Reclaim(9u, 20u);
+	TEST_CHECK(!slots.Alloc(slot));
+
+	slots.Reclaim(10u, 19u);
+	TEST_CHECK(!slots.Alloc(slot));
+
+	slots.Reclaim(10u, 20u);
+	TEST_CHECK(slots.Alloc(slot) && slot == a);
+}
+
+// Frames come back in the order they ended, a later frame waits behind an earlier one still in flight.
+static void TestFramesReclaimInOrder()
+{
+	DescriptorSlotAllocator slots(3u);
+
+	uint32_t allocated[3] = {};
+	for (uint32_t& slot : allocated)
+	{
+		TEST_CHECK(slots.Alloc(slot));
+	}
+
+	slots.Free(allocated[0]);
+	slots.EndFrame(1u, 1u);
+
+	slots.Free(allocated[1]);
+	slots.Free(allocated[2]);
+	slots.EndFrame(2u, 2u);
+
+	// Frames without frees don't add anything to wait on
+	slots.EndFrame(3u, 3u);
+
+	slots.Reclaim(1u, 1u);
+
+	uint32_t slot = 0u;
+	TEST_CHECK(slots.Alloc(slot) && slot == allocated[0]);
+	TEST_CHECK(!slots.Alloc(slot));
+
+	slots.Reclaim(2u, 2u);
+
+	std::vector<uint32_t> reclaimed(2u);
+	TEST_CHECK(slots.Alloc(reclaimed[0]) && slots.Alloc(reclaimed[1]));
+	std::sort(reclaimed.begin(), reclaimed.end());
+
+	TEST_CHECK(reclaimed[0] == allocated[1] && reclaimed[1] == allocated[2]);
+	TEST_CHECK(!slots.Alloc(slot));
+}
+
+// Reclaimed slots are handed out before slots never used, so the part of the heap in use stays as small as it can.
+static void TestReclaimedSlotsReusedFirst()
+{
+	DescriptorSlotAllocator slots(8u);
+
+	uint32_t a = 0u;
+	uint32_t b = 0u;
+	TEST_CHECK(slots.Alloc(a) && slots.Alloc(b));
+
+	slots.Free(a);
+	slots.EndFrame(1u, 1u);
+	slots.Reclaim(1u, 1u);
+
+	uint32_t slot = ~0u;
+	TEST_CHECK(slots.Alloc(slot) && slot == a);
+	TEST_CHECK(slots.Alloc(slot) && slot == 2u);
+}
+
+// Views are created and destroyed from many threads while the frame thread retires and reclaims.
+// No slot may be handed to two live views, checked with a per slot owner count.
+static void TestConcurrentAllocFree()
+{
+	constexpr uint32_t Capacity = 256u;
+	constexpr uint32_t ThreadCount = 8u;
+	constexpr uint32_t FrameCount = 100u;
+
+	DescriptorSlotAllocator slots(Capacity);
+
+	std::vector<std::atomic<uint32_t>> owners(Capacity);
+	std::atomic<uint32_t> failedAllocs = 0u;
+
+	for (uint32_t frame = 1u; frame <= FrameCount; frame++)
+	{
+		std::vector<std::thread> threads;
+
+		for (uint32_t i = 0; i < ThreadCount; i++)
+		{
+			threads.emplace_back([&]
+			{
+				std::vector<uint32_t> live;
+
+				for (uint32_t op = 0; op < 16u; op++)
+				{
+					uint32_t slot = 0u;
+					if (!slots.Alloc(slot))
+					{
+						failedAllocs.fetch_add(1u);
+						continue;
+					}
+
+					TEST_CHECK(slot < Capacity);
+					TEST_CHECK(owners[slot].fetch_add(1u) == 0u);
+
+					live.push_back(slot);
+				}
+
+				for (uint32_t slot : live)
+				{
+					owners[slot].fetch_sub(1u);
+					slots.Free(slot);
+				}
+			});
+		}
+
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+
+		// The gpu runs a frame behind
+		slots.EndFrame(frame, frame);
+		slots.Reclaim(frame - 1u, frame - 1u);
+	}
+
+	// A frame never holds more than half the heap and only the last frame's slots are still retiring, so nothing runs out
+	TEST_CHECK(failedAllocs.load() == 0u);
+
+	slots.Reclaim(FrameCount, FrameCount);
+
+	std::vector<uint32_t> all;
+	uint32_t slot = 0u;
+	while (slots.Alloc(slot))
+	{
+		all.push_back(slot);
+	}
+
+	std::sort(all.begin(), all.end());
+	TEST_CHECK(all.size() == Capacity && std::adjacent_find(all.begin(), all.end()) == all.end());
+}
+
+int main()
+{
+	TestAllocUntilFull();
+	TestFreedSlotWaitsForItsFrame();
+	TestFramesReclaimInOrder();
+	TestReclaimedSlotsReusedFirst();
+	TestConcurrentAllocFree();
+
+	return TestResult("DescriptorSlotAllocatorTests");
+}
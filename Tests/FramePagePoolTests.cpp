@@ -0,0 +1,248 @@
+#include "Test.h"
+
+#include "FramePagePool.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using namespace rl;
+
+// Stands in for an upload page, the fences are simulated by passing completed values by hand.
+struct TestPage
+{
+	uint64_t GraphicsFence = 0u;
+	uint64_t ComputeFence = 0u;
+	uint32_t Retires = 0u;
+
+	void Retire(uint64_t graphicsFence, uint64_t computeFence)
+	{
+		GraphicsFence = graphicsFence;
+		ComputeFence = computeFence;
+		Retires++;
+	}
+
+	bool InFlight(uint64_t completedGraphicsFence, uint64_t completedComputeFence) const
+	{
+		return completedGraphicsFence < GraphicsFence || completedComputeFence < ComputeFence;
+	}
+};
+
+// Takes pages until the pool runs dry, then creates the rest the way the dynamic buffer threads do.
+static std::vector<TestPage*> UsePages(FramePagePool<TestPage>& pool, std::vector<std::unique_ptr<TestPage>>& created, uint32_t count)
+{
+	std::vector<TestPage*> pages;
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		TestPage* page = pool.TakePage();
+		if (!page)
+		{
+			created.push_back(std::make_unique<TestPage>());
+			page = created.back().get();
+		}
+
+		pages.push_back(page);
+	}
+
+	return pages;
+}
+
+static void EndFrame(FramePagePool<TestPage>& pool, std::vector<std::unique_ptr<TestPage>>& created, uint64_t graphicsFence, uint64_t computeFence)
+{
+	pool.RetireTakenPages(graphicsFence, computeFence);
+
+	for (std::unique_ptr<TestPage>& page : created)
+	{
+		pool.RetirePage(std::move(page), graphicsFence, computeFence);
+	}
+
+	created.clear();
+}
+
+static void TestPagesWaitForTheirFrame()
+{
+	FramePagePool<TestPage> pool;
+	std::vector<std::unique_ptr<TestPage>> created;
+
+	pool.NewFrame(0u, 0u);
+	const std::vector<TestPage*> frame1 = UsePages(pool, created, 3u);
+	TEST_CHECK(created.size() == 3u);
+	EndFrame(pool, created, 1u, 1u);
+
+	TEST_CHECK(pool.GetInFlightCount() == 3u && pool.GetFreeCount() == 0u);
+
+	// The gpu hasn't finished frame 1, so frame 2 has to create its own pages
+	pool.NewFrame(0u, 0u);
+	UsePages(pool, created, 2u);
+	TEST_CHECK(created.size() == 2u);
+	EndFrame(pool, created, 2u, 2u);
+
+	// Only frame 1's pages come back once its fences complete
+	pool.NewFrame(1u, 1u);
+	TEST_CHECK(pool.GetFreeCount() == 3u && pool.GetInFlightCount() == 2u);
+
+	const std::vector<TestPage*> frame3 = UsePages(pool, created, 3u);
+	TEST_CHECK(created.empty());
+
+	for (TestPage* page : frame3)
+	{
+		TEST_CHECK(std::find(frame1.begin(), frame1.end(), page) != frame1.end());
+		TEST_CHECK(page->Retires == 1u);
+	}
+
+	EndFrame(pool, created, 3u, 3u);
+	TEST_CHECK(pool.GetFreeCount() == 0u && pool.GetInFlightCount() == 5u);
+}
+
+// A frame is only done once both its graphics and compute work are.
+static void TestBothQueuesMustComplete()
+{
+	FramePagePool<TestPage> pool;
+	std::vector<std::unique_ptr<TestPage>> created;
+
+	pool.NewFrame(0u, 0u);
+	UsePages(pool, created, 1u);
+	EndFrame(pool, created, 5u, 7u);
+
+	pool.NewFrame(5u, 6u);
+	TEST_CHECK(pool.GetFreeCount() == 0u);
+
+	pool.NewFrame(4u, 7u);
+	TEST_CHECK(pool.GetFreeCount() == 0u);
+
+	pool.NewFrame(5u, 7u);
+	TEST_CHECK(pool.GetFreeCount() == 1u && pool.GetInFlightCount() == 0u);
+}
+
+// Pages created mid frame join behind the ones already in flight, a later frame never frees before an earlier one.
+static void TestRetirementIsInOrder()
+{
+	FramePagePool<TestPage> pool;
+	std::vector<std::unique_ptr<TestPage>> created;
+
+	for (uint64_t frame = 1u; frame <= 4u; frame++)
+	{
+		pool.NewFrame(0u, 0u);
+		UsePages(pool, created, 2u);
+		EndFrame(pool, created, frame, frame);
+	}
+
+	TEST_CHECK(pool.GetInFlightCount() == 8u);
+
+	// Frames 1 and 2 complete, their four pages are trimmed to the two a frame has needed so far
+	pool.NewFrame(2u, 2u);
+	TEST_CHECK(pool.GetFreeCount() == 2u && pool.GetInFlightCount() == 4u);
+
+	// Reused pages retire with the current frame behind the older ones still in flight
+	UsePages(pool, created, 5u);
+	TEST_CHECK(created.size() == 3u);
+	EndFrame(pool, created, 5u, 5u);
+
+	pool.NewFrame(4u, 4u);
+	TEST_CHECK(pool.GetFreeCount() == 4u && pool.GetInFlightCount() == 5u);
+
+	pool.NewFrame(5u, 5u);
+	TEST_CHECK(pool.GetInFlightCount() == 0u);
+}
+
+// A spike frame's pages are kept while it is inside the high water window and released once it leaves.
+static void TestHighWaterMarkTrims()
+{
+	FramePagePool<TestPage> pool;
+	std::vector<std::unique_ptr<TestPage>> created;
+
+	uint64_t fence = 0u;
+
+	pool.NewFrame(fence, fence);
+	UsePages(pool, created, 50u);
+	EndFrame(pool, created, fence + 1u, fence + 1u);
+	fence++;
+
+	for (uint32_t frame = 0; frame < FrameHighWaterMark::FrameCount; frame++)
+	{
+		pool.NewFrame(fence, fence);
+		TEST_CHECK(pool.GetFreeCount() + pool.GetInFlightCount() >= 50u);
+
+		UsePages(pool, created, 2u);
+		EndFrame(pool, created, fence + 1u, fence + 1u);
+		fence++;
+	}
+
+	pool.NewFrame(fence, fence);
+	TEST_CHECK(pool.GetFreeCount() == 2u);
+}
+
+// Threads take pages concurrently during a frame, each page goes to exactly one thread.
+static void TestConcurrentTakes()
+{
+	constexpr uint32_t ThreadCount = 8u;
+	constexpr uint32_t PagesPerThread = 64u;
+
+	FramePagePool<TestPage> pool;
+	std::vector<std::unique_ptr<TestPage>> created;
+
+	pool.NewFrame(0u, 0u);
+	UsePages(pool, created, ThreadCount * PagesPerThread / 2u);
+	EndFrame(pool, created, 1u, 1u);
+
+	for (uint64_t frame = 1u; frame <= 20u; frame++)
+	{
+		pool.NewFrame(frame, frame);
+
+		std::vector<std::vector<TestPage*>> taken(ThreadCount);
+		std::vector<std::vector<std::unique_ptr<TestPage>>> threadCreated(ThreadCount);
+		std::vector<std::thread> threads;
+
+		for (uint32_t i = 0; i < ThreadCount; i++)
+		{
+			threads.emplace_back([&, i]
+			{
+				taken[i] = UsePages(pool, threadCreated[i], PagesPerThread);
+
+				// Write to the page so ThreadSanitizer sees two threads sharing one
+				for (TestPage* page : taken[i])
+				{
+					page->GraphicsFence = i;
+				}
+			});
+		}
+
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+
+		std::vector<TestPage*> all;
+		for (const std::vector<TestPage*>& pages : taken)
+		{
+			all.insert(all.end(), pages.begin(), pages.end());
+		}
+
+		std::sort(all.begin(), all.end());
+		TEST_CHECK(std::adjacent_find(all.begin(), all.end()) == all.end());
+
+		pool.RetireTakenPages(frame + 1u, frame + 1u);
+		for (std::vector<std::unique_ptr<TestPage>>& pages : threadCreated)
+		{
+			for (std::unique_ptr<TestPage>& page : pages)
+			{
+				pool.RetirePage(std::move(page), frame + 1u, frame + 1u);
+			}
+		}
+	}
+
+	pool.NewFrame(21u, 21u);
+	TEST_CHECK(pool.GetFreeCount() == ThreadCount * PagesPerThread && pool.GetInFlightCount() == 0u);
+}
+
+int main()
+{
+	TestPagesWaitForTheirFrame();
+	TestBothQueuesMustComplete();
+	TestRetirementIsInOrder();
+	TestHighWaterMarkTrims();
+	TestConcurrentTakes();
+
+	return TestResult("FramePagePoolTests");
+}
@@ -0,0 +1,146 @@
+#include "Test.h"
+
+#include "FreeSpaceIndex.h"
+
+#include <random>
+#include <vector>
+
+using namespace rl;
+
+static void TestFindsSmallestFittingBucket()
+{
+	FreeSpaceIndex index;
+	index.Update(0u, 100u);
+	index.Update(1u, 5000u);
+	index.Update(2u, 70000u);
+
+	TEST_CHECK(index.Find(64u) == 1u);
+	// 5000 shares 4096's bucket, so the larger bucket that is guaranteed to fit wins
+	TEST_CHECK(index.Find(4096u) == 2u);
+	TEST_CHECK(index.Find(5000u) == 2u);
+	TEST_CHECK(index.Find(70000u) == 2u);
+	TEST_CHECK(index.Find(70001u) == FreeSpaceIndex::InvalidPage);
+
+	TEST_CHECK(index.Find(90u) == 1u);
+	index.Remove(1u);
+	index.Remove(2u);
+
+	// Only pages in the size's own bucket are left, so that bucket is scanned for one that fits
+	TEST_CHECK(index.Find(90u) == 0u);
+	TEST_CHECK(index.Find(101u) == FreeSpaceIndex::InvalidPage);
+}
+
+static void TestUpdatesMovePages()
+{
+	FreeSpaceIndex index;
+
+	for (uint32_t page = 0; page < 8u; page++)
+	{
+		index.Update(page, 1024u);
+	}
+
+	index.Update(3u, 0u);
+	index.Update(5u, 64u);
+
+	std::vector<uint32_t> found;
+	while (true)
+	{
+		const uint32_t page = index.Find(1024u);
+		if (page == FreeSpaceIndex::InvalidPage)
+			break;
+
+		found.push_back(page);
+		index.Remove(page);
+	}
+
+	TEST_CHECK(found.size() == 6u);
+	TEST_CHECK(index.Find(64u) == 5u);
+	TEST_CHECK(index.GetLargestFreeBlock(3u) == 0u);
+	TEST_CHECK(index.GetLargestFreeBlock(100u) == 0u);
+}
+
+static void TestAcceptSkipsPages()
+{
+	FreeSpaceIndex index;
+	index.Update(0u, 4096u);
+	index.Update(1u, 4096u);
+
+	const uint32_t first = index.Find(256u);
+	const uint32_t second = index.Find(256u, [first](uint32_t page) { return page != first; });
+
+	TEST_CHECK(first != FreeSpaceIndex::InvalidPage && second != FreeSpaceIndex::InvalidPage && first != second);
+	TEST_CHECK(index.Find(256u, [](uint32_t) { return false; }) == FreeSpaceIndex::InvalidPage);
+}
+
+// Random updates checked against a plain array, any page returned must fit and a miss means no page fits.
+static void TestMatchesLinearScan()
+{
+	constexpr uint32_t PageCount = 64u;
+
+	FreeSpaceIndex index;
+	std::vector<uint64_t> largest(PageCount, 0u);
+
+	std::mt19937 rng(3u);
+
+	for (uint32_t i = 0; i < 20000u; i++)
+	{
+		const uint32_t page = rng() % PageCount;
+		const uint64_t value = rng() % 4u == 0u ? 0u : rng() % (2u * 1024u * 1024u);
+
+		index.Update(page, value);
+		largest[page] = value;
+
+		const uint64_t size = 1u + rng() % (2u * 1024u * 1024u);
+		const uint32_t found = index.Find(size);
+
+		bool anyFits = false;
+		for (uint64_t pageLargest : largest)
+		{
+			anyFits |= pageLargest >= size;
+		}
+
+		TEST_CHECK(anyFits == (found != FreeSpaceIndex::InvalidPage));
+		TEST_CHECK(found == FreeSpaceIndex::InvalidPage || largest[found] >= size);
+	}
+}
+
+// Heaps for large buffers have free blocks over 4GB, a truncated size would send a request to a page that can't hold it.
+static void TestMultiGigabyteFreeBlocks()
+{
+	constexpr uint64_t GB = 1024ull * 1024u * 1024u;
+
+	FreeSpaceIndex index;
+	index.Update(0u, 3 * GB);
+	index.Update(1u, 6 * GB);
+	index.Update(2u, 5 * GB);
+
+	TEST_CHECK(index.GetLargestFreeBlock(1u) == 6 * GB);
+
+	const uint32_t over4GB = index.Find(4 * GB + 1u);
+	TEST_CHECK(over4GB == 1u || over4GB == 2u);
+
+	TEST_CHECK(index.Find(5 * GB + 1u) == 1u);
+	TEST_CHECK(index.Find(6 * GB + 1u) == FreeSpaceIndex::InvalidPage);
+
+	// 4GB and 4GB + 1 fall in the 2^32 bucket, 3GB below it
+	index.Remove(1u);
+	index.Update(3u, 4 * GB);
+
+	TEST_CHECK(index.Find(4 * GB, [](uint32_t page) { return page != 2u; }) == 3u);
+	TEST_CHECK(index.Find(4 * GB + 1u) == 2u);
+
+	index.Remove(2u);
+	TEST_CHECK(index.Find(4 * GB + 1u) == FreeSpaceIndex::InvalidPage);
+	TEST_CHECK(index.Find(3 * GB + 1u) == 3u);
+}
+
+int main()
+{
+	TestFindsSmallestFittingBucket();
+	TestUpdatesMovePages();
+	TestAcceptSkipsPages();
+	TestMatchesLinearScan();
+	TestMultiGigabyteFreeBlocks();
+
+	return TestResult("FreeSpaceIndexTests");
+}
@@ -0,0 +1,142 @@
+#include "Benchmark.h"
+
+#include "MappedFile.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace rl;
+
+// Loads one file into upload memory the way CreateBufferFromFile does, against reading it into a vector and copying that.
+// The file is usually still in the page cache after it is written, so this measures the copies and the memory they hold rather than the disk.
+static const size_t FileSize = 256u * 1024u * 1024u;
+
+static std::string WriteBenchmarkFile()
+{
+	const char* tmp = getenv("TMPDIR");
+	const std::string path = std::string(tmp ? tmp : "/tmp") + "/MappedFileBenchmark.bin";
+
+	std::vector<uint8_t> chunk(4u * 1024u * 1024u);
+	for (size_t i = 0; i < chunk.size(); i++)
+	{
+		chunk[i] = (uint8_t)(i * 13u);
+	}
+
+	FILE* file = fopen(path.c_str(), "wb");
+	if (!file)
+	{
+		return {};
+	}
+
+	for (size_t written = 0u; written < FileSize; written += chunk.size())
+	{
+		fwrite(chunk.data(), 1u, chunk.size(), file);
+	}
+
+	fclose(file);
+
+	return path;
+}
+
+static uint64_t GetPeakRssBytes()
+{
+	rusage usage = {};
+	getrusage(RUSAGE_SELF, &usage);
+
+	// Kilobytes on linux
+	return (uint64_t)usage.ru_maxrss * 1024u;
+}
+
+// ru_maxrss only ever grows, so each path runs in its own process and reports the peak it added on top of the upload memory.
+template<typename Load>
+static void BenchmarkLoad(const char* name, const std::string& path, Load&& load)
+{
+	fflush(stdout);
+
+	const pid_t child = fork();
+
+	if (child == 0)
+	{
+		// Stands in for the staging memory the upload is copied to, touched up front so it is part of the baseline
+		std::vector<uint8_t> upload(FileSize, 1u);
+
+		const uint64_t baselineRss = GetPeakRssBytes();
+
+		bool loaded = false;
+		Benchmark(name, 1u, [&] { loaded = load(path, upload); });
+
+		printf("%-56s %12llu bytes\n", "  peak rss above the upload memory", (unsigned long long)(GetPeakRssBytes() - baselineRss));
+
+		if (!loaded)
+		{
+			printf("  load failed\n");
+		}
+
+		DoNotOptimize(upload[FileSize / 2u]);
+
+		fflush(stdout);
+		_exit(loaded ? 0 : 1);
+	}
+
+	int status = 0;
+	waitpid(child, &status, 0);
+}
+
+int main()
+{
+	const std::string path = WriteBenchmarkFile();
+	if (path.empty())
+	{
+		printf("Couldn't write the benchmark file\n");
+		return 1;
+	}
+
+	// Mapped pages count towards rss once touched, but they are clean page cache pages the os can drop rather than a second copy of the file
+	BenchmarkLoad("mapped file, copy to upload memory", path, [](const std::string& filePath, std::vector<uint8_t>& upload)
+	{
+		MappedFile file;
+		size_t size = 0u;
+
+		if (!MapFileRange(file, filePath.c_str(), 0u, size) || size > upload.size())
+		{
+			return false;
+		}
+
+		memcpy(upload.data(), file.Data(), size);
+
+		return true;
+	});
+
+	BenchmarkLoad("read into vector, copy to upload memory", path, [](const std::string& filePath, std::vector<uint8_t>& upload)
+	{
+		FILE* file = fopen(filePath.c_str(), "rb");
+		if (!file)
+		{
+			return false;
+		}
+
+		std::vector<uint8_t> data(FileSize);
+		const size_t size = fread(data.data(), 1u, data.size(), file);
+
+		fclose(file);
+
+		if (size != FileSize)
+		{
+			return false;
+		}
+
+		memcpy(upload.data(), data.data(), size);
+
+		return true;
+	});
+
+	remove(path.c_str());
+
+	return 0;
+}
@@ -0,0 +1,125 @@
+#include "Test.h"
+
+#include "MpscQueue.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace rl;
+
+struct Message
+{
+	uint32_t Producer = 0u;
+	uint32_t Sequence = 0u;
+
+	// Written by the producer before the push, read by the consumer after the pop, so ThreadSanitizer sees the handover
+	std::unique_ptr<uint64_t> Payload;
+};
+
+static void TestSingleThreadOrder()
+{
+	MpscQueue<uint32_t> queue;
+
+	for (uint32_t i = 0; i < 100u; i++)
+	{
+		queue.Push(uint32_t(i));
+	}
+
+	std::vector<uint32_t> out = { 1000u };
+	queue.PopAll(out);
+
+	TEST_CHECK(out.size() == 101u && out[0] == 1000u);
+
+	for (uint32_t i = 0; i < 100u; i++)
+	{
+		TEST_CHECK(out[i + 1u] == i);
+	}
+
+	TEST_CHECK(queue.Empty());
+}
+
+// Producers push while the consumer keeps popping, every message must arrive once and in its producer's order.
+static void TestConcurrentProducers()
+{
+	constexpr uint32_t ProducerCount = 8u;
+	constexpr uint32_t MessagesPerProducer = 20000u;
+
+	MpscQueue<Message> queue;
+
+	std::atomic<uint32_t> finishedProducers = 0u;
+	std::vector<std::thread> producers;
+
+	for (uint32_t producer = 0; producer < ProducerCount; producer++)
+	{
+		producers.emplace_back([&queue, &finishedProducers, producer]
+		{
+			for (uint32_t i = 0; i < MessagesPerProducer; i++)
+			{
+				queue.Push({ producer, i, std::make_unique<uint64_t>(((uint64_t)producer << 32u) | i) });
+			}
+
+			finishedProducers.fetch_add(1u, std::memory_order_release);
+		});
+	}
+
+	std::vector<uint32_t> nextSequence(ProducerCount, 0u);
+	std::vector<Message> popped;
+	uint64_t received = 0u;
+
+	while (true)
+	{
+		const bool producersDone = finishedProducers.load(std::memory_order_acquire) == ProducerCount;
+
+		popped.clear();
+		queue.PopAll(popped);
+
+		for (const Message& message : popped)
+		{
+			TEST_CHECK(message.Producer < ProducerCount);
+			TEST_CHECK(message.Sequence == nextSequence[message.Producer]);
+			TEST_CHECK(message.Payload && *message.Payload == (((uint64_t)message.Producer << 32u) | message.Sequence));
+
+			nextSequence[message.Producer] = message.Sequence + 1u;
+		}
+
+		received += popped.size();
+
+		// Only stop after a pop that started once every producer had finished
+		if (producersDone && popped.empty())
+		{
+			break;
+		}
+	}
+
+	for (std::thread& thread : producers)
+	{
+		thread.join();
+	}
+
+	TEST_CHECK(received == (uint64_t)ProducerCount * MessagesPerProducer);
+	TEST_CHECK(queue.Empty());
+}
+
+// Anything left in the queue is freed with it.
+static void TestDestroyWithPendingMessages()
+{
+	auto queue = std::make_unique<MpscQueue<Message>>();
+
+	for (uint32_t i = 0; i < 16u; i++)
+	{
+		queue->Push({ 0u, i, std::make_unique<uint64_t>(i) });
+	}
+
+	queue.reset();
+}
+
+int main()
+{
+	TestSingleThreadOrder();
+	TestConcurrentProducers();
+	TestDestroyWithPendingMessages();
+
+	return TestResult("MpscQueueTests");
+}
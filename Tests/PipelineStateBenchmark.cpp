@@ -0,0 +1,146 @@
+#include "Benchmark.h"
+
+#include "Hash.h"
+#include "Impl/PipelineStateImpl.h"
+
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rl
+{
+
+// No backend, pipelines only go through the shared interning and deduplication.
+bool CompileGraphicsPipelineState(GraphicsPipelineState_t handle, const GraphicsPipelineStateDesc& desc, InputLayout_t layout) { return true; }
+bool CompileComputePipelineState(ComputePipelineState_t handle, const ComputePipelineStateDesc& desc) { return true; }
+void DestroyGraphicsPipelineState(GraphicsPipelineState_t pso) {}
+void DestroyComputePipelineState(ComputePipelineState_t pso) {}
+void DestroyInputLayout(InputLayout_t layout) {}
+
+}
+
+using namespace rl;
+
+static const char* SemanticNames[] = { "POSITION", "NORMAL", "TANGENT", "TEXCOORD", "TEXCOORD", "COLOR" };
+static constexpr size_t ElementCount = sizeof(SemanticNames) / sizeof(SemanticNames[0]);
+
+// Each pipeline owns its own copy of the names, like descs built by separate loaders.
+struct LegacyPipeline
+{
+	std::vector<std::string> Names;
+	std::vector<InputElementDesc> Inputs;
+};
+
+static LegacyPipeline MakeLegacyPipeline()
+{
+	LegacyPipeline pipeline;
+	pipeline.Names.assign(SemanticNames, SemanticNames + ElementCount);
+
+	for (size_t i = 0; i < ElementCount; i++)
+	{
+		pipeline.Inputs.push_back({ pipeline.Names[i].c_str(), (uint32_t)(i == 4), RenderFormat::R32G32B32_FLOAT, 0u, (uint32_t)(i * 12u), InputClassification::PER_VERTEX, 0u });
+	}
+
+	return pipeline;
+}
+
+static uint64_t HashLegacyInputs(const std::vector<InputElementDesc>& inputs)
+{
+	uint64_t hash = 0u;
+
+	for (const InputElementDesc& input : inputs)
+	{
+		hash_combine(hash, std::string_view(input.semanticName));
+		hash_combine(hash, input.semanticIndex);
+		hash_combine(hash, (uint32_t)input.format);
+		hash_combine(hash, input.alignedByteOffset);
+	}
+
+	return hash;
+}
+
+static bool SameLegacyInputs(const std::vector<InputElementDesc>& a, const std::vector<InputElementDesc>& b)
+{
+	if (a.size() != b.size())
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < a.size(); i++)
+	{
+		if (!(a[i] == b[i]))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int main()
+{
+	constexpr uint64_t Iterations = 1000000u;
+
+	const LegacyPipeline a = MakeLegacyPipeline();
+	const LegacyPipeline b = MakeLegacyPipeline();
+
+	Benchmark("layout hash, per pipeline element vectors", Iterations, [&]
+	{
+		uint64_t sum = 0u;
+		for (uint64_t i = 0; i < Iterations; i++)
+		{
+			sum += HashLegacyInputs(i & 1u ? a.Inputs : b.Inputs);
+		}
+		DoNotOptimize(sum);
+	});
+
+	Benchmark("layout compare, per pipeline element vectors", Iterations, [&]
+	{
+		uint64_t same = 0u;
+		for (uint64_t i = 0; i < Iterations; i++)
+		{
+			same += SameLegacyInputs(a.Inputs, b.Inputs);
+		}
+		DoNotOptimize(same);
+	});
+
+	const InputLayout_t layoutA = InternInputLayout(a.Inputs.data(), a.Inputs.size());
+	const InputLayout_t layoutB = InternInputLayout(b.Inputs.data(), b.Inputs.size());
+
+	Benchmark("layout hash and compare, interned handles", Iterations, [&]
+	{
+		uint64_t sum = 0u;
+		for (uint64_t i = 0; i < Iterations; i++)
+		{
+			uint64_t hash = 0u;
+			hash_combine(hash, (uint32_t)(i & 1u ? layoutA : layoutB));
+			sum += hash + (layoutA == layoutB);
+		}
+		DoNotOptimize(sum);
+	});
+
+	constexpr uint64_t CreateIterations = 100000u;
+
+	GraphicsPipelineStateDesc desc;
+	desc.RasterizerDesc(PrimitiveTopologyType::TRIANGLE, FillMode::SOLID, CullMode::BACK);
+	desc.TargetBlendDesc({ RenderFormat::R8G8B8A8_UNORM }, { BlendMode::None() }, RenderFormat::D32_FLOAT);
+	desc.VertexShader((VertexShader_t)1u).PixelShader((PixelShader_t)1u);
+
+	const GraphicsPipelineState_t first = CreateGraphicsPipelineState(desc, a.Inputs.data(), a.Inputs.size());
+
+	Benchmark("CreateGraphicsPipelineState, existing pipeline", CreateIterations, [&]
+	{
+		for (uint64_t i = 0; i < CreateIterations; i++)
+		{
+			const GraphicsPipelineState_t pso = CreateGraphicsPipelineState(desc, b.Inputs.data(), b.Inputs.size());
+			RenderRelease(pso);
+		}
+	});
+
+	RenderRelease(first);
+	RenderRelease(layoutA);
+	RenderRelease(layoutB);
+
+	return 0;
+}
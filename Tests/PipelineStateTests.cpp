@@ -0,0 +1,126 @@
+#include "Test.h"
+
+#include "Impl/PipelineStateImpl.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace rl
+{
+
+std::atomic<uint32_t> g_CompiledPipelines = 0u;
+
+bool CompileGraphicsPipelineState(GraphicsPipelineState_t handle, const GraphicsPipelineStateDesc& desc, InputLayout_t layout) { g_CompiledPipelines++; return true; }
+bool CompileComputePipelineState(ComputePipelineState_t handle, const ComputePipelineStateDesc& desc) { return true; }
+void DestroyGraphicsPipelineState(GraphicsPipelineState_t pso) {}
+void DestroyComputePipelineState(ComputePipelineState_t pso) {}
+void DestroyInputLayout(InputLayout_t layout) {}
+
+}
+
+using namespace rl;
+
+static const InputElementDesc Inputs[] =
+{
+	{ "POSITION", 0u, RenderFormat::R32G32B32_FLOAT, 0u, 0u, InputClassification::PER_VERTEX, 0u },
+	{ "TEXCOORD", 0u, RenderFormat::R32G32_FLOAT, 0u, 12u, InputClassification::PER_VERTEX, 0u },
+};
+
+static GraphicsPipelineStateDesc MakeDesc()
+{
+	GraphicsPipelineStateDesc desc;
+	desc.RasterizerDesc(PrimitiveTopologyType::TRIANGLE, FillMode::SOLID, CullMode::BACK);
+	desc.VertexShader((VertexShader_t)1u).PixelShader((PixelShader_t)1u);
+	desc.DebugName = L"Pipeline";
+	return desc;
+}
+
+// Id 0 is reserved, so the used counts start at one
+static void TestIdenticalPipelinesShareHandle()
+{
+	// Separate copies of the semantic names, layouts are matched by content not by pointer
+	std::string position = "POSITION";
+	std::string texcoord = "TEXCOORD";
+	InputElementDesc copies[] = { Inputs[0], Inputs[1] };
+	copies[0].semanticName = position.c_str();
+	copies[1].semanticName = texcoord.c_str();
+
+	const GraphicsPipelineState_t a = CreateGraphicsPipelineState(MakeDesc(), Inputs, 2u);
+	const GraphicsPipelineState_t b = CreateGraphicsPipelineState(MakeDesc(), copies, 2u);
+
+	TEST_CHECK(a != GraphicsPipelineState_t::INVALID);
+	TEST_CHECK(a == b);
+	TEST_CHECK(GetGraphicsPipelineStateCount() == 2u);
+	TEST_CHECK(GetInputLayoutCount() == 2u);
+
+	RenderRelease(a);
+	TEST_CHECK(GetGraphicsPipelineStateCount() == 2u);
+
+	RenderRelease(b);
+	TEST_CHECK(GetGraphicsPipelineStateCount() == 1u);
+	TEST_CHECK(GetInputLayoutCount() == 1u);
+}
+
+static void TestDebugNameKeepsPipelinesApart()
+{
+	GraphicsPipelineStateDesc renamed = MakeDesc();
+	renamed.DebugName = L"Renamed";
+
+	const GraphicsPipelineState_t a = CreateGraphicsPipelineState(MakeDesc(), Inputs, 2u);
+	const GraphicsPipelineState_t b = CreateGraphicsPipelineState(renamed, Inputs, 2u);
+
+	TEST_CHECK(a != b);
+	TEST_CHECK(GetInputLayoutCount() == 2u);
+
+	RenderRelease(a);
+	RenderRelease(b);
+
+	TEST_CHECK(GetGraphicsPipelineStateCount() == 1u);
+}
+
+static void TestParallelCreatesAgree()
+{
+	constexpr uint32_t ThreadCount = 8u;
+
+	std::vector<GraphicsPipelineState_t> results(ThreadCount, GraphicsPipelineState_t::INVALID);
+	std::vector<std::thread> threads;
+
+	for (uint32_t i = 0; i < ThreadCount; i++)
+	{
+		threads.emplace_back([&results, i]
+		{
+			results[i] = CreateGraphicsPipelineState(MakeDesc(), Inputs, 2u);
+		});
+	}
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	// Racing compiles are allowed, but every thread must end up with the one handle kept in the lookup
+	for (uint32_t i = 0; i < ThreadCount; i++)
+	{
+		TEST_CHECK(results[i] == results[0]);
+	}
+
+	TEST_CHECK(GetGraphicsPipelineStateCount() == 2u);
+
+	for (GraphicsPipelineState_t pso : results)
+	{
+		RenderRelease(pso);
+	}
+
+	TEST_CHECK(GetGraphicsPipelineStateCount() == 1u);
+	TEST_CHECK(GetInputLayoutCount() == 1u);
+}
+
+int main()
+{
+	TestIdenticalPipelinesShareHandle();
+	TestDebugNameKeepsPipelinesApart();
+	TestParallelCreatesAgree();
+
+	return TestResult("PipelineStateTests");
+}
@@ -0,0 +1,171 @@
+#include "Test.h"
+
+#include "Impl/SamplersImpl.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace rl
+{
+
+std::atomic<uint32_t> g_CreatedSamplers = 0u;
+std::atomic<uint32_t> g_DestroyedSamplers = 0u;
+bool g_FailSamplerCreation = false;
+
+bool CreateSamplerImpl(Sampler_t sampler, const SamplerDesc& desc) { g_CreatedSamplers++; return !g_FailSamplerCreation; }
+void DestroySamplerImpl(Sampler_t sampler) { g_DestroyedSamplers++; }
+uint32_t GetDescriptorIndexImpl(Sampler_t sampler) { return (uint32_t)sampler; }
+
+}
+
+using namespace rl;
+
+static SamplerDesc MakeDesc(SamplerFilterMode filter)
+{
+	SamplerDesc desc;
+	desc.AddressMode.U = SamplerAddressMode::CLAMP;
+	desc.AddressMode.V = SamplerAddressMode::CLAMP;
+	desc.AddressMode.W = SamplerAddressMode::WRAP;
+	desc.FilterMode.Min = filter;
+	desc.FilterMode.Mag = filter;
+	desc.FilterMode.Mip = SamplerFilterMode::LINEAR;
+	desc.MaxAnisotropy = 8u;
+	return desc;
+}
+
+// Id 0 is reserved, so the used count starts at one
+static void TestEqualDescsShareSampler()
+{
+	g_CreatedSamplers = 0u;
+	g_DestroyedSamplers = 0u;
+
+	const Sampler_t a = CreateSampler(MakeDesc(SamplerFilterMode::LINEAR));
+	const Sampler_t b = CreateSampler(MakeDesc(SamplerFilterMode::LINEAR));
+
+	TEST_CHECK(a != Sampler_t::INVALID && a == b);
+	TEST_CHECK(g_CreatedSamplers == 1u && GetSamplerCount() == 2u);
+	TEST_CHECK(GetDescriptorIndex(a) == (uint32_t)a);
+
+	// The sampler lives until its last reference is released
+	RenderRelease(a);
+	TEST_CHECK(g_DestroyedSamplers == 0u && GetSamplerCount() == 2u);
+
+	RenderRelease(b);
+	TEST_CHECK(g_DestroyedSamplers == 1u && GetSamplerCount() == 1u);
+}
+
+static void TestDifferentDescsGetOwnSampler()
+{
+	g_CreatedSamplers = 0u;
+	g_DestroyedSamplers = 0u;
+
+	const Sampler_t linear = CreateSampler(MakeDesc(SamplerFilterMode::LINEAR));
+	const Sampler_t point = CreateSampler(MakeDesc(SamplerFilterMode::POINT));
+
+	SamplerDesc biased = MakeDesc(SamplerFilterMode::LINEAR);
+	biased.MipLODBias = -0.5f;
+	const Sampler_t bias = CreateSampler(biased);
+
+	TEST_CHECK(linear != point && linear != bias && point != bias);
+	TEST_CHECK(g_CreatedSamplers == 3u && GetSamplerCount() == 4u);
+
+	RenderRelease(linear);
+	RenderRelease(point);
+	RenderRelease(bias);
+
+	TEST_CHECK(g_DestroyedSamplers == 3u && GetSamplerCount() == 1u);
+}
+
+// A released desc isn't found again, the next create makes a new sampler and it is shared as before.
+static void TestReleasedSamplerIsRecreated()
+{
+	g_CreatedSamplers = 0u;
+	g_DestroyedSamplers = 0u;
+
+	const SamplerDesc desc = MakeDesc(SamplerFilterMode::ANISOTROPIC);
+
+	RenderRelease(CreateSampler(desc));
+	TEST_CHECK(g_CreatedSamplers == 1u && g_DestroyedSamplers == 1u);
+
+	const Sampler_t a = CreateSampler(desc);
+	TEST_CHECK(a != Sampler_t::INVALID && g_CreatedSamplers == 2u);
+
+	const Sampler_t b = CreateSampler(desc);
+	TEST_CHECK(a == b && g_CreatedSamplers == 2u);
+
+	RenderRelease(a);
+	RenderRelease(b);
+
+	TEST_CHECK(g_DestroyedSamplers == 2u && GetSamplerCount() == 1u);
+}
+
+// A sampler the backend couldn't create isn't kept or looked up, the next create tries again.
+static void TestFailedCreationIsRetried()
+{
+	g_CreatedSamplers = 0u;
+	g_DestroyedSamplers = 0u;
+
+	const SamplerDesc desc = MakeDesc(SamplerFilterMode::POINT);
+
+	g_FailSamplerCreation = true;
+	TEST_CHECK(CreateSampler(desc) == Sampler_t::INVALID);
+	TEST_CHECK(GetSamplerCount() == 1u);
+
+	g_FailSamplerCreation = false;
+	const Sampler_t sampler = CreateSampler(desc);
+	TEST_CHECK(sampler != Sampler_t::INVALID && g_CreatedSamplers == 2u);
+
+	RenderRelease(sampler);
+	TEST_CHECK(GetSamplerCount() == 1u);
+}
+
+static void TestParallelCreatesShareSampler()
+{
+	constexpr uint32_t ThreadCount = 8u;
+
+	g_CreatedSamplers = 0u;
+	g_DestroyedSamplers = 0u;
+
+	std::vector<Sampler_t> results(ThreadCount, Sampler_t::INVALID);
+	std::vector<std::thread> threads;
+
+	for (uint32_t i = 0; i < ThreadCount; i++)
+	{
+		threads.emplace_back([&results, i]
+		{
+			results[i] = CreateSampler(MakeDesc(SamplerFilterMode::LINEAR));
+		});
+	}
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	// The lookup is held while creating, so only one sampler is ever made
+	for (uint32_t i = 0; i < ThreadCount; i++)
+	{
+		TEST_CHECK(results[i] == results[0]);
+	}
+
+	TEST_CHECK(g_CreatedSamplers == 1u && GetSamplerCount() == 2u);
+
+	for (Sampler_t sampler : results)
+	{
+		RenderRelease(sampler);
+	}
+
+	TEST_CHECK(g_DestroyedSamplers == 1u && GetSamplerCount() == 1u);
+}
+
+int main()
+{
+	TestEqualDescsShareSampler();
+	TestDifferentDescsGetOwnSampler();
+	TestReleasedSamplerIsRecreated();
+	TestFailedCreationIsRetried();
+	TestParallelCreatesShareSampler();
+
+	return TestResult("SamplersTests");
+}
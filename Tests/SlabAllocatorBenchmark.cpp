@@ -0,0 +1,116 @@
+#include "Benchmark.h"
+
+#include "SlabAllocator.h"
+#include "TlsfAllocator.h"
+
+#include <random>
+#include <vector>
+
+using namespace rl;
+
+struct ConstantOp
+{
+	bool Create;
+	uint64_t Size;
+	uint32_t Slot;
+};
+
+// Constant buffer sized creates and destroys, per object and per material constants living a few hundred operations each.
+static std::vector<ConstantOp> MakeConstantChurn(uint32_t count)
+{
+	std::vector<ConstantOp> ops;
+	std::vector<uint32_t> live;
+
+	std::mt19937 rng(1234u);
+	std::uniform_int_distribution<uint64_t> sizes(16u, 4u * 1024u);
+
+	uint32_t nextSlot = 0u;
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		if (live.size() < 256u || (live.size() < 1024u && rng() % 2u == 0u))
+		{
+			ops.push_back({ true, sizes(rng), nextSlot });
+			live.push_back(nextSlot++);
+		}
+		else
+		{
+			const size_t index = rng() % live.size();
+			ops.push_back({ false, 0u, live[index] });
+			live[index] = live.back();
+			live.pop_back();
+		}
+	}
+
+	return ops;
+}
+
+int main()
+{
+	// The 2MB static buffer page and constant buffer alignment constant buffers were allocated with before slab pages
+	constexpr uint64_t PageSize = 2u * 1024u * 1024u;
+	constexpr uint64_t ConstantAlignment = 256u;
+	constexpr uint32_t OpCount = 1000000u;
+
+	const std::vector<ConstantOp> ops = MakeConstantChurn(OpCount);
+
+	{
+		std::vector<TlsfAllocator> pages;
+		std::vector<uint32_t> allocationPages(OpCount, ~0u);
+		std::vector<TlsfAllocation> allocations(OpCount);
+
+		Benchmark("tlsf page constant buffers, create and destroy", OpCount, [&]
+		{
+			for (const ConstantOp& op : ops)
+			{
+				if (op.Create)
+				{
+					const uint64_t alignedSize = (op.Size + ConstantAlignment - 1u) / ConstantAlignment * ConstantAlignment;
+
+					uint32_t page = 0u;
+					while (page < (uint32_t)pages.size() && !pages[page].Alloc(alignedSize, ConstantAlignment, allocations[op.Slot]))
+					{
+						page++;
+					}
+
+					if (page == (uint32_t)pages.size())
+					{
+						pages.emplace_back(PageSize).Alloc(alignedSize, ConstantAlignment, allocations[op.Slot]);
+					}
+
+					allocationPages[op.Slot] = page;
+				}
+				else if (allocationPages[op.Slot] != ~0u)
+				{
+					pages[allocationPages[op.Slot]].Free(allocations[op.Slot]);
+				}
+			}
+		});
+
+		printf("%-56s %12llu bytes\n", "tlsf pages reserved", (unsigned long long)(pages.size() * PageSize));
+	}
+
+	{
+		SlabAllocator slabs;
+		std::vector<SlabAllocation> allocations(OpCount);
+
+		Benchmark("slab constant buffers, create and destroy", OpCount, [&]
+		{
+			for (const ConstantOp& op : ops)
+			{
+				if (op.Create)
+				{
+					slabs.Alloc(op.Size, allocations[op.Slot]);
+				}
+				else if (allocations[op.Slot].Valid())
+				{
+					slabs.Free(allocations[op.Slot]);
+				}
+			}
+		});
+
+		printf("%-56s %12llu bytes\n", "slab pages reserved", (unsigned long long)(slabs.GetPageCount() * SlabAllocator::PageSize));
+	}
+
+	return 0;
+}
@@ -0,0 +1,141 @@
+#include "Test.h"
+
+#include "SlabAllocator.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace rl;
+
+static void TestSizeClasses()
+{
+	SlabAllocator slabs;
+
+	SlabAllocation allocation;
+	TEST_CHECK(slabs.Alloc(1u, allocation) && allocation.Size == 256u);
+	TEST_CHECK(slabs.Alloc(256u, allocation) && allocation.Size == 256u);
+	TEST_CHECK(slabs.Alloc(257u, allocation) && allocation.Size == 512u);
+	TEST_CHECK(slabs.Alloc(SlabAllocator::GetMaxSize(), allocation) && allocation.Size == SlabAllocator::PageSize);
+	TEST_CHECK(!slabs.Alloc(SlabAllocator::GetMaxSize() + 1u, allocation));
+
+	// One page per size class used so far
+	TEST_CHECK(slabs.GetPageCount() == 3u);
+	TEST_CHECK(slabs.GetAllocationCount() == 4u);
+}
+
+static void TestPageFillsBeforeGrowing()
+{
+	SlabAllocator slabs;
+
+	std::vector<SlabAllocation> allocations(SlabAllocator::MaxSlotsPerPage);
+
+	for (SlabAllocation& allocation : allocations)
+	{
+		TEST_CHECK(slabs.Alloc(200u, allocation));
+		TEST_CHECK(allocation.Page == 0u);
+		TEST_CHECK(allocation.Offset % 256u == 0u && allocation.Offset + allocation.Size <= SlabAllocator::PageSize);
+	}
+
+	std::sort(allocations.begin(), allocations.end(), [](const SlabAllocation& a, const SlabAllocation& b) { return a.Offset < b.Offset; });
+
+	for (size_t i = 1; i < allocations.size(); i++)
+	{
+		TEST_CHECK(allocations[i].Offset != allocations[i - 1].Offset);
+	}
+
+	SlabAllocation overflow;
+	TEST_CHECK(slabs.Alloc(200u, overflow) && overflow.Page == 1u);
+}
+
+static void TestEmptyPagesChangeClass()
+{
+	SlabAllocator slabs;
+
+	SlabAllocation small;
+	TEST_CHECK(slabs.Alloc(256u, small));
+
+	slabs.Free(small);
+	TEST_CHECK(slabs.GetAllocationCount() == 0u);
+
+	// The emptied page is reused for a different size class instead of growing
+	SlabAllocation large;
+	TEST_CHECK(slabs.Alloc(4096u, large));
+	TEST_CHECK(large.Page == small.Page && large.Size == 4096u);
+	TEST_CHECK(slabs.GetPageCount() == 1u);
+}
+
+// Reuse is immediate here, the dx12 pool only frees a slot once the frame that freed it has completed.
+static void TestFreedSlotIsReused()
+{
+	SlabAllocator slabs;
+
+	SlabAllocation a;
+	SlabAllocation b;
+	TEST_CHECK(slabs.Alloc(1024u, a));
+	TEST_CHECK(slabs.Alloc(1024u, b));
+
+	slabs.Free(a);
+
+	SlabAllocation c;
+	TEST_CHECK(slabs.Alloc(1024u, c));
+	TEST_CHECK(c.Page == a.Page && c.Slot == a.Slot && c.Offset == a.Offset);
+}
+
+// Random churn over every size class, live allocations in the same page must never overlap.
+static void TestChurn()
+{
+	SlabAllocator slabs;
+
+	std::vector<SlabAllocation> live;
+	std::mt19937 rng(21u);
+
+	for (uint32_t i = 0; i < 20000u; i++)
+	{
+		if (live.empty() || rng() % 3u != 0u)
+		{
+			SlabAllocation allocation;
+			const uint64_t size = 1u + rng() % SlabAllocator::GetMaxSize();
+
+			TEST_CHECK(slabs.Alloc(size, allocation));
+			TEST_CHECK(allocation.Size >= size && allocation.Offset % allocation.Size == 0u);
+
+			live.push_back(allocation);
+		}
+		else
+		{
+			const size_t index = rng() % live.size();
+
+			slabs.Free(live[index]);
+
+			live[index] = live.back();
+			live.pop_back();
+		}
+
+		TEST_CHECK(slabs.GetAllocationCount() == (uint32_t)live.size());
+	}
+
+	std::sort(live.begin(), live.end(), [](const SlabAllocation& a, const SlabAllocation& b)
+	{
+		return a.Page != b.Page ? a.Page < b.Page : a.Offset < b.Offset;
+	});
+
+	for (size_t i = 1; i < live.size(); i++)
+	{
+		if (live[i - 1].Page == live[i].Page)
+		{
+			TEST_CHECK(live[i - 1].Offset + live[i - 1].Size <= live[i].Offset);
+		}
+	}
+}
+
+int main()
+{
+	TestSizeClasses();
+	TestPageFillsBeforeGrowing();
+	TestEmptyPagesChangeClass();
+	TestFreedSlotIsReused();
+	TestChurn();
+
+	return TestResult("SlabAllocatorTests");
+}
@@ -0,0 +1,338 @@
+#include "Test.h"
+
+#include "StaticBufferPool.h"
+
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace rl;
+
+static constexpr uint64_t TestPageSize = 64u * 1024u;
+
+// Every allocation marks the 16 byte granules it covers, two live allocations sharing a granule is an overlap.
+static constexpr uint64_t GranuleSize = 16u;
+
+struct OwnedRanges
+{
+	explicit OwnedRanges(uint64_t size)
+		: Owners(size / GranuleSize)
+	{
+	}
+
+	bool Claim(uint64_t offset, uint64_t size)
+	{
+		bool exclusive = true;
+
+		for (uint64_t granule = offset / GranuleSize; granule < (offset + size) / GranuleSize; granule++)
+		{
+			exclusive &= Owners[granule].fetch_add(1u) == 0u;
+		}
+
+		return exclusive;
+	}
+
+	void Release(uint64_t offset, uint64_t size)
+	{
+		for (uint64_t granule = offset / GranuleSize; granule < (offset + size) / GranuleSize; granule++)
+		{
+			Owners[granule].fetch_sub(1u);
+		}
+	}
+
+	std::vector<std::atomic<uint32_t>> Owners;
+};
+
+// Stands in for a backend page, the copy fence is written by uploads on other threads like the dx12 pages.
+struct TestPage : StaticBufferPage
+{
+	explicit TestPage(uint32_t index)
+		: StaticBufferPage(TestPageSize)
+		, Index(index)
+		, Ranges(TestPageSize)
+	{
+	}
+
+	uint64_t GetCopyFence() const { return CopyFence.load(std::memory_order_acquire); }
+	void SetCopyFence(uint64_t fence) { CopyFence.store(fence, std::memory_order_release); }
+
+	uint32_t Index = 0u;
+	std::atomic<uint64_t> CopyFence = 0u;
+
+	OwnedRanges Ranges;
+};
+
+struct TestSlabPage
+{
+	explicit TestSlabPage(uint32_t index)
+		: Index(index)
+		, Ranges(SlabAllocator::PageSize)
+	{
+	}
+
+	uint32_t Index = 0u;
+
+	OwnedRanges Ranges;
+};
+
+static std::unique_ptr<TestPage> CreateTestPage(uint32_t index)
+{
+	return std::make_unique<TestPage>(index);
+}
+
+static std::unique_ptr<TestSlabPage> CreateTestSlabPage(uint32_t index)
+{
+	return std::make_unique<TestSlabPage>(index);
+}
+
+// Allocations go to a page with room before a new one is created.
+static void TestPagesFillBeforeGrowing()
+{
+	StaticBufferPageSet<TestPage> pages;
+
+	uint32_t created = 0u;
+	auto createPage = [&created](uint32_t index) { created++; return CreateTestPage(index); };
+
+	uint32_t page = 0u;
+	TlsfAllocation block;
+	TlsfAllocation quarters[4];
+
+	for (uint32_t i = 0; i < 4u; i++)
+	{
+		TEST_CHECK(pages.Alloc(TestPageSize / 4u, 256u, createPage, page, quarters[i]));
+		TEST_CHECK(page == 0u && quarters[i].Offset == i * TestPageSize / 4u);
+	}
+
+	TEST_CHECK(created == 1u);
+
+	TEST_CHECK(pages.Alloc(256u, 256u, createPage, page, block));
+	TEST_CHECK(page == 1u && created == 2u);
+
+	pages.Free(0u, quarters[1]);
+
+	// The freed quarter is found through the index as the tightest fit, the index leaves room for alignment so the request is a little smaller
+	TEST_CHECK(pages.Alloc(TestPageSize / 4u - 256u, 256u, createPage, page, block));
+	TEST_CHECK(page == 0u && block.Offset == TestPageSize / 4u && created == 2u);
+
+	TEST_CHECK(pages.GetPageCount() == 2u);
+}
+
+// A page that fails to create gives its slot back and the allocation fails cleanly.
+static void TestFailedPageCreation()
+{
+	StaticBufferPageSet<TestPage> pages;
+
+	uint32_t page = 0u;
+	TlsfAllocation block;
+
+	TEST_CHECK(!pages.Alloc(256u, 256u, [](uint32_t) { return std::unique_ptr<TestPage>(); }, page, block));
+	TEST_CHECK(pages.GetPageCount() == 0u);
+
+	TEST_CHECK(pages.Alloc(256u, 256u, CreateTestPage, page, block));
+	TEST_CHECK(page == 0u);
+
+	StaticBufferSlabSet<TestSlabPage> slabs;
+
+	SlabAllocation slab;
+	TEST_CHECK(!slabs.Alloc(256u, [](uint32_t) { return std::unique_ptr<TestSlabPage>(); }, slab));
+	TEST_CHECK(!slab.Valid() && slabs.GetAllocationCount() == 0u);
+
+	// The page is created again by the next allocation
+	TEST_CHECK(slabs.Alloc(256u, CreateTestSlabPage, slab));
+	TEST_CHECK(slab.Page == 0u && slabs.WithPage(0u, [](TestSlabPage& slabPage) { TEST_CHECK(slabPage.Index == 0u); }));
+}
+
+// Released pages leave the index and their slot is reused by the next page created.
+static void TestReleasedPageSlotsAreReused()
+{
+	StaticBufferPageSet<TestPage> pages;
+
+	uint32_t page = 0u;
+	TlsfAllocation block;
+
+	TlsfAllocation first;
+	TEST_CHECK(pages.Alloc(TestPageSize, 256u, CreateTestPage, page, first) && page == 0u);
+	TEST_CHECK(pages.Alloc(TestPageSize, 256u, CreateTestPage, page, block) && page == 1u);
+
+	pages.Free(0u, first);
+
+	{
+		std::unique_lock lock(pages.Mutex);
+
+		pages.Pages[0]->SetRetiring();
+		pages.Publish(0u, pages.Pages[0]->GetLargestFreeBlock());
+	}
+
+	// The retiring page is empty but not offered
+	TEST_CHECK(pages.Alloc(256u, 256u, CreateTestPage, page, block) && page == 2u);
+
+	pages.ReleasePage(0u);
+	TEST_CHECK(!pages.WithPage(0u, [](TestPage&) {}));
+
+	TEST_CHECK(pages.Alloc(TestPageSize, 256u, CreateTestPage, page, block) && page == 0u);
+	TEST_CHECK(pages.GetPageCount() == 3u);
+}
+
+// Loader threads create and destroy buffers and constant buffers while uploads record copy fences and the frame thread retires and releases empty pages.
+// Every live allocation claims its bytes, so an overlap fails a check and ThreadSanitizer sees every page, index and slab handover.
+static void TestConcurrentLoaders()
+{
+	constexpr uint32_t ThreadCount = 8u;
+	constexpr uint32_t OpsPerThread = 4000u;
+
+	StaticBufferPageSet<TestPage> pages;
+	StaticBufferSlabSet<TestSlabPage> slabs;
+
+	std::atomic<uint32_t> runningLoaders = ThreadCount;
+
+	std::thread frameThread([&]
+	{
+		std::vector<uint32_t> retiring;
+
+		while (runningLoaders.load() > 0u)
+		{
+			for (uint32_t page : retiring)
+			{
+				pages.ReleasePage(page);
+			}
+
+			retiring.clear();
+
+			// Compaction holds the pages exclusively while it picks empty pages to retire
+			std::unique_lock lock(pages.Mutex);
+
+			for (uint32_t page = 0; page < (uint32_t)pages.Pages.size(); page++)
+			{
+				if (pages.Pages[page] && !pages.Pages[page]->IsRetiring() && pages.Pages[page]->GetAllocator().GetAllocationCount() == 0u)
+				{
+					pages.Pages[page]->SetRetiring();
+					pages.Publish(page, pages.Pages[page]->GetLargestFreeBlock());
+
+					retiring.push_back(page);
+				}
+			}
+
+			lock.unlock();
+
+			std::this_thread::yield();
+		}
+
+		for (uint32_t page : retiring)
+		{
+			pages.ReleasePage(page);
+		}
+	});
+
+	std::vector<std::thread> loaders;
+
+	for (uint32_t thread = 0; thread < ThreadCount; thread++)
+	{
+		loaders.emplace_back([&, thread]
+		{
+			struct Live
+			{
+				bool Slab;
+				uint32_t Page;
+				TlsfAllocation Block;
+				SlabAllocation SlabBlock;
+			};
+
+			static constexpr uint64_t Strides[] = { 16u, 48u, 256u };
+
+			std::mt19937 rng(thread + 1u);
+			std::vector<Live> live;
+
+			auto destroy = [&](const Live& allocation)
+			{
+				if (allocation.Slab)
+				{
+					slabs.WithPage(allocation.SlabBlock.Page, [&](TestSlabPage& page) { page.Ranges.Release(allocation.SlabBlock.Offset, allocation.SlabBlock.Size); });
+					slabs.Free(allocation.SlabBlock);
+				}
+				else
+				{
+					pages.WithPage(allocation.Page, [&](TestPage& page) { page.Ranges.Release(allocation.Block.Offset, allocation.Block.Size); });
+					pages.Free(allocation.Page, allocation.Block);
+				}
+			};
+
+			for (uint32_t op = 0; op < OpsPerThread; op++)
+			{
+				if (live.size() >= 32u || (!live.empty() && rng() % 3u == 0u))
+				{
+					const size_t index = rng() % live.size();
+
+					destroy(live[index]);
+
+					live[index] = live.back();
+					live.pop_back();
+				}
+				else if (rng() % 2u == 0u)
+				{
+					Live allocation = { true };
+
+					TEST_CHECK(slabs.Alloc(16u + rng() % 4096u, CreateTestSlabPage, allocation.SlabBlock));
+					TEST_CHECK(slabs.WithPage(allocation.SlabBlock.Page, [&](TestSlabPage& page)
+					{
+						TEST_CHECK(page.Ranges.Claim(allocation.SlabBlock.Offset, allocation.SlabBlock.Size));
+					}));
+
+					live.push_back(allocation);
+				}
+				else
+				{
+					Live allocation = { false };
+
+					const uint64_t stride = Strides[rng() % 3u];
+					const uint64_t size = (1u + rng() % 512u) * GranuleSize;
+
+					TEST_CHECK(pages.Alloc(size, stride, CreateTestPage, allocation.Page, allocation.Block));
+					TEST_CHECK(allocation.Block.Offset % stride == 0u && allocation.Block.Offset + allocation.Block.Size <= TestPageSize);
+
+					// The upload recording its copy fence, the page can't be released while this allocation lives in it
+					TEST_CHECK(pages.WithPage(allocation.Page, [&](TestPage& page)
+					{
+						TEST_CHECK(page.Index == allocation.Page && !page.IsRetiring());
+						TEST_CHECK(page.Ranges.Claim(allocation.Block.Offset, allocation.Block.Size));
+
+						page.SetCopyFence(page.GetCopyFence() + 1u);
+					}));
+
+					live.push_back(allocation);
+				}
+			}
+
+			for (const Live& allocation : live)
+			{
+				destroy(allocation);
+			}
+
+			runningLoaders.fetch_sub(1u);
+		});
+	}
+
+	for (std::thread& loader : loaders)
+	{
+		loader.join();
+	}
+
+	frameThread.join();
+
+	TEST_CHECK(slabs.GetAllocationCount() == 0u);
+
+	for (const std::unique_ptr<TestPage>& page : pages.Pages)
+	{
+		TEST_CHECK(!page || page->GetAllocator().GetAllocationCount() == 0u);
+	}
+}
+
+int main()
+{
+	TestPagesFillBeforeGrowing();
+	TestFailedPageCreation();
+	TestReleasedPageSlotsAreReused();
+	TestConcurrentLoaders();
+
+	return TestResult("StaticBufferPoolTests");
+}
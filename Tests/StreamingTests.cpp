@@ -0,0 +1,229 @@
+#include "Test.h"
+
+#include "Render.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace rl
+{
+
+// Stands in for the backend, copies are recorded by Streaming_Update and the upload fence only completes when a test says so.
+struct StreamedCopy
+{
+	Buffer_t Dst = Buffer_t::INVALID;
+	size_t DstOffset = 0u;
+	size_t Size = 0u;
+	uint8_t FirstByte = 0u;
+};
+
+std::vector<StreamedCopy> g_Copies;
+std::atomic<int32_t> g_BufferRefs = 0;
+
+uint64_t g_UploadFence = 0u;
+uint64_t g_CompletedUploadFence = 0u;
+
+static const size_t DstSize = 64u * 1024u;
+
+bool Render_IsThreadSafe() { return false; }
+size_t GetBufferSize(Buffer_t buf) { return DstSize; }
+void UpdateBufferRange(Buffer_t buf, const void* const data, size_t offset, size_t size) { g_Copies.push_back({ buf, offset, size, *(const uint8_t*)data }); }
+uint64_t GetBufferUploadFence() { return ++g_UploadFence; }
+bool IsBufferUploadComplete(uint64_t fence) { return fence <= g_CompletedUploadFence; }
+void RenderRef(Buffer_t buf) { g_BufferRefs++; }
+void RenderRelease(Buffer_t buf) { g_BufferRefs--; }
+
+}
+
+using namespace rl;
+
+static const size_t FileSize = 4096u;
+
+static std::string WriteTestFile()
+{
+	const char* tmp = getenv("TMPDIR");
+	const std::string path = std::string(tmp ? tmp : "/tmp") + "/StreamingTests.bin";
+
+	std::vector<uint8_t> data(FileSize);
+	for (size_t i = 0; i < FileSize; i++)
+	{
+		data[i] = (uint8_t)(i * 7u + 3u);
+	}
+
+	FILE* file = fopen(path.c_str(), "wb");
+	TEST_CHECK(file != nullptr);
+
+	if (file)
+	{
+		TEST_CHECK(fwrite(data.data(), 1u, data.size(), file) == data.size());
+		fclose(file);
+	}
+
+	return path;
+}
+
+// Pumps Streaming_Update like the submitting thread does until the condition holds, false if it never does.
+template<typename Cond>
+static bool UpdateUntil(Cond&& cond)
+{
+	const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+	while (!cond())
+	{
+		if (std::chrono::steady_clock::now() > timeout)
+		{
+			return false;
+		}
+
+		Streaming_Update();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	return true;
+}
+
+struct Completion
+{
+	Buffer_t Dst;
+	bool Success;
+};
+
+static StreamRequest MakeRequest(const std::string& path, Buffer_t dst, StreamPriority priority, std::vector<Completion>& completions)
+{
+	StreamRequest request;
+	request.Path = path;
+	request.Size = FileSize;
+	request.Dst = dst;
+	request.DstOffset = 256u;
+	request.Priority = priority;
+	request.OnComplete = [&completions, dst](bool success) { completions.push_back({ dst, success }); };
+
+	return request;
+}
+
+// The first request fills the budget, so the rest queue until its upload fence completes and are then started highest priority first, same priorities in order.
+static void TestPriorityWithinBudget(const std::string& path)
+{
+	g_Copies.clear();
+
+	StreamingDesc desc;
+	desc.MaxInFlightBytes = FileSize;
+	TEST_CHECK(Streaming_Init(desc));
+
+	std::vector<Completion> completions;
+
+	TEST_CHECK(StreamToBuffer(MakeRequest(path, (Buffer_t)1u, StreamPriority::NORMAL, completions)));
+	TEST_CHECK(UpdateUntil([] { return g_Copies.size() == 1u; }));
+
+	TEST_CHECK(g_Copies[0].Dst == (Buffer_t)1u && g_Copies[0].DstOffset == 256u && g_Copies[0].Size == FileSize && g_Copies[0].FirstByte == 3u);
+
+	TEST_CHECK(StreamToBuffer(MakeRequest(path, (Buffer_t)2u, StreamPriority::LOW, completions)));
+	TEST_CHECK(StreamToBuffer(MakeRequest(path, (Buffer_t)3u, StreamPriority::HIGH, completions)));
+	TEST_CHECK(StreamToBuffer(MakeRequest(path, (Buffer_t)4u, StreamPriority::NORMAL, completions)));
+	TEST_CHECK(StreamToBuffer(MakeRequest(path, (Buffer_t)5u, StreamPriority::HIGH, completions)));
+
+	// Nothing completes or starts while the upload fence is pending
+	for (uint32_t i = 0; i < 20u; i++)
+	{
+		Streaming_Update();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	StreamingStats stats = GetStreamingStats();
+	TEST_CHECK(stats.QueuedRequests == 4u && stats.InFlightRequests == 1u && stats.InFlightBytes == FileSize);
+	TEST_CHECK(completions.empty() && g_Copies.size() == 1u);
+
+	const Buffer_t expectedOrder[] = { (Buffer_t)3u, (Buffer_t)5u, (Buffer_t)4u, (Buffer_t)2u };
+
+	for (Buffer_t expected : expectedOrder)
+	{
+		const size_t copies = g_Copies.size();
+
+		g_CompletedUploadFence = g_UploadFence;
+
+		TEST_CHECK(UpdateUntil([copies] { return g_Copies.size() == copies + 1u; }));
+		TEST_CHECK(g_Copies.back().Dst == expected);
+
+		// The previous request completed once its fence did, and only one request fits the budget at a time
+		TEST_CHECK(completions.size() == copies && completions.back().Success);
+		TEST_CHECK(GetStreamingStats().InFlightBytes == FileSize);
+	}
+
+	g_CompletedUploadFence = g_UploadFence;
+	TEST_CHECK(UpdateUntil([&completions] { return completions.size() == 5u; }));
+
+	stats = GetStreamingStats();
+	TEST_CHECK(stats.QueuedRequests == 0u && stats.InFlightRequests == 0u && stats.InFlightBytes == 0u);
+	TEST_CHECK(stats.StreamedBytes == 5u * FileSize);
+
+	Streaming_ShutDown();
+
+	TEST_CHECK(g_BufferRefs == 0);
+}
+
+// Requests that can't be read fail without a copy and without waiting for an upload fence, whole file requests are sized once opened.
+static void TestFailedAndWholeFileRequests(const std::string& path)
+{
+	g_Copies.clear();
+	g_CompletedUploadFence = g_UploadFence;
+
+	TEST_CHECK(Streaming_Init(StreamingDesc()));
+
+	std::vector<Completion> completions;
+
+	StreamRequest missing = MakeRequest(path + ".missing", (Buffer_t)1u, StreamPriority::NORMAL, completions);
+	TEST_CHECK(StreamToBuffer(std::move(missing)));
+
+	StreamRequest tooLarge = MakeRequest(path, (Buffer_t)2u, StreamPriority::NORMAL, completions);
+	tooLarge.DstOffset = DstSize - FileSize + 1u;
+	TEST_CHECK(StreamToBuffer(std::move(tooLarge)));
+
+	TEST_CHECK(UpdateUntil([&completions] { return completions.size() == 2u; }));
+	TEST_CHECK(!completions[0].Success && !completions[1].Success && g_Copies.empty());
+
+	StreamRequest wholeFile = MakeRequest(path, (Buffer_t)3u, StreamPriority::NORMAL, completions);
+	wholeFile.FileOffset = 1024u;
+	wholeFile.Size = 0u;
+	TEST_CHECK(StreamToBuffer(std::move(wholeFile)));
+
+	TEST_CHECK(UpdateUntil([] { return g_Copies.size() == 1u; }));
+	TEST_CHECK(g_Copies[0].Size == FileSize - 1024u && GetStreamingStats().InFlightBytes == FileSize - 1024u);
+
+	g_CompletedUploadFence = g_UploadFence;
+	TEST_CHECK(UpdateUntil([&completions] { return completions.size() == 3u; }));
+	TEST_CHECK(completions[2].Success && GetStreamingStats().InFlightBytes == 0u);
+
+	// Requests still queued at shut down are failed
+	StreamingDesc desc;
+	desc.MaxInFlightBytes = 1u;
+	g_CompletedUploadFence = 0u;
+
+	Streaming_ShutDown();
+	TEST_CHECK(Streaming_Init(desc));
+
+	TEST_CHECK(StreamToBuffer(MakeRequest(path, (Buffer_t)4u, StreamPriority::NORMAL, completions)));
+	TEST_CHECK(StreamToBuffer(MakeRequest(path, (Buffer_t)5u, StreamPriority::NORMAL, completions)));
+	TEST_CHECK(UpdateUntil([] { return g_Copies.size() == 2u; }));
+
+	Streaming_ShutDown();
+
+	TEST_CHECK(completions.size() == 5u && !completions[3].Success && !completions[4].Success);
+	TEST_CHECK(g_BufferRefs == 0);
+}
+
+int main()
+{
+	const std::string path = WriteTestFile();
+
+	TestPriorityWithinBudget(path);
+	TestFailedAndWholeFileRequests(path);
+
+	remove(path.c_str());
+
+	return TestResult("StreamingTests");
+}
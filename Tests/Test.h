@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdio>
+
+namespace rl
+{
+
+// Minimal checks for the backend agnostic unit tests, each test is its own executable run by ctest.
+inline int g_TestFailures = 0;
+
+#define TEST_CHECK(cond) \
+	do { if (!(cond)) { fprintf(stderr, "%s:%d: TEST_CHECK(%s) failed\n", __FILE__, __LINE__, #cond); rl::g_TestFailures++; } } while (0)
+
+inline int TestResult(const char* name)
+{
+	if (g_TestFailures > 0)
+	{
+		fprintf(stderr, "%s: %d checks failed\n", name, g_TestFailures);
+		return 1;
+	}
+
+	printf("%s: passed\n", name);
+	return 0;
+}
+
+}
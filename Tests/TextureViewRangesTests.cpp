@@ -0,0 +1,121 @@
+#include "Test.h"
+
+#include "TextureViewRanges.h"
+
+using namespace rl;
+
+static TextureCreateDescEx MakeDesc(TextureDimension dim, uint32_t depthOrArraySize, uint32_t mipCount)
+{
+	TextureCreateDescEx desc;
+	desc.Width = 256u;
+	desc.Height = 256u;
+	desc.Dimension = dim;
+	desc.DepthOrArraySize = depthOrArraySize;
+	desc.MipCount = mipCount;
+
+	return desc;
+}
+
+static TextureViewRange MakeRange(uint32_t firstMip, uint32_t mipLevels, uint32_t firstSlice, uint32_t sliceCount)
+{
+	TextureViewRange range;
+	range.FirstMip = firstMip;
+	range.MipLevels = mipLevels;
+	range.FirstSlice = firstSlice;
+	range.SliceCount = sliceCount;
+
+	return range;
+}
+
+static void TestMipRanges()
+{
+	const TextureCreateDescEx desc = MakeDesc(TextureDimension::TEX2D, 1u, 9u);
+
+	TEST_CHECK(IsRangeInTexture(desc, MakeRange(0u, ~0u, 0u, 1u)));
+	TEST_CHECK(IsRangeInTexture(desc, MakeRange(8u, ~0u, 0u, 1u)));
+	TEST_CHECK(IsRangeInTexture(desc, MakeRange(3u, 6u, 0u, 1u)));
+
+	TEST_CHECK(!IsRangeInTexture(desc, MakeRange(9u, ~0u, 0u, 1u)));
+	TEST_CHECK(!IsRangeInTexture(desc, MakeRange(3u, 7u, 0u, 1u)));
+
+	// Empty ranges aren't views of anything
+	TEST_CHECK(!IsRangeInTexture(desc, MakeRange(0u, 0u, 0u, 1u)));
+	TEST_CHECK(!IsRangeInTexture(desc, MakeRange(0u, 1u, 0u, 0u)));
+}
+
+static void TestSliceRanges()
+{
+	const TextureCreateDescEx array = MakeDesc(TextureDimension::TEX2D_ARRAY, 8u, 1u);
+
+	TEST_CHECK(IsRangeInTexture(array, MakeRange(0u, 1u, 0u, 8u)));
+	TEST_CHECK(IsRangeInTexture(array, MakeRange(0u, 1u, 7u, 1u)));
+	TEST_CHECK(!IsRangeInTexture(array, MakeRange(0u, 1u, 7u, 2u)));
+	TEST_CHECK(!IsRangeInTexture(array, MakeRange(0u, 1u, 8u, 1u)));
+
+	// Cubemap arrays have six slices per cube
+	const TextureCreateDescEx cubes = MakeDesc(TextureDimension::CUBEMAP_ARRAY, 2u, 1u);
+
+	TEST_CHECK(IsRangeInTexture(cubes, MakeRange(0u, 1u, 6u, 6u)));
+	TEST_CHECK(!IsRangeInTexture(cubes, MakeRange(0u, 1u, 6u, 7u)));
+}
+
+// Counts near 2^32 used to wrap around when added to the first mip or slice and pass.
+static void TestLargeCountsDontWrap()
+{
+	const TextureCreateDescEx desc = MakeDesc(TextureDimension::TEX2D_ARRAY, 8u, 4u);
+
+	TEST_CHECK(!IsRangeInTexture(desc, MakeRange(1u, ~0u - 1u, 0u, 1u)));
+	TEST_CHECK(!IsRangeInTexture(desc, MakeRange(0u, 1u, 1u, ~0u)));
+	TEST_CHECK(!IsRangeInTexture(desc, MakeRange(0u, 1u, 2u, ~0u - 1u)));
+	TEST_CHECK(!IsRangeInTexture(desc, MakeRange(0u, 1u, ~0u, 2u)));
+
+	const TextureCreateDescEx volume = MakeDesc(TextureDimension::TEX3D, 32u, 1u);
+
+	TEST_CHECK(!IsRangeInTexture(volume, MakeRange(0u, 1u, 4u, ~0u - 1u)));
+}
+
+// 3D views slice the depth of the mip they view, which halves with each mip.
+static void TestVolumeSlicesFollowMipDepth()
+{
+	const TextureCreateDescEx volume = MakeDesc(TextureDimension::TEX3D, 32u, 6u);
+
+	TEST_CHECK(IsRangeInTexture(volume, MakeRange(0u, 1u, 0u, 32u)));
+	TEST_CHECK(IsRangeInTexture(volume, MakeRange(2u, 1u, 0u, 8u)));
+	TEST_CHECK(IsRangeInTexture(volume, MakeRange(2u, 1u, 7u, 1u)));
+
+	TEST_CHECK(!IsRangeInTexture(volume, MakeRange(2u, 1u, 0u, 9u)));
+	TEST_CHECK(!IsRangeInTexture(volume, MakeRange(2u, 1u, 8u, 1u)));
+
+	// Every slice of the mip, and the smallest mips keep one slice
+	TEST_CHECK(IsRangeInTexture(volume, MakeRange(3u, 1u, 0u, ~0u)));
+	TEST_CHECK(!IsRangeInTexture(volume, MakeRange(3u, 1u, 4u, ~0u)));
+	TEST_CHECK(IsRangeInTexture(volume, MakeRange(5u, 1u, 0u, 1u)));
+	TEST_CHECK(!IsRangeInTexture(volume, MakeRange(5u, 1u, 1u, 1u)));
+}
+
+static void TestFullRanges()
+{
+	TEST_CHECK(GetFullTextureRange(TextureDimension::CUBEMAP, 1u, 1u).SliceCount == 6u);
+	TEST_CHECK(GetFullTextureRange(TextureDimension::CUBEMAP_ARRAY, 1u, 3u).SliceCount == 18u);
+	TEST_CHECK(GetFullTextureRange(TextureDimension::TEX3D, 1u, 16u).SliceCount == ~0u);
+	TEST_CHECK(GetFullTextureRange(TextureDimension::TEX2D_ARRAY, 5u, 4u).SliceCount == 4u);
+	TEST_CHECK(GetFullTextureRange(TextureDimension::TEX2D_ARRAY, 5u, 4u).MipLevels == 5u);
+
+	// What the range-less views cover is always in the texture
+	const TextureCreateDescEx volume = MakeDesc(TextureDimension::TEX3D, 16u, 5u);
+	TEST_CHECK(IsRangeInTexture(volume, GetFullTextureRange(TextureDimension::TEX3D, 5u, 16u)));
+
+	const TextureCreateDescEx cubes = MakeDesc(TextureDimension::CUBEMAP_ARRAY, 3u, 4u);
+	TEST_CHECK(IsRangeInTexture(cubes, GetFullTextureRange(TextureDimension::CUBEMAP_ARRAY, 4u, 3u)));
+}
+
+int main()
+{
+	TestMipRanges();
+	TestSliceRanges();
+	TestLargeCountsDontWrap();
+	TestVolumeSlicesFollowMipDepth();
+	TestFullRanges();
+
+	return TestResult("TextureViewRangesTests");
+}
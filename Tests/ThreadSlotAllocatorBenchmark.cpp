@@ -0,0 +1,244 @@
+#include "Benchmark.h"
+
+#include "AppendOnlyList.h"
+#include "ThreadSlotAllocator.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace rl;
+
+static ThreadSlotAllocator g_slots(64u);
+static std::atomic<uint32_t> g_counter = 0u;
+
+// The counter dynamic buffers used before, slots were never given back.
+static uint32_t GetCounterSlot()
+{
+	thread_local uint32_t slot = g_counter.fetch_add(1u, std::memory_order_relaxed);
+	return slot;
+}
+
+static uint32_t GetRecycledSlot()
+{
+	thread_local ThreadSlot slot;
+	return slot.Get(g_slots);
+}
+
+// The per allocation cost, every dynamic buffer looks up its thread's slot.
+template<typename Func>
+static void BenchmarkLookup(const char* name, uint32_t threadCount, Func&& getSlot)
+{
+	constexpr uint32_t LookupsPerThread = 10000000u;
+
+	Benchmark(name, LookupsPerThread, [&]
+	{
+		std::vector<std::thread> threads;
+
+		for (uint32_t i = 0; i < threadCount; i++)
+		{
+			threads.emplace_back([&]
+			{
+				uint64_t sum = 0u;
+				for (uint32_t lookup = 0; lookup < LookupsPerThread; lookup++)
+				{
+					sum += getSlot();
+				}
+
+				DoNotOptimize(sum);
+			});
+		}
+
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+	});
+}
+
+// Short lived job threads, each takes a slot on its first dynamic buffer and gives it back on exit.
+static void BenchmarkThreadChurn()
+{
+	constexpr uint32_t FrameCount = 500u;
+	constexpr uint32_t ThreadsPerFrame = 16u;
+
+	Benchmark("thread slots, acquire and release per thread", FrameCount * ThreadsPerFrame, []
+	{
+		for (uint32_t frame = 0; frame < FrameCount; frame++)
+		{
+			std::vector<std::thread> threads;
+
+			for (uint32_t i = 0; i < ThreadsPerFrame; i++)
+			{
+				threads.emplace_back([] { DoNotOptimize(GetRecycledSlot()); });
+			}
+
+			for (std::thread& thread : threads)
+			{
+				thread.join();
+			}
+
+			g_slots.Recycle([](uint32_t) {});
+		}
+	});
+
+	printf("%-56s %12u\n", "slots used after churn", g_slots.GetUsedCount());
+}
+
+// Stands in for a dynamic buffer upload page, only the bump offset is needed to compare the two paths.
+struct BumpPage
+{
+	static constexpr uint64_t PageSize = 2u * 1024u * 1024u;
+
+	uint64_t Offset = 0u;
+
+	bool Allocate(uint64_t size, uint64_t alignment, uint64_t& outOffset)
+	{
+		const uint64_t offset = (Offset + alignment - 1u) / alignment * alignment;
+
+		if (offset + size > PageSize)
+		{
+			return false;
+		}
+
+		outOffset = offset;
+		Offset = offset + size;
+
+		return true;
+	}
+};
+
+struct BumpAllocation
+{
+	uint32_t Page = 0u;
+	uint64_t Offset = 0u;
+	uint64_t Size = 0u;
+};
+
+static constexpr uint32_t AllocationThreads = 8u;
+static constexpr uint32_t AllocationsPerThread = 200000u;
+
+// Constant buffer sized allocations, the size varies so the bump offset has to be aligned each time.
+static uint64_t GetAllocationSize(uint32_t allocation)
+{
+	return 64u + (allocation % 7u) * 48u;
+}
+
+// The single upload buffer and handle list dynamic buffers used before, made safe for several threads with one lock.
+static void BenchmarkGlobalBumpAllocation()
+{
+	std::mutex mutex;
+	std::vector<BumpPage> pages(1u);
+	std::vector<BumpAllocation> allocations;
+
+	Benchmark("global bump allocation under a lock, 8 threads", AllocationsPerThread, [&]
+	{
+		std::vector<std::thread> threads;
+
+		for (uint32_t i = 0; i < AllocationThreads; i++)
+		{
+			threads.emplace_back([&]
+			{
+				uint64_t sum = 0u;
+
+				for (uint32_t allocation = 0; allocation < AllocationsPerThread; allocation++)
+				{
+					const uint64_t size = GetAllocationSize(allocation);
+
+					std::scoped_lock lock(mutex);
+
+					BumpAllocation alloc = { (uint32_t)pages.size() - 1u, 0u, size };
+					if (!pages.back().Allocate(size, 256u, alloc.Offset))
+					{
+						pages.emplace_back().Allocate(size, 256u, alloc.Offset);
+						alloc.Page++;
+					}
+
+					allocations.push_back(alloc);
+					sum += allocations.size();
+				}
+
+				DoNotOptimize(sum);
+			});
+		}
+
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+	});
+}
+
+// AllocateDynamic, each thread bumps through its own page and publishes the allocation to its own list.
+static void BenchmarkPerThreadBumpAllocation()
+{
+	using AllocationList = AppendOnlyList<BumpAllocation, 4096u, 256u>;
+
+	struct ThreadAllocator
+	{
+		std::vector<BumpPage> Pages;
+		AllocationList Allocations;
+	};
+
+	ThreadSlotAllocator slots(64u);
+	std::unique_ptr<ThreadAllocator[]> allocators = std::make_unique<ThreadAllocator[]>(64u);
+
+	Benchmark("per thread bump allocation, 8 threads", AllocationsPerThread, [&]
+	{
+		std::vector<std::thread> threads;
+
+		for (uint32_t i = 0; i < AllocationThreads; i++)
+		{
+			threads.emplace_back([&]
+			{
+				uint64_t sum = 0u;
+
+				for (uint32_t allocation = 0; allocation < AllocationsPerThread; allocation++)
+				{
+					thread_local ThreadSlot slot;
+					ThreadAllocator& allocator = allocators[slot.Get(slots)];
+
+					const uint64_t size = GetAllocationSize(allocation);
+
+					if (allocator.Pages.empty())
+					{
+						allocator.Pages.emplace_back();
+					}
+
+					BumpAllocation alloc = { (uint32_t)allocator.Pages.size() - 1u, 0u, size };
+					if (!allocator.Pages.back().Allocate(size, 256u, alloc.Offset))
+					{
+						allocator.Pages.emplace_back().Allocate(size, 256u, alloc.Offset);
+						alloc.Page++;
+					}
+
+					sum += allocator.Allocations.Push(alloc);
+				}
+
+				DoNotOptimize(sum);
+			});
+		}
+
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+	});
+}
+
+int main()
+{
+	BenchmarkLookup("counter slot lookup, 8 threads", 8u, GetCounterSlot);
+	BenchmarkLookup("recycled slot lookup, 8 threads", 8u, GetRecycledSlot);
+
+	g_slots.Recycle([](uint32_t) {});
+
+	BenchmarkThreadChurn();
+
+	BenchmarkGlobalBumpAllocation();
+	BenchmarkPerThreadBumpAllocation();
+
+	return 0;
+}
@@ -0,0 +1,167 @@
+#include "Test.h"
+
+#include "ThreadSlotAllocator.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace rl;
+
+static void TestSlotsAreDense()
+{
+	ThreadSlotAllocator slots(4u);
+
+	TEST_CHECK(slots.Acquire() == 0u);
+	TEST_CHECK(slots.Acquire() == 1u);
+	TEST_CHECK(slots.GetUsedCount() == 2u);
+}
+
+// A released slot isn't handed out again until it is recycled, and the reset runs first.
+static void TestReleasedSlotWaitsForRecycle()
+{
+	ThreadSlotAllocator slots(2u);
+
+	const uint32_t a = slots.Acquire();
+	const uint32_t b = slots.Acquire();
+
+	TEST_CHECK(slots.Acquire() == ThreadSlotAllocator::InvalidSlot);
+
+	slots.Release(a);
+	TEST_CHECK(slots.Acquire() == ThreadSlotAllocator::InvalidSlot);
+
+	std::vector<uint32_t> reset;
+	slots.Recycle([&](uint32_t slot) { reset.push_back(slot); });
+
+	TEST_CHECK(reset.size() == 1u && reset[0] == a);
+	TEST_CHECK(slots.Acquire() == a);
+	TEST_CHECK(slots.GetUsedCount() == 2u);
+
+	slots.Release(b);
+}
+
+// Every slot belongs to a live thread, the next thread fails cleanly and succeeds once one exits and its slot is recycled.
+static void TestExhaustionFailsCleanly()
+{
+	ThreadSlotAllocator slots(4u);
+
+	std::atomic<uint32_t> acquired = 0u;
+	std::atomic<bool> release = false;
+
+	std::vector<std::thread> holders;
+	for (uint32_t i = 0; i < 4u; i++)
+	{
+		holders.emplace_back([&]
+		{
+			thread_local ThreadSlot slot;
+			TEST_CHECK(slot.Get(slots) != ThreadSlotAllocator::InvalidSlot);
+
+			acquired.fetch_add(1u);
+			while (!release.load())
+			{
+				std::this_thread::yield();
+			}
+		});
+	}
+
+	while (acquired.load() < 4u)
+	{
+		std::this_thread::yield();
+	}
+
+	std::thread([&]
+	{
+		thread_local ThreadSlot slot;
+		TEST_CHECK(slot.Get(slots) == ThreadSlotAllocator::InvalidSlot);
+	}).join();
+
+	release.store(true);
+	for (std::thread& thread : holders)
+	{
+		thread.join();
+	}
+
+	slots.Recycle([](uint32_t) {});
+
+	std::thread([&]
+	{
+		thread_local ThreadSlot slot;
+		TEST_CHECK(slot.Get(slots) != ThreadSlotAllocator::InvalidSlot);
+	}).join();
+
+	TEST_CHECK(slots.GetUsedCount() == 4u);
+}
+
+// Short lived threads over many frames, far more threads than slots.
+// Each slot's data is written without atomics by its thread and read and reset by the frame thread, so ThreadSanitizer checks the handovers.
+static void TestThreadChurn()
+{
+	constexpr uint32_t Capacity = 8u;
+	constexpr uint32_t FrameCount = 200u;
+	constexpr uint32_t ThreadsPerFrame = 6u;
+
+	struct SlotData
+	{
+		uint64_t Writes = 0u;
+		std::atomic<uint32_t> Owners = 0u;
+	};
+
+	ThreadSlotAllocator slots(Capacity);
+	SlotData data[Capacity];
+
+	uint64_t totalWrites = 0u;
+
+	for (uint32_t frame = 0; frame < FrameCount; frame++)
+	{
+		std::vector<std::thread> threads;
+
+		for (uint32_t i = 0; i < ThreadsPerFrame; i++)
+		{
+			threads.emplace_back([&]
+			{
+				thread_local ThreadSlot slot;
+
+				const uint32_t index = slot.Get(slots);
+				TEST_CHECK(index < Capacity);
+
+				if (index >= Capacity)
+					return;
+
+				TEST_CHECK(data[index].Owners.fetch_add(1u) == 0u);
+
+				for (uint32_t write = 0; write < 100u; write++)
+				{
+					data[index].Writes++;
+				}
+
+				data[index].Owners.fetch_sub(1u);
+			});
+		}
+
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+
+		// The end of the frame, every thread has exited so all of their slots come back
+		slots.Recycle([&](uint32_t slot)
+		{
+			totalWrites += data[slot].Writes;
+			data[slot].Writes = 0u;
+		});
+
+		TEST_CHECK(slots.GetUsedCount() <= Capacity);
+	}
+
+	TEST_CHECK(totalWrites == (uint64_t)FrameCount * ThreadsPerFrame * 100u);
+}
+
+int main()
+{
+	TestSlotsAreDense();
+	TestReleasedSlotWaitsForRecycle();
+	TestExhaustionFailsCleanly();
+	TestThreadChurn();
+
+	return TestResult("ThreadSlotAllocatorTests");
+}
@@ -0,0 +1,193 @@
+#include "Benchmark.h"
+
+#include "TlsfAllocator.h"
+
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace rl;
+
+// The offset and size maps the dx12 static buffer pages used before TlsfAllocator, without the gpu resources.
+struct MapPageAllocator
+{
+	struct Block;
+	using FreeBlocksByOffsetMap = std::map<uint64_t, Block>;
+	using FreeBlocksBySizeMap = std::multimap<uint64_t, FreeBlocksByOffsetMap::iterator>;
+
+	struct Block
+	{
+		FreeBlocksBySizeMap::iterator OrderBySizeIt;
+
+		uint64_t Size() const { return OrderBySizeIt->first; }
+	};
+
+	FreeBlocksByOffsetMap FreeBlocksByOffset;
+	FreeBlocksBySizeMap FreeBlocksBySize;
+
+	explicit MapPageAllocator(uint64_t size)
+	{
+		AddFreeBlock(0u, size);
+	}
+
+	void AddFreeBlock(uint64_t offset, uint64_t size)
+	{
+		FreeBlocksByOffsetMap::iterator blockIt = FreeBlocksByOffset.emplace(offset, Block{}).first;
+		blockIt->second.OrderBySizeIt = FreeBlocksBySize.emplace(size, blockIt);
+	}
+
+	bool Alloc(uint64_t size, uint64_t alignment, uint64_t& outOffset)
+	{
+		for (FreeBlocksBySizeMap::iterator it = FreeBlocksBySize.lower_bound(size); it != FreeBlocksBySize.end(); it++)
+		{
+			const uint64_t blockOffset = it->second->first;
+			const uint64_t blockSize = it->first;
+			const uint64_t alignedOffset = (blockOffset + alignment - 1u) / alignment * alignment;
+			const uint64_t padding = alignedOffset - blockOffset;
+
+			if (padding + size > blockSize)
+			{
+				continue;
+			}
+
+			FreeBlocksByOffset.erase(it->second);
+			FreeBlocksBySize.erase(it);
+
+			if (padding > 0u)
+			{
+				AddFreeBlock(blockOffset, padding);
+			}
+
+			if (blockSize - padding - size > 0u)
+			{
+				AddFreeBlock(alignedOffset + size, blockSize - padding - size);
+			}
+
+			outOffset = alignedOffset;
+			return true;
+		}
+
+		return false;
+	}
+
+	void Free(uint64_t offset, uint64_t size)
+	{
+		FreeBlocksByOffsetMap::iterator next = FreeBlocksByOffset.upper_bound(offset);
+
+		if (next != FreeBlocksByOffset.begin())
+		{
+			FreeBlocksByOffsetMap::iterator prev = std::prev(next);
+
+			if (prev->first + prev->second.Size() == offset)
+			{
+				offset = prev->first;
+				size += prev->second.Size();
+
+				FreeBlocksBySize.erase(prev->second.OrderBySizeIt);
+				FreeBlocksByOffset.erase(prev);
+			}
+		}
+
+		if (next != FreeBlocksByOffset.end() && offset + size == next->first)
+		{
+			size += next->second.Size();
+
+			FreeBlocksBySize.erase(next->second.OrderBySizeIt);
+			FreeBlocksByOffset.erase(next);
+		}
+
+		AddFreeBlock(offset, size);
+	}
+};
+
+struct ChurnOp
+{
+	bool Alloc;
+	uint64_t Size;
+	uint32_t Slot;
+};
+
+// Vertex and index sized allocations in a 2MB page, kept around half full like a streaming level.
+static std::vector<ChurnOp> MakeChurn(uint32_t count)
+{
+	std::vector<ChurnOp> ops;
+	std::vector<uint32_t> live;
+
+	std::mt19937 rng(1234u);
+	std::uniform_int_distribution<uint64_t> sizes(256u, 32u * 1024u);
+
+	uint32_t nextSlot = 0u;
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		if (live.size() < 64u || (live.size() < 256u && rng() % 2u == 0u))
+		{
+			ops.push_back({ true, sizes(rng), nextSlot });
+			live.push_back(nextSlot++);
+		}
+		else
+		{
+			const size_t index = rng() % live.size();
+			ops.push_back({ false, 0u, live[index] });
+			live[index] = live.back();
+			live.pop_back();
+		}
+	}
+
+	return ops;
+}
+
+int main()
+{
+	constexpr uint64_t PageSize = 2u * 1024u * 1024u;
+	constexpr uint64_t Alignment = 256u;
+	constexpr uint32_t OpCount = 1000000u;
+
+	const std::vector<ChurnOp> ops = MakeChurn(OpCount);
+
+	{
+		MapPageAllocator allocator(PageSize);
+		std::vector<uint64_t> offsets(OpCount, ~0ull);
+		std::vector<uint64_t> allocSizes(OpCount, 0u);
+
+		Benchmark("map page churn, alloc and free", OpCount, [&]
+		{
+			for (const ChurnOp& op : ops)
+			{
+				if (op.Alloc)
+				{
+					if (allocator.Alloc(op.Size, Alignment, offsets[op.Slot]))
+					{
+						allocSizes[op.Slot] = op.Size;
+					}
+				}
+				else if (offsets[op.Slot] != ~0ull)
+				{
+					allocator.Free(offsets[op.Slot], allocSizes[op.Slot]);
+				}
+			}
+		});
+	}
+
+	{
+		TlsfAllocator allocator(PageSize);
+		std::vector<TlsfAllocation> allocations(OpCount);
+
+		Benchmark("tlsf churn, alloc and free", OpCount, [&]
+		{
+			for (const ChurnOp& op : ops)
+			{
+				if (op.Alloc)
+				{
+					allocator.Alloc(op.Size, Alignment, allocations[op.Slot]);
+				}
+				else if (allocations[op.Slot].Valid())
+				{
+					allocator.Free(allocations[op.Slot]);
+				}
+			}
+		});
+	}
+
+	return 0;
+}
@@ -0,0 +1,264 @@
+#include "Test.h"
+
+#include "TlsfAllocator.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace rl;
+
+static constexpr uint64_t KB = 1024u;
+static constexpr uint64_t MB = 1024u * KB;
+static constexpr uint64_t GB = 1024u * MB;
+
+static void TestExactFit()
+{
+	// A block of exactly the requested size lives in the size's own class, which the rounded up search skips
+	for (uint64_t total : { uint64_t(31u), uint64_t(32u), uint64_t(100u), 2 * MB, 64 * MB, 3 * MB + 17u })
+	{
+		TlsfAllocator allocator(total);
+
+		TlsfAllocation allocation;
+		TEST_CHECK(allocator.Alloc(total, 1u, allocation));
+		TEST_CHECK(allocation.Offset == 0u && allocation.Size == total);
+		TEST_CHECK(allocator.GetFreeSize() == 0u);
+
+		allocator.Free(allocation);
+		TEST_CHECK(allocator.GetFreeSize() == total);
+	}
+
+	TlsfAllocator heap(64 * MB);
+
+	TlsfAllocation allocation;
+	TEST_CHECK(heap.Alloc(64 * MB, 64 * KB, allocation));
+	TEST_CHECK(allocation.Offset == 0u);
+}
+
+static void TestExactFitAfterCoalescing()
+{
+	const uint64_t total = 4 * MB;
+
+	TlsfAllocator allocator(total);
+
+	std::vector<TlsfAllocation> allocations;
+
+	TlsfAllocation allocation;
+	while (allocator.Alloc(4 * KB, 256u, allocation))
+	{
+		allocations.push_back(allocation);
+	}
+
+	TEST_CHECK(allocator.GetFreeSize() == 0u);
+
+	std::mt19937 rng(7u);
+	std::shuffle(allocations.begin(), allocations.end(), rng);
+
+	for (const TlsfAllocation& a : allocations)
+	{
+		allocator.Free(a);
+	}
+
+	TEST_CHECK(allocator.GetAllocationCount() == 0u);
+	TEST_CHECK(allocator.GetLargestFreeBlockHint() == total);
+
+	TEST_CHECK(allocator.Alloc(total, 1u, allocation));
+}
+
+// Placement heaps round sizes to 64KB and allocate with no alignment, so a heap sized for its buffers must fit them exactly.
+static void TestPlacementHeapFillsExactly()
+{
+	const uint64_t placementAlignment = 64 * KB;
+
+	TlsfAllocator dedicated(96 * MB);
+
+	TlsfAllocation allocation;
+	TEST_CHECK(dedicated.Alloc(96 * MB, 1u, allocation));
+
+	TlsfAllocator pooled(64 * MB);
+
+	std::vector<TlsfAllocation> blocks;
+	std::mt19937 rng(9u);
+
+	uint64_t used = 0u;
+	while (true)
+	{
+		const uint64_t size = (1u + rng() % 64u) * placementAlignment;
+		if (used + size > 64 * MB)
+			break;
+
+		TEST_CHECK(pooled.Alloc(size, 1u, allocation));
+		TEST_CHECK(allocation.Offset % placementAlignment == 0u);
+
+		blocks.push_back(allocation);
+		used += size;
+	}
+
+	// Free every other block, the gaps stay aligned and are refilled in place
+	for (size_t i = 0; i < blocks.size(); i += 2u)
+	{
+		pooled.Free(blocks[i]);
+	}
+
+	for (size_t i = 0; i < blocks.size(); i += 2u)
+	{
+		TEST_CHECK(pooled.Alloc(blocks[i].Size, 1u, allocation));
+		TEST_CHECK(allocation.Offset % placementAlignment == 0u);
+	}
+
+	TEST_CHECK(pooled.GetFreeSize() == 64 * MB - used);
+}
+
+static void TestAlignment()
+{
+	TlsfAllocator allocator(1 * MB);
+
+	// One byte first so the following allocations start unaligned
+	TlsfAllocation first;
+	TEST_CHECK(allocator.Alloc(1u, 1u, first));
+
+	for (uint64_t alignment : { 2u, 3u, 256u, 1000u, 4096u, 65536u })
+	{
+		TlsfAllocation allocation;
+		TEST_CHECK(allocator.Alloc(100u, alignment, allocation));
+		TEST_CHECK(allocation.Offset % alignment == 0u);
+		TEST_CHECK(allocation.Size == 100u);
+	}
+}
+
+static void TestFailureLeavesAllocatorUnchanged()
+{
+	TlsfAllocator allocator(1 * MB);
+
+	TlsfAllocation allocation;
+	TEST_CHECK(!allocator.Alloc(1 * MB + 1u, 1u, allocation));
+	TEST_CHECK(!allocation.Valid());
+	TEST_CHECK(!allocator.Alloc(~0ull, 1u, allocation));
+	TEST_CHECK(allocator.GetFreeSize() == 1 * MB);
+	TEST_CHECK(allocator.GetAllocationCount() == 0u);
+}
+
+// Random churn checked against the live allocations, nothing may overlap and the free size must always add up.
+static void TestChurn()
+{
+	const uint64_t total = 16 * MB;
+
+	TlsfAllocator allocator(total);
+
+	std::vector<TlsfAllocation> live;
+	std::mt19937 rng(42u);
+	std::uniform_int_distribution<uint64_t> sizes(1u, 256 * KB);
+	const uint64_t alignments[] = { 1u, 4u, 256u, 4 * KB, 64 * KB };
+
+	uint64_t used = 0u;
+
+	for (uint32_t i = 0; i < 20000u; i++)
+	{
+		if (live.empty() || rng() % 3u != 0u)
+		{
+			const uint64_t alignment = alignments[rng() % 5u];
+
+			TlsfAllocation allocation;
+			if (allocator.Alloc(sizes(rng), alignment, allocation))
+			{
+				TEST_CHECK(allocation.Offset % alignment == 0u);
+				TEST_CHECK(allocation.Offset + allocation.Size <= total);
+
+				live.push_back(allocation);
+				used += allocation.Size;
+			}
+		}
+		else
+		{
+			const size_t index = rng() % live.size();
+
+			allocator.Free(live[index]);
+			used -= live[index].Size;
+
+			live[index] = live.back();
+			live.pop_back();
+		}
+
+		TEST_CHECK(allocator.GetFreeSize() == total - used);
+		TEST_CHECK(allocator.GetLargestFreeBlockHint() <= allocator.GetLargestFreeBlockUpperBound());
+	}
+
+	std::sort(live.begin(), live.end(), [](const TlsfAllocation& a, const TlsfAllocation& b) { return a.Offset < b.Offset; });
+
+	for (size_t i = 1; i < live.size(); i++)
+	{
+		TEST_CHECK(live[i - 1].Offset + live[i - 1].Size <= live[i].Offset);
+	}
+
+	for (const TlsfAllocation& allocation : live)
+	{
+		allocator.Free(allocation);
+	}
+
+	TlsfAllocation whole;
+	TEST_CHECK(allocator.Alloc(total, 1u, whole));
+}
+
+// Point cloud and terrain buffers over 4GB get a dedicated heap, and pooled heaps can hold blocks past the first 4GB.
+// Every size and offset here would be wrong if any were truncated to 32 bits.
+static void TestMultiGigabyteHeaps()
+{
+	TlsfAllocator allocator(16 * GB);
+
+	TlsfAllocation sixGB;
+	TEST_CHECK(allocator.Alloc(6 * GB, 64 * KB, sixGB));
+	TEST_CHECK(sixGB.Offset == 0u && sixGB.Size == 6 * GB);
+
+	TlsfAllocation fiveGB;
+	TEST_CHECK(allocator.Alloc(5 * GB, 64 * KB, fiveGB));
+	TEST_CHECK(fiveGB.Offset == 6 * GB && fiveGB.Size == 5 * GB);
+
+	TlsfAllocation justOver4GB;
+	TEST_CHECK(allocator.Alloc(4 * GB + 1u, 1u, justOver4GB));
+	TEST_CHECK(justOver4GB.Offset == 11 * GB && justOver4GB.Size == 4 * GB + 1u);
+
+	TEST_CHECK(allocator.GetFreeSize() == GB - 1u);
+	TEST_CHECK(allocator.GetLargestFreeBlockUpperBound() >= GB - 1u);
+
+	// Small blocks placed above 4GB keep their full offsets
+	TlsfAllocation small;
+	TEST_CHECK(allocator.Alloc(256u, 256u, small));
+	TEST_CHECK(small.Offset >= 15 * GB && small.Offset % 256u == 0u);
+	allocator.Free(small);
+
+	// The hole left by the 5GB block is reused exactly, a larger request can't fit anywhere
+	allocator.Free(fiveGB);
+
+	TlsfAllocation tooLarge;
+	TEST_CHECK(!allocator.Alloc(5 * GB + GB, 1u, tooLarge));
+
+	TEST_CHECK(allocator.Alloc(5 * GB, 64 * KB, fiveGB));
+	TEST_CHECK(fiveGB.Offset == 6 * GB);
+
+	allocator.Free(sixGB);
+	allocator.Free(fiveGB);
+	allocator.Free(justOver4GB);
+
+	TEST_CHECK(allocator.GetFreeSize() == 16 * GB && allocator.GetAllocationCount() == 0u);
+
+	// A dedicated heap for a 6GB buffer is sized to the buffer and filled exactly
+	const uint64_t heapSize = (6 * GB + 1u + 64 * KB - 1u) / (64 * KB) * (64 * KB);
+	TlsfAllocator dedicated(heapSize);
+
+	TlsfAllocation buffer;
+	TEST_CHECK(dedicated.Alloc(heapSize, 1u, buffer));
+	TEST_CHECK(buffer.Offset == 0u && buffer.Size == heapSize && dedicated.GetFreeSize() == 0u);
+}
+
+int main()
+{
+	TestExactFit();
+	TestExactFitAfterCoalescing();
+	TestPlacementHeapFillsExactly();
+	TestAlignment();
+	TestFailureLeavesAllocatorUnchanged();
+	TestChurn();
+	TestMultiGigabyteHeaps();
+
+	return TestResult("TlsfAllocatorTests");
+}